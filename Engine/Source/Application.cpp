@@ -9,9 +9,12 @@
 #include "ResourcesModule.h"
 #include "ShaderDescriptorsModule.h"
 #include "SamplersModule.h"
+#include "PipelineCacheModule.h"
 #include "ExerciseModule.h"
 #include "CameraModule.h"
 #include "RingBufferModule.h"
+#include "JobSystemModule.h"
+#include "JobSystem.h"
 
 
 
@@ -20,15 +23,21 @@ Application::Application(int argc, wchar_t** argv, void* hWnd)
     Timer t;
     t.Start();
 
-    modules.push_back(new ModuleInput((HWND)hWnd));
+    // Before any module: exercises create their pipelines from it in init()
+    shaderArchive.open(ShaderArchive::ARCHIVE_FILE);
+
+    // First module: every other module may hand work to the job system
+    modules.push_back(jobSystem = new JobSystemModule());
+    modules.push_back(input = new ModuleInput((HWND)hWnd));
     modules.push_back(d3d12 = new D3D12Module((HWND)hWnd));
+    modules.push_back(pipelineCache = new PipelineCacheModule());
     modules.push_back(resources = new ResourcesModule());
     modules.push_back(shaderDescriptors = new ShaderDescriptorsModule());
     modules.push_back(samplers = new SamplersModule());
     modules.push_back(camera = new CameraModule());
     modules.push_back(ringBuffer = new RingBufferModule());
 
-    // Last Module to be pushed must be the Editor Module
+    // Pushed last: it reads everything, so the scheduler orders it after the rest
     modules.push_back(new EditorModule((HWND)hWnd, d3d12));
 
     t.Stop();
@@ -58,7 +67,18 @@ bool Application::init()
 
     debugDrawPass = std::make_unique<DebugDrawPass>(d3d12->getDevice(), d3d12->getCommandQueue());
 
-    lastMilis = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    scheduler.build(modules);
+    for (size_t p = 0; p < size_t(ModulePhase::Count); ++p)
+    {
+        ModulePhase phase = ModulePhase(p);
+        Logger::Log(std::string("Scheduler ") + ModuleScheduler::getPhaseName(phase) + ": " +
+            std::to_string(scheduler.getNodeCount(phase)) + " modules, " +
+            std::to_string(scheduler.getEdgeCount(phase)) + " dependencies, " +
+            std::to_string(scheduler.getRootCount(phase)) + " ready at start");
+    }
+
+    // Loading time is not simulated
+    time.reset();
 
     t.Stop();
     Logger::Log("Applicaion initialized in: " + std::to_string(t.ReadMs()) + " ms");
@@ -68,53 +88,51 @@ bool Application::init()
 
 void Application::update()
 {
-    static Timer updateTimer, preRenderTimer, renderTimer, postRenderTimer;
-    static float updateMs = 0.0f, preRenderMs = 0.0f, renderMs = 0.0f, postRenderMs = 0.0f;
-
-    using namespace std::chrono_literals;
-
-    // Update milis
-    uint64_t currentMilis = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    // Fixed steps of simulation that fit in the time since last frame
+    const uint32_t steps = time.beginFrame();
 
-    elapsedMilis = currentMilis - lastMilis;
-    lastMilis = currentMilis;
     tickSum -= tickList[tickIndex];
-    tickSum += elapsedMilis;
-    tickList[tickIndex] = elapsedMilis;
+    tickSum += time.getFrameUs();
+    tickList[tickIndex] = time.getFrameUs();
     tickIndex = (tickIndex + 1) % MAX_FPS_TICKS;
 
     if (!app->paused)
     {
-        updateTimer.Start();
-        for (auto it = modules.begin(); it != modules.end(); ++it)
-            (*it)->update();
-        updateTimer.Stop();
-        updateMs = updateTimer.ReadMs();
-
-        preRenderTimer.Start();
-        for (auto it = modules.begin(); it != modules.end(); ++it)
-            (*it)->preRender();
-        preRenderTimer.Stop();
-        preRenderMs = preRenderTimer.ReadMs();
-
-        renderTimer.Start();
-        for (auto it = modules.begin(); it != modules.end(); ++it)
-            (*it)->render();
-        renderTimer.Stop();
-        renderMs = renderTimer.ReadMs();
-
-        postRenderTimer.Start();
-        for (auto it = modules.begin(); it != modules.end(); ++it)
-            (*it)->postRender();
-        postRenderTimer.Stop();
-        postRenderMs = postRenderTimer.ReadMs();
-
-        app->updateMs = updateMs;
-        app->preRenderMs = preRenderMs;
-        app->renderMs = renderMs;
-        app->postRenderMs = postRenderMs;
-
+        JobSystem* jobs = getJobSystem();
+
+        if (pipelined && jobs && jobs->getWorkerCount() > 0)
+        {
+            // Render the snapshots published last frame while the next
+            // simulation steps run on the workers, then hand them over
+            JobCounter simulation;
+            scheduler.runAsync(ModulePhase::Update, *jobs, simulation, steps);
+
+            scheduler.run(ModulePhase::PreRender, jobs);
+            scheduler.run(ModulePhase::Render, jobs);
+            scheduler.run(ModulePhase::PostRender, jobs);
+
+            scheduler.waitAsync(ModulePhase::Update, *jobs, simulation);
+            scheduler.publish();
+        }
+        else
+        {
+            // Independent modules overlap in update / preRender; render and
+            // postRender record the frame command list, so they stay in order
+            scheduler.run(ModulePhase::Update, jobs, steps);
+            scheduler.publish();
+
+            scheduler.run(ModulePhase::PreRender, jobs);
+            scheduler.run(ModulePhase::Render, jobs);
+            scheduler.run(ModulePhase::PostRender, jobs);
+        }
     }
+
+    time.limitFrame();
+}
+
+JobSystem* Application::getJobSystem()
+{
+    return jobSystem ? jobSystem->getJobSystem() : nullptr;
 }
 
 bool Application::cleanUp()
@@ -1,19 +1,25 @@
 #pragma once
 
 #include "Globals.h"
+#include "ModuleScheduler.h"
+#include "TimeService.h"
+#include "ShaderArchive.h"
 
 #include <array>
 #include <vector>
-#include <chrono>
 
 class Module;
 class D3D12Module;
 class ResourcesModule;
 class ShaderDescriptorsModule;
 class SamplersModule;
+class PipelineCacheModule;
 class CameraModule;
+class ModuleInput;
 class ViewportModule;
 class RingBufferModule;
+class JobSystemModule;
+class JobSystem;
 
 class DebugDrawPass;
 
@@ -32,54 +38,69 @@ public:
     ResourcesModule* getResources() { return resources; }
     ShaderDescriptorsModule* getShaderDescriptors() { return shaderDescriptors; }
     SamplersModule* getSamplers() { return samplers; }
+    PipelineCacheModule* getPipelineCache() { return pipelineCache; }
     CameraModule* getCamera() { return camera; }
+    ModuleInput* getInput() { return input; }
     ViewportModule* getViewport() { return viewport; }
     RingBufferModule* getRingBuffer() { return ringBuffer; }
+    JobSystem* getJobSystem();
 
     DebugDrawPass* getDebugDrawPass() { return debugDrawPass.get(); }
 
-    float                       getFPS() const { return 1000.0f * float(MAX_FPS_TICKS) / tickSum; }
-    float                       getAvgElapsedMs() const { return tickSum / float(MAX_FPS_TICKS); }
-    uint64_t                    getElapsedMilis() const { return elapsedMilis; }
+    float                       getFPS() const { return tickSum > 0 ? 1e6f * float(MAX_FPS_TICKS) / float(tickSum) : 0.0f; }
+    float                       getAvgElapsedMs() const { return float(tickSum) * 0.001f / float(MAX_FPS_TICKS); }
+    uint64_t                    getElapsedMilis() const { return uint64_t(time.getFrameUs() / 1000); }
+
+    // Variable frame time, for things that are not simulated (UI, stats)
+    float                       getFrameSeconds() const { return time.getFrameSeconds(); }
+    // Simulation runs update() in fixed steps of this duration
+    float                       getFixedStepSeconds() const { return time.getFixedStepSeconds(); }
+    // How far rendering is between the last two fixed steps [0, 1)
+    float                       getInterpolationAlpha() const { return time.getAlpha(); }
+    TimeService&                getTimeService() { return time; }
+
+    // Compiled shaders, mapped for the whole run
+    ShaderArchive&              getShaderArchive() { return shaderArchive; }
 
     bool                        isPaused() const { return paused; }
     bool                        setPaused(bool p) { paused = p; return paused; }
 
-    float                       getUpdateMs() const { return updateMs; }
-    float                       getPreRenderMs() const { return preRenderMs; }
-    float                       getRenderMs() const { return renderMs; }
-    float                       getPostRenderMs() const { return postRenderMs; }
+    // Pipelined: frame N+1 simulates on the workers while frame N is recorded (one frame of latency)
+    bool                        isPipelined() const { return pipelined; }
+    void                        setPipelined(bool p) { pipelined = p; }
+
+    float                       getPhaseMs(ModulePhase phase) const { return scheduler.getPhaseMs(phase); }
+    const ModuleScheduler&      getModuleScheduler() const { return scheduler; }
 
     void setViewport(ViewportModule* vp) { viewport = vp; }
 
 private:
     enum { MAX_FPS_TICKS = 30 };
-    typedef std::array<uint64_t, MAX_FPS_TICKS> TickList;
+    typedef std::array<int64_t, MAX_FPS_TICKS> TickList;    // microseconds
 
     std::vector<Module*> modules;
+    ModuleScheduler scheduler;
 
     D3D12Module* d3d12 = nullptr;
     ResourcesModule* resources = nullptr;
     ShaderDescriptorsModule* shaderDescriptors = nullptr;
     SamplersModule* samplers = nullptr;
+    PipelineCacheModule* pipelineCache = nullptr;
     CameraModule* camera = nullptr;
+    ModuleInput* input = nullptr;
     ViewportModule* viewport = nullptr;
     RingBufferModule* ringBuffer = nullptr;
+    JobSystemModule* jobSystem = nullptr;
 
     std::unique_ptr<DebugDrawPass> debugDrawPass;
 
-    uint64_t  lastMilis = 0;
-    TickList  tickList;
-    uint64_t  tickIndex;
-    uint64_t  tickSum = 0;
-    uint64_t  elapsedMilis = 0;
+    TimeService time;
+    ShaderArchive shaderArchive;     // outlives the modules: PSOs are created from its bytecode
+    TickList  tickList = {};
+    uint32_t  tickIndex = 0;
+    int64_t   tickSum = 0;
     bool      paused = false;
-
-
-    float updateMs = 0.0f;
-    float preRenderMs = 0.0f;
-    float renderMs = 0.0f;
-    float postRenderMs = 0.0f;
+    bool      pipelined = false;
 
 };
 
@@ -0,0 +1,224 @@
+#include "Globals.h"
+#include "BVH.h"
+
+#include <algorithm>
+
+// ----------------------------------------------------------------------------
+// PickRay / BoundingBox3 helpers
+// ----------------------------------------------------------------------------
+PickRay::PickRay(const Vector3& o, const Vector3& d) : origin(o), direction(d)
+{
+    // 1/0 gives +-inf, which the slab test handles
+    invDirection = Vector3(1.0f / d.x, 1.0f / d.y, 1.0f / d.z);
+}
+
+PickRay PickRay::transformed(const Matrix& m) const
+{
+    return PickRay(Vector3::Transform(origin, m), Vector3::TransformNormal(direction, m));
+}
+
+BoundingBox3 BoundingBox3::transformed(const Matrix& m) const
+{
+    BoundingBox3 result;
+    for (int i = 0; i < 8; ++i)
+    {
+        Vector3 corner((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z);
+        result.grow(Vector3::Transform(corner, m));
+    }
+    return result;
+}
+
+bool intersectTriangle(const PickRay& ray, const Vector3& v0, const Vector3& v1, const Vector3& v2, float& t)
+{
+    const float EPSILON = 1e-8f;
+
+    Vector3 e1 = v1 - v0;
+    Vector3 e2 = v2 - v0;
+    Vector3 p = ray.direction.Cross(e2);
+    float det = e1.Dot(p);
+
+    // Picking is double sided
+    if (fabsf(det) < EPSILON)
+        return false;
+
+    float invDet = 1.0f / det;
+    Vector3 s = ray.origin - v0;
+    float u = s.Dot(p) * invDet;
+    if (u < 0.0f || u > 1.0f)
+        return false;
+
+    Vector3 q = s.Cross(e1);
+    float v = ray.direction.Dot(q) * invDet;
+    if (v < 0.0f || u + v > 1.0f)
+        return false;
+
+    float hitT = e2.Dot(q) * invDet;
+    if (hitT <= 0.0f || hitT >= t)
+        return false;
+
+    t = hitT;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// BVH build
+// ----------------------------------------------------------------------------
+void BVH::build(const BoundingBox3* boxes, size_t count)
+{
+    clear();
+    if (count == 0)
+        return;
+
+    std::vector<Vector3> centroids(count);
+    primIndices.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        centroids[i] = boxes[i].center();
+        primIndices[i] = uint32_t(i);
+    }
+
+    nodes.reserve(count * 2);
+    nodes.emplace_back();
+    nodes[0].first = 0;
+    nodes[0].count = uint32_t(count);
+
+    updateBounds(0, boxes);
+    subdivide(0, boxes, centroids.data(), 0);
+
+    nodes.shrink_to_fit();
+}
+
+void BVH::updateBounds(uint32_t nodeIndex, const BoundingBox3* boxes)
+{
+    Node& node = nodes[nodeIndex];
+
+    BoundingBox3 bounds;
+    for (uint32_t i = 0; i < node.count; ++i)
+        bounds.grow(boxes[primIndices[node.first + i]]);
+
+    node.boundsMin = bounds.min;
+    node.boundsMax = bounds.max;
+}
+
+void BVH::subdivide(uint32_t nodeIndex, const BoundingBox3* boxes, const Vector3* centroids, uint32_t depth)
+{
+    const uint32_t first = nodes[nodeIndex].first;
+    const uint32_t count = nodes[nodeIndex].count;
+
+    if (count <= MAX_LEAF_SIZE || depth + 1 >= MAX_DEPTH)
+        return;
+
+    // ------------------------------------------------------------
+    // Split axis: longest extent of the centroid bounds
+    // ------------------------------------------------------------
+    BoundingBox3 centroidBounds;
+    for (uint32_t i = 0; i < count; ++i)
+        centroidBounds.grow(centroids[primIndices[first + i]]);
+
+    Vector3 extent = centroidBounds.extent();
+    int axis = 0;
+    if (extent.y > extent.x) axis = 1;
+    if (extent.z > (&extent.x)[axis]) axis = 2;
+
+    const float axisMin = (&centroidBounds.min.x)[axis];
+    const float axisExtent = (&extent.x)[axis];
+    if (axisExtent <= 0.0f)
+        return;     // all centroids coincide, keep as leaf
+
+    // ------------------------------------------------------------
+    // Binned SAH
+    // ------------------------------------------------------------
+    struct Bin { BoundingBox3 bounds; uint32_t count = 0; };
+    Bin bins[BIN_COUNT];
+
+    const float binScale = float(BIN_COUNT) / axisExtent;
+    auto binOf = [&](uint32_t prim)
+        {
+            int b = int(((&centroids[prim].x)[axis] - axisMin) * binScale);
+            return std::min(std::max(b, 0), int(BIN_COUNT) - 1);
+        };
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t prim = primIndices[first + i];
+        Bin& bin = bins[binOf(prim)];
+        bin.bounds.grow(boxes[prim]);
+        ++bin.count;
+    }
+
+    float leftArea[BIN_COUNT - 1], rightArea[BIN_COUNT - 1];
+    uint32_t leftCount[BIN_COUNT - 1], rightCount[BIN_COUNT - 1];
+
+    BoundingBox3 leftBox, rightBox;
+    uint32_t leftSum = 0, rightSum = 0;
+    for (uint32_t i = 0; i < BIN_COUNT - 1; ++i)
+    {
+        leftSum += bins[i].count;
+        leftBox.grow(bins[i].bounds);
+        leftCount[i] = leftSum;
+        leftArea[i] = leftBox.valid() ? leftBox.area() : 0.0f;
+
+        rightSum += bins[BIN_COUNT - 1 - i].count;
+        rightBox.grow(bins[BIN_COUNT - 1 - i].bounds);
+        rightCount[BIN_COUNT - 2 - i] = rightSum;
+        rightArea[BIN_COUNT - 2 - i] = rightBox.valid() ? rightBox.area() : 0.0f;
+    }
+
+    float bestCost = FLT_MAX;
+    uint32_t bestSplit = 0;
+    for (uint32_t i = 0; i < BIN_COUNT - 1; ++i)
+    {
+        float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+        if (leftCount[i] > 0 && rightCount[i] > 0 && cost < bestCost)
+        {
+            bestCost = cost;
+            bestSplit = i;
+        }
+    }
+
+    // Compare against not splitting at all
+    BoundingBox3 nodeBox;
+    nodeBox.min = nodes[nodeIndex].boundsMin;
+    nodeBox.max = nodes[nodeIndex].boundsMax;
+    if (bestCost >= float(count) * nodeBox.area())
+        return;
+
+    // ------------------------------------------------------------
+    // Partition primitive indices in place
+    // ------------------------------------------------------------
+    uint32_t* begin = primIndices.data() + first;
+    uint32_t* mid = std::partition(begin, begin + count, [&](uint32_t prim) { return uint32_t(binOf(prim)) <= bestSplit; });
+
+    const uint32_t leftN = uint32_t(mid - begin);
+    if (leftN == 0 || leftN == count)
+        return;
+
+    const uint32_t leftIndex = uint32_t(nodes.size());
+    nodes.emplace_back();
+    nodes.emplace_back();
+
+    nodes[leftIndex].first = first;
+    nodes[leftIndex].count = leftN;
+    nodes[leftIndex + 1].first = first + leftN;
+    nodes[leftIndex + 1].count = count - leftN;
+
+    nodes[nodeIndex].first = leftIndex;
+    nodes[nodeIndex].count = 0;
+
+    updateBounds(leftIndex, boxes);
+    updateBounds(leftIndex + 1, boxes);
+
+    subdivide(leftIndex, boxes, centroids, depth + 1);
+    subdivide(leftIndex + 1, boxes, centroids, depth + 1);
+}
+
+BoundingBox3 BVH::getBounds() const
+{
+    BoundingBox3 bounds;
+    if (!nodes.empty())
+    {
+        bounds.min = nodes[0].boundsMin;
+        bounds.max = nodes[0].boundsMax;
+    }
+    return bounds;
+}
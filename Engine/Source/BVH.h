@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cfloat>
+#include <vector>
+
+// ============================================================================
+// BVH
+// ----------------------------------------------------------------------------
+// Binary bounding volume hierarchy over generic primitives, used for ray
+// picking (scene level: one box per entity, mesh level: one box per triangle).
+//
+// Build:
+// - Input is one AABB per primitive. Nodes are split with a binned SAH
+//   (BIN_COUNT bins along the longest centroid axis); leaves hold at most
+//   MAX_LEAF_SIZE primitives.
+// - Nodes are stored flat (32 bytes each). Children of an inner node are
+//   always adjacent: left = firstChild, right = firstChild + 1.
+//
+// Traversal:
+// - intersect() walks the tree front-to-back with an explicit stack. The
+//   ray-box slab test runs on the three axes at once with DirectXMath vectors.
+// - The caller provides the primitive test as a callable:
+//     bool testPrimitive(uint32_t primIndex, float& tMax)
+//   that returns true (and shrinks tMax) on a closer hit.
+// ============================================================================
+
+struct PickRay
+{
+    Vector3 origin;
+    Vector3 direction;      // normalized
+    Vector3 invDirection;
+
+    PickRay() = default;
+    PickRay(const Vector3& o, const Vector3& d);
+
+    // Transforms the ray by 'm' (direction is NOT renormalized, so t values stay comparable)
+    PickRay transformed(const Matrix& m) const;
+};
+
+struct BoundingBox3
+{
+    Vector3 min = Vector3(FLT_MAX, FLT_MAX, FLT_MAX);
+    Vector3 max = Vector3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+    void grow(const Vector3& p) { min = Vector3::Min(min, p); max = Vector3::Max(max, p); }
+    void grow(const BoundingBox3& b) { min = Vector3::Min(min, b.min); max = Vector3::Max(max, b.max); }
+
+    Vector3 center() const { return (min + max) * 0.5f; }
+    Vector3 extent() const { return max - min; }
+    float   area() const { Vector3 e = extent(); return e.x * e.y + e.y * e.z + e.z * e.x; }
+    bool    valid() const { return min.x <= max.x; }
+
+    BoundingBox3 transformed(const Matrix& m) const;
+};
+
+// Moller-Trumbore ray/triangle test. Returns true and updates t if the hit is closer than t.
+bool intersectTriangle(const PickRay& ray, const Vector3& v0, const Vector3& v1, const Vector3& v2, float& t);
+
+class BVH
+{
+public:
+    static constexpr uint32_t BIN_COUNT = 12;
+    static constexpr uint32_t MAX_LEAF_SIZE = 4;
+    static constexpr uint32_t MAX_DEPTH = 64;
+
+private:
+    struct alignas(16) Node
+    {
+        XMFLOAT3 boundsMin;
+        uint32_t first = 0;      // first child (inner) or first primitive index (leaf)
+        XMFLOAT3 boundsMax;
+        uint32_t count = 0;      // 0 = inner node
+    };
+
+    std::vector<Node>     nodes;
+    std::vector<uint32_t> primIndices;
+
+    void subdivide(uint32_t nodeIndex, const BoundingBox3* boxes, const Vector3* centroids, uint32_t depth);
+    void updateBounds(uint32_t nodeIndex, const BoundingBox3* boxes);
+
+    static inline bool intersectNode(const Node& node, XMVECTOR origin, XMVECTOR invDir, float tMax, float& tNear)
+    {
+        XMVECTOR t1 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&node.boundsMin), origin), invDir);
+        XMVECTOR t2 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&node.boundsMax), origin), invDir);
+
+        XMVECTOR tMin = XMVectorMin(t1, t2);
+        XMVECTOR tMaxV = XMVectorMax(t1, t2);
+
+        // Horizontal max of tMin / min of tMax over x, y, z
+        XMVECTOR nearV = XMVectorMax(XMVectorMax(XMVectorSplatX(tMin), XMVectorSplatY(tMin)), XMVectorSplatZ(tMin));
+        XMVECTOR farV = XMVectorMin(XMVectorMin(XMVectorSplatX(tMaxV), XMVectorSplatY(tMaxV)), XMVectorSplatZ(tMaxV));
+
+        float tn = XMVectorGetX(nearV);
+        float tf = XMVectorGetX(farV);
+
+        tNear = tn;
+        return tf >= tn && tf >= 0.0f && tn < tMax;
+    }
+
+public:
+    BVH() = default;
+
+    void build(const BoundingBox3* boxes, size_t count);
+    void clear() { nodes.clear(); primIndices.clear(); }
+
+    bool   empty() const { return nodes.empty(); }
+    size_t getNodeCount() const { return nodes.size(); }
+
+    BoundingBox3 getBounds() const;
+
+    template<class PrimitiveTest>
+    bool intersect(const PickRay& ray, float& tMax, PrimitiveTest&& testPrimitive) const
+    {
+        if (nodes.empty())
+            return false;
+
+        const XMVECTOR origin = XMLoadFloat3(&ray.origin);
+        const XMVECTOR invDir = XMLoadFloat3(&ray.invDirection);
+
+        uint32_t stack[MAX_DEPTH * 2];
+        uint32_t stackSize = 0;
+
+        float tNear = 0.0f;
+        if (!intersectNode(nodes[0], origin, invDir, tMax, tNear))
+            return false;
+
+        bool hit = false;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0)
+        {
+            const Node& node = nodes[stack[--stackSize]];
+
+            if (node.count > 0)
+            {
+                for (uint32_t i = 0; i < node.count; ++i)
+                    hit |= testPrimitive(primIndices[node.first + i], tMax);
+                continue;
+            }
+
+            // Push the far child first so the near one is visited next
+            float tLeft = 0.0f, tRight = 0.0f;
+            bool hitLeft = intersectNode(nodes[node.first], origin, invDir, tMax, tLeft);
+            bool hitRight = intersectNode(nodes[node.first + 1], origin, invDir, tMax, tRight);
+
+            if (hitLeft && hitRight)
+            {
+                if (tLeft <= tRight) { stack[stackSize++] = node.first + 1; stack[stackSize++] = node.first; }
+                else                 { stack[stackSize++] = node.first;     stack[stackSize++] = node.first + 1; }
+            }
+            else if (hitLeft)  stack[stackSize++] = node.first;
+            else if (hitRight) stack[stackSize++] = node.first + 1;
+        }
+
+        return hit;
+    }
+};
@@ -4,6 +4,7 @@
 #include "ResourcesModule.h"
 #include "ShaderDescriptorsModule.h"
 #include "RingBufferModule.h"
+#include "SamplersModule.h"
 
 #define TINYGLTF_NO_STB_IMAGE_WRITE
 #define TINYGLTF_NO_STB_IMAGE
@@ -11,6 +12,52 @@
 
 #include "tiny_gltf.h"
 
+namespace
+{
+	D3D12_TEXTURE_ADDRESS_MODE gltfAddressMode(int wrap)
+	{
+		switch (wrap)
+		{
+		case TINYGLTF_TEXTURE_WRAP_CLAMP_TO_EDGE:   return D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+		case TINYGLTF_TEXTURE_WRAP_MIRRORED_REPEAT: return D3D12_TEXTURE_ADDRESS_MODE_MIRROR;
+		default:                                    return D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+		}
+	}
+
+	// glTF sampler -> D3D12. Undefined filters are linear (the spec leaves them to the implementation)
+	D3D12_SAMPLER_DESC gltfSamplerDesc(const tinygltf::Sampler& sampler)
+	{
+		const bool magPoint = sampler.magFilter == TINYGLTF_TEXTURE_FILTER_NEAREST;
+		bool minPoint = false;
+		bool mipPoint = false;
+
+		switch (sampler.minFilter)
+		{
+		case TINYGLTF_TEXTURE_FILTER_NEAREST:                minPoint = true;  mipPoint = true;  break;
+		case TINYGLTF_TEXTURE_FILTER_LINEAR:                 minPoint = false; mipPoint = true;  break;
+		case TINYGLTF_TEXTURE_FILTER_NEAREST_MIPMAP_NEAREST: minPoint = true;  mipPoint = true;  break;
+		case TINYGLTF_TEXTURE_FILTER_LINEAR_MIPMAP_NEAREST:  minPoint = false; mipPoint = true;  break;
+		case TINYGLTF_TEXTURE_FILTER_NEAREST_MIPMAP_LINEAR:  minPoint = true;  mipPoint = false; break;
+		default:                                             minPoint = false; mipPoint = false; break;
+		}
+
+		const D3D12_FILTER filter = D3D12_ENCODE_BASIC_FILTER(
+			minPoint ? D3D12_FILTER_TYPE_POINT : D3D12_FILTER_TYPE_LINEAR,
+			magPoint ? D3D12_FILTER_TYPE_POINT : D3D12_FILTER_TYPE_LINEAR,
+			mipPoint ? D3D12_FILTER_TYPE_POINT : D3D12_FILTER_TYPE_LINEAR,
+			D3D12_FILTER_REDUCTION_TYPE_STANDARD);
+
+		D3D12_SAMPLER_DESC desc = SamplersModule::makeDesc(filter, gltfAddressMode(sampler.wrapS));
+		desc.AddressV = gltfAddressMode(sampler.wrapT);
+
+		// NEAREST / LINEAR min filters: no mipmapping, only the top level
+		if (sampler.minFilter == TINYGLTF_TEXTURE_FILTER_NEAREST || sampler.minFilter == TINYGLTF_TEXTURE_FILTER_LINEAR)
+			desc.MaxLOD = 0.0f;
+
+		return desc;
+	}
+}
+
 void BasicMaterial::load(const tinygltf::Model& model, const tinygltf::Material& material, Type type, const char* basePath)
 {
 	materialType = type;
@@ -20,7 +67,8 @@ void BasicMaterial::load(const tinygltf::Model& model, const tinygltf::Material&
 		float(pbr.baseColorFactor[2]), float(pbr.baseColorFactor[3]));
 
 	hasColourTexture = FALSE;
-	colourTexSRV = app->getShaderDescriptors()->createNullTexture2DSRV();
+	colourTexSRV.reset();
+	colourSampler = SamplersModule::DEFAULT_LINEAR_WRAP;
 
 	if (pbr.baseColorTexture.index >= 0)
 	{
@@ -30,8 +78,13 @@ void BasicMaterial::load(const tinygltf::Model& model, const tinygltf::Material&
 		if (!image.uri.empty())
 		{
 			tex = app->getResources()->createTextureFromFile(std::string(basePath) + image.uri);
-			colourTexSRV = app->getShaderDescriptors()->createSRV(tex.Get());
+			ShaderDescriptorsModule* descriptors = app->getShaderDescriptors();
+			colourTexSRV = descriptors->share(descriptors->createSRV(tex.Get()));
 			hasColourTexture = TRUE;
+
+			// Identical glTF samplers (in this model or any other) share one slot
+			if (texture.sampler >= 0)
+				colourSampler = app->getSamplers()->createSampler(gltfSamplerDesc(model.samplers[texture.sampler]));
 		}
 	}
 
@@ -40,8 +93,7 @@ void BasicMaterial::load(const tinygltf::Model& model, const tinygltf::Material&
         case Type::BASIC:
         {
             materialData.basic = { baseColour, hasColourTexture, {0,0,0} };
-            materialBuffer = app->getResources()->createDefaultBuffer(&materialData.basic, sizeof(BasicMaterialData),"MaterialCBV");
-            materialBufferGPU = getMaterialBuffer()->GetGPUVirtualAddress();
+            materialBuffer = app->getResources()->createStaticBuffer(&materialData.basic, sizeof(BasicMaterialData),"MaterialCBV");
             break;
     }
         case Type::PHONG:
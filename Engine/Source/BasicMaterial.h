@@ -1,5 +1,8 @@
 #pragma once
 
+#include "GpuHeapAllocator.h"
+#include "ShaderDescriptorsModule.h"
+
 namespace tinygltf { class Model; struct Material; }
 
 struct BasicMaterialData 
@@ -52,11 +55,11 @@ private:
     Type materialType = Type::BASIC;
 
     // Buffers
-    ComPtr<ID3D12Resource> materialBuffer;           // only basic
-    D3D12_GPU_VIRTUAL_ADDRESS materialBufferGPU = 0; // for ring buffer
+    GpuAllocationPtr materialBuffer;                 // only basic (static buffer heap range)
 
     ComPtr<ID3D12Resource> tex;
-    UINT colourTexSRV = UINT_MAX;
+    SharedDescriptor colourTexSRV;                   // shared by the copies, null: no texture
+    UINT colourSampler = 0;                          // SamplersModule slot (glTF sampler, linear/wrap by default)
 
     Vector4 baseColour = { 1,1,1,1 };
     BOOL hasColourTexture = FALSE;
@@ -67,10 +70,12 @@ public:
     void load(const tinygltf::Model& model, const tinygltf::Material& material, Type tyoe, const char* basePath);
 
 
-    ID3D12Resource* getMaterialBuffer() const { return materialBuffer.Get(); }
-    D3D12_GPU_VIRTUAL_ADDRESS getMaterialBufferGPU() const { return materialBufferGPU; }
+    ID3D12Resource* getMaterialBuffer() const { return materialBuffer ? materialBuffer->resource : nullptr; }
+    D3D12_GPU_VIRTUAL_ADDRESS getMaterialBufferGPU() const { return materialBuffer ? materialBuffer->getGPUAddress() : 0; }
 
-    UINT  getColourTexSRV()      const { return colourTexSRV; }
+    // Invalid without a texture: it resolves to the shared null SRV
+    DescriptorHandle getColourTexSRV() const { return colourTexSRV ? *colourTexSRV : DescriptorHandle(); }
+    UINT  getColourSampler()     const { return colourSampler; }
     bool  hasTexture()           const { return hasColourTexture == TRUE; }
     const Vector4& getBaseColour() const { return baseColour; }
 
@@ -3,6 +3,7 @@
 
 #include "Application.h"
 #include "D3D12Module.h"
+#include "ModuleInput.h"
 
 #include "Mouse.h"
 #include "Keyboard.h"
@@ -62,20 +63,32 @@ bool CameraModule::init()
     // Create initial view matrix using LookAt
     view = SimpleMath::Matrix::CreateLookAt(SimpleMath::Vector3(position), SimpleMath::Vector3(target), SimpleMath::Vector3::Up);
 
+    stepPosition = position;
+    stepViewRotation = Quaternion::CreateFromRotationMatrix(view);
+
+    writeSnapshot();
+    snapshots.reset(snapshots.write());
+
+    renderView = view;
+    renderPosition = position;
+
     return true;
   
 }
 
 void CameraModule::update()
 {
-    float dt = app->getElapsedMilis() * 0.001f;
+    applyEdits();
+
+    // One fixed simulation step per call
+    float dt = app->getFixedStepSeconds();
 
     // ------------------------------------------------------------------------------
     // MOUSE ROTATION INPUT
     // ------------------------------------------------------------------------------
     // Detect right mouse button for camera rotation (FPS style)
-    auto& mouse = Mouse::Get();
-    Mouse::State ms = mouse.GetState();
+    ModuleInput* input = app->getInput();
+    const Mouse::State& ms = input->getMouseState();
     static bool rotating = false;
     static int lastX = 0, lastY = 0;
 
@@ -157,7 +170,7 @@ void CameraModule::update()
     // -------------------------------------------------------------------------
     // SET SPEED (SHIFT)
     // -------------------------------------------------------------------------
-    Keyboard::State kb = Keyboard::Get().GetState();
+    const Keyboard::State& kb = input->getKeyboardState();
     if (kb.IsKeyDown(Keyboard::Keys::LeftShift))
         speed = 10.0f;
     else
@@ -295,6 +308,70 @@ void CameraModule::update()
     target = position + forward;
     view = Matrix::CreateLookAt(position, target, up);
 
-   
+    writeSnapshot();
+}
+
+void CameraModule::publish()
+{
+    snapshots.publish();
+
+    // Render between the last two simulated steps
+    const Snapshot& s = snapshots.read();
+    const float alpha = app->getInterpolationAlpha();
+
+    renderPosition = Vector3::Lerp(s.previousPosition, s.position, alpha);
+    Quaternion viewRotation = Quaternion::Slerp(s.previousViewRotation, s.viewRotation, alpha);
+
+    renderView = Matrix::CreateTranslation(-renderPosition) * Matrix::CreateFromQuaternion(viewRotation);
 }
 
+void CameraModule::queueEdit(std::function<void()> edit)
+{
+    std::lock_guard<std::mutex> lock(editMutex);
+    pendingEdits.push_back(std::move(edit));
+}
+
+void CameraModule::applyEdits()
+{
+    std::vector<std::function<void()>> edits;
+    {
+        std::lock_guard<std::mutex> lock(editMutex);
+        edits.swap(pendingEdits);
+    }
+
+    for (auto& edit : edits)
+        edit();
+}
+
+void CameraModule::writeSnapshot()
+{
+    Snapshot& s = snapshots.write();
+    s.previousPosition = stepPosition;
+    s.previousViewRotation = stepViewRotation;
+
+    stepPosition = position;
+    stepViewRotation = Quaternion::CreateFromRotationMatrix(view);
+
+    s.view = view;
+    s.rotation = rotation;
+    s.position = position;
+    s.viewRotation = stepViewRotation;
+    s.speed = speed;
+    s.aspect = aspect;
+    s.fov = fov;
+    s.nearPlane = nearPlane;
+    s.farPlane = farPlane;
+}
+
+
+ModuleAccess CameraModule::getAccess(ModulePhase phase) const
+{
+    using namespace ModuleResource;
+
+    // Reads the copy ModuleInput takes on the main thread (ordered after it),
+    // so the camera can update on a worker
+    if (phase == ModulePhase::Update)
+        return ModuleAccess::worker(Input | Device, Camera);
+
+    return ModuleAccess::idle();
+}
@@ -1,7 +1,43 @@
 #pragma once
 #include "Module.h"
+#include "SnapshotBuffer.h"
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// ============================================================================
+// CameraModule
+// ----------------------------------------------------------------------------
+// update() may run on a worker, one frame ahead of rendering (pipelined
+// mode), so:
+// - The getters return the published Snapshot, never the live state.
+// - The setters are queued and applied at the start of the next update().
+//
+// update() runs once per fixed simulation step. publish() interpolates the
+// view between the last two steps with the Application's alpha, so motion
+// stays smooth whatever the frame rate.
+// ============================================================================
+
 class CameraModule : public Module
 {
+public:
+	struct Snapshot
+	{
+		Matrix view;
+		Quaternion rotation;
+		Vector3 position;
+		Quaternion viewRotation;            // rotation part of view
+		Vector3 previousPosition;           // previous fixed step
+		Quaternion previousViewRotation;
+		float speed = 5.0f;
+		float aspect = 1.0f;
+		float fov = XM_PIDIV4;
+		float nearPlane = 1.0f;
+		float farPlane = 100.0f;
+	};
+
+private:
 	Quaternion rotation;
 	Vector3 position;
 	Vector3 target;
@@ -21,27 +57,50 @@ class CameraModule : public Module
 	float nearPlane = 1.0f;
 	float farPlane = 100.0f;
 
+	SnapshotBuffer<Snapshot> snapshots;
+
+	// Last simulated step, becomes "previous" in the next snapshot
+	Vector3 stepPosition;
+	Quaternion stepViewRotation;
+
+	// Interpolated render state, rebuilt by publish()
+	Matrix renderView;
+	Vector3 renderPosition;
+
+	std::mutex editMutex;
+	std::vector<std::function<void()>> pendingEdits;
+
+	void queueEdit(std::function<void()> edit);
+	void applyEdits();
+	void writeSnapshot();
+
 public:
 	CameraModule();
 	~CameraModule();
 
 	bool init() override;
 	void update() override;
+	void publish() override;
+
+	const char* getName() const override { return "Camera"; }
+	ModuleAccess getAccess(ModulePhase phase) const override;
 
 	void FocusAt(const Vector3& point);
-	float setSpeed(float _speed) { return speed = _speed; }
-	float SetFov(float newFov) { return fov = newFov; }
-	float SetNearPlane(float nearP) { return nearPlane = nearP; }
-	float SetFarPlane(float farP) { return farPlane = farP; }
-
-	const Matrix& getView() const { return view; }
-	SimpleMath::Matrix GetProjection(float aspect) const { return SimpleMath::Matrix::CreatePerspectiveFieldOfView(fov, aspect, nearPlane, farPlane); }
-	const Quaternion& getRot() const { return rotation; }
-	const Vector3& getPos() const { return position; }
-	const float& getSpeed() const { return speed; }
-	const float getAspect() const { return aspect; }
-	float GetFov() const { return fov; }
-	float GetNearPlane() const { return nearPlane; }
-	float GetFarPlane() const { return farPlane; }
+	float setSpeed(float _speed) { queueEdit([this, _speed]() { speed = _speed; }); return _speed; }
+	float SetFov(float newFov) { queueEdit([this, newFov]() { fov = newFov; }); return newFov; }
+	float SetNearPlane(float nearP) { queueEdit([this, nearP]() { nearPlane = nearP; }); return nearP; }
+	float SetFarPlane(float farP) { queueEdit([this, farP]() { farPlane = farP; }); return farP; }
+
+	const Snapshot& getSnapshot() const { return snapshots.read(); }
+
+	const Matrix& getView() const { return renderView; }
+	SimpleMath::Matrix GetProjection(float aspect) const { const Snapshot& s = snapshots.read(); return SimpleMath::Matrix::CreatePerspectiveFieldOfView(s.fov, aspect, s.nearPlane, s.farPlane); }
+	const Quaternion& getRot() const { return snapshots.read().rotation; }
+	const Vector3& getPos() const { return renderPosition; }
+	const float& getSpeed() const { return snapshots.read().speed; }
+	const float getAspect() const { return snapshots.read().aspect; }
+	float GetFov() const { return snapshots.read().fov; }
+	float GetNearPlane() const { return snapshots.read().nearPlane; }
+	float GetFarPlane() const { return snapshots.read().farPlane; }
 };
 
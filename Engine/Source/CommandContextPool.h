@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// ============================================================================
+// CommandContextPool
+// ----------------------------------------------------------------------------
+// Recycles (command allocator, command list) pairs for multi-threaded
+// recording.
+//
+// Lifetime of a context:
+// - acquire(): any thread takes a context and gets it back reset and open.
+//   Each recording job acquires its own, so every worker ends up with its
+//   own allocator / list for every frame in flight.
+// - endFrame(fenceValue): everything acquired this frame is tagged with the
+//   fence value signaled after its submission.
+// - beginFrame(completedValue): contexts whose fence value has completed go
+//   back to the free list. An allocator is never reset while the GPU may
+//   still read its memory.
+//
+// Device policy:
+// - Header-only template over a "Device" that creates and resets the
+//   allocators and lists, so the pool itself never calls D3D12. It provides:
+//     using Allocator / List
+//     Allocator createAllocator();
+//     List      createList(Allocator&);          // returned closed
+//     void      reset(Allocator&, List&);        // reopens the list
+//   The engine instantiates it with D3D12CommandDevice (D3D12Module.h), the
+//   headless tests (Engine/Tests) with a mock device and fence.
+// ============================================================================
+
+template<class Device>
+class CommandContextPoolT
+{
+public:
+    using Allocator = typename Device::Allocator;
+    using List = typename Device::List;
+
+    struct Context
+    {
+        Allocator allocator;
+        List list;
+        uint64_t fenceValue = 0;        // 0: not submitted yet
+    };
+
+    struct Stats
+    {
+        uint32_t created = 0;           // contexts ever created
+        uint32_t free = 0;              // ready for reuse
+        uint32_t pending = 0;           // waiting for the GPU
+        uint32_t acquiredThisFrame = 0;
+        uint32_t acquiredLastFrame = 0;
+    };
+
+private:
+    Device device;
+
+    std::vector<std::unique_ptr<Context>> contexts;
+    std::vector<Context*> freeContexts;
+    std::vector<Context*> frameContexts;    // acquired since beginFrame()
+    std::vector<Context*> pendingContexts;  // submitted, sorted by fence value
+
+    uint32_t acquiredLastFrame = 0;
+    mutable std::mutex mutex;
+
+public:
+    CommandContextPoolT() = default;
+    explicit CommandContextPoolT(Device dev) : device(std::move(dev)) {}
+
+    CommandContextPoolT(const CommandContextPoolT&) = delete;
+    CommandContextPoolT& operator=(const CommandContextPoolT&) = delete;
+
+    void setDevice(Device dev) { device = std::move(dev); }
+    Device& getDevice() { return device; }
+
+    void beginFrame(uint64_t completedFenceValue)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Fence values only grow, so retired contexts are always a prefix
+        size_t retired = 0;
+        while (retired < pendingContexts.size() && pendingContexts[retired]->fenceValue <= completedFenceValue)
+        {
+            freeContexts.push_back(pendingContexts[retired]);
+            ++retired;
+        }
+        pendingContexts.erase(pendingContexts.begin(), pendingContexts.begin() + retired);
+    }
+
+    // Thread safe. The returned list is open and empty.
+    Context* acquire()
+    {
+        Context* context = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!freeContexts.empty())
+            {
+                context = freeContexts.back();
+                freeContexts.pop_back();
+            }
+            else
+            {
+                contexts.push_back(std::make_unique<Context>());
+                context = contexts.back().get();
+                context->allocator = device.createAllocator();
+                context->list = device.createList(context->allocator);
+            }
+
+            context->fenceValue = 0;
+            frameContexts.push_back(context);
+        }
+
+        // Resetting is the expensive part, keep it outside the lock
+        device.reset(context->allocator, context->list);
+        return context;
+    }
+
+    void endFrame(uint64_t fenceValue)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (Context* context : frameContexts)
+        {
+            context->fenceValue = fenceValue;
+            pendingContexts.push_back(context);
+        }
+
+        acquiredLastFrame = uint32_t(frameContexts.size());
+        frameContexts.clear();
+    }
+
+    // Drops every context. The GPU must be idle.
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeContexts.clear();
+        frameContexts.clear();
+        pendingContexts.clear();
+        contexts.clear();
+    }
+
+    Stats getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        Stats stats;
+        stats.created = uint32_t(contexts.size());
+        stats.free = uint32_t(freeContexts.size());
+        stats.pending = uint32_t(pendingContexts.size());
+        stats.acquiredThisFrame = uint32_t(frameContexts.size());
+        stats.acquiredLastFrame = acquiredLastFrame;
+        return stats;
+    }
+};
@@ -56,7 +56,7 @@ void ConsoleModule::preRender()
     ImGui::SameLine();
     if (ImGui::Button("Errors")) { showErrors = true; showInfo = showWarnings = false; }
     ImGui::SameLine();
-    if (ImGui::Button("Clear")) { Logger::Clear(); }
+    if (ImGui::Button("Clear")) { Logger::Clear(); logs.clear(); }
 
     ImGui::Separator();
 
@@ -74,7 +74,7 @@ void ConsoleModule::preRender()
     //-------------------------------------------------------------------------
     // Displays all messages currently stored in the Logger system.
     // Applies per-type color coding and respects both type and text filters.
-    const auto& logs = Logger::GetMessages();
+    Logger::CopyMessages(logs);
     ImGui::BeginChild("LogRegion", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
 
     for (const auto& entry : logs)
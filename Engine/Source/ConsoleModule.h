@@ -20,6 +20,9 @@ private:
 	static bool showErrors;
     bool visible = true;
 
+    // Logger entries copied so far (the Logger is written from worker threads)
+    std::vector<LogEntry> logs;
+
 public:
 
     ConsoleModule();
@@ -51,6 +51,7 @@ bool D3D12Module::init()
 	createSwapChain();							// "Frame flipper" for presenting images
 	createCommandAllocator();					// Memory for recording command lists
 	createCommandList();						// "Playlist" of GPU work
+	commandContexts.setDevice(D3D12CommandDevice{ device.Get() });	// Extra allocators / lists for worker threads
 	//createRenderTarget();						// "Canvas" to draw into <---- Inside the resize() method
 	createFence();								// "Completion flag" for CPU↔GPU sync
 	getWindowSize(windowWidth, windowHeight);
@@ -71,6 +72,8 @@ bool D3D12Module::init()
 
 bool D3D12Module::cleanUp()
 {
+	commandContexts.clear();
+
 	if (fenceEvent)
 		CloseHandle(fenceEvent);
 	fenceEvent = NULL;
@@ -276,10 +279,19 @@ void D3D12Module::preRender()
 
 	// Reset the command list to start recording commands for this frame
 	ThrowIfFailed(commandList->Reset(commandAllocator[currentBackBufferIdx].Get(), nullptr));
+	currentList = commandList.Get();
+	frameLists.clear();
+
+	// Worker lists whose frame has finished on the GPU can be reused
+	commandContexts.beginFrame(fence->GetCompletedValue());
+
+	// A reset list has no bound state: restart the redundant-state filter (keep last frame's counts for the editor)
+	lastFilterStats = filteredCommandList.getStats();
+	filteredCommandList.resetStats();
+	filteredCommandList.reset(commandList.Get());
 
-	// Transition from PRESENT -> RENDER_TARGET (prepare the canvas)
-	D3D12_RESOURCE_BARRIER barrierToRender = CD3DX12_RESOURCE_BARRIER::Transition(backBuffers[currentBackBufferIdx].Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
-	commandList->ResourceBarrier(1, &barrierToRender);
+	// The back buffer stays in PRESENT here: the frame render graph (EditorModule::render)
+	// moves it to RENDER_TARGET for its passes and back before postRender()
 
 	// Set the RTV and DSV so ClearRenderTargetView affects current buffer
 	auto rtvHandle = getRenderTargetDescriptor();
@@ -294,22 +306,19 @@ void D3D12Module::preRender()
 
 void D3D12Module::postRender()
 {
-	// Transition RENDER_TARGET -> PRESENT
-	D3D12_RESOURCE_BARRIER barrierToPresent = CD3DX12_RESOURCE_BARRIER::Transition(backBuffers[currentBackBufferIdx].Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
-	commandList->ResourceBarrier(1, &barrierToPresent);
-
-	// Close and execute the recorded commands
-	ThrowIfFailed(commandList->Close());
-	ID3D12CommandList* lists[] = { commandList.Get() };
-	commandQueue->ExecuteCommandLists(_countof(lists), lists);
+	// Close and execute the recorded commands (main list + spliced worker lists, in order)
+	ThrowIfFailed(currentList->Close());
+	frameLists.push_back(currentList);
+	commandQueue->ExecuteCommandLists(UINT(frameLists.size()), frameLists.data());
 
 	// Present the frame
 	ThrowIfFailed(swapChain->Present(1, 0));
 
-	// Signal and synchronize with the GPU
-	ThrowIfFailed(commandQueue->Signal(fence.Get(), fenceValue[currentBackBufferIdx]));
+	// Signal and synchronize with the GPU; the pool recycles this frame's lists once the fence passes
+	lastFrameFence = signalDrawQueue();
+	commandContexts.endFrame(lastFrameFence);
 	waitForGPU();
-	fenceValue[currentBackBufferIdx]++;
+	currentList = commandList.Get();
 
 	// After present, update the back buffer index for next frame (GetCurrentBackBufferIndex reflects next index)
 	currentBackBufferIdx = swapChain->GetCurrentBackBufferIndex();
@@ -341,9 +350,23 @@ UINT D3D12Module::signalDrawQueue()
 	return fenceCounter;
 }
 
+void D3D12Module::spliceCommandLists(ID3D12GraphicsCommandList* const* lists, size_t count)
+{
+	// Everything recorded so far runs before the spliced lists
+	ThrowIfFailed(currentList->Close());
+	frameLists.push_back(currentList);
+	frameLists.insert(frameLists.end(), lists, lists + count);
+
+	// Recording continues in a fresh list: no state carries over
+	currentList = commandContexts.acquire()->list.Get();
+	filteredCommandList.reset(currentList);
+}
+
 ID3D12GraphicsCommandList* D3D12Module::beginFrameRender()
 {
 	commandList->Reset(getCommandAllocator(), nullptr);
+	currentList = commandList.Get();
+	filteredCommandList.reset(commandList.Get());
 	// TODO: Missing methods in Application class
 	/*ID3D12DescriptorHeap* descriptorHeaps[] = { app->getShaderDescriptors()->getHeap(), app->getSamplers()->getHeap() };
 	commandList->SetDescriptorHeaps(2, descriptorHeaps);*/
@@ -483,3 +506,47 @@ void D3D12Module::toogleFullscreen()
 
 
 
+
+ModuleAccess D3D12Module::getAccess(ModulePhase phase) const
+{
+    using namespace ModuleResource;
+
+    // preRender picks the back buffer and opens the command list, postRender closes and presents it
+    switch (phase)
+    {
+    case ModulePhase::PreRender:
+    case ModulePhase::PostRender:
+        return ModuleAccess::main(Device | CommandList, Device | CommandList);
+    default:
+        return ModuleAccess::idle();
+    }
+}
+
+// ─────────────────────────────────────────────────────────────
+//  COMMAND CONTEXT POOL DEVICE
+// ─────────────────────────────────────────────────────────────
+
+D3D12CommandDevice::Allocator D3D12CommandDevice::createAllocator()
+{
+	Allocator allocator;
+	if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&allocator))))
+		throw std::runtime_error("CreateCommandAllocator failed.");
+	return allocator;
+}
+
+D3D12CommandDevice::List D3D12CommandDevice::createList(Allocator& allocator)
+{
+	List list;
+	if (FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, allocator.Get(), nullptr, IID_PPV_ARGS(&list))))
+		throw std::runtime_error("CreateCommandList failed.");
+
+	// Created open; the pool expects closed lists
+	list->Close();
+	return list;
+}
+
+void D3D12CommandDevice::reset(Allocator& allocator, List& list)
+{
+	allocator->Reset();
+	list->Reset(allocator.Get(), nullptr);
+}
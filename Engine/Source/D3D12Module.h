@@ -1,7 +1,25 @@
 #pragma once
 #include "Module.h"
 #include "dxgi1_6.h"
+#include "FilteredCommandList.h"
+#include "CommandContextPool.h"
 #include <stdexcept>
+#include <vector>
+
+// Device policy of the CommandContextPool for direct command lists
+struct D3D12CommandDevice
+{
+	using Allocator = ComPtr<ID3D12CommandAllocator>;
+	using List = ComPtr<ID3D12GraphicsCommandList>;
+
+	ID3D12Device* device = nullptr;
+
+	Allocator createAllocator();
+	List createList(Allocator& allocator);
+	void reset(Allocator& allocator, List& list);
+};
+
+using CommandContextPool = CommandContextPoolT<D3D12CommandDevice>;
 
 //-----------------------------------------------------------------------------
 // D3D12Module manages the Direct3D 12 graphics device and swap chain.
@@ -30,11 +48,19 @@ private:
 	ComPtr<ID3D12CommandQueue> commandQueue;
 	ComPtr<ID3D12CommandAllocator> commandAllocator[FRAMES_IN_FLIGHT];
 	ComPtr<ID3D12GraphicsCommandList> commandList;
+	ID3D12GraphicsCommandList* currentList = nullptr;	// list being recorded (commandList or a spliced continuation)
+	FilteredCommandList filteredCommandList;
+
+	// Extra lists for parallel recording, executed in order with one ExecuteCommandLists
+	CommandContextPool commandContexts;
+	std::vector<ID3D12CommandList*> frameLists;
+	FilteredCommandList::Stats lastFilterStats;
 
 	ComPtr<ID3D12Fence> fence;
 	HANDLE fenceEvent = nullptr;
 	unsigned fenceCounter = 0;
 	unsigned fenceValue[FRAMES_IN_FLIGHT] = { 0,0,0 };
+	unsigned lastFrameFence = 0;				// signalled after the last submitted frame
 
 	unsigned frameValues[FRAMES_IN_FLIGHT] = { 0,0,0 };
 	unsigned frameIndex = 0;
@@ -59,6 +85,9 @@ public:
 	void preRender() override;
 	void postRender() override;
 
+	const char* getName() const override { return "D3D12"; }
+	ModuleAccess getAccess(ModulePhase phase) const override;
+
 
 	void resize();
 	void toogleFullscreen();
@@ -67,7 +96,16 @@ public:
 	HWND getHWnd() { return hWnd; }
 	IDXGISwapChain3* getSwapChain() { return swapChain.Get(); }
 	ID3D12Device5* getDevice() { return device.Get(); }
-	ID3D12GraphicsCommandList* getCommandList() { return commandList.Get(); }
+	ID3D12GraphicsCommandList* getCommandList() { return currentList; }
+	CommandContextPool& getCommandContexts() { return commandContexts; }
+	uint32_t getFrameListCount() const { return uint32_t(frameLists.size()) + 1; }
+
+	// Closes the current list and queues it, followed by 'lists' (already closed),
+	// for this frame's submission. Recording continues in a fresh list from the
+	// pool, so callers must re-fetch getCommandList() and rebind their state.
+	void spliceCommandLists(ID3D12GraphicsCommandList* const* lists, size_t count);
+	FilteredCommandList& getFilteredCommandList() { return filteredCommandList; }
+	const FilteredCommandList::Stats& getFilterStats() const { return lastFilterStats; }
 	ID3D12CommandAllocator* getCommandAllocator() { return commandAllocator[currentBackBufferIdx].Get(); }
 	ID3D12Resource* getBackBuffer() { return backBuffers[currentBackBufferIdx].Get(); }
 	ID3D12CommandQueue* getCommandQueue() { return commandQueue.Get(); }
@@ -78,6 +116,8 @@ public:
 	D3D12_CPU_DESCRIPTOR_HANDLE getDepthStencilDescriptor();
 
 	UINT signalDrawQueue();
+	UINT getLastFrameFence() const { return lastFrameFence; }
+	UINT64 getCompletedFenceValue() const { return fence->GetCompletedValue(); }
 
 	unsigned getCurrentFrame() const { return frameIndex; }
 	unsigned getLastCompletedFrame() const { return lastCompletedFrame; }
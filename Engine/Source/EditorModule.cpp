@@ -5,6 +5,9 @@
 #include "ShaderDescriptorsModule.h"
 #include "RingBufferModule.h"
 #include "SamplersModule.h"
+#include "PipelineCacheModule.h"
+#include "RenderGraph.h"
+#include "ResourcesModule.h"
 
 
 enum class ExerciseSelection
@@ -23,6 +26,22 @@ enum class ExerciseSelection
 
 ExerciseSelection currentExercise = ExerciseSelection::None;
 
+// Exercise list entry: the title plus its loading state. The '###' id keeps
+// the entry the same ImGui item while the text changes.
+static std::string exerciseLabel(const ExerciseModule* exercise, const char* title, int index)
+{
+	std::string label = title;
+
+	switch (exercise->getState(index))
+	{
+	case ExerciseModule::State::Loading: label += "  (loading...)"; break;
+	case ExerciseModule::State::Failed:  label += "  (failed)";     break;
+	default: break;
+	}
+
+	return label + "###Exercise" + std::to_string(index + 1);
+}
+
 EditorModule::EditorModule(HWND hWnd, D3D12Module* d3d12)
 {
 	this->hWnd = hWnd;
@@ -30,6 +49,10 @@ EditorModule::EditorModule(HWND hWnd, D3D12Module* d3d12)
 	
 }
 
+EditorModule::~EditorModule()
+{
+}
+
 bool EditorModule::init() 
 {
 	Logger::Log("Initializing EditorModule...");
@@ -38,8 +61,8 @@ bool EditorModule::init()
 
 	ShaderDescriptorsModule* shaderDesc = app->getShaderDescriptors();
 
-	cpuHandle = shaderDesc->getCPUHandle(0);
-	gpuHandle = shaderDesc->getGPUHandle(0);
+	cpuHandle = shaderDesc->getCPUHandle(ShaderDescriptorsModule::IMGUI_SLOT);
+	gpuHandle = shaderDesc->getGPUHandle(ShaderDescriptorsModule::IMGUI_SLOT);
 
 	imGuiPass = new ImGuiPass(d3d12->getDevice(), hWnd, cpuHandle, gpuHandle);
 
@@ -54,6 +77,8 @@ bool EditorModule::init()
 	exercise = new ExerciseModule(d3d12);
 	exercise->init();
 
+	frameGraph = std::make_unique<RenderGraph>(d3d12->getDevice());
+
 
 	t.Stop();
 	Logger::Log("EditorModule initialized in: " + std::to_string(t.ReadMs()) + " ms.");
@@ -91,47 +116,97 @@ void EditorModule::preRender()
 
 void EditorModule::render()
 {
-	ID3D12GraphicsCommandList* cmd = d3d12->getCommandList();
+	FilteredCommandList& filtered = d3d12->getFilteredCommandList();
+	auto bbRtv = d3d12->getRenderTargetDescriptor();
+	auto bbDsv = d3d12->getDepthStencilDescriptor();
+
+	// ------------------------------------------------------------
+	// Frame graph: passes declare their targets, the graph owns every transition
+	// ------------------------------------------------------------
+	frameGraph->reset();
+
+	RenderGraph::Handle backBuffer = frameGraph->importResource("BackBuffer", d3d12->getBackBuffer(),
+		RenderGraphState::Present, RenderGraphState::Present);
 
-	// 1) Ensures heaps shader-visible for this frame
-	ID3D12DescriptorHeap* frameHeaps[] =
+	// ImGui samples the viewport texture, which lives in PIXEL_SHADER_RESOURCE between frames
+	RenderGraph::Handle viewportColor = RenderGraph::INVALID;
+	if (viewport->getColorTexture())
 	{
-		app->getShaderDescriptors()->getHeap(), // CBV/SRV/UAV
-		app->getSamplers()->getHeap()           // Samplers
-	};
-	cmd->SetDescriptorHeaps(_countof(frameHeaps), frameHeaps);
+		viewportColor = frameGraph->importResource("Viewport", viewport->getColorTexture(),
+			RenderGraphState::PixelShaderResource, RenderGraphState::PixelShaderResource);
+	}
 
-	// 2) Backbuffer as target + clear
-	auto bbRtv = d3d12->getRenderTargetDescriptor();
-	auto bbDsv = d3d12->getDepthStencilDescriptor();
-	cmd->OMSetRenderTargets(1, &bbRtv, FALSE, &bbDsv);
+	// Same target selection as GetSceneRenderPass()
+	const RenderGraph::Handle sceneTarget = viewport->isUsable() ? viewportColor : backBuffer;
+
+	// 1) Backbuffer as target + clear, heaps shader-visible for this frame
+	frameGraph->addPass("Clear",
+		[&](RenderGraph::PassBuilder& pass) { pass.write(backBuffer, RenderGraphState::RenderTarget); },
+		[&](ID3D12GraphicsCommandList* cmd)
+		{
+			ID3D12DescriptorHeap* frameHeaps[] =
+			{
+				app->getShaderDescriptors()->getHeap(), // CBV/SRV/UAV
+				app->getSamplers()->getHeap()           // Samplers
+			};
+			filtered.SetDescriptorHeaps(_countof(frameHeaps), frameHeaps);
 
-	const float clearColor[] = { 0.0f, 0.0f, 0.0f, 1.0f };
-	cmd->ClearRenderTargetView(bbRtv, clearColor, 0, nullptr);
+			cmd->OMSetRenderTargets(1, &bbRtv, FALSE, &bbDsv);
 
-	// 3) Execute ecercise
-	switch (currentExercise)
+			const float clearColor[] = { 0.0f, 0.0f, 0.0f, 1.0f };
+			cmd->ClearRenderTargetView(bbRtv, clearColor, 0, nullptr);
+		});
+
+	// 2) Execute exercise
+	if (currentExercise != ExerciseSelection::None)
 	{
-	case ExerciseSelection::Exercise1: exercise->exercise1(); break;
-	case ExerciseSelection::Exercise2: exercise->exercise2(); break;
-	case ExerciseSelection::Exercise3: exercise->exercise3(); break;
-	case ExerciseSelection::Exercise4: exercise->exercise4(); break;
-	case ExerciseSelection::Exercise5: exercise->exercise5(); break;
-	case ExerciseSelection::Exercise6: exercise->exercise6(); break;
-	case ExerciseSelection::Exercise7: exercise->exercise7(); break;
-	case ExerciseSelection::Exercise8: exercise->exercise8(); break;
-	default: break;
+		frameGraph->addPass("Scene",
+			[&](RenderGraph::PassBuilder& pass)
+			{
+				pass.write(sceneTarget, RenderGraphState::RenderTarget);
+				pass.changesCommandList();      // parallel recording (Exercise 8)
+			},
+			[&](ID3D12GraphicsCommandList*)
+			{
+				switch (currentExercise)
+				{
+				case ExerciseSelection::Exercise1: exercise->exercise1(); break;
+				case ExerciseSelection::Exercise2: exercise->exercise2(); break;
+				case ExerciseSelection::Exercise3: exercise->exercise3(); break;
+				case ExerciseSelection::Exercise4: exercise->exercise4(); break;
+				case ExerciseSelection::Exercise5: exercise->exercise5(); break;
+				case ExerciseSelection::Exercise6: exercise->exercise6(); break;
+				case ExerciseSelection::Exercise7: exercise->exercise7(); break;
+				case ExerciseSelection::Exercise8: exercise->exercise8(); break;
+				default: break;
+				}
+
+				// Exercises 1-7 still record straight into the raw list
+				filtered.invalidate();
+			});
 	}
 
-	// 4) Backbuffer and heap settings are correct for ImGui
-	cmd->OMSetRenderTargets(1, &bbRtv, FALSE, &bbDsv);
+	// 3) Last: ImGui (editor windows sample the viewport texture)
+	frameGraph->addPass("ImGui",
+		[&](RenderGraph::PassBuilder& pass)
+		{
+			if (viewportColor != RenderGraph::INVALID)
+				pass.read(viewportColor, RenderGraphState::PixelShaderResource);
+			pass.write(backBuffer, RenderGraphState::RenderTarget);
+		},
+		[&](ID3D12GraphicsCommandList* cmd)
+		{
+			// Backbuffer and heap settings are correct for ImGui
+			cmd->OMSetRenderTargets(1, &bbRtv, FALSE, &bbDsv);
 
-	ID3D12DescriptorHeap* imguiHeaps[] = { app->getShaderDescriptors()->getHeap() };
-	cmd->SetDescriptorHeaps(1, imguiHeaps);
+			ID3D12DescriptorHeap* imguiHeaps[] = { app->getShaderDescriptors()->getHeap() };
+			filtered.SetDescriptorHeaps(1, imguiHeaps);
 
-	// 5) Last: ImGui
-	imGuiPass->record(cmd, bbRtv);
+			imGuiPass->record(cmd, bbRtv);
+		});
 
+	frameGraph->compile();
+	frameGraph->execute(d3d12);
 }
 
 void EditorModule::postRender()
@@ -148,6 +223,7 @@ bool EditorModule::cleanUp()
 	delete viewport;
 	delete exercise;
 	delete imGuiPass;
+	frameGraph.reset();
 	return true;
 }
 
@@ -303,51 +379,57 @@ void EditorModule::drawExerciseMenu()
 	ImGui::Begin("Exercise List", &showExercisesWindow);
 
 	ImGui::Text("Select an exercise:");
+
+	// Exercises load the first time they are shown
+	bool prefetch = exercise->getPrefetchNext();
+	if (ImGui::Checkbox("Load the next exercise in the background", &prefetch))
+		exercise->setPrefetchNext(prefetch);
+
 	ImGui::Separator();
 
-	if (ImGui::Selectable("Exercise 1: Background Color", currentExercise == ExerciseSelection::Exercise1))
+	if (ImGui::Selectable(exerciseLabel(exercise, "Exercise 1: Background Color", 0).c_str(), currentExercise == ExerciseSelection::Exercise1))
 	{
 		Logger::Log("Selectable 1 clicked!");
 		currentExercise = ExerciseSelection::Exercise1;
 	}
 
-	if (ImGui::Selectable("Exercise 2: 2D Triangle", currentExercise == ExerciseSelection::Exercise2))
+	if (ImGui::Selectable(exerciseLabel(exercise, "Exercise 2: 2D Triangle", 1).c_str(), currentExercise == ExerciseSelection::Exercise2))
 	{
 		Logger::Log("Selectable 2 clicked!");
 		currentExercise = ExerciseSelection::Exercise2;
 	}
 
-	if (ImGui::Selectable("Exercise 3: 3D Triangle", currentExercise == ExerciseSelection::Exercise3))
+	if (ImGui::Selectable(exerciseLabel(exercise, "Exercise 3: 3D Triangle", 2).c_str(), currentExercise == ExerciseSelection::Exercise3))
 	{
 		Logger::Log("Selectable 3 clicked!");
 		currentExercise = ExerciseSelection::Exercise3;
 	}
 
-	if (ImGui::Selectable("Exercise 4: Textured Cube", currentExercise == ExerciseSelection::Exercise4))
+	if (ImGui::Selectable(exerciseLabel(exercise, "Exercise 4: Textured Cube", 3).c_str(), currentExercise == ExerciseSelection::Exercise4))
 	{
 		Logger::Log("Selectable 4 clicked!");
 		currentExercise = ExerciseSelection::Exercise4;
 	}
 
-	if (ImGui::Selectable("Exercise 5: Geometry Loading", currentExercise == ExerciseSelection::Exercise5))
+	if (ImGui::Selectable(exerciseLabel(exercise, "Exercise 5: Geometry Loading", 4).c_str(), currentExercise == ExerciseSelection::Exercise5))
 	{
 		Logger::Log("Selectable 5 clicked!");
 		currentExercise = ExerciseSelection::Exercise5;
 	}
 
-	if (ImGui::Selectable("Exercise 6: Phong Shading", currentExercise == ExerciseSelection::Exercise6))
+	if (ImGui::Selectable(exerciseLabel(exercise, "Exercise 6: Phong Shading", 5).c_str(), currentExercise == ExerciseSelection::Exercise6))
 	{
 		Logger::Log("Selectable 6 clicked!");
 		currentExercise = ExerciseSelection::Exercise6;
 	}
 
-	if (ImGui::Selectable("Exercise 7: PBR Phong", currentExercise == ExerciseSelection::Exercise7))
+	if (ImGui::Selectable(exerciseLabel(exercise, "Exercise 7: PBR Phong", 6).c_str(), currentExercise == ExerciseSelection::Exercise7))
 	{
 		Logger::Log("Selectable 7 clicked!");
 		currentExercise = ExerciseSelection::Exercise7;
 	}
 
-	if (ImGui::Selectable("Exercise 8: Multi-Light", currentExercise == ExerciseSelection::Exercise8))
+	if (ImGui::Selectable(exerciseLabel(exercise, "Exercise 8: Multi-Light", 7).c_str(), currentExercise == ExerciseSelection::Exercise8))
 	{
 		Logger::Log("Selectable 8 clicked!");
 		currentExercise = ExerciseSelection::Exercise8;
@@ -405,7 +487,8 @@ void EditorModule::drawPerformancePanel()
 
 		// Data
 		const char* names[4] = { "Update", "PreRender", "Render", "PostRender" };
-		float values[4] = { app->getUpdateMs(), app->getPreRenderMs(), app->getRenderMs(), app->getPostRenderMs() };
+		float values[4] = { app->getPhaseMs(ModulePhase::Update), app->getPhaseMs(ModulePhase::PreRender),
+			app->getPhaseMs(ModulePhase::Render), app->getPhaseMs(ModulePhase::PostRender) };
 		ImVec4 colors[4] = {
 			ImVec4(1.0f,0.3f,0.3f,1.0f),
 			ImVec4(1.0f,1.0f,0.3f,1.0f),
@@ -439,6 +522,169 @@ void EditorModule::drawPerformancePanel()
 		ImGui::Columns(1);
 	}
 
+	// --- Fixed timestep / frame limiter ---
+	if (ImGui::CollapsingHeader("Frame Timing"))
+	{
+		TimeService& time = app->getTimeService();
+
+		float stepHz = float(time.getFixedStepHz());
+		if (ImGui::SliderFloat("Fixed step (Hz)", &stepHz, 10.0f, 240.0f, "%.0f"))
+			time.setFixedStepHz(stepHz);
+
+		int maxSteps = int(time.getMaxStepsPerFrame());
+		if (ImGui::SliderInt("Max steps / frame", &maxSteps, 1, 10))
+			time.setMaxStepsPerFrame(uint32_t(maxSteps));
+
+		float targetFps = float(time.getTargetFps());
+		if (ImGui::SliderFloat("Frame limit (FPS)", &targetFps, 0.0f, 240.0f, targetFps > 0.0f ? "%.0f" : "Off"))
+			time.setTargetFps(targetFps);
+
+		ImGui::Text("Frame: %.3f ms", float(time.getFrameUs()) * 0.001f);
+		ImGui::Text("Steps this frame: %u  (alpha %.2f)", time.getLastSteps(), time.getAlpha());
+		ImGui::Text("Dropped steps: %llu", (unsigned long long)time.getDroppedSteps());
+	}
+
+	// --- Frame render graph (last frame) ---
+	if (ImGui::CollapsingHeader("Render Graph") && frameGraph)
+	{
+		const CompiledRenderGraph::Stats& stats = frameGraph->getStats();
+
+		ImGui::Text("Passes: %u  (%u culled)", stats.passes, stats.culledPasses);
+		ImGui::Text("Barriers: %u in %u batches  (%u split, %u aliasing)", stats.barriers, stats.batches, stats.splitBarriers, stats.aliasingBarriers);
+		ImGui::Text("Transient memory: %.2f MB  (%.2f MB without aliasing)",
+			double(stats.heapSize) / (1024.0 * 1024.0), double(stats.unaliasedSize) / (1024.0 * 1024.0));
+
+		for (const CompiledRenderGraph::PassBarriers& pass : frameGraph->getCompiled().passes)
+			ImGui::BulletText("%s: %u before, %u after", frameGraph->getPassName(pass.pass), uint32_t(pass.before.size()), uint32_t(pass.after.size()));
+	}
+
+	// --- Static resource heaps ---
+	if (ImGui::CollapsingHeader("GPU Heaps"))
+	{
+		ResourcesModule* resources = app->getResources();
+		const GpuHeapAllocator::Stats stats = resources->getHeapStats();
+
+		ImGui::Text("Buffers: %u in %u heap(s), %.2f / %.0f MB  (fragmentation %.0f %%)", stats.buffers, stats.bufferHeaps,
+			double(stats.bufferBytes) / (1024.0 * 1024.0), double(stats.bufferCapacity) / (1024.0 * 1024.0), stats.bufferFragmentation * 100.0f);
+		ImGui::Text("Textures: %u in %u heap(s), %.2f / %.0f MB  (fragmentation %.0f %%)", stats.textures, stats.textureHeaps,
+			double(stats.textureBytes) / (1024.0 * 1024.0), double(stats.textureCapacity) / (1024.0 * 1024.0), stats.textureFragmentation * 100.0f);
+		ImGui::Text("Committed fallbacks: %u   Pending frees: %u", resources->getCommittedFallbacks(), stats.pendingFrees);
+		ImGui::Text("Defragmented: %u heap(s), %.2f MB moved", stats.defragmentations, double(stats.bytesMoved) / (1024.0 * 1024.0));
+
+		if (ImGui::Button("Defragment buffer heaps"))
+			resources->requestDefragment();
+
+		const ShaderDescriptorsModule::Stats descriptors = app->getShaderDescriptors()->getStats();
+		ImGui::Separator();
+		ImGui::Text("Descriptors: %u / %u  (%u free range(s), %u pending free(s))", descriptors.allocated, descriptors.capacity,
+			descriptors.freeRanges, descriptors.pendingFrees);
+		if (descriptors.staleAccesses > 0 || descriptors.failures > 0)
+			ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Stale handle uses: %u   Failed allocations: %u", descriptors.staleAccesses, descriptors.failures);
+
+		const SamplersModule::Stats samplerStats = app->getSamplers()->getStats();
+		ImGui::Text("Samplers: %u / %u  (%u of %u requests shared an existing one)", samplerStats.samplers, SamplersModule::MAX_SAMPLERS,
+			samplerStats.hits, samplerStats.requests);
+	}
+
+	// --- Pipeline cache ---
+	if (ImGui::CollapsingHeader("Pipelines"))
+	{
+		const PipelineCacheModule::Stats pipelineStats = app->getPipelineCache()->getStats();
+		ImGui::Text("PSOs: %u  Root signatures: %u  (%u of %u requests shared an existing PSO)", pipelineStats.pipelines,
+			pipelineStats.rootSignatures, pipelineStats.hits, pipelineStats.requests);
+		ImGui::Text("Loaded from library: %u   Compiled: %u   Pending: %u   (%.1f ms total)", pipelineStats.libraryLoads,
+			pipelineStats.compiled, pipelineStats.pending, pipelineStats.compileMs);
+		if (pipelineStats.failures > 0)
+			ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Failed PSOs: %u", pipelineStats.failures);
+
+		const ShaderArchive::Stats archiveStats = app->getShaderArchive().getStats();
+		ImGui::Separator();
+		ImGui::Text("Shader archive: %u shaders, %.2f MB mapped  (%u lookups mapped, %u loose .cso, %u missing)",
+			archiveStats.archived, double(archiveStats.mappedBytes) / (1024.0 * 1024.0), archiveStats.mappedHits,
+			archiveStats.looseFiles, archiveStats.missing);
+	}
+
+	// --- Per-module timings (last frame) ---
+	if (ImGui::CollapsingHeader("Modules"))
+	{
+		const ModuleScheduler& scheduler = app->getModuleScheduler();
+
+		bool pipelined = app->isPipelined();
+		if (ImGui::Checkbox("Pipelined update / render", &pipelined))
+			app->setPipelined(pipelined);
+		if (ImGui::IsItemHovered())
+			ImGui::SetTooltip("Next frame's update runs on the workers while this frame is recorded (+1 frame latency)");
+
+		if (ImGui::BeginTable("ModuleTable", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+		{
+			ImGui::TableSetupColumn("Module");
+			for (size_t p = 0; p < size_t(ModulePhase::Count); ++p)
+				ImGui::TableSetupColumn(ModuleScheduler::getPhaseName(ModulePhase(p)));
+			ImGui::TableHeadersRow();
+
+			float sums[size_t(ModulePhase::Count)] = {};
+			for (const ModuleScheduler::ModuleTiming& timing : scheduler.getTimings())
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn(); ImGui::Text("%s", timing.name);
+				for (size_t p = 0; p < size_t(ModulePhase::Count); ++p)
+				{
+					ImGui::TableNextColumn(); ImGui::Text("%.3f", timing.ms[p]);
+					sums[p] += timing.ms[p];
+				}
+			}
+
+			// Sum above wall time means modules overlapped
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn(); ImGui::TextDisabled("sum / wall");
+			for (size_t p = 0; p < size_t(ModulePhase::Count); ++p)
+			{
+				ImGui::TableNextColumn();
+				ImGui::TextDisabled("%.2f / %.2f", sums[p], scheduler.getPhaseMs(ModulePhase(p)));
+			}
+
+			ImGui::EndTable();
+		}
+
+		for (size_t p = 0; p < size_t(ModulePhase::Count); ++p)
+		{
+			ModulePhase phase = ModulePhase(p);
+			ImGui::Text("%s: %u modules, %u deps, %u ready at start", ModuleScheduler::getPhaseName(phase),
+				scheduler.getNodeCount(phase), scheduler.getEdgeCount(phase), scheduler.getRootCount(phase));
+		}
+	}
+
+	// --- Redundant state filtering (last frame) ---
+	if (ImGui::CollapsingHeader("State Filtering"))
+	{
+		const FilteredCommandList::Stats& stats = d3d12->getFilterStats();
+
+		uint32_t issued = stats.totalIssued();
+		uint32_t filtered = stats.totalFiltered();
+		uint32_t total = issued + filtered;
+
+		ImGui::Text("Issued: %u  Filtered: %u  (%.0f%% saved)", issued, filtered,
+			total > 0 ? 100.0f * float(filtered) / float(total) : 0.0f);
+
+		if (ImGui::BeginTable("FilterTable", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+		{
+			ImGui::TableSetupColumn("Call");
+			ImGui::TableSetupColumn("Issued");
+			ImGui::TableSetupColumn("Filtered");
+			ImGui::TableHeadersRow();
+
+			for (size_t i = 0; i < size_t(FilteredCommandList::Call::Count); ++i)
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn(); ImGui::Text("%s", filteredCallName(i));
+				ImGui::TableNextColumn(); ImGui::Text("%u", stats.issued[i]);
+				ImGui::TableNextColumn(); ImGui::Text("%u", stats.filtered[i]);
+			}
+
+			ImGui::EndTable();
+		}
+	}
+
 	ImGui::End();
 }
 
@@ -475,6 +721,24 @@ void EditorModule::drawRingBufferPanel()
 	ImGui::Text("Tail:                 %zu KB", tailBytes / 1024);
 	ImGui::Text("Current Frame:        %u", currentFrame);
 
+	// ------------------------------------------------------------
+	// Multi-threaded allocation (last recorded frame)
+	// ------------------------------------------------------------
+	const RingBufferModule::Stats& ringStats = ring->getLastFrameStats();
+	ImGui::Text("Thread blocks:        %u x %zu KB", ringStats.blocks, RingBufferModule::BLOCK_SIZE / 1024);
+	ImGui::Text("Allocations:          %u from blocks, %u direct", ringStats.subAllocations, ringStats.directAllocations);
+	ImGui::Text("Head contention:      %u retries", ringStats.casRetries);
+	ImGui::Text("Block waste:          %zu KB of %zu KB (%.1f %%)", ringStats.wasted / 1024, ringStats.reserved / 1024,
+		ringStats.reserved > 0 ? 100.0f * float(ringStats.wasted) / float(ringStats.reserved) : 0.0f);
+	ImGui::Text("Alignment padding:    %zu B (%zu B if rounded to 256 B)", ringStats.padding, ringStats.cbvPadding);
+	ImGui::Text("High-water (%u fr):   %zu KB per frame", RingBufferModule::HISTORY_FRAMES, ringStats.highWater / 1024);
+	ImGui::Text("Resizes:              %u", ringStats.resizes);
+	ImGui::Text("Overflow pages:       %u alive", ringStats.pages);
+	if (ringStats.overflowAllocations > 0)
+		ImGui::TextColored(ImVec4(1, 0.6f, 0, 1), "Overflow:             %u allocations, %zu KB", ringStats.overflowAllocations, ringStats.overflow / 1024);
+	if (ringStats.failures > 0)
+		ImGui::TextColored(ImVec4(1, 0, 0, 1), "Failed allocations:   %u", ringStats.failures);
+
 	ImGui::Dummy(ImVec2(0.0f, 6.0f));
 
 	ImGui::ProgressBar(usage, ImVec2(0.0f, 0.0f));
@@ -512,6 +776,36 @@ void EditorModule::drawRingBufferPanel()
 		ImVec2(0.0f, 80.0f)
 	);
 
+	// ------------------------------------------------------------
+	// Allocations per size class (last recorded frame)
+	// ------------------------------------------------------------
+	float sizeClasses[RingBufferModule::SIZE_CLASSES];
+	for (uint32_t i = 0; i < RingBufferModule::SIZE_CLASSES; ++i)
+		sizeClasses[i] = float(ringStats.histogram[i]);
+
+	ImGui::Text("Allocations per size class (256 B .. 1 MB+)");
+	ImGui::PlotHistogram(
+		"##RingSizeClasses",
+		sizeClasses,
+		RingBufferModule::SIZE_CLASSES,
+		0,
+		nullptr,
+		0.0f,
+		FLT_MAX,
+		ImVec2(0.0f, 80.0f)
+	);
+	if (ImGui::IsItemHovered())
+	{
+		ImGui::BeginTooltip();
+		for (uint32_t i = 0; i < RingBufferModule::SIZE_CLASSES; ++i)
+		{
+			if (ringStats.histogram[i] > 0)
+				ImGui::Text("%s %7zu B: %u", i + 1 < RingBufferModule::SIZE_CLASSES ? "<=" : "> ",
+					size_t(256) << (i + 1 < RingBufferModule::SIZE_CLASSES ? i : i - 1), ringStats.histogram[i]);
+		}
+		ImGui::EndTooltip();
+	}
+
 	ImGui::Separator();
 
 	// ------------------------------------------------------------
@@ -615,3 +909,12 @@ void EditorModule::drawRingBufferPanel()
 }
 
 
+
+ModuleAccess EditorModule::getAccess(ModulePhase phase) const
+{
+    // ImGui, the viewport and the exercises touch everything, on the main thread
+    if (phase == ModulePhase::Update)
+        return ModuleAccess::idle();
+
+    return ModuleAccess();
+}
@@ -7,6 +7,8 @@
 #include "ViewportModule.h"
 #include "ExerciseModule.h"
 
+class RenderGraph;
+
 class EditorModule : public Module
 {
 
@@ -19,6 +21,9 @@ private:
 	ViewportModule* viewport = nullptr;
 	ExerciseModule* exercise = nullptr;
 
+	// Rebuilt every frame in render(): inserts the backbuffer / viewport transitions
+	std::unique_ptr<RenderGraph> frameGraph;
+
 	D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = {};
 	D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle = {};
 
@@ -32,7 +37,7 @@ private:
 public:
 
 	EditorModule(HWND hWnd, D3D12Module* d3d12);
-	~EditorModule() {}
+	~EditorModule();
 
 	bool init() override;
 	//void update() override;
@@ -41,7 +46,11 @@ public:
 	void render() override;
 	bool cleanUp() override;
 
+	const char* getName() const override { return "Editor"; }
+	ModuleAccess getAccess(ModulePhase phase) const override;
+
 	ImGuiPass* getImGuiPass() { return imGuiPass; }
+	const RenderGraph* getFrameGraph() const { return frameGraph.get(); }
 
 private:
 	void createDockSpace();
@@ -8,6 +8,7 @@
 
 #include "Application.h"
 #include "D3D12Module.h"
+#include "ShaderArchivePacker.h"
 
 #include <shellapi.h>
 
@@ -45,6 +46,11 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
     UNREFERENCED_PARAMETER(hPrevInstance);
     UNREFERENCED_PARAMETER(lpCmdLine);
 
+    // Build step ('-packshaders'): pack and exit, no window
+    int packExitCode = 0;
+    if (ShaderArchivePacker::runFromCommandLine(__argc, __wargv, packExitCode))
+        return packExitCode;
+
     // TODO: Place code here.
 
     // Initialize global strings
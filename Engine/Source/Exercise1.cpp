@@ -2,10 +2,11 @@
 #include "Exercise1.h"
 
 #include <d3d12.h>
-#include "ReadData.h"
+#include "ShaderArchive.h"
 #include "d3dx12.h"
 
 #include "D3D12Module.h"
+#include "PipelineCacheModule.h"
 #include "Application.h"
 #include "ResourcesModule.h"
 #include "SceneRenderPass.h"
@@ -68,7 +69,7 @@ void Exercise1::render()
     commandList->DrawInstanced(4, 1, 0, 0);
 
     // ------------------------------------------------------------
-    // End pass: transitions viewport RTV -> SRV for ImGui sampling
+    // End pass (the frame render graph restores the viewport to SRV)
     // ------------------------------------------------------------
     pass.end(commandList);
 
@@ -132,7 +133,7 @@ bool Exercise1::createRootSignature()
         return false;
     }
 
-    hr = app->getD3D12()->getDevice()->CreateRootSignature(
+    hr = app->getPipelineCache()->createRootSignature(
         0,
         sigBlob->GetBufferPointer(),
         sigBlob->GetBufferSize(),
@@ -150,10 +151,10 @@ bool Exercise1::createPSO()
           D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
     };
 
-    auto dataVS = DX::ReadData(L"Exercise1VS.cso");
-    auto dataPS = DX::ReadData(L"Exercise1PS.cso");
+    D3D12_SHADER_BYTECODE dataVS = app->getShaderArchive().get(L"Exercise1VS");
+    D3D12_SHADER_BYTECODE dataPS = app->getShaderArchive().get(L"Exercise1PS");
 
-    if (dataVS.empty() || dataPS.empty())
+    if (dataVS.BytecodeLength == 0 || dataPS.BytecodeLength == 0)
     {
         Logger::Err("Exercise1: VS or PS .cso is empty  check build output and paths");
         return false;
@@ -162,8 +163,8 @@ bool Exercise1::createPSO()
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
     psoDesc.InputLayout = { inputLayout, _countof(inputLayout) };
     psoDesc.pRootSignature = rootSignature.Get();
-    psoDesc.VS = { dataVS.data(), dataVS.size() };
-    psoDesc.PS = { dataPS.data(), dataPS.size() };
+    psoDesc.VS = dataVS;
+    psoDesc.PS = dataPS;
 
     psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
 
@@ -183,7 +184,7 @@ bool Exercise1::createPSO()
     psoDesc.DepthStencilState.DepthEnable = FALSE;
     psoDesc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO;
 
-    return SUCCEEDED(app->getD3D12()->getDevice()->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pso)));
+    return SUCCEEDED(app->getPipelineCache()->createGraphicsPipeline(&psoDesc, IID_PPV_ARGS(&pso)));
 }
 
 
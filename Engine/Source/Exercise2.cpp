@@ -1,10 +1,11 @@
 #include "Globals.h"
 #include "Exercise2.h"
 #include "D3D12Module.h"
+#include "PipelineCacheModule.h"
 #include "ResourcesModule.h"
 #include "Application.h"
 #include <d3d12.h>
-#include "ReadData.h"
+#include "ShaderArchive.h"
 #include "SceneRenderPass.h"
 
 bool Exercise2::init()
@@ -120,7 +121,7 @@ bool Exercise2::createRootSignature()
         return false;
     }
 
-    if (FAILED(app->getD3D12()->getDevice()->CreateRootSignature(0, rootSignatureBlob->GetBufferPointer(), rootSignatureBlob->GetBufferSize(), IID_PPV_ARGS(&rootSignature))))
+    if (FAILED(app->getPipelineCache()->createRootSignature(0, rootSignatureBlob->GetBufferPointer(), rootSignatureBlob->GetBufferSize(), IID_PPV_ARGS(&rootSignature))))
     {
         return false;
     }
@@ -132,10 +133,10 @@ bool Exercise2::createPSO()
 {
     D3D12_INPUT_ELEMENT_DESC inputLayout[] = { {"MY_POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0} };
 
-    auto dataVS = DX::ReadData(L"Exercise2VS.cso");
-    auto dataPS = DX::ReadData(L"Exercise2PS.cso");
+    D3D12_SHADER_BYTECODE dataVS = app->getShaderArchive().get(L"Exercise2VS");
+    D3D12_SHADER_BYTECODE dataPS = app->getShaderArchive().get(L"Exercise2PS");
 
-    if (dataVS.empty() || dataPS.empty()) {
+    if (dataVS.BytecodeLength == 0 || dataPS.BytecodeLength == 0) {
         Logger::Err("ERROR: VS or PS .cso is empty  check build output and paths");
         return false;
     }
@@ -147,8 +148,8 @@ bool Exercise2::createPSO()
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
     psoDesc.InputLayout = { inputLayout, sizeof(inputLayout) / sizeof(D3D12_INPUT_ELEMENT_DESC) };  // the structure describing our input layout
     psoDesc.pRootSignature = rootSignature.Get();                                                   // the root signature that describes the input data this pso needs
-    psoDesc.VS = { dataVS.data(), dataVS.size() };                                                  // structure describing where to find the vertex shader bytecode and how large it is
-    psoDesc.PS = { dataPS.data(), dataPS.size() };                                                  // same as VS but for pixel shader
+    psoDesc.VS = dataVS;                                                                            // structure describing where to find the vertex shader bytecode and how large it is
+    psoDesc.PS = dataPS;                                                                            // same as VS but for pixel shader
     psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;                         // type of topology we are drawing
     psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;                                             // format of the render target
     psoDesc.SampleDesc = { 1, 0 };                                                                  // must be the same sample description as the swapchain and depth/stencil buffer
@@ -158,5 +159,5 @@ bool Exercise2::createPSO()
     psoDesc.NumRenderTargets = 1;                                                                   // we are only binding one render target
 
     // create the pso
-    return SUCCEEDED(app->getD3D12()->getDevice()->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pso)));
+    return SUCCEEDED(app->getPipelineCache()->createGraphicsPipeline(&psoDesc, IID_PPV_ARGS(&pso)));
 }
@@ -2,11 +2,12 @@
 #include "Exercise3.h"
 
 #include "D3D12Module.h"
+#include "PipelineCacheModule.h"
 #include "ResourcesModule.h"
 #include "Application.h"
 
 #include <d3d12.h>
-#include "ReadData.h"
+#include "ShaderArchive.h"
 #include <d3dcompiler.h>
 #include "d3dx12.h"
 #include "SceneRenderPass.h"
@@ -133,7 +134,7 @@ bool Exercise3::createRootSignature()
         return false;
     }
 
-    hr = app->getD3D12()->getDevice()->CreateRootSignature(0,
+    hr = app->getPipelineCache()->createRootSignature(0,
         signatureBlob->GetBufferPointer(),
         signatureBlob->GetBufferSize(),
         IID_PPV_ARGS(&rootSignature));
@@ -144,10 +145,10 @@ bool Exercise3::createPSO()
 {
     D3D12_INPUT_ELEMENT_DESC inputLayout[] = { {"MY_POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0} };
 
-    auto dataVS = DX::ReadData(L"Exercise3VS.cso");
-    auto dataPS = DX::ReadData(L"Exercise3PS.cso");
+    D3D12_SHADER_BYTECODE dataVS = app->getShaderArchive().get(L"Exercise3VS");
+    D3D12_SHADER_BYTECODE dataPS = app->getShaderArchive().get(L"Exercise3PS");
 
-    if (dataVS.empty() || dataPS.empty()) {
+    if (dataVS.BytecodeLength == 0 || dataPS.BytecodeLength == 0) {
         Logger::Err("ERROR: VS or PS .cso is empty  check build output and paths");
         return false;
     }
@@ -159,8 +160,8 @@ bool Exercise3::createPSO()
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
     psoDesc.InputLayout = { inputLayout, sizeof(inputLayout) / sizeof(D3D12_INPUT_ELEMENT_DESC) };  // the structure describing our input layout
     psoDesc.pRootSignature = rootSignature.Get();                                                   // the root signature that describes the input data this pso needs
-    psoDesc.VS = { dataVS.data(), dataVS.size() };                                                  // structure describing where to find the vertex shader bytecode and how large it is
-    psoDesc.PS = { dataPS.data(), dataPS.size() };                                                  // same as VS but for pixel shader
+    psoDesc.VS = dataVS;                                                                            // structure describing where to find the vertex shader bytecode and how large it is
+    psoDesc.PS = dataPS;                                                                            // same as VS but for pixel shader
     psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;                         // type of topology we are drawing
     psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;                                             // format of the render target
     psoDesc.DSVFormat = DXGI_FORMAT_D32_FLOAT;                    //  AADE
@@ -172,7 +173,7 @@ bool Exercise3::createPSO()
     psoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);  //  AADE
 
     // create the pso
-    return SUCCEEDED(app->getD3D12()->getDevice()->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pso)));
+    return SUCCEEDED(app->getPipelineCache()->createGraphicsPipeline(&psoDesc, IID_PPV_ARGS(&pso)));
 }
 
 
@@ -2,6 +2,7 @@
 #include "Exercise4.h"
 
 #include "D3D12Module.h"
+#include "PipelineCacheModule.h"
 #include "ResourcesModule.h"
 #include "ShaderDescriptorsModule.h"
 #include "SamplersModule.h"
@@ -9,7 +10,7 @@
 #include "Application.h"
 
 #include <d3d12.h>
-#include "ReadData.h"
+#include "ShaderArchive.h"
 #include <d3dcompiler.h>
 #include "d3dx12.h"
 #include "SceneRenderPass.h"
@@ -150,7 +151,7 @@ void Exercise4::render()
     commandList->SetGraphicsRootDescriptorTable(1, texHandle);
 
     // s0: sampler samplerMode
-    D3D12_GPU_DESCRIPTOR_HANDLE sampHandle = samplers->getGPUHandle((UINT)samplerMode);
+    D3D12_GPU_DESCRIPTOR_HANDLE sampHandle = samplers->getGPUHandle(samplerIndices[samplerMode]);
     commandList->SetGraphicsRootDescriptorTable(2, sampHandle); 
 
 
@@ -317,7 +318,7 @@ bool Exercise4::createRootSignature()
     // ------------------------------------------------------------
     // Create root signature object
     // ------------------------------------------------------------
-    hr = app->getD3D12()->getDevice()->CreateRootSignature(
+    hr = app->getPipelineCache()->createRootSignature(
         0,
         signatureBlob->GetBufferPointer(),
         signatureBlob->GetBufferSize(),
@@ -346,10 +347,10 @@ bool Exercise4::createPSO()
     // ------------------------------------------------------------
     // Load compiled shaders (.cso files)
     // ------------------------------------------------------------
-    auto dataVS = DX::ReadData(L"Exercise4VS.cso");
-    auto dataPS = DX::ReadData(L"Exercise4PS.cso");
+    D3D12_SHADER_BYTECODE dataVS = app->getShaderArchive().get(L"Exercise4VS");
+    D3D12_SHADER_BYTECODE dataPS = app->getShaderArchive().get(L"Exercise4PS");
 
-    if (dataVS.empty() || dataPS.empty()) {
+    if (dataVS.BytecodeLength == 0 || dataPS.BytecodeLength == 0) {
         Logger::Err("ERROR: VS or PS .cso is empty  check build output and paths");
         return false;
     }
@@ -364,8 +365,8 @@ bool Exercise4::createPSO()
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
     psoDesc.InputLayout = { inputLayout, sizeof(inputLayout) / sizeof(D3D12_INPUT_ELEMENT_DESC) };  // the structure describing our input layout
     psoDesc.pRootSignature = rootSignature.Get();                                                   // the root signature that describes the input data this pso needs
-    psoDesc.VS = { dataVS.data(), dataVS.size() };                                                  // structure describing where to find the vertex shader bytecode and how large it is
-    psoDesc.PS = { dataPS.data(), dataPS.size() };                                                  // same as VS but for pixel shader
+    psoDesc.VS = dataVS;                                                                            // structure describing where to find the vertex shader bytecode and how large it is
+    psoDesc.PS = dataPS;                                                                            // same as VS but for pixel shader
     psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;                         // type of topology we are drawing
     psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;                                             // format of the render target
     psoDesc.DSVFormat = DXGI_FORMAT_D32_FLOAT;                    
@@ -379,7 +380,7 @@ bool Exercise4::createPSO()
     // ------------------------------------------------------------
     // Create Pipeline State Object
     // ------------------------------------------------------------
-    return SUCCEEDED(app->getD3D12()->getDevice()->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pso)));
+    return SUCCEEDED(app->getPipelineCache()->createGraphicsPipeline(&psoDesc, IID_PPV_ARGS(&pso)));
 }
 
 void Exercise4::ExerciseMenu(CameraModule* camera)
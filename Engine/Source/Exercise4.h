@@ -1,6 +1,7 @@
 #pragma once
 #include "Module.h"
 #include "DebugDrawPass.h"
+#include "ShaderDescriptorsModule.h"
 
 class CameraModule;
 
@@ -18,7 +19,7 @@ private:
 	D3D12_INDEX_BUFFER_VIEW indexBufferView;
 
 	ComPtr<ID3D12Resource> texture;
-	UINT textureIndex = UINT_MAX;
+	DescriptorHandle textureIndex;
 
 	uint32_t samplerIndices[4] = { 0,1,2,3 };
 	int samplerMode = 0; 
@@ -2,6 +2,7 @@
 #include "Exercise5.h"
 
 #include "D3D12Module.h"
+#include "PipelineCacheModule.h"
 #include "ResourcesModule.h"
 #include "ShaderDescriptorsModule.h"
 #include "SamplersModule.h"
@@ -10,7 +11,7 @@
 #include "ViewportModule.h"
 
 #include <d3d12.h>
-#include "ReadData.h"
+#include "ShaderArchive.h"
 #include <d3dcompiler.h>
 #include "d3dx12.h"
 
@@ -19,6 +20,7 @@
 #include "BasicMaterial.h"
 
 #include "SceneRenderPass.h"
+#include "JobSystem.h"
 
 Exercise5::Exercise5()
 {
@@ -30,21 +32,41 @@ Exercise5::~Exercise5()
 
 bool Exercise5::init()
 {
+    // ------------------------------------------------------------
+    // The model (glTF parse, texture decodes, uploads) loads on a
+    // worker while the root signature and pipeline are created here
+    // ------------------------------------------------------------
     duck = std::make_unique<Model>();
 
-    if (!duck->Load("Assets/Models/Duck/", "Duck.gltf", BasicMaterial::Type::BASIC))
+    bool modelLoaded = false;
+    JobCounter modelJob;
+    auto loadModel = [this, &modelLoaded]() { modelLoaded = duck->Load("Assets/Models/Duck/", "Duck.gltf", BasicMaterial::Type::BASIC); };
+
+    JobSystem* jobs = app->getJobSystem();
+    if (jobs && jobs->getWorkerCount() > 0)
+        jobs->run(loadModel, &modelJob);
+    else
+        loadModel();
+
+    const bool rootSignatureOk = createRootSignature();
+    const bool psoOk = rootSignatureOk && createPSO();
+
+    if (jobs)
+        jobs->wait(modelJob);
+
+    if (!modelLoaded)
     {
         Logger::Err("Exercise5: Duck Model not loaded");
         return false;
     }
 
-    if (!createRootSignature())
+    if (!rootSignatureOk)
     {
         Logger::Err("Exercise 5: RootSignature Failed");
         return false;
     }
 
-    if (!createPSO())
+    if (!psoOk)
     {
         Logger::Err("Exercise 5: PSO Failed");
         return false;
@@ -193,7 +215,7 @@ bool Exercise5::createRootSignature()
     // ------------------------------------------------------------
     // Create root signature object
     // ------------------------------------------------------------
-    hr = app->getD3D12()->getDevice()->CreateRootSignature(
+    hr = app->getPipelineCache()->createRootSignature(
         0,
         signatureBlob->GetBufferPointer(),
         signatureBlob->GetBufferSize(),
@@ -223,10 +245,10 @@ bool Exercise5::createPSO()
     // ------------------------------------------------------------
     // Load compiled shaders (.cso files)
     // ------------------------------------------------------------
-    auto dataVS = DX::ReadData(L"Exercise5VS.cso");
-    auto dataPS = DX::ReadData(L"Exercise5PS.cso");
+    D3D12_SHADER_BYTECODE dataVS = app->getShaderArchive().get(L"Exercise5VS");
+    D3D12_SHADER_BYTECODE dataPS = app->getShaderArchive().get(L"Exercise5PS");
 
-    if (dataVS.empty() || dataPS.empty()) {
+    if (dataVS.BytecodeLength == 0 || dataPS.BytecodeLength == 0) {
         Logger::Err("ERROR: VS or PS .cso is empty  check build output and paths");
         return false;
     }
@@ -241,8 +263,8 @@ bool Exercise5::createPSO()
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
     psoDesc.InputLayout = { inputLayout, sizeof(inputLayout) / sizeof(D3D12_INPUT_ELEMENT_DESC) };  // the structure describing our input layout
     psoDesc.pRootSignature = rootSignature.Get();                                                   // the root signature that describes the input data this pso needs
-    psoDesc.VS = { dataVS.data(), dataVS.size() };                                                  // structure describing where to find the vertex shader bytecode and how large it is
-    psoDesc.PS = { dataPS.data(), dataPS.size() };                                                  // same as VS but for pixel shader
+    psoDesc.VS = dataVS;                                                                            // structure describing where to find the vertex shader bytecode and how large it is
+    psoDesc.PS = dataPS;                                                                            // same as VS but for pixel shader
     psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;                         // type of topology we are drawing
     psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;                                             // format of the render target
     psoDesc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
@@ -257,7 +279,7 @@ bool Exercise5::createPSO()
     // ------------------------------------------------------------
     // Create Pipeline State Object
     // ------------------------------------------------------------
-    return SUCCEEDED(app->getD3D12()->getDevice()->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pso)));
+    return SUCCEEDED(app->getPipelineCache()->createGraphicsPipeline(&psoDesc, IID_PPV_ARGS(&pso)));
 }
 
 void Exercise5::loadModel(ID3D12GraphicsCommandList* commandList, ShaderDescriptorsModule* shaders, SamplersModule* samplers)
@@ -279,7 +301,7 @@ void Exercise5::loadModel(ID3D12GraphicsCommandList* commandList, ShaderDescript
         commandList->SetGraphicsRootDescriptorTable(2, texHandle);
 
         // Sampler slot 3
-        D3D12_GPU_DESCRIPTOR_HANDLE sampHandle = samplers->getGPUHandle(0);
+        D3D12_GPU_DESCRIPTOR_HANDLE sampHandle = samplers->getGPUHandle(mat.getColourSampler());
         commandList->SetGraphicsRootDescriptorTable(3, sampHandle);
 
         // Draw
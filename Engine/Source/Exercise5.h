@@ -22,7 +22,7 @@ private:
 	D3D12_INDEX_BUFFER_VIEW indexBufferView;
 
 	ComPtr<ID3D12Resource> texture;
-	UINT textureIndex = UINT_MAX;
+	DescriptorHandle textureIndex;
 
 	std::unique_ptr<Model> duck;
 	SimpleMath::Quaternion qRot = SimpleMath::Quaternion::Identity;
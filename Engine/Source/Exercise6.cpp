@@ -2,6 +2,7 @@
 #include "Exercise6.h"
 
 #include "D3D12Module.h"
+#include "PipelineCacheModule.h"
 #include "ResourcesModule.h"
 #include "ShaderDescriptorsModule.h"
 #include "SamplersModule.h"
@@ -11,7 +12,7 @@
 #include "ViewportModule.h"
 
 #include <d3d12.h>
-#include "ReadData.h"
+#include "ShaderArchive.h"
 #include <d3dcompiler.h>
 #include "d3dx12.h"
 
@@ -20,6 +21,7 @@
 #include "BasicMaterial.h"
 
 #include "SceneRenderPass.h"
+#include "JobSystem.h"
 
 Exercise6::Exercise6()
 {
@@ -31,21 +33,41 @@ Exercise6::~Exercise6()
 
 bool Exercise6::init()
 {
+    // ------------------------------------------------------------
+    // The model (glTF parse, texture decodes, uploads) loads on a
+    // worker while the root signature and pipeline are created here
+    // ------------------------------------------------------------
     duck = std::make_unique<Model>();
 
-    if (!duck->Load("Assets/Models/Duck/", "Duck.gltf", BasicMaterial::Type::PHONG))
+    bool modelLoaded = false;
+    JobCounter modelJob;
+    auto loadModel = [this, &modelLoaded]() { modelLoaded = duck->Load("Assets/Models/Duck/", "Duck.gltf", BasicMaterial::Type::PHONG); };
+
+    JobSystem* jobs = app->getJobSystem();
+    if (jobs && jobs->getWorkerCount() > 0)
+        jobs->run(loadModel, &modelJob);
+    else
+        loadModel();
+
+    const bool rootSignatureOk = createRootSignature();
+    const bool psoOk = rootSignatureOk && createPSO();
+
+    if (jobs)
+        jobs->wait(modelJob);
+
+    if (!modelLoaded)
     {
         Logger::Err("Exercise6: Duck Model not loaded");
         return false;
     }
 
-    if (!createRootSignature())
+    if (!rootSignatureOk)
     {
         Logger::Err("Exercise 6: RootSignature Failed");
         return false;
     }
 
-    if (!createPSO())
+    if (!psoOk)
     {
         Logger::Err("Exercise 6: PSO Failed");
         return false;
@@ -100,7 +122,7 @@ void Exercise6::render()
     // PerFrame constant buffer (Phong lighting)
     // ------------------------------------------------------------
     PerFrame* perFrame = nullptr;
-    auto perFrameGPU = ring->allocBuffer(sizeof(PerFrame), (void**)&perFrame);
+    auto perFrameGPU = ring->allocConstants(&perFrame);
 
     perFrame->L = lightDir;
     perFrame->Lc = lightColor;
@@ -240,7 +262,7 @@ bool Exercise6::createRootSignature()
     // ------------------------------------------------------------
     // Create root signature object
     // ------------------------------------------------------------
-    hr = app->getD3D12()->getDevice()->CreateRootSignature(
+    hr = app->getPipelineCache()->createRootSignature(
         0,
         signatureBlob->GetBufferPointer(),
         signatureBlob->GetBufferSize(),
@@ -271,11 +293,11 @@ bool Exercise6::createPSO()
     // ------------------------------------------------------------
     // Load compiled shaders (.cso files)
     // ------------------------------------------------------------
-    auto dataVS = DX::ReadData(L"Exercise6VS.cso");
-    auto dataPS = DX::ReadData(L"Exercise6PS.cso");
+    D3D12_SHADER_BYTECODE dataVS = app->getShaderArchive().get(L"Exercise6VS");
+    D3D12_SHADER_BYTECODE dataPS = app->getShaderArchive().get(L"Exercise6PS");
    
 
-    if (dataVS.empty() || dataPS.empty()) {
+    if (dataVS.BytecodeLength == 0 || dataPS.BytecodeLength == 0) {
         Logger::Err("ERROR: VS or PS .cso is empty  check build output and paths");
         return false;
     }
@@ -290,8 +312,8 @@ bool Exercise6::createPSO()
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
     psoDesc.InputLayout = { inputLayout, sizeof(inputLayout) / sizeof(D3D12_INPUT_ELEMENT_DESC) };  // the structure describing our input layout
     psoDesc.pRootSignature = rootSignature.Get();                                                   // the root signature that describes the input data this pso needs
-    psoDesc.VS = { dataVS.data(), dataVS.size() };                                                  // structure describing where to find the vertex shader bytecode and how large it is
-    psoDesc.PS = { dataPS.data(), dataPS.size() };                                                  // same as VS but for pixel shader
+    psoDesc.VS = dataVS;                                                                            // structure describing where to find the vertex shader bytecode and how large it is
+    psoDesc.PS = dataPS;                                                                            // same as VS but for pixel shader
     psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;                         // type of topology we are drawing
     psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;                                             // format of the render target
     psoDesc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
@@ -306,7 +328,7 @@ bool Exercise6::createPSO()
     // ------------------------------------------------------------
     // Create Solid PSO
     // ------------------------------------------------------------
-    HRESULT hr = app->getD3D12()->getDevice()->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pso));
+    HRESULT hr = app->getPipelineCache()->createGraphicsPipeline(&psoDesc, IID_PPV_ARGS(&pso));
 
     if (FAILED(hr))
     {
@@ -319,9 +341,9 @@ bool Exercise6::createPSO()
     // ------------------------------------------------------------
     D3D12_GRAPHICS_PIPELINE_STATE_DESC wireDesc = psoDesc;
 
-    auto wireframePS = DX::ReadData(L"WireframePS.cso");
+    D3D12_SHADER_BYTECODE wireframePS = app->getShaderArchive().get(L"WireframePS");
 
-    wireDesc.PS = { wireframePS.data(), wireframePS.size() };
+    wireDesc.PS = wireframePS;
 
     wireDesc.RasterizerState.FillMode = D3D12_FILL_MODE_WIREFRAME;
     wireDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
@@ -333,7 +355,7 @@ bool Exercise6::createPSO()
     wireDesc.DepthStencilState.DepthWriteMask =
         D3D12_DEPTH_WRITE_MASK_ZERO;
 
-    hr = app->getD3D12()->getDevice()->CreateGraphicsPipelineState(
+    hr = app->getPipelineCache()->createGraphicsPipeline(
         &wireDesc, IID_PPV_ARGS(&psoWireframe));
 
     if (FAILED(hr))
@@ -345,12 +367,12 @@ bool Exercise6::createPSO()
     // ------------------------------------------------------------
     // Create NORMALS PSO
     // ------------------------------------------------------------
-    auto dataNormalsPS = DX::ReadData(L"NormalsPS.cso");
+    D3D12_SHADER_BYTECODE dataNormalsPS = app->getShaderArchive().get(L"NormalsPS");
 
     D3D12_GRAPHICS_PIPELINE_STATE_DESC normalsDesc = psoDesc;
-    normalsDesc.PS = { dataNormalsPS.data(), dataNormalsPS.size() };
+    normalsDesc.PS = dataNormalsPS;
 
-    HRESULT _hr = app->getD3D12()->getDevice()->CreateGraphicsPipelineState(&normalsDesc, IID_PPV_ARGS(&psoNormals));
+    HRESULT _hr = app->getPipelineCache()->createGraphicsPipeline(&normalsDesc, IID_PPV_ARGS(&psoNormals));
 
     if (FAILED(_hr))
     {
@@ -389,7 +411,7 @@ void Exercise6::drawModel(ID3D12GraphicsCommandList* commandList, ShaderDescript
         // Per-instance constants (transform + phong material)
         // ------------------------------------------------------------
         PerInstance* perInstance = nullptr;
-        auto perInstanceGPU = ring->allocBuffer(sizeof(PerInstance), (void**)&perInstance);
+        auto perInstanceGPU = ring->allocConstants(&perInstance);
         perInstance->modelMat = duck->getModelMatrix().Transpose();
         perInstance->normalMat = duck->getModelMatrix().Invert().Transpose();
 
@@ -413,7 +435,7 @@ void Exercise6::drawModel(ID3D12GraphicsCommandList* commandList, ShaderDescript
         D3D12_GPU_DESCRIPTOR_HANDLE texHandle = shaders->getGPUHandle(mat.getColourTexSRV()); // Texture (t0)
         commandList->SetGraphicsRootDescriptorTable(3, texHandle);
 
-        D3D12_GPU_DESCRIPTOR_HANDLE sampHandle = samplers->getGPUHandle(0);  // Sampler (s0)
+        D3D12_GPU_DESCRIPTOR_HANDLE sampHandle = samplers->getGPUHandle(mat.getColourSampler());  // Sampler (s0)
         commandList->SetGraphicsRootDescriptorTable(4, sampHandle);
 
         // ------------------------------------------------------------
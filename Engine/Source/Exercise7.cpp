@@ -2,6 +2,7 @@
 #include "Exercise7.h"
 
 #include "D3D12Module.h"
+#include "PipelineCacheModule.h"
 #include "ResourcesModule.h"
 #include "ShaderDescriptorsModule.h"
 #include "SamplersModule.h"
@@ -11,7 +12,7 @@
 #include "Application.h"
 
 #include <d3d12.h>
-#include "ReadData.h"
+#include "ShaderArchive.h"
 #include <d3dcompiler.h>
 #include "d3dx12.h"
 
@@ -20,6 +21,7 @@
 #include "BasicMaterial.h"
 
 #include "SceneRenderPass.h"
+#include "JobSystem.h"
 
 Exercise7::Exercise7()
 {
@@ -31,21 +33,41 @@ Exercise7::~Exercise7()
 
 bool Exercise7::init()
 {
+    // ------------------------------------------------------------
+    // The model (glTF parse, texture decodes, uploads) loads on a
+    // worker while the root signature and pipeline are created here
+    // ------------------------------------------------------------
     duck = std::make_unique<Model>();
 
-    if (!duck->Load("Assets/Models/Duck/", "Duck.gltf", BasicMaterial::Type::PBR_PHONG))
+    bool modelLoaded = false;
+    JobCounter modelJob;
+    auto loadModel = [this, &modelLoaded]() { modelLoaded = duck->Load("Assets/Models/Duck/", "Duck.gltf", BasicMaterial::Type::PBR_PHONG); };
+
+    JobSystem* jobs = app->getJobSystem();
+    if (jobs && jobs->getWorkerCount() > 0)
+        jobs->run(loadModel, &modelJob);
+    else
+        loadModel();
+
+    const bool rootSignatureOk = createRootSignature();
+    const bool psoOk = rootSignatureOk && createPSO();
+
+    if (jobs)
+        jobs->wait(modelJob);
+
+    if (!modelLoaded)
     {
         Logger::Err("Exercise6: Duck Model not loaded");
         return false;
     }
 
-    if (!createRootSignature())
+    if (!rootSignatureOk)
     {
         Logger::Err("Exercise 6: RootSignature Failed");
         return false;
     }
 
-    if (!createPSO())
+    if (!psoOk)
     {
         Logger::Err("Exercise 6: PSO Failed");
         return false;
@@ -99,7 +121,7 @@ void Exercise7::render()
     // PerFrame constant buffer (Phong lighting)
     // ------------------------------------------------------------
     PerFrame* perFrame = nullptr;
-    auto perFrameGPU = ring->allocBuffer(sizeof(PerFrame), (void**)&perFrame);
+    auto perFrameGPU = ring->allocConstants(&perFrame);
 
     perFrame->L = lightDir;
     perFrame->Lc = lightColor;
@@ -239,7 +261,7 @@ bool Exercise7::createRootSignature()
     // ------------------------------------------------------------
     // Create root signature object
     // ------------------------------------------------------------
-    hr = app->getD3D12()->getDevice()->CreateRootSignature(
+    hr = app->getPipelineCache()->createRootSignature(
         0,
         signatureBlob->GetBufferPointer(),
         signatureBlob->GetBufferSize(),
@@ -270,11 +292,11 @@ bool Exercise7::createPSO()
     // ------------------------------------------------------------
     // Load compiled shaders (.cso files)
     // ------------------------------------------------------------
-    auto dataVS = DX::ReadData(L"Exercise7VS.cso");
-    auto dataPS = DX::ReadData(L"Exercise7PS.cso");
+    D3D12_SHADER_BYTECODE dataVS = app->getShaderArchive().get(L"Exercise7VS");
+    D3D12_SHADER_BYTECODE dataPS = app->getShaderArchive().get(L"Exercise7PS");
 
 
-    if (dataVS.empty() || dataPS.empty()) {
+    if (dataVS.BytecodeLength == 0 || dataPS.BytecodeLength == 0) {
         Logger::Err("ERROR: VS or PS .cso is empty  check build output and paths");
         return false;
     }
@@ -289,8 +311,8 @@ bool Exercise7::createPSO()
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
     psoDesc.InputLayout = { inputLayout, sizeof(inputLayout) / sizeof(D3D12_INPUT_ELEMENT_DESC) };  // the structure describing our input layout
     psoDesc.pRootSignature = rootSignature.Get();                                                   // the root signature that describes the input data this pso needs
-    psoDesc.VS = { dataVS.data(), dataVS.size() };                                                  // structure describing where to find the vertex shader bytecode and how large it is
-    psoDesc.PS = { dataPS.data(), dataPS.size() };                                                  // same as VS but for pixel shader
+    psoDesc.VS = dataVS;                                                                            // structure describing where to find the vertex shader bytecode and how large it is
+    psoDesc.PS = dataPS;                                                                            // same as VS but for pixel shader
     psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;                         // type of topology we are drawing
     psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;                                             // format of the render target
     psoDesc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
@@ -305,7 +327,7 @@ bool Exercise7::createPSO()
     // ------------------------------------------------------------
     // Create Solid PSO
     // ------------------------------------------------------------
-    HRESULT hr = app->getD3D12()->getDevice()->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pso));
+    HRESULT hr = app->getPipelineCache()->createGraphicsPipeline(&psoDesc, IID_PPV_ARGS(&pso));
 
     if (FAILED(hr))
     {
@@ -318,9 +340,9 @@ bool Exercise7::createPSO()
     // ------------------------------------------------------------
     D3D12_GRAPHICS_PIPELINE_STATE_DESC wireDesc = psoDesc;
 
-    auto wireframePS = DX::ReadData(L"WireframePS.cso");
+    D3D12_SHADER_BYTECODE wireframePS = app->getShaderArchive().get(L"WireframePS");
 
-    wireDesc.PS = { wireframePS.data(), wireframePS.size() };
+    wireDesc.PS = wireframePS;
 
     wireDesc.RasterizerState.FillMode = D3D12_FILL_MODE_WIREFRAME;
     wireDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
@@ -332,7 +354,7 @@ bool Exercise7::createPSO()
     wireDesc.DepthStencilState.DepthWriteMask =
         D3D12_DEPTH_WRITE_MASK_ZERO;
 
-    hr = app->getD3D12()->getDevice()->CreateGraphicsPipelineState(
+    hr = app->getPipelineCache()->createGraphicsPipeline(
         &wireDesc, IID_PPV_ARGS(&psoWireframe));
 
     if (FAILED(hr))
@@ -344,12 +366,12 @@ bool Exercise7::createPSO()
     // ------------------------------------------------------------
     // Create NORMALS PSO
     // ------------------------------------------------------------
-    auto dataNormalsPS = DX::ReadData(L"NormalsPS.cso");
+    D3D12_SHADER_BYTECODE dataNormalsPS = app->getShaderArchive().get(L"NormalsPS");
 
     D3D12_GRAPHICS_PIPELINE_STATE_DESC normalsDesc = psoDesc;
-    normalsDesc.PS = { dataNormalsPS.data(), dataNormalsPS.size() };
+    normalsDesc.PS = dataNormalsPS;
 
-    HRESULT _hr = app->getD3D12()->getDevice()->CreateGraphicsPipelineState(&normalsDesc, IID_PPV_ARGS(&psoNormals));
+    HRESULT _hr = app->getPipelineCache()->createGraphicsPipeline(&normalsDesc, IID_PPV_ARGS(&psoNormals));
 
     if (FAILED(_hr))
     {
@@ -367,6 +389,9 @@ void Exercise7::drawModel(ID3D12GraphicsCommandList* commandList, ShaderDescript
     const SimpleMath::Matrix modelMat = duck->getModelMatrix();
     const SimpleMath::Matrix normalMat = modelMat.Invert().Transpose();
 
+    // One reservation for the constants of every mesh
+    RingBufferModule::ConstantBatch<PerInstance> perInstances = ring->allocConstantBatch<PerInstance>(duck->getMeshCount());
+
     for (size_t i = 0; i < duck->getMeshCount(); ++i)
     {
         // ------------------------------------------------------------
@@ -387,8 +412,8 @@ void Exercise7::drawModel(ID3D12GraphicsCommandList* commandList, ShaderDescript
         // ------------------------------------------------------------
         // Per-instance constants (transform + phong material)
         // ------------------------------------------------------------
-        PerInstance* perInstance = nullptr;
-        auto perInstanceGPU = ring->allocBuffer(sizeof(PerInstance), (void**)&perInstance);
+        PerInstance* perInstance = perInstances[i];
+        auto perInstanceGPU = perInstances.address(i);
         perInstance->modelMat = duck->getModelMatrix().Transpose();
         perInstance->normalMat = duck->getModelMatrix().Invert().Transpose();
 
@@ -423,7 +448,7 @@ void Exercise7::drawModel(ID3D12GraphicsCommandList* commandList, ShaderDescript
         D3D12_GPU_DESCRIPTOR_HANDLE texHandle = shaders->getGPUHandle(mat.getColourTexSRV()); // Texture (t0)
         commandList->SetGraphicsRootDescriptorTable(3, texHandle);
 
-        D3D12_GPU_DESCRIPTOR_HANDLE sampHandle = samplers->getGPUHandle(0);  // Sampler (s0)
+        D3D12_GPU_DESCRIPTOR_HANDLE sampHandle = samplers->getGPUHandle(mat.getColourSampler());  // Sampler (s0)
         commandList->SetGraphicsRootDescriptorTable(4, sampHandle);
 
         // ------------------------------------------------------------
@@ -2,6 +2,7 @@
 #include "Exercise8.h"
 
 #include "D3D12Module.h"
+#include "PipelineCacheModule.h"
 #include "ResourcesModule.h"
 #include "ShaderDescriptorsModule.h"
 #include "SamplersModule.h"
@@ -11,7 +12,7 @@
 #include "Application.h"
 
 #include <d3d12.h>
-#include "ReadData.h"
+#include "ShaderArchive.h"
 #include <d3dcompiler.h>
 #include "d3dx12.h"
 
@@ -20,6 +21,9 @@
 #include "BasicMaterial.h"
 
 #include "SceneRenderPass.h"
+#include "JobSystem.h"
+
+#include <algorithm>
 
 Exercise8::Exercise8()
 {
@@ -31,27 +35,58 @@ Exercise8::~Exercise8()
 
 bool Exercise8::init()
 {
-    duck = std::make_unique<Model>();
-
     qRot = SimpleMath::Quaternion::CreateFromYawPitchRoll(
             XMConvertToRadians(rotationY), // yaw   (Y)
             XMConvertToRadians(rotationX), // pitch (X)
             XMConvertToRadians(rotationZ)  // roll  (Z)
         );
 
-    if (!duck->Load("Assets/Models/DamagedHelmet/", "damagedHelmet.gltf", BasicMaterial::Type::PBR_PHONG))
+    // ------------------------------------------------------------
+    // The model (glTF parse, texture decodes, uploads) loads on a
+    // worker while the root signature and pipeline are created here
+    // ------------------------------------------------------------
+    duck = std::make_unique<Model>();
+
+    bool modelLoaded = false;
+    JobCounter modelJob;
+    auto loadModel = [this, &modelLoaded]() { modelLoaded = duck->Load("Assets/Models/DamagedHelmet/", "damagedHelmet.gltf", BasicMaterial::Type::PBR_PHONG); };
+
+    JobSystem* jobs = app->getJobSystem();
+    if (jobs && jobs->getWorkerCount() > 0)
+        jobs->run(loadModel, &modelJob);
+    else
+        loadModel();
+
+    // Bindless textures: an unbounded SRV table needs resource binding tier 2
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+    app->getD3D12()->getDevice()->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options));
+    const bool bindlessOk = options.ResourceBindingTier >= D3D12_RESOURCE_BINDING_TIER_2;
+
+    const bool rootSignatureOk = bindlessOk && createRootSignature();
+    const bool psoOk = rootSignatureOk && createPSO();
+
+    if (jobs)
+        jobs->wait(modelJob);
+
+    if (!modelLoaded)
     {
         Logger::Err("Exercise8: Duck Model not loaded");
         return false;
     }
 
-    if (!createRootSignature())
+    if (!bindlessOk)
+    {
+        Logger::Err("Exercise 8: bindless materials need resource binding tier 2");
+        return false;
+    }
+
+    if (!rootSignatureOk)
     {
         Logger::Err("Exercise 8: RootSignature Failed");
         return false;
     }
 
-    if (!createPSO())
+    if (!psoOk)
     {
         Logger::Err("Exercise 8: PSO Failed");
         return false;
@@ -67,6 +102,7 @@ void Exercise8::render()
     // ------------------------------------------------------------
     D3D12Module* d3d12 = app->getD3D12();
     ID3D12GraphicsCommandList* commandList = d3d12->getCommandList();
+    FilteredCommandList& cmd = d3d12->getFilteredCommandList();     // state calls: repeated bindings are dropped
     CameraModule* camera = app->getCamera();
     RingBufferModule* ring = app->getRingBuffer();
     ShaderDescriptorsModule* shaders = app->getShaderDescriptors();
@@ -77,19 +113,59 @@ void Exercise8::render()
     // ----------------------------------------------------------------
     ExerciseMenu(camera);
 
+    // ------------------------------------------------------------
+    // Material table and lights: only what changed since last frame goes up
+    // (before the pass, copies don't mix with the draws)
+    // ------------------------------------------------------------
+    updateMaterialTable();
+    materialTable.upload(commandList, ring);
+
+    updateLights();
+    lights.upload(commandList, ring);
+
     // ------------------------------------------------------------
     // Scene render pass (Viewport or Backbuffer)
     // ------------------------------------------------------------
     SceneRenderPass pass = GetSceneRenderPass(app);
 
+    // ------------------------------------------------------------
+    // Clustered light lists (CPU, one job per depth slice, needs the pass aspect)
+    // ------------------------------------------------------------
+    D3D12_GPU_VIRTUAL_ADDRESS clusterGridGPU = 0, clusterIndicesGPU = 0;
+    if (lightingPath == LightingPath::Clustered)
+    {
+        LightClusterBuilder::View clusterView;
+        clusterView.view = camera->getView();
+        clusterView.fovY = camera->GetFov();
+        clusterView.aspect = pass.aspect;
+        clusterView.nearZ = camera->GetNearPlane();
+        clusterView.farZ = camera->GetFarPlane();
+
+        clusterBuilder.build(clusterView, lights, app->getJobSystem());
+
+        if (validateClusters)
+        {
+            clusterReference.settings = clusterBuilder.settings;
+            clusterReference.buildReference(clusterView, lights);
+            clusterMismatches = clusterReference.compare(clusterBuilder);
+        }
+
+        clusterBuilder.upload(ring, &clusterGridGPU, &clusterIndicesGPU);
+    }
+    else
+    {
+        // The other paths never read the clusters: placeholders keep the root SRVs valid
+        LightClusterBuilder::uploadEmpty(ring, &clusterGridGPU, &clusterIndicesGPU);
+    }
+
     const float clearColor[] = { 0.2f, 0.2f, 0.2f, 1.0f };
     pass.begin(commandList, clearColor);
 
     // ------------------------------------------------------------
     // Pipeline state
     // ------------------------------------------------------------
-    commandList->SetGraphicsRootSignature(rootSignature.Get()); // The root signature defines how resources are passed to shaders
-    commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST); // Set primitive type (triangles)
+    cmd.SetGraphicsRootSignature(rootSignature.Get()); // The root signature defines how resources are passed to shaders
+    cmd.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST); // Set primitive type (triangles)
 
     // ------------------------------------------------------------
     // Descriptor heaps
@@ -99,71 +175,51 @@ void Exercise8::render()
         shaders->getHeap(),     // t0: texture
         samplers->getHeap()     // s0: sampler
     };
-    commandList->SetDescriptorHeaps(2, heaps);  // 2 heaps
+    cmd.SetDescriptorHeaps(2, heaps);  // 2 heaps
+
+    // Every material and texture of the pass: bound once, indexed per draw
+    cmd.SetGraphicsRootShaderResourceView(8, materialTable.getGPUAddress());
+    cmd.SetGraphicsRootDescriptorTable(9, shaders->getBindlessTable());
 
     // ------------------------------------------------------------
     // PerFrame constant buffer (Phong lighting)
     // ------------------------------------------------------------
     PerFrame* perFrame = nullptr;
-    auto perFrameGPU = ring->allocBuffer(sizeof(PerFrame), (void**)&perFrame);
+    auto perFrameGPU = ring->allocConstants(&perFrame);
 
     perFrame->Ac = ambient;
     perFrame->viewPos = camera->getPos();
 
-    perFrame->NumDirLights = 1;
-    perFrame->NumPointLights = 1;
-    perFrame->NumSpotLights = 1;
-
-    commandList->SetGraphicsRootConstantBufferView(2, perFrameGPU);
-
-    // Directional
-    DirectionalLightGPU dirLights[1] = {};
-    dirLights[0].direction = XMFLOAT3(lightDir.x, lightDir.y, lightDir.z);
-    dirLights[0].color = XMFLOAT3(lightColor.x, lightColor.y, lightColor.z);
-    dirLights[0].intensity = 1.0f;
-
-    // Point
-    PointLightGPU pointLights[1] = {};
-    pointLights[0].position = XMFLOAT3(pointPosition.x, pointPosition.y, pointPosition.z);
-    pointLights[0].color = XMFLOAT3(pointColor.x, pointColor.y, pointColor.z);
-    pointLights[0].intensity = pointIntensity;
-    pointLights[0].radius = pointRange;
-
-
-    // Spot
-    spotDirection.Normalize();
-    if (spotOuterAngleDeg < spotInnerAngleDeg) spotOuterAngleDeg = spotInnerAngleDeg;
-
-    float innerRad = XMConvertToRadians(spotInnerAngleDeg);
-    float outerRad = XMConvertToRadians(spotOuterAngleDeg);
-
-    SpotLightGPU spotLights[1] = {};
-    spotLights[0].position = XMFLOAT3(spotPosition.x, spotPosition.y, spotPosition.z);
-    spotLights[0].direction = XMFLOAT3(spotDirection.x, spotDirection.y, spotDirection.z);
-    spotLights[0].color = XMFLOAT3(spotColor.x, spotColor.y, spotColor.z);
-    spotLights[0].intensity = spotIntensity;
-    spotLights[0].radius = spotRange;
-    spotLights[0].cosInnerAngle = cosf(innerRad);
-    spotLights[0].cosOuterAngle = cosf(outerRad);
-
-    // Upload DirLights
-    DirectionalLightGPU* dirCPU = nullptr;
-    auto dirGPU = ring->allocBuffer(sizeof(dirLights), (void**)&dirCPU);
-    memcpy(dirCPU, dirLights, sizeof(dirLights));
-
-    // Upload PointLights
-    PointLightGPU* pointCPU = nullptr;
-    auto pointGPU = ring->allocBuffer(sizeof(pointLights), (void**)&pointCPU);
-    memcpy(pointCPU, pointLights, sizeof(pointLights));
-
-    // Upload SpotLights
-    SpotLightGPU* spotCPU = nullptr;
-    auto spotGPU = ring->allocBuffer(sizeof(spotLights), (void**)&spotCPU);
-    memcpy(spotCPU, spotLights, sizeof(spotLights));
-
-    commandList->SetGraphicsRootShaderResourceView(3, dirGPU);
-    commandList->SetGraphicsRootShaderResourceView(4, pointGPU);
-    commandList->SetGraphicsRootShaderResourceView(5, spotGPU);
+    perFrame->NumDirLights = lights.getCount(LightManager::DIRECTIONAL);
+    perFrame->NumPointLights = lights.getCount(LightManager::POINT);
+    perFrame->NumSpotLights = lights.getCount(LightManager::SPOT);
+
+    // Cluster lookup: slice from the view depth, tile from SV_Position
+    const LightClusterBuilder::Settings& grid = clusterBuilder.getBuiltSettings();
+    const SimpleMath::Matrix& view = camera->getView();
+    perFrame->LightingMode = uint32_t(lightingPath);
+    perFrame->ToneMapping = useToneMapping ? 1 : 0;
+    perFrame->ViewForward = SimpleMath::Vector3(-view._13, -view._23, -view._33);
+    perFrame->ClusterDepthScale = clusterBuilder.getDepthScale();
+    perFrame->ClusterDepthBias = clusterBuilder.getDepthBias();
+    perFrame->ClusterDims[0] = grid.dimX;
+    perFrame->ClusterDims[1] = grid.dimY;
+    perFrame->ClusterDims[2] = grid.dimZ;
+    perFrame->ClusterTileScale[0] = float(grid.dimX) / float(std::max(pass.width, 1u));
+    perFrame->ClusterTileScale[1] = float(grid.dimY) / float(std::max(pass.height, 1u));
+
+    cmd.SetGraphicsRootConstantBufferView(2, perFrameGPU);
+
+    // Persistent light buffers (uploaded above, only what changed)
+    const D3D12_GPU_VIRTUAL_ADDRESS dirGPU = lights.getGPUAddress(LightManager::DIRECTIONAL);
+    const D3D12_GPU_VIRTUAL_ADDRESS pointGPU = lights.getGPUAddress(LightManager::POINT);
+    const D3D12_GPU_VIRTUAL_ADDRESS spotGPU = lights.getGPUAddress(LightManager::SPOT);
+
+    cmd.SetGraphicsRootShaderResourceView(3, dirGPU);
+    cmd.SetGraphicsRootShaderResourceView(4, pointGPU);
+    cmd.SetGraphicsRootShaderResourceView(5, spotGPU);
+    cmd.SetGraphicsRootShaderResourceView(10, clusterGridGPU);
+    cmd.SetGraphicsRootShaderResourceView(11, clusterIndicesGPU);
 
     // ----------------------------------------------------------------
     // Model-View-Projection Matrix
@@ -179,9 +235,17 @@ void Exercise8::render()
         ApplyImGuizmo(camera);
 
     auto proj = camera->GetProjection(pass.aspect);
-    mvpMatrix = (duck->getModelMatrix() * camera->getView() * proj).Transpose();
+    viewProjMatrix = (camera->getView() * proj).Transpose();
+
+    // ------------------------------------------------------------
+    // Mouse picking (click in the viewport, gizmo has priority)
+    // ------------------------------------------------------------
+    ViewportModule* viewport = app->getViewport();
+    if (viewport && viewport->wasClicked() && !(isGizmoVisible && (ImGuizmo::IsOver() || ImGuizmo::IsUsing())))
+        pickInstance(viewport->getMouseRay(camera->getView(), proj));
 
-    commandList->SetGraphicsRoot32BitConstants(0, sizeof(Matrix) / sizeof(UINT32), &mvpMatrix, 0);
+    // The model transform now travels per instance (t4), only ViewProj stays in root constants
+    cmd.SetGraphicsRoot32BitConstants(0, sizeof(Matrix) / sizeof(UINT32), &viewProjMatrix, 0);
 
     // ------------------------------------------------------------
     // DEBUG DRAWS
@@ -252,6 +316,12 @@ void Exercise8::render()
 
     }
 
+    if (selectedInstance >= 0 && selectedInstance < getInstanceCount())
+    {
+        BoundingBox3 box = getInstanceBounds(selectedInstance);
+        dd::aabb(ddConvert(box.min), ddConvert(box.max), dd::colors::Orange);
+    }
+
     if (isGridVisible) { dd::xzSquareGrid(-10.0f, 10.0f, 0.0f, 1.0f, dd::colors::LightGray); }
     if (isAxisVisible) { dd::axisTriad(ddConvert(SimpleMath::Matrix::Identity), 0.1f, 1.0f); }
 
@@ -260,26 +330,62 @@ void Exercise8::render()
     // ------------------------------------------------------------
     if (isGeoVisible)
     {
+        // LOD / detail-cull decision for every grid instance, consumed by queueModel()
+        selectInstanceLods(camera, float(pass.height));
+
+        if (lightingPath == LightingPath::PerObject)
+            assignInstanceLights();
+
+        // Every sampler, indexed from the material record
+        cmd.SetGraphicsRootDescriptorTable(7, samplers->getGPUHandle(0));
+
+        batcher.begin(sizeof(PerInstance));
+
         // ---------- Base pass ----------
         if (!isWireframe)
         {
-            if (isNormalsVisible)
-            {
-                commandList->SetPipelineState(psoNormals.Get());
-                drawModel(commandList, shaders, samplers);
-            }
-            else
-            {
-                commandList->SetPipelineState(pso.Get());
-                drawModel(commandList, shaders, samplers);
-            }
+            queueModel(0, isNormalsVisible ? PassState::Normals : PassState::Solid, camera->getView());
         }
 
         // ---------- Wireframe pass ----------
         if (isWireframe || isWireframeOverlay)
         {
-            commandList->SetPipelineState(psoWireframe.Get());
-            drawModel(commandList, shaders, samplers);
+            queueModel(1, PassState::Wireframe, camera->getView());
+        }
+
+        // ---------- Per-list state for parallel recording (nothing carries over between lists) ----------
+        auto setupList = [&](FilteredCommandList& list)
+            {
+                pass.bind(list.get());
+                list.SetGraphicsRootSignature(rootSignature.Get());
+                list.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+                list.SetDescriptorHeaps(2, heaps);
+                list.SetGraphicsRoot32BitConstants(0, sizeof(Matrix) / sizeof(UINT32), &viewProjMatrix, 0);
+                list.SetGraphicsRootConstantBufferView(2, perFrameGPU);
+                list.SetGraphicsRootShaderResourceView(3, dirGPU);
+                list.SetGraphicsRootShaderResourceView(4, pointGPU);
+                list.SetGraphicsRootShaderResourceView(5, spotGPU);
+                list.SetGraphicsRootShaderResourceView(10, clusterGridGPU);
+                list.SetGraphicsRootShaderResourceView(11, clusterIndicesGPU);
+                list.SetGraphicsRootDescriptorTable(7, samplers->getGPUHandle(0));
+                list.SetGraphicsRootShaderResourceView(8, materialTable.getGPUAddress());
+                list.SetGraphicsRootDescriptorTable(9, shaders->getBindlessTable());
+            };
+
+        // ---------- Sort + one instanced draw per (PSO, mesh, material) ----------
+        // A material change is one root constant: the index into the material table
+        const BasicMaterial* firstMaterial = duck->getMaterials().data();
+        batcher.flush(cmd, app->getRingBuffer(), 1, [firstMaterial](FilteredCommandList& list, const BasicMaterial* mat)
+            {
+                const uint32_t materialIndex = uint32_t(mat - firstMaterial);
+                list.SetGraphicsRoot32BitConstants(6, 1, &materialIndex, 0); // MaterialIndex (b3)
+            }, useParallelRecording ? InstanceBatcher::SetupListFn(setupList) : nullptr);
+
+        // Parallel lists were spliced in: continue on the new list with the targets bound again
+        if (batcher.getRecordedLists() > 0)
+        {
+            commandList = d3d12->getCommandList();
+            pass.bind(commandList);
         }
     }
 
@@ -287,6 +393,7 @@ void Exercise8::render()
     // Debug pass (last)
     // ------------------------------------------------------------
     app->getDebugDrawPass()->record(commandList, pass.width, pass.height, camera->getView(), proj);
+    cmd.invalidate();   // debug draw binds its own state through the raw list
 
     pass.end(commandList);
 }
@@ -294,19 +401,20 @@ void Exercise8::render()
 
 bool Exercise8::createRootSignature()
 {
-    CD3DX12_ROOT_PARAMETER rootParameters[8];
-    CD3DX12_DESCRIPTOR_RANGE srvRange;
+    CD3DX12_ROOT_PARAMETER rootParameters[12];
+    CD3DX12_DESCRIPTOR_RANGE bindlessRange;
     CD3DX12_DESCRIPTOR_RANGE sampRange;
 
     // ------------------------------------------------------------  
-    // [0] MVP constants b0
+    // [0] ViewProj constants b0
     // ------------------------------------------------------------
     rootParameters[0].InitAsConstants(16, 0, 0, D3D12_SHADER_VISIBILITY_VERTEX);
 
     // ------------------------------------------------------------
-    // [1] PerInstance CBV (b1) - VS + PS
+    // [1] Instance StructuredBuffer root SRV (t4) - VS + PS
+    //     Indexed with SV_InstanceID, re-pointed per instanced draw
     // ------------------------------------------------------------
-    rootParameters[1].InitAsConstantBufferView(1, 0, D3D12_SHADER_VISIBILITY_ALL);
+    rootParameters[1].InitAsShaderResourceView(4, 0, D3D12_SHADER_VISIBILITY_ALL);
 
     // ------------------------------------------------------------
     // [2] PerFrame CBV (b2) - PS
@@ -323,17 +431,37 @@ bool Exercise8::createRootSignature()
     rootParameters[5].InitAsShaderResourceView(2, 0, D3D12_SHADER_VISIBILITY_PIXEL);
 
     // ------------------------------------------------------------
-    // [6]  SRV texture table (t3) - PS
+    // [6] Material index root constant (b3) - PS
+    //     The only per-draw material state
     // ------------------------------------------------------------
-    srvRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 3);
-    rootParameters[6].InitAsDescriptorTable(1, &srvRange, D3D12_SHADER_VISIBILITY_PIXEL);
+    rootParameters[6].InitAsConstants(1, 3, 0, D3D12_SHADER_VISIBILITY_PIXEL);
 
     // ------------------------------------------------------------
-    // [4] Sampler Table (s0) - PS
+    // [7] Bindless samplers (s0, space1) - PS
+    //     The whole sampler heap, indexed from the material record
     // ------------------------------------------------------------
-    sampRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER, 1, 0);
+    sampRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER, UINT_MAX, 0, 1, 0);
     rootParameters[7].InitAsDescriptorTable(1, &sampRange, D3D12_SHADER_VISIBILITY_PIXEL);
 
+    // [8] Material table root SRV (t5) - PS
+    rootParameters[8].InitAsShaderResourceView(5, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+
+    // ------------------------------------------------------------
+    // [9] Bindless textures (t0, space1) - PS
+    //     Unbounded table over the whole shader-visible heap: a
+    //     texture index is its descriptor slot
+    // ------------------------------------------------------------
+    bindlessRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, UINT_MAX, 0, 1, 0);
+    rootParameters[9].InitAsDescriptorTable(1, &bindlessRange, D3D12_SHADER_VISIBILITY_PIXEL);
+
+    // ------------------------------------------------------------
+    // [10] Cluster grid root SRV (t6) - PS
+    // [11] Cluster light indices root SRV (t7) - PS
+    //     Rebuilt on the CPU every frame (LightClusterBuilder)
+    // ------------------------------------------------------------
+    rootParameters[10].InitAsShaderResourceView(6, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+    rootParameters[11].InitAsShaderResourceView(7, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+
     // ------------------------------------------------------------
     // Create and serialize root signature
     // ------------------------------------------------------------
@@ -358,7 +486,7 @@ bool Exercise8::createRootSignature()
     // ------------------------------------------------------------
     // Create root signature object
     // ------------------------------------------------------------
-    hr = app->getD3D12()->getDevice()->CreateRootSignature(
+    hr = app->getPipelineCache()->createRootSignature(
         0,
         signatureBlob->GetBufferPointer(),
         signatureBlob->GetBufferSize(),
@@ -376,6 +504,56 @@ bool Exercise8::createRootSignature()
 
 bool Exercise8::createPSO()
 {
+    // ------------------------------------------------------------
+    // Shaders shared by every pipeline (the PS permutations load on demand)
+    // ------------------------------------------------------------
+    ShaderArchive& shaders = app->getShaderArchive();
+    vsBytecode = shaders.get(L"Exercise8VS");
+    wireframePSBytecode = shaders.get(L"WireframePS");
+    normalsPSBytecode = shaders.get(L"NormalsPS");
+
+    if (vsBytecode.BytecodeLength == 0 || wireframePSBytecode.BytecodeLength == 0 || normalsPSBytecode.BytecodeLength == 0)
+    {
+        Logger::Err("Exercise8: missing .cso, check build output and paths");
+        return false;
+    }
+
+    // ------------------------------------------------------------
+    // The pipeline of the default settings, so a broken shader fails init
+    // ------------------------------------------------------------
+    const uint32_t permutation = PS_COLOUR_TEXTURE | (useToneMapping ? PS_TONE_MAPPING : 0) |
+        (uint32_t(lightingPath) << PS_LIGHTING_PATH_SHIFT);
+
+    if (!getPipeline(PassState::Solid, permutation))
+        return false;
+
+    Logger::Log("Exercise8: VS Data & PS Data: OK!");
+    return true;
+}
+
+uint32_t Exercise8::getPermutation(const BasicMaterial& mat) const
+{
+    uint32_t key = uint32_t(lightingPath) << PS_LIGHTING_PATH_SHIFT;
+
+    if (isTextureVisible && mat.getPBRPhongMaterial().hasDiffuseTex)
+        key |= PS_COLOUR_TEXTURE;
+
+    if (useToneMapping)
+        key |= PS_TONE_MAPPING;
+
+    return key;
+}
+
+ID3D12PipelineState* Exercise8::getPipeline(PassState pass, uint32_t permutation)
+{
+    // Wireframe / normals have their own pixel shaders: the material features don't apply
+    const uint32_t resolved = pass == PassState::Solid ? psPermutations.resolve(permutation) : 0;
+    const uint64_t key = (uint64_t(resolved) << 32) | uint32_t(pass);
+
+    auto it = pipelines.find(key);
+    if (it != pipelines.end())
+        return it->second.Get();
+
     // ------------------------------------------------------------
     // Input Layout: POSITION (vec3) + TEXCOORD (vec2)
     // ------------------------------------------------------------
@@ -386,30 +564,13 @@ bool Exercise8::createPSO()
 
     };
 
-    // ------------------------------------------------------------
-    // Load compiled shaders (.cso files)
-    // ------------------------------------------------------------
-    auto dataVS = DX::ReadData(L"Exercise8VS.cso");
-    auto dataPS = DX::ReadData(L"Exercise8PS.cso");
-
-
-    if (dataVS.empty() || dataPS.empty()) {
-        Logger::Err("ERROR: VS or PS .cso is empty  check build output and paths");
-        return false;
-    }
-    else
-    {
-        Logger::Log("Exercise8: VS Data & PS Data: OK!");
-    }
-
     // ------------------------------------------------------------
     // Pipeline State Object configuration
     // ------------------------------------------------------------
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
     psoDesc.InputLayout = { inputLayout, sizeof(inputLayout) / sizeof(D3D12_INPUT_ELEMENT_DESC) };  // the structure describing our input layout
     psoDesc.pRootSignature = rootSignature.Get();                                                   // the root signature that describes the input data this pso needs
-    psoDesc.VS = { dataVS.data(), dataVS.size() };                                                  // structure describing where to find the vertex shader bytecode and how large it is
-    psoDesc.PS = { dataPS.data(), dataPS.size() };                                                  // same as VS but for pixel shader
+    psoDesc.VS = vsBytecode;                                                                        // structure describing where to find the vertex shader bytecode and how large it is
     psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;                         // type of topology we are drawing
     psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;                                             // format of the render target
     psoDesc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
@@ -421,143 +582,402 @@ bool Exercise8::createPSO()
     psoDesc.NumRenderTargets = 1;                                                                   // we are only binding one render target
     psoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
 
+    switch (pass)
+    {
+    case PassState::Solid:
+        // PS permutation (the uber shader when the variant was not built)
+        psoDesc.PS = psPermutations.get(resolved);
+        break;
+
+    case PassState::Wireframe:
+        // Overlay-ready: no culling, biased towards the camera, no depth writes
+        psoDesc.PS = wireframePSBytecode;
+        psoDesc.RasterizerState.FillMode = D3D12_FILL_MODE_WIREFRAME;
+        psoDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+        psoDesc.RasterizerState.DepthBias = 500;
+        psoDesc.RasterizerState.SlopeScaledDepthBias = -4.0f;
+        psoDesc.RasterizerState.DepthBiasClamp = 0.0f;
+        psoDesc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO;
+        break;
+
+    case PassState::Normals:
+        psoDesc.PS = normalsPSBytecode;
+        break;
+    }
+
+    PipelineCacheModule* cache = app->getPipelineCache();
+    ComPtr<ID3D12PipelineState> pipeline;
+
     // ------------------------------------------------------------
-    // Create Solid PSO
+    // Permutations compile on the workers; until they are ready the
+    // uber pipeline (created synchronously) draws in their place
     // ------------------------------------------------------------
-    HRESULT hr = app->getD3D12()->getDevice()->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pso));
+    if (asyncPipelines && pass == PassState::Solid && resolved != ShaderPermutations::UBER_KEY && psoDesc.PS.BytecodeLength > 0)
+    {
+        switch (cache->requestGraphicsPipeline(psoDesc, pipeline))
+        {
+        case PipelineCacheModule::Status::Pending:
+            return getPipeline(pass, ShaderPermutations::UBER_KEY);
 
-    if (FAILED(hr))
+        case PipelineCacheModule::Status::Failed:
+            // Kept: the uber shader answers for this key from now on
+            Logger::Err("Exercise8: failed to create PSO permutation " + std::to_string(resolved) + ", using the uber shader");
+            pipeline = getPipeline(pass, ShaderPermutations::UBER_KEY);
+            break;
+
+        case PipelineCacheModule::Status::Ready:
+            break;
+        }
+    }
+    else if (psoDesc.PS.BytecodeLength == 0 || FAILED(cache->createGraphicsPipeline(&psoDesc, IID_PPV_ARGS(&pipeline))))
     {
-        Logger::Err("Failed to create solid PSO");
-        return false;
+        Logger::Err("Exercise8: failed to create PSO (pass " + std::to_string(uint32_t(pass)) +
+            ", permutation " + std::to_string(resolved) + ")");
+        return nullptr;
     }
 
+    // Failures of the synchronous path are not cached: nothing to draw with, retried next time
+    if (pipeline)
+        pipelines[key] = pipeline;
+    return pipeline.Get();
+}
+
+void Exercise8::queueModel(uint32_t renderPass, PassState pass, const SimpleMath::Matrix& view)
+{
+    const SimpleMath::Matrix baseMat = duck->getModelMatrix();
+    const float invFar = 1.0f / std::max(app->getCamera()->GetFarPlane(), 0.001f);
+
+    // ------------------------------------------------------------
+    // Instance grid (centered on the model transform)
+    // ------------------------------------------------------------
+    const int gridSize = std::max(instanceGridSize, 1);
+    const float halfExtent = 0.5f * float(gridSize - 1) * instanceSpacing;
+
     // ------------------------------------------------------------
-    // Create WIREFRAME PSO (overlay-ready)
+    // Pipeline per mesh, specialized on its material's features
+    // (created the first time a combination shows up)
     // ------------------------------------------------------------
-    D3D12_GRAPHICS_PIPELINE_STATE_DESC wireDesc = psoDesc;
+    std::vector<ID3D12PipelineState*> meshPipelines(duck->getMeshCount());
+    for (size_t i = 0; i < duck->getMeshCount(); ++i)
+        meshPipelines[i] = getPipeline(pass, getPermutation(duck->getMaterialForMesh(i)));
 
-    auto wireframePS = DX::ReadData(L"WireframePS.cso");
+    for (int z = 0; z < gridSize; ++z)
+    {
+        for (int x = 0; x < gridSize; ++x)
+        {
+            // The duck only ships LOD 0, so the selector output is "draw" or "culled"
+            if (lodSelector.getLod(size_t(z) * gridSize + x) == LodSelector::LOD_CULLED)
+                continue;
 
-    wireDesc.PS = { wireframePS.data(), wireframePS.size() };
+            const SimpleMath::Matrix modelMat = baseMat *
+                SimpleMath::Matrix::CreateTranslation(float(x) * instanceSpacing - halfExtent, 0.0f, float(z) * instanceSpacing - halfExtent);
 
-    wireDesc.RasterizerState.FillMode = D3D12_FILL_MODE_WIREFRAME;
-    wireDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+            const SimpleMath::Matrix modelT = modelMat.Transpose();
+            const SimpleMath::Matrix normalMat = modelMat.Invert();
 
-    wireDesc.RasterizerState.DepthBias = 500;
-    wireDesc.RasterizerState.SlopeScaledDepthBias = -4.0f;
-    wireDesc.RasterizerState.DepthBiasClamp = 0.0f;
+            // View depth of the instance origin (right-handed view: -Z is forward)
+            const float depth01 = -SimpleMath::Vector3::Transform(modelMat.Translation(), view).z * invFar;
 
-    wireDesc.DepthStencilState.DepthWriteMask =
-        D3D12_DEPTH_WRITE_MASK_ZERO;
+            for (size_t i = 0; i < duck->getMeshCount(); ++i)
+            {
+                const Mesh& mesh = duck->getMesh(i);
+                const BasicMaterial& mat = duck->getMaterialForMesh(i);
+
+                ID3D12PipelineState* pipeline = meshPipelines[i];
+                if (!pipeline)
+                    continue;
+
+                // ------------------------------------------------------------
+                // Per-instance record (transform only, the material is in the table)
+                // ------------------------------------------------------------
+                PerInstance* perInstance = batcher.add<PerInstance>(renderPass, pipeline, &mesh, &mat, depth01);
+
+                perInstance->modelMat = modelT;
+                perInstance->normalMat = normalMat;
+                perInstance->lights = lightingPath == LightingPath::PerObject ?
+                    objectLights.getLights(size_t(z) * gridSize + x) : ObjectLightAssigner::ObjectLights{};
+            }
+        }
+    }
+}
 
-    hr = app->getD3D12()->getDevice()->CreateGraphicsPipelineState(
-        &wireDesc, IID_PPV_ARGS(&psoWireframe));
+void Exercise8::updateMaterialTable()
+{
+    ShaderDescriptorsModule* shaders = app->getShaderDescriptors();
+    const std::vector<BasicMaterial>& materials = duck->getMaterials();
 
-    if (FAILED(hr))
+    for (size_t i = 0; i < materials.size(); ++i)
     {
-        Logger::Err("Exercise6: Failed to create wireframe PSO");
-        return false;
+        const BasicMaterial& mat = materials[i];
+
+        MaterialRecord record;
+        record.phong = mat.getPBRPhongMaterial();
+
+        // ImGui overrides (PBR-friendly)
+        record.phong.diffuseColour = XMFLOAT3(
+            pbrPhongDiffuseColor.x,
+            pbrPhongDiffuseColor.y,
+            pbrPhongDiffuseColor.z
+        );
+
+        record.phong.specularColour = XMFLOAT3(
+            pbrPhongSpecularColor.x,
+            pbrPhongSpecularColor.y,
+            pbrPhongSpecularColor.z
+        );
+
+        record.phong.hasDiffuseTex = isTextureVisible && mat.getPBRPhongMaterial().hasDiffuseTex;
+        record.phong.shininess = pbrPhongShininess;
+
+        // Slots in the bindless ranges (the null SRV without texture)
+        record.colourTexture = shaders->getIndex(mat.getColourTexSRV());
+        record.colourSampler = mat.getColourSampler();
+
+        // Unchanged records are not uploaded again
+        if (i < materialTable.getCount())
+            materialTable.set(uint32_t(i), record);
+        else
+            materialTable.add(record);
     }
+}
 
+void Exercise8::updateLights()
+{
     // ------------------------------------------------------------
-    // Create NORMALS PSO
+    // Editor lights: set() only dirties them when a value changed
     // ------------------------------------------------------------
-    auto dataNormalsPS = DX::ReadData(L"NormalsPS.cso");
+    spotDirection.Normalize();
+    if (spotOuterAngleDeg < spotInnerAngleDeg) spotOuterAngleDeg = spotInnerAngleDeg;
 
-    D3D12_GRAPHICS_PIPELINE_STATE_DESC normalsDesc = psoDesc;
-    normalsDesc.PS = { dataNormalsPS.data(), dataNormalsPS.size() };
+    LightManager::DirectionalLight dir;
+    dir.direction = lightDir;
+    dir.color = lightColor;
+    dir.intensity = 1.0f;
+
+    LightManager::PointLight point;
+    point.position = pointPosition;
+    point.color = pointColor;
+    point.intensity = pointIntensity;
+    point.radius = pointRange;
+
+    LightManager::SpotLight spot;
+    spot.position = spotPosition;
+    spot.direction = spotDirection;
+    spot.color = spotColor;
+    spot.intensity = spotIntensity;
+    spot.radius = spotRange;
+    spot.innerAngle = XMConvertToRadians(spotInnerAngleDeg);
+    spot.outerAngle = XMConvertToRadians(spotOuterAngleDeg);
+
+    if (dirLightId == LightManager::INVALID)
+    {
+        dirLightId = lights.addDirectional(dir);
+        pointLightId = lights.addPoint(point);
+        spotLightId = lights.addSpot(spot);
+    }
+    else
+    {
+        lights.setDirectional(dirLightId, dir);
+        lights.setPoint(pointLightId, point);
+        lights.setSpot(spotLightId, spot);
+    }
 
-    HRESULT _hr = app->getD3D12()->getDevice()->CreateGraphicsPipelineState(&normalsDesc, IID_PPV_ARGS(&psoNormals));
+    // ------------------------------------------------------------
+    // Dynamic point lights over the instance grid: added / removed
+    // to match the slider, a share of them orbits every frame
+    // ------------------------------------------------------------
+    const int gridSize = std::max(instanceGridSize, 1);
+    const float halfExtent = 0.5f * float(gridSize) * instanceSpacing;
 
-    if (FAILED(_hr))
+    while (int(dynamicLightIds.size()) > dynamicLightCount)
     {
-        Logger::Err("Failed to create normals PSO");
-        return false;
+        lights.remove(LightManager::POINT, dynamicLightIds.back());
+        dynamicLightIds.pop_back();
+        dynamicLightCenters.pop_back();
     }
 
-    return true;
+    while (int(dynamicLightIds.size()) < dynamicLightCount)
+    {
+        // Deterministic scatter (golden ratio), stable across count changes
+        const float k = float(dynamicLightIds.size());
+        const float u = fmodf(k * 0.618034f, 1.0f);
+        const float v = fmodf(k * 0.754878f, 1.0f);
+
+        LightManager::PointLight light;
+        light.position = SimpleMath::Vector3((u * 2.0f - 1.0f) * halfExtent, 1.0f, (v * 2.0f - 1.0f) * halfExtent);
+        light.color = SimpleMath::Vector3(0.5f + 0.5f * u, 0.5f + 0.5f * v, 1.0f - 0.5f * u);
+        light.intensity = 2.0f;
+        light.radius = 2.0f;
+
+        dynamicLightCenters.push_back(light.position);
+        dynamicLightIds.push_back(lights.addPoint(light));
+    }
+
+    dynamicLightTime += app->getTimeService().getFrameSeconds();
+
+    const size_t moving = dynamicLightIds.size() * size_t(std::clamp(movingLightPercent, 0, 100)) / 100;
+    for (size_t i = 0; i < moving; ++i)
+    {
+        const float phase = dynamicLightTime + float(i) * 0.37f;
+        lights.setPointPosition(dynamicLightIds[i], dynamicLightCenters[i] + SimpleMath::Vector3(cosf(phase), 0.0f, sinf(phase)) * 0.75f);
+    }
+
+    lights.setFullUpload(fullLightUpload);
 }
 
-void Exercise8::drawModel(ID3D12GraphicsCommandList* commandList, ShaderDescriptorsModule* shaders, SamplersModule* samplers)
+int Exercise8::getInstanceCount() const
 {
-    RingBufferModule* ring = app->getRingBuffer();
+    const int gridSize = std::max(instanceGridSize, 1);
+    return gridSize * gridSize;
+}
 
-    const SimpleMath::Matrix modelMat = duck->getModelMatrix();
-    const SimpleMath::Matrix normalMat = modelMat.Invert().Transpose();
+SimpleMath::Matrix Exercise8::getInstanceMatrix(int index) const
+{
+    const int gridSize = std::max(instanceGridSize, 1);
+    const float halfExtent = 0.5f * float(gridSize - 1) * instanceSpacing;
 
-    for (size_t i = 0; i < duck->getMeshCount(); ++i)
-    {
-        // ------------------------------------------------------------
-        // Mesh geometry
-        // ------------------------------------------------------------
-        const Mesh& mesh = duck->getMesh(i);
+    const int x = index % gridSize;
+    const int z = index / gridSize;
 
-        // Vertex buffer
-        const D3D12_VERTEX_BUFFER_VIEW& vbv = mesh.getVertexView();
-        commandList->IASetVertexBuffers(0, 1, &vbv);
+    return duck->getModelMatrix() *
+        SimpleMath::Matrix::CreateTranslation(float(x) * instanceSpacing - halfExtent, 0.0f, float(z) * instanceSpacing - halfExtent);
+}
 
-        if (mesh.hasIndices())
-        {
-            const D3D12_INDEX_BUFFER_VIEW& ibv = mesh.getIndexView();
-            commandList->IASetIndexBuffer(&ibv);
-        }
+BoundingBox3 Exercise8::getInstanceBounds(int index) const
+{
+    const SimpleMath::Vector3 r(duck->getBoundsRadius());
 
-        // ------------------------------------------------------------
-        // Per-instance constants (transform + phong material)
-        // ------------------------------------------------------------
-        PerInstance* perInstance = nullptr;
-        auto perInstanceGPU = ring->allocBuffer(sizeof(PerInstance), (void**)&perInstance);
+    BoundingBox3 local;
+    local.grow(duck->getBoundsCenter() - r);
+    local.grow(duck->getBoundsCenter() + r);
 
-        perInstance->modelMat = duck->getModelMatrix().Transpose();
-        perInstance->normalMat = duck->getModelMatrix().Invert();
+    return local.transformed(getInstanceMatrix(index));
+}
 
-        // Material data
-        const BasicMaterial& mat = duck->getMaterialForMesh(i);
+void Exercise8::pickInstance(const PickRay& ray)
+{
+    Timer timer;
+    timer.Start();
 
-        perInstance->material = mat.getPBRPhongMaterial();
+    // ------------------------------------------------------------
+    // Scene BVH over the instance boxes, rebuilt only when the grid moves
+    // ------------------------------------------------------------
+    const int instanceCount = getInstanceCount();
+    const SimpleMath::Matrix& baseMat = duck->getModelMatrix();
 
-        // ImGui overrides (PBR-friendly)
-        perInstance->material.diffuseColour = XMFLOAT3(
-            pbrPhongDiffuseColor.x,
-            pbrPhongDiffuseColor.y,
-            pbrPhongDiffuseColor.z
-        );
+    if (sceneBVH.empty() || sceneBVHGridSize != instanceGridSize || sceneBVHSpacing != instanceSpacing || sceneBVHBase != baseMat)
+    {
+        std::vector<BoundingBox3> boxes(instanceCount);
+        for (int i = 0; i < instanceCount; ++i)
+            boxes[i] = getInstanceBounds(i);
 
-        perInstance->material.specularColour = XMFLOAT3(
-            pbrPhongSpecularColor.x,
-            pbrPhongSpecularColor.y,
-            pbrPhongSpecularColor.z
-        );
+        sceneBVH.build(boxes.data(), boxes.size());
+
+        sceneBVHGridSize = instanceGridSize;
+        sceneBVHSpacing = instanceSpacing;
+        sceneBVHBase = baseMat;
+    }
 
-        perInstance->material.hasDiffuseTex =
-            isTextureVisible && mat.getPBRPhongMaterial().hasDiffuseTex;
+    // ------------------------------------------------------------
+    // Scene BVH -> object space ray -> per-mesh triangle BVH
+    // ------------------------------------------------------------
+    float tClosest = FLT_MAX;
+    int hitInstance = -1;
+    int hitMesh = -1;
+    uint32_t hitTriangle = 0;
+
+    sceneBVH.intersect(ray, tClosest, [&](uint32_t instance, float& tMax)
+        {
+            // Direction is not renormalized, so local t == world t
+            const PickRay localRay = ray.transformed(getInstanceMatrix(int(instance)).Invert());
+
+            bool hit = false;
+            for (size_t i = 0; i < duck->getMeshCount(); ++i)
+            {
+                uint32_t triangle = 0;
+                if (duck->getMesh(i).intersect(localRay, tMax, triangle))
+                {
+                    hit = true;
+                    hitInstance = int(instance);
+                    hitMesh = int(i);
+                    hitTriangle = triangle;
+                }
+            }
+            return hit;
+        });
+
+    timer.Stop();
+    pickMs = float(timer.ReadMs());
+
+    selectedInstance = hitInstance;
+    pickedMesh = hitMesh;
+    pickedTriangle = hitTriangle;
+    pickedDistance = tClosest;
+}
 
-        perInstance->material.shininess = pbrPhongShininess;
+void Exercise8::selectInstanceLods(CameraModule* camera, float viewportHeight)
+{
+    const SimpleMath::Matrix baseMat = duck->getModelMatrix();
 
-        commandList->SetGraphicsRootConstantBufferView(1, perInstanceGPU); // Bind PerInstance CBV -> slot 1 (b1)
+    const int gridSize = std::max(instanceGridSize, 1);
+    const float halfExtent = 0.5f * float(gridSize - 1) * instanceSpacing;
 
-        // ------------------------------------------------------------
-        // Material resources (texture + sampler)
-        // ------------------------------------------------------------
-        D3D12_GPU_DESCRIPTOR_HANDLE texHandle = shaders->getGPUHandle(mat.getColourTexSRV()); // Texture (t0)
-        commandList->SetGraphicsRootDescriptorTable(6, texHandle);
+    // World radius: object radius scaled by the largest axis scale of the model matrix
+    const float maxScale = std::max({ baseMat.Right().Length(), baseMat.Up().Length(), baseMat.Backward().Length() });
+    const float worldRadius = duck->getBoundsRadius() * maxScale;
+    const float lodErrors[] = { 0.0f };
 
-        D3D12_GPU_DESCRIPTOR_HANDLE sampHandle = samplers->getGPUHandle(0);  // Sampler (s0)
-        commandList->SetGraphicsRootDescriptorTable(7, sampHandle);
+    lodSelector.resize(size_t(gridSize) * gridSize);
 
-        // ------------------------------------------------------------
-        // Draw
-        // ------------------------------------------------------------
-        if (mesh.hasIndices())
+    for (int z = 0; z < gridSize; ++z)
+    {
+        for (int x = 0; x < gridSize; ++x)
         {
-            commandList->DrawIndexedInstanced(mesh.getIndexCount(), 1, 0, 0, 0);
+            const SimpleMath::Matrix modelMat = baseMat *
+                SimpleMath::Matrix::CreateTranslation(float(x) * instanceSpacing - halfExtent, 0.0f, float(z) * instanceSpacing - halfExtent);
+
+            const SimpleMath::Vector3 center = SimpleMath::Vector3::Transform(duck->getBoundsCenter(), modelMat);
+            lodSelector.setObject(size_t(z) * gridSize + x, center, worldRadius, 1, lodErrors);
         }
-        else
+    }
+
+    const float fps = app->getFPS();
+    if (fps > 0.0f)
+        lodSelector.updateBudget(1000.0f / fps);
+
+    if (useSimdLod)
+        lodSelector.select(camera->getPos(), camera->GetFov(), viewportHeight);
+    else
+        lodSelector.selectScalar(camera->getPos(), camera->GetFov(), viewportHeight);
+}
+
+void Exercise8::assignInstanceLights()
+{
+    const SimpleMath::Matrix baseMat = duck->getModelMatrix();
+
+    const int gridSize = std::max(instanceGridSize, 1);
+    const float halfExtent = 0.5f * float(gridSize - 1) * instanceSpacing;
+
+    const float maxScale = std::max({ baseMat.Right().Length(), baseMat.Up().Length(), baseMat.Backward().Length() });
+    const float worldRadius = duck->getBoundsRadius() * maxScale;
+
+    // Same spheres as the LOD selection; instances it culled are not ranked
+    objectLights.resize(size_t(gridSize) * gridSize);
+
+    for (int z = 0; z < gridSize; ++z)
+    {
+        for (int x = 0; x < gridSize; ++x)
         {
-            commandList->DrawInstanced(mesh.getVertexCount(), 1, 0, 0);
+            const size_t index = size_t(z) * gridSize + x;
+            const SimpleMath::Matrix modelMat = baseMat *
+                SimpleMath::Matrix::CreateTranslation(float(x) * instanceSpacing - halfExtent, 0.0f, float(z) * instanceSpacing - halfExtent);
+
+            const SimpleMath::Vector3 center = SimpleMath::Vector3::Transform(duck->getBoundsCenter(), modelMat);
+            objectLights.setObject(index, center, worldRadius, lodSelector.getLod(index) != LodSelector::LOD_CULLED);
         }
     }
+
+    objectLights.assign(lights, app->getJobSystem());
 }
 
 void Exercise8::ApplyImGuizmo(CameraModule* camera)
@@ -590,7 +1010,13 @@ void Exercise8::ApplyImGuizmo(CameraModule* camera)
     // -------------------------------
     // ImGuizmo Matrix
     // -------------------------------
-    DirectX::XMMATRIX modelM = duck->getModelMatrix();
+    // The gizmo edits the picked instance; the change is carried back to the grid base transform
+    const bool editInstance = selectedInstance >= 0 && selectedInstance < getInstanceCount();
+    const SimpleMath::Matrix instanceOffset = editInstance
+        ? duck->getModelMatrix().Invert() * getInstanceMatrix(selectedInstance)
+        : SimpleMath::Matrix::Identity;
+
+    DirectX::XMMATRIX modelM = editInstance ? getInstanceMatrix(selectedInstance) : duck->getModelMatrix();
     DirectX::XMMATRIX viewM = camera->getView();
 
     float aspect = camera->getAspect();
@@ -621,6 +1047,8 @@ void Exercise8::ApplyImGuizmo(CameraModule* camera)
     if (ImGuizmo::IsUsing())
     {
         DirectX::XMMATRIX newModel = DirectX::XMLoadFloat4x4(&modelF);
+        if (editInstance)
+            newModel = SimpleMath::Matrix(newModel) * instanceOffset.Invert();
         duck->setModelMatrix(SimpleMath::Matrix(newModel));
 
         // Actualiza quaternion interno
@@ -762,6 +1190,134 @@ void Exercise8::ExerciseMenu(CameraModule* camera)
 
     }
 
+    if (ImGui::CollapsingHeader("Instancing"))
+    {
+        ImGui::Text("Grid Size");
+        ImGui::SameLine(125.0f);
+        ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x - 60.0f);
+        ImGui::SliderInt("##InstGrid", &instanceGridSize, 1, 100);
+
+        ImGui::Text("Spacing");
+        ImGui::SameLine(125.0f);
+        ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x - 60.0f);
+        ImGui::SliderFloat("##InstSpacing", &instanceSpacing, 0.5f, 20.0f, "%.2f");
+
+        ImGui::Text("Instances: %u  Draw calls: %u", batcher.getInstanceCount(), batcher.getDrawCalls());
+        ImGui::Text("State changes: PSO %u  VB/IB %u  Material %u",
+            batcher.getPSOChanges(), batcher.getMeshChanges(), batcher.getMaterialChanges());
+
+        // ---------- Light upload benchmark ----------
+        ImGui::Text("Dynamic lights");
+        ImGui::SameLine(125.0f);
+        ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x - 60.0f);
+        ImGui::SliderInt("##DynLights", &dynamicLightCount, 0, 4096);
+
+        ImGui::Text("Moving %%");
+        ImGui::SameLine(125.0f);
+        ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x - 60.0f);
+        ImGui::SliderInt("##MovingLights", &movingLightPercent, 0, 100);
+
+        ImGui::Checkbox("Full light re-upload (old path)", &fullLightUpload);
+
+        const LightManager::Stats& lightStats = lights.getStats();
+        ImGui::Text("Lights: %u dir, %u point, %u spot", lightStats.lights[LightManager::DIRECTIONAL],
+            lightStats.lights[LightManager::POINT], lightStats.lights[LightManager::SPOT]);
+        ImGui::Text("Light upload: %u lights, %.1f KB/frame (full: %.1f KB/frame, %u copies)", lightStats.uploadedLights,
+            lightStats.avgUploadedBytes / 1024.0, lightStats.avgFullBytes / 1024.0, lightStats.copies);
+
+        // ---------- Clustered lighting ----------
+        const char* lightingPaths[] = { "All lights", "Clustered", "Per object" };
+        int path = int(lightingPath);
+        ImGui::Text("Lighting");
+        ImGui::SameLine(125.0f);
+        ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x - 60.0f);
+        if (ImGui::Combo("##LightingPath", &path, lightingPaths, IM_ARRAYSIZE(lightingPaths)))
+        {
+            lightingPath = LightingPath(path);
+            objectLights.invalidate();      // lists were not kept up to date meanwhile
+        }
+
+        ImGui::Checkbox("Tone mapping", &useToneMapping);
+        ImGui::Checkbox("Compile permutations in the background", &asyncPipelines);
+
+        const ShaderPermutations::Stats& permutationStats = psPermutations.getStats();
+        ImGui::Text("PS permutations: %u loaded, %u missing (uber shader), %zu PSOs",
+            permutationStats.loaded, permutationStats.missing, pipelines.size());
+
+        if (lightingPath == LightingPath::Clustered)
+        {
+            ImGui::Checkbox("Validate vs brute force", &validateClusters);
+
+            const LightClusterBuilder::Stats& clusterStats = clusterBuilder.getStats();
+            const LightClusterBuilder::Settings& grid = clusterBuilder.getBuiltSettings();
+            ImGui::Text("Clusters: %ux%ux%u, %u non-empty, max %u lights, %u indices",
+                grid.dimX, grid.dimY, grid.dimZ, clusterStats.nonEmptyClusters, clusterStats.maxLightsPerCluster, clusterStats.indices);
+            ImGui::Text("Cluster build: %.3f ms", clusterStats.buildMs);
+
+            if (validateClusters)
+            {
+                ImGui::Text("Brute force: %.3f ms, %u mismatching clusters", clusterReference.getStats().buildMs, clusterMismatches);
+            }
+        }
+        else if (lightingPath == LightingPath::PerObject)
+        {
+            const ObjectLightAssigner::Stats& objectStats = objectLights.getStats();
+            ImGui::Text("Object lights: %u visible, %u ranked, %u cached (max %u lights each)",
+                objectStats.visible, objectStats.assigned, objectStats.cached, ObjectLightAssigner::MAX_LIGHTS);
+            ImGui::Text("Changed lights: %u, assign: %.3f ms", objectStats.changedLights, objectStats.assignMs);
+        }
+
+        ImGui::Separator();
+
+        const MaterialTable::Stats& tableStats = materialTable.getStats();
+        ImGui::Text("Material table: %u / %u records, %u uploaded (%u copies)",
+            tableStats.records, tableStats.capacity, tableStats.uploadedRecords, tableStats.copies);
+
+        ImGui::Checkbox("Parallel recording", &useParallelRecording);
+        ImGui::SameLine();
+        ImGui::TextDisabled("(%u lists)", batcher.getRecordedLists());
+
+        ImGui::Separator();
+
+        ImGui::Text("Detail Cull (px)");
+        ImGui::SameLine(125.0f);
+        ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x - 60.0f);
+        ImGui::SliderFloat("##LodCull", &lodSelector.settings.cullPixels, 0.0f, 50.0f, "%.1f");
+
+        ImGui::Text("Hysteresis");
+        ImGui::SameLine(125.0f);
+        ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x - 60.0f);
+        ImGui::SliderFloat("##LodHyst", &lodSelector.settings.hysteresis, 0.0f, 0.5f, "%.2f");
+
+        ImGui::Text("Budget (ms)");
+        ImGui::SameLine(125.0f);
+        ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x - 60.0f);
+        ImGui::SliderFloat("##LodBudget", &lodSelector.settings.budgetMs, 4.0f, 33.3f, "%.1f");
+
+        ImGui::Checkbox("SIMD LOD selection", &useSimdLod);
+        ImGui::Text("LOD bias: %.2f  Culled: %u / %zu", lodSelector.getBias(), lodSelector.getCulledCount(), lodSelector.size());
+    }
+
+    if (ImGui::CollapsingHeader("Picking"))
+    {
+        ImGui::TextWrapped("Left click in the viewport to select an instance. The gizmo follows the selection.");
+
+        if (selectedInstance >= 0)
+        {
+            ImGui::Text("Instance: %d  Mesh: %d  Triangle: %u", selectedInstance, pickedMesh, pickedTriangle);
+            ImGui::Text("Distance: %.3f", pickedDistance);
+        }
+        else
+        {
+            ImGui::Text("Nothing selected");
+        }
+
+        ImGui::Text("Last pick: %.4f ms  Scene BVH nodes: %zu", pickMs, sceneBVH.getNodeCount());
+
+        if (ImGui::Button("Clear Selection"))
+            selectedInstance = -1;
+    }
+
     if (ImGui::CollapsingHeader("PBR-Phong Material", ImGuiTreeNodeFlags_DefaultOpen))
     {
         static int presetIndex = 0;
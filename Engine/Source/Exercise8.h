@@ -3,6 +3,15 @@
 #include "DebugDrawPass.h"
 #include "Model.h"
 #include "ImGuizmo.h"
+#include "InstanceBatcher.h"
+#include "LodSelector.h"
+#include "MaterialTable.h"
+#include "LightManager.h"
+#include "LightClusterBuilder.h"
+#include "ObjectLightAssigner.h"
+#include "ShaderPermutations.h"
+
+#include <unordered_map>
 
 class CameraModule;
 class ShaderDescriptorsModule;
@@ -15,11 +24,17 @@ private:
 	// ------------------------------------------------------------------------
 	// GPU Constant Buffers
 	// ------------------------------------------------------------------------
+
+	// One record per instance in the instance StructuredBuffer (t4).
+	// Must match 'InstanceData' in Exercise8VS.hlsl / Exercise8PS.hlsl. The
+	// material is not copied per instance: the draw's root constant indexes
+	// the material table. 'lights' is the instance's light list (per-object
+	// lighting only).
 	struct PerInstance
 	{
 		SimpleMath::Matrix modelMat;
 		SimpleMath::Matrix normalMat;
-		PBRPhongMaterialData  material;
+		ObjectLightAssigner::ObjectLights lights;
 	};
 
 	struct PerFrame
@@ -33,50 +48,128 @@ private:
 		uint32_t NumDirLights;
 		uint32_t NumPointLights;
 		uint32_t NumSpotLights;
-		uint32_t pad2;
-	};
+		uint32_t LightingMode;		// LightingPath
 
-	struct DirectionalLightGPU
-	{
-		XMFLOAT3 direction;
-		XMFLOAT3 color;
-		float intensity;
-	};
+		SimpleMath::Vector3 ViewForward;
+		float ClusterDepthScale;
 
-	struct PointLightGPU
-	{
-		XMFLOAT3 position;
-		XMFLOAT3 color;
-		float intensity;
-		float radius;
-	};
+		uint32_t ClusterDims[3];
+		float ClusterDepthBias;
 
-	struct SpotLightGPU
-	{
-		XMFLOAT3 position;
-		XMFLOAT3 direction;
-		XMFLOAT3 color;
-		float intensity;
-		float radius;
-		float cosInnerAngle;
-		float cosOuterAngle;
-		float pad0;
+		float ClusterTileScale[2];
+		uint32_t ToneMapping;		// uber shader only, permutations have it built in
+		float pad3;
 	};
 
 	// ------------------------------------------------------------------------
 	// Pipeline
 	// ------------------------------------------------------------------------
 	ComPtr<ID3D12RootSignature> rootSignature;
-	ComPtr<ID3D12PipelineState> pso;
-	ComPtr<ID3D12PipelineState> psoWireframe;
-	ComPtr<ID3D12PipelineState> psoNormals;
+
+	// Pixel shader feature bits: the permutation key of Exercise8PS
+	// (COLOUR_TEXTURE, TONE_MAPPING and LIGHTING_PATH in the shader)
+	enum PSFeature : uint32_t
+	{
+		PS_COLOUR_TEXTURE = 1u << 0,
+		PS_TONE_MAPPING = 1u << 1,
+		PS_LIGHTING_PATH_SHIFT = 2,		// 2 bits, LightingPath
+	};
+
+	// Fixed-function state of a pass; with the PS permutation it keys the PSO
+	enum class PassState : uint32_t
+	{
+		Solid = 0,
+		Wireframe,
+		Normals
+	};
+
+	// Point into the shader archive (or its loose .cso copies)
+	D3D12_SHADER_BYTECODE vsBytecode = {};
+	D3D12_SHADER_BYTECODE wireframePSBytecode = {};
+	D3D12_SHADER_BYTECODE normalsPSBytecode = {};
+	ShaderPermutations psPermutations{ L"Exercise8PS" };
+
+	// Created on first use, by (resolved permutation, pass state)
+	std::unordered_map<uint64_t, ComPtr<ID3D12PipelineState>> pipelines;
 
 	// ------------------------------------------------------------------------
 	// Scene
 	// -----------------------------------------------------------------------
-	SimpleMath::Matrix mvpMatrix;
+	SimpleMath::Matrix viewProjMatrix;
 	std::unique_ptr<Model> duck;
 
+	// ------------------------------------------------------------------------
+	// Instancing (grid of copies around the model transform)
+	// ------------------------------------------------------------------------
+	InstanceBatcher batcher;
+	int   instanceGridSize = 1;       // instances per side (N x N)
+	float instanceSpacing = 3.0f;
+
+	// ------------------------------------------------------------------------
+	// Bindless materials: one record per duck material (same index as
+	// Model::getMaterials()), textures through the bindless SRV range
+	// ------------------------------------------------------------------------
+	MaterialTable materialTable;
+
+	// ------------------------------------------------------------------------
+	// Lights: persistent SoA storage, only changed lights are uploaded
+	// ------------------------------------------------------------------------
+	LightManager lights;
+	uint32_t dirLightId = LightManager::INVALID;
+	uint32_t pointLightId = LightManager::INVALID;
+	uint32_t spotLightId = LightManager::INVALID;
+
+	// Extra point lights scattered over the instance grid (upload benchmark)
+	std::vector<uint32_t> dynamicLightIds;
+	std::vector<SimpleMath::Vector3> dynamicLightCenters;
+	int   dynamicLightCount = 0;
+	int   movingLightPercent = 10;        // share of the dynamic lights animated every frame
+	float dynamicLightTime = 0.0f;
+	bool  fullLightUpload = false;
+
+	// ------------------------------------------------------------------------
+	// Clustered lighting: per-cluster light lists built on the CPU every
+	// frame (t6 / t7), the pixel shader only loops over its cluster's lights
+	// ------------------------------------------------------------------------
+	// Which point / spot lights a pixel evaluates (same values in Exercise8PS.hlsl)
+	enum class LightingPath
+	{
+		AllLights = 0,
+		Clustered,
+		PerObject
+	};
+
+	LightingPath lightingPath = LightingPath::Clustered;
+	bool useToneMapping = true;
+	bool asyncPipelines = true;     // permutation PSOs compile on the job system, the uber PSO draws meanwhile
+
+	LightClusterBuilder clusterBuilder;
+	LightClusterBuilder clusterReference;     // brute force, to validate the fast path
+	bool     validateClusters = false;
+	uint32_t clusterMismatches = 0;
+
+	// Per-object lighting: the strongest lights of every grid instance, kept
+	// until the instance or a light near it changes
+	ObjectLightAssigner objectLights;
+
+	LodSelector lodSelector;          // one entry per grid instance
+	bool  useSimdLod = true;
+	bool  useParallelRecording = true;     // large passes record on several command lists
+
+	// ------------------------------------------------------------------------
+	// Picking (scene BVH over the instances, lazy triangle BVH per mesh)
+	// ------------------------------------------------------------------------
+	BVH sceneBVH;
+	int sceneBVHGridSize = 0;
+	float sceneBVHSpacing = 0.0f;
+	SimpleMath::Matrix sceneBVHBase;
+
+	int selectedInstance = -1;
+	int pickedMesh = -1;
+	uint32_t pickedTriangle = 0;
+	float pickedDistance = 0.0f;
+	float pickMs = 0.0f;
+
 	SimpleMath::Quaternion qRot = SimpleMath::Quaternion::Identity;
 	float rotationX{ 90.0f }, rotationY{ 0.0f }, rotationZ{ 0.0f };
 	float scaleX{ 1.0f }, scaleY{ 1.0f }, scaleZ{ 1.0f };
@@ -157,7 +250,18 @@ private:
 	// ------------------------------------------------------------------------
 	bool createRootSignature();
 	bool createPSO();
-	void drawModel(ID3D12GraphicsCommandList* commandList, ShaderDescriptorsModule* shaders, SamplersModule* samplers);
+	ID3D12PipelineState* getPipeline(PassState pass, uint32_t permutation);
+	uint32_t getPermutation(const BasicMaterial& mat) const;
+	void updateMaterialTable();
+	void updateLights();
+	void queueModel(uint32_t renderPass, PassState pass, const SimpleMath::Matrix& view);
+	void selectInstanceLods(CameraModule* camera, float viewportHeight);
+	void assignInstanceLights();
+	void pickInstance(const PickRay& ray);
+
+	int getInstanceCount() const;
+	SimpleMath::Matrix getInstanceMatrix(int index) const;
+	BoundingBox3 getInstanceBounds(int index) const;
 	void ApplyImGuizmo(CameraModule* camera);
 	void applyMaterialPreset(MaterialPreset preset);
 	void ExerciseMenu(CameraModule* camera);
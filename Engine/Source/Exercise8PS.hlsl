@@ -40,7 +40,7 @@ StructuredBuffer<PointLight> PointLights : register(t1);
 StructuredBuffer<SpotLight> SpotLights : register(t2);
 
 // -------------------------------
-// PerFrame (b2): globals + counts
+// PerFrame (b2): globals + counts + cluster grid
 // -------------------------------
 cbuffer PerFrame : register(b2)
 {
@@ -53,29 +53,94 @@ cbuffer PerFrame : register(b2)
     uint NumDirLights;
     uint NumPointLights;
     uint NumSpotLights;
-    uint pad2;
+    uint LightingMode;          // 0 all lights, 1 clustered, 2 per object
+
+    float3 ViewForward;
+    float ClusterDepthScale;
+
+    uint3 ClusterDims;
+    float ClusterDepthBias;
+
+    float2 ClusterTileScale;    // clusters per pixel
+    uint ToneMapping;
+    float pad3;
 };
 
 // -------------------------------
-// PerInstance (b1): transforms + material
+// Permutations
+// Built with PERMUTATION (Exercise8PS_<key>.cso, the ShaderPermutation
+// items in Engine.vcxproj) the features are compile-time constants and
+// their branches are compiled out:
+//   COLOUR_TEXTURE  0 / 1   the material samples its colour texture
+//   TONE_MAPPING    0 / 1
+//   LIGHTING_PATH   0 all lights, 1 clustered, 2 per object
+// Built without it (Exercise8PS.cso) they are read at run time: the
+// fallback when a permutation is missing.
+// -------------------------------
+#ifdef PERMUTATION
+#define USE_COLOUR_TEXTURE(mat) (COLOUR_TEXTURE != 0)
+#define USE_TONE_MAPPING (TONE_MAPPING != 0)
+#define ACTIVE_LIGHTING_PATH LIGHTING_PATH
+#else
+#define USE_COLOUR_TEXTURE(mat) (mat.hasDiffuseTex != 0)
+#define USE_TONE_MAPPING (ToneMapping != 0)
+#define ACTIVE_LIGHTING_PATH LightingMode
+#endif
+
+// -------------------------------
+// Clustered lights ('LightClusterBuilder')
+// ClusterGrid (t6): per cluster, x = first index, y = point count | spot count << 16
+// ClusterLightIndices (t7): point slots then spot slots of every cluster
+// -------------------------------
+StructuredBuffer<uint2> ClusterGrid : register(t6);
+StructuredBuffer<uint> ClusterLightIndices : register(t7);
+
+// -------------------------------
+// Per-object lights (t4, 'InstanceData' in Exercise8VS): up to 8 16-bit
+// entries, light slot | 0x8000 for spot lights ('ObjectLightAssigner')
 // -------------------------------
-cbuffer PerInstance : register(b1)
+struct InstanceData
 {
     float4x4 modelMat;
     float4x4 normalMat;
+    uint lightCount;
+    uint3 lightPad;
+    uint4 lightEntries;
+};
+
+StructuredBuffer<InstanceData> Instances : register(t4);
+
+static const uint LIGHTING_CLUSTERED = 1;
+static const uint LIGHTING_PER_OBJECT = 2;
+static const uint OBJECT_LIGHT_SPOT = 0x8000;
 
+// -------------------------------
+// Bindless materials
+// MaterialIndex (b3): root constant, the only per-draw material state
+// Materials (t5): one record per material ('MaterialRecord' in MaterialTable.h)
+// Textures / Samplers (space1): the whole shader-visible heaps, indexed by slot
+// -------------------------------
+cbuffer DrawMaterial : register(b3)
+{
+    uint MaterialIndex;
+};
+
+struct MaterialData
+{
     float3 diffuseColour;
-    bool hasDiffuseTex;
+    uint hasDiffuseTex;
 
     float3 specularColour;
     float shininess;
+
+    uint colourTexture;
+    uint colourSampler;
+    uint2 padding;
 };
 
-// -------------------------------
-// Texture moved to t3
-// -------------------------------
-Texture2D baseTexture : register(t3);
-SamplerState samplerState : register(s0);
+StructuredBuffer<MaterialData> Materials : register(t5);
+Texture2D Textures[] : register(t0, space1);
+SamplerState Samplers[] : register(s0, space1);
 
 struct PSInput
 {
@@ -83,8 +148,20 @@ struct PSInput
     float2 texCoord : TEXCOORD;
     float3 worldPos : POSITION;
     float3 normal : NORMAL;
+    nointerpolation uint instanceID : INSTANCEID;
 };
 
+uint ClusterIndex(float2 pixel, float3 worldPos)
+{
+    // Exponential depth slices, same formula as the CPU builder
+    float depth = max(dot(worldPos - viewPos, ViewForward), 1e-4f);
+    int slice = int(floor(log(depth) * ClusterDepthScale + ClusterDepthBias));
+    uint z = uint(clamp(slice, 0, int(ClusterDims.z) - 1));
+
+    uint2 xy = min(uint2(pixel * ClusterTileScale), ClusterDims.xy - 1);
+    return (z * ClusterDims.y + xy.y) * ClusterDims.x + xy.x;
+}
+
 float3 LinearToSRGB(float3 c)
 {
     return pow(saturate(c), INV_GAMMA);
@@ -211,10 +288,16 @@ float3 EvalSpot(SpotLight l, float3 worldPos, float3 N, float3 V, float3 Cd, flo
 
 float4 main(PSInput input) : SV_TARGET
 {
-    float3 Cd = diffuseColour;
-    if (hasDiffuseTex)
+    // Uniform per draw: no NonUniformResourceIndex needed
+    MaterialData mat = Materials[MaterialIndex];
+
+    float3 Cd = mat.diffuseColour;
+    float3 specularColour = mat.specularColour;
+    float shininess = mat.shininess;
+
+    if (USE_COLOUR_TEXTURE(mat))
     {
-        float3 tex = baseTexture.Sample(samplerState, input.texCoord).rgb;
+        float3 tex = Textures[mat.colourTexture].Sample(Samplers[mat.colourSampler], input.texCoord).rgb;
         Cd *= tex;
     }
 
@@ -226,14 +309,47 @@ float4 main(PSInput input) : SV_TARGET
     for (uint i = 0; i < NumDirLights; ++i)
         result += EvalDir(DirLights[i], input.worldPos, N, V, Cd, specularColour, shininess);
 
-    for (uint i = 0; i < NumPointLights; ++i)
-        result += EvalPoint(PointLights[i], input.worldPos, N, V, Cd, specularColour, shininess);
+    if (ACTIVE_LIGHTING_PATH == LIGHTING_CLUSTERED)
+    {
+        // Only the lights of this pixel's cluster
+        uint2 cluster = ClusterGrid[ClusterIndex(input.position.xy, input.worldPos)];
+        uint pointCount = cluster.y & 0xFFFF;
+        uint spotCount = cluster.y >> 16;
+
+        for (uint i = 0; i < pointCount; ++i)
+            result += EvalPoint(PointLights[ClusterLightIndices[cluster.x + i]], input.worldPos, N, V, Cd, specularColour, shininess);
+
+        for (uint i = 0; i < spotCount; ++i)
+            result += EvalSpot(SpotLights[ClusterLightIndices[cluster.x + pointCount + i]], input.worldPos, N, V, Cd, specularColour, shininess);
+    }
+    else if (ACTIVE_LIGHTING_PATH == LIGHTING_PER_OBJECT)
+    {
+        // The strongest lights of this instance, ranked on the CPU
+        InstanceData inst = Instances[input.instanceID];
+
+        for (uint i = 0; i < inst.lightCount; ++i)
+        {
+            uint entry = (inst.lightEntries[i >> 1] >> ((i & 1) * 16)) & 0xFFFF;
+            uint slot = entry & ~OBJECT_LIGHT_SPOT;
+
+            if (entry & OBJECT_LIGHT_SPOT)
+                result += EvalSpot(SpotLights[slot], input.worldPos, N, V, Cd, specularColour, shininess);
+            else
+                result += EvalPoint(PointLights[slot], input.worldPos, N, V, Cd, specularColour, shininess);
+        }
+    }
+    else
+    {
+        for (uint i = 0; i < NumPointLights; ++i)
+            result += EvalPoint(PointLights[i], input.worldPos, N, V, Cd, specularColour, shininess);
 
-    for (uint i = 0; i < NumSpotLights; ++i)
-        result += EvalSpot(SpotLights[i], input.worldPos, N, V, Cd, specularColour, shininess);
+        for (uint i = 0; i < NumSpotLights; ++i)
+            result += EvalSpot(SpotLights[i], input.worldPos, N, V, Cd, specularColour, shininess);
+    }
 
     // tone mapping then gamma as the last step
-    result = PBRNeutralToneMapping(result);
+    if (USE_TONE_MAPPING)
+        result = PBRNeutralToneMapping(result);
     result = LinearToSRGB(result);
 
     return float4(result, 1.0f);
@@ -1,17 +1,24 @@
-cbuffer MVP : register(b0)
+cbuffer ViewProj : register(b0)
 {
-    float4x4 mvpMatrix;
+    float4x4 viewProjMatrix;
 };
 
-// PerInstance CBV (slot 1)
-cbuffer PerInstance : register(b1)
+// -------------------------------
+// Per-instance data (t4), indexed by SV_InstanceID
+// (the material comes from the material table, the light list is
+// read by Exercise8PS)
+// -------------------------------
+struct InstanceData
 {
     float4x4 modelMat;
     float4x4 normalMat;
-    float4 dummy0;
-    float4 dummy1;
+    uint lightCount;
+    uint3 lightPad;
+    uint4 lightEntries;
 };
 
+StructuredBuffer<InstanceData> Instances : register(t4);
+
 struct VSInput
 {
     float3 position : POSITION;
@@ -25,19 +32,23 @@ struct VSOutput
     float2 texCoord : TEXCOORD;
     float3 worldPos : POSITION;
     float3 normal : NORMAL;
+    nointerpolation uint instanceID : INSTANCEID;
 };
 
-VSOutput main(VSInput input)
+VSOutput main(VSInput input, uint instanceID : SV_InstanceID)
 {
     VSOutput output;
 
-    float4 worldPos = mul(float4(input.position, 1.0f), modelMat);
+    InstanceData inst = Instances[instanceID];
+
+    float4 worldPos = mul(float4(input.position, 1.0f), inst.modelMat);
     output.worldPos = worldPos.xyz;
 
-    output.normal = normalize(mul(input.normal, (float3x3) normalMat));
+    output.normal = normalize(mul(input.normal, (float3x3) inst.normalMat));
 
-    output.position = mul(float4(input.position, 1.0f), mvpMatrix);
+    output.position = mul(worldPos, viewProjMatrix);
     output.texCoord = input.texCoord;
+    output.instanceID = instanceID;
 
     return output;
 }
\ No newline at end of file
@@ -10,6 +10,8 @@
 #include "Exercise7.h"
 #include "Exercise8.h"
 
+#include "Application.h"
+
 ExerciseModule::ExerciseModule(D3D12Module* d3d12)
 {
 	this->d3d12 = d3d12;
@@ -22,6 +24,10 @@ ExerciseModule::ExerciseModule(D3D12Module* d3d12)
 	exe6 = new Exercise6();
 	exe7 = new Exercise7();
 	exe8 = new Exercise8();
+
+	Module* exercises[EXERCISE_COUNT] = { exe1, exe2, exe3, exe4, exe5, exe6, exe7, exe8 };
+	for (int i = 0; i < EXERCISE_COUNT; ++i)
+		slots[i].exercise = exercises[i];
 }
 
 ExerciseModule::~ExerciseModule()
@@ -30,27 +36,20 @@ ExerciseModule::~ExerciseModule()
 
 bool ExerciseModule::init()
 {
-	Logger::Log("Initializing ExerciseModule...");
-	Timer t;
-	t.Start();
-
-	exe1->init();
-	exe2->init();
-	exe3->init();
-	exe4->init();
-	exe5->init();
-	exe6->init();
-	exe7->init();
-	exe8->init();
-
-
-	t.Stop();
-	Logger::Log("ExerciseModule initialized in: " + std::to_string(t.ReadMs()) + " ms.");
+	// Exercises load on first use (activate())
+	Logger::Log("ExerciseModule ready, " + std::to_string(EXERCISE_COUNT) + " exercises load on demand");
 	return true;
 }
 
 bool ExerciseModule::cleanUp()
 {
+	// Loads still running use the exercises
+	if (JobSystem* jobs = app->getJobSystem())
+	{
+		for (Slot& slot : slots)
+			jobs->wait(slot.job);
+	}
+
 	delete exe1;
 	delete exe2;
 	delete exe3;
@@ -68,44 +67,106 @@ void ExerciseModule::render()
 	
 }
 
+void ExerciseModule::load(Slot& slot, int index)
+{
+	Timer t;
+	t.Start();
+
+	const bool ok = slot.exercise->init();
+
+	t.Stop();
+	slot.loadMs = t.ReadMs();
+
+	if (ok)
+		Logger::Log("Exercise " + std::to_string(index + 1) + " initialized in: " + std::to_string(slot.loadMs) + " ms.");
+	else
+		Logger::Err("Exercise " + std::to_string(index + 1) + " failed to initialize");
+
+	// Release: the render thread sees everything init() wrote
+	slot.state.store(ok ? State::Ready : State::Failed, std::memory_order_release);
+}
+
+void ExerciseModule::startLoading(int index, bool background)
+{
+	Slot& slot = slots[index];
+	if (slot.state.load(std::memory_order_acquire) != State::NotLoaded)
+		return;
+
+	JobSystem* jobs = app->getJobSystem();
+	if (!jobs || jobs->getWorkerCount() == 0)
+	{
+		// No workers: shown exercises load right here, prefetching would only stall the frame
+		if (background)
+			return;
+
+		slot.state.store(State::Loading, std::memory_order_relaxed);
+		load(slot, index);
+		return;
+	}
+
+	slot.state.store(State::Loading, std::memory_order_relaxed);
+	jobs->run([this, &slot, index]() { load(slot, index); }, &slot.job);
+}
+
+bool ExerciseModule::activate(int index)
+{
+	startLoading(index, false);
+
+	if (getState(index) != State::Ready)
+		return false;
+
+	if (prefetchNext && index + 1 < EXERCISE_COUNT)
+		startLoading(index + 1, true);
+
+	return true;
+}
+
 void ExerciseModule::exercise1()
 {
-	exe1->render();
+	if (activate(0))
+		exe1->render();
 }
 
 void ExerciseModule::exercise2()
 {
-	exe2->render();
+	if (activate(1))
+		exe2->render();
 }
 
 void ExerciseModule::exercise3()
 {
-	exe3->render();
+	if (activate(2))
+		exe3->render();
 }
 
 void ExerciseModule::exercise4()
 {
-	exe4->render();
+	if (activate(3))
+		exe4->render();
 }
 
 void ExerciseModule::exercise5()
 {
-	exe5->render();
+	if (activate(4))
+		exe5->render();
 }
 
 void ExerciseModule::exercise6()
 {
-	exe6->render();
+	if (activate(5))
+		exe6->render();
 }
 
 void ExerciseModule::exercise7()
 {
-	exe7->render();
+	if (activate(6))
+		exe7->render();
 }
 
 void ExerciseModule::exercise8()
 {
-	exe8->render();
+	if (activate(7))
+		exe8->render();
 }
 
 
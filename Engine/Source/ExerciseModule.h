@@ -1,6 +1,10 @@
 #pragma once
 #include "Module.h"
 #include "D3D12Module.h"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <functional>
 
 class Exercise1;
 class Exercise2;
@@ -11,9 +15,40 @@ class Exercise6;
 class Exercise7;
 class Exercise8;
 
+// ----------------------------------------------------------------------------
+// ExerciseModule owns the exercises and initializes them lazily: nothing
+// loads at start-up, an exercise starts loading the first time it is shown
+// and renders once it is ready. Loading runs as a job (model, textures and
+// pipelines of one exercise load in parallel on the workers), so the frame
+// keeps going meanwhile.
+//
+// With prefetchNext, the exercise after the one being shown loads in the
+// background once the shown one is ready (the next one in the list is the
+// likely next pick).
+// ----------------------------------------------------------------------------
+
 class ExerciseModule : public Module
 {
+public:
+	static constexpr int EXERCISE_COUNT = 8;
+
+	enum class State
+	{
+		NotLoaded,
+		Loading,
+		Ready,
+		Failed
+	};
+
 private:
+	struct Slot
+	{
+		Module* exercise = nullptr;
+		std::atomic<State> state{ State::NotLoaded };
+		JobCounter job;
+		double loadMs = 0.0;
+	};
+
 	D3D12Module* d3d12 = nullptr;
 
 	Exercise1* exe1 = nullptr;
@@ -25,6 +60,15 @@ private:
 	Exercise7* exe7 = nullptr;
 	Exercise8* exe8 = nullptr;
 
+	Slot slots[EXERCISE_COUNT];
+	bool prefetchNext = true;
+
+	void load(Slot& slot, int index);
+	void startLoading(int index, bool background);
+
+	// True when exercise 'index' can render; starts loading it otherwise
+	bool activate(int index);
+
 public:
 	ExerciseModule(D3D12Module* d3d12);
 	~ExerciseModule();
@@ -42,5 +86,11 @@ public:
 	void exercise7();
 	void exercise8();
 
-};
+	// 'index' is 0 based (exercise1() is 0)
+	State getState(int index) const { return slots[index].state.load(std::memory_order_acquire); }
+	double getLoadMs(int index) const { return getState(index) == State::Ready ? slots[index].loadMs : 0.0; }
+
+	bool getPrefetchNext() const { return prefetchNext; }
+	void setPrefetchNext(bool value) { prefetchNext = value; }
 
+};
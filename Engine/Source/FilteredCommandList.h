@@ -0,0 +1,364 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <d3d12.h>
+
+// ============================================================================
+// FilteredCommandList
+// ----------------------------------------------------------------------------
+// Thin recording wrapper in front of a graphics command list that remembers
+// the last bound state and drops calls that would bind it again.
+//
+// Filtered state:
+// - PSO, graphics root signature and descriptor heaps.
+// - Root descriptor tables, root CBV/SRV addresses and root 32-bit constants.
+// - Vertex buffer views (first MAX_VERTEX_SLOTS slots), index buffer view and
+//   primitive topology.
+// - Resource barriers: transitions whose before and after states are the
+//   same are dropped, the rest of the batch is forwarded in order.
+//
+// Invalidation rules (same as D3D12):
+// - A new root signature makes every root argument stale.
+// - New descriptor heaps make every cached descriptor table stale.
+// - reset() must be called whenever the underlying list is Reset(), and
+//   invalidate() after anything records state through the raw list (ImGui,
+//   debug draw, ...), since the cache would not see those calls.
+//
+// Every other command (draws, clears, copies, ...) goes through get().
+//
+// Header-only template over the command list type: the engine uses
+// ID3D12GraphicsCommandList, the headless tests (Engine/Tests) a mock that
+// records the calls it receives. Only the D3D12 structs / enums are needed,
+// never a device.
+// ============================================================================
+
+template<class CommandList>
+class FilteredCommandListT
+{
+public:
+    enum class Call
+    {
+        PipelineState = 0,
+        RootSignature,
+        DescriptorHeaps,
+        RootDescriptorTable,
+        RootCBV,
+        RootSRV,
+        RootConstants,
+        VertexBuffers,
+        IndexBuffer,
+        Topology,
+        Barriers,
+        Count
+    };
+
+    struct Stats
+    {
+        uint32_t issued[size_t(Call::Count)] = {};
+        uint32_t filtered[size_t(Call::Count)] = {};
+
+        uint32_t totalIssued() const { uint32_t t = 0; for (uint32_t v : issued) t += v; return t; }
+        uint32_t totalFiltered() const { uint32_t t = 0; for (uint32_t v : filtered) t += v; return t; }
+    };
+
+    static constexpr uint32_t MAX_ROOT_PARAMS = 64;
+    static constexpr uint32_t MAX_ROOT_CONSTANTS = 64;      // DWORDs, whole root signature budget
+    static constexpr uint32_t MAX_VERTEX_SLOTS = 4;
+    static constexpr uint32_t MAX_HEAPS = 2;
+    static constexpr uint32_t MAX_BARRIER_BATCH = 16;       // forwarded in batches of up to this many
+
+private:
+    enum class RootKind : uint8_t { None = 0, Table, CBV, SRV, Constants };
+
+    struct RootSlot
+    {
+        RootKind kind = RootKind::None;
+        uint64_t value = 0;             // GPU handle / GPU VA
+    };
+
+    CommandList* list = nullptr;
+
+    const void* pipelineState = nullptr;
+    const void* rootSignature = nullptr;
+
+    const void* heaps[MAX_HEAPS] = {};
+    uint32_t    heapCount = 0;
+
+    RootSlot rootSlots[MAX_ROOT_PARAMS];
+
+    // Root constants are cached per DWORD of the parameter they belong to
+    uint32_t constants[MAX_ROOT_PARAMS][MAX_ROOT_CONSTANTS];
+    uint64_t constantsValid[MAX_ROOT_PARAMS] = {};          // bit per DWORD
+
+    D3D12_VERTEX_BUFFER_VIEW vertexViews[MAX_VERTEX_SLOTS] = {};
+    bool                     vertexViewValid[MAX_VERTEX_SLOTS] = {};
+
+    D3D12_INDEX_BUFFER_VIEW indexView = {};
+    bool                    indexViewValid = false;
+
+    D3D12_PRIMITIVE_TOPOLOGY topology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+
+    Stats stats;
+
+    void count(Call call, bool issue)
+    {
+        if (issue) ++stats.issued[size_t(call)];
+        else       ++stats.filtered[size_t(call)];
+    }
+
+    void invalidateRoot()
+    {
+        for (RootSlot& slot : rootSlots)
+            slot = RootSlot();
+        for (uint64_t& valid : constantsValid)
+            valid = 0;
+    }
+
+    void invalidateTables()
+    {
+        for (RootSlot& slot : rootSlots)
+        {
+            if (slot.kind == RootKind::Table)
+                slot = RootSlot();
+        }
+    }
+
+    bool setRootSlot(UINT index, RootKind kind, uint64_t value)
+    {
+        if (index >= MAX_ROOT_PARAMS)
+            return true;
+
+        RootSlot& slot = rootSlots[index];
+        if (slot.kind == kind && slot.value == value)
+            return false;
+
+        slot.kind = kind;
+        slot.value = value;
+        return true;
+    }
+
+public:
+    FilteredCommandListT() { invalidate(); }
+    explicit FilteredCommandListT(CommandList* commandList) : list(commandList) { invalidate(); }
+
+    // Binds the wrapper to a (freshly reset) command list and clears the cache
+    void reset(CommandList* commandList)
+    {
+        list = commandList;
+        invalidate();
+    }
+
+    // Forgets all cached state; the next call of every kind is issued
+    void invalidate()
+    {
+        pipelineState = nullptr;
+        rootSignature = nullptr;
+        heapCount = 0;
+        for (const void*& heap : heaps)
+            heap = nullptr;
+        invalidateRoot();
+        for (bool& valid : vertexViewValid)
+            valid = false;
+        indexViewValid = false;
+        topology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    }
+
+    CommandList* get() const { return list; }
+    CommandList* operator->() const { return list; }
+
+    const Stats& getStats() const { return stats; }
+    void resetStats() { stats = Stats(); }
+
+    // Counts of another list of the same frame (parallel recording)
+    void addStats(const Stats& other)
+    {
+        for (size_t i = 0; i < size_t(Call::Count); ++i)
+        {
+            stats.issued[i] += other.issued[i];
+            stats.filtered[i] += other.filtered[i];
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // Pipeline / root signature / heaps
+    // ------------------------------------------------------------------------
+    void SetPipelineState(ID3D12PipelineState* pso)
+    {
+        bool issue = pso != pipelineState;
+        count(Call::PipelineState, issue);
+        if (!issue) return;
+
+        pipelineState = pso;
+        list->SetPipelineState(pso);
+    }
+
+    void SetGraphicsRootSignature(ID3D12RootSignature* signature)
+    {
+        bool issue = signature != rootSignature;
+        count(Call::RootSignature, issue);
+        if (!issue) return;
+
+        rootSignature = signature;
+        invalidateRoot();
+        list->SetGraphicsRootSignature(signature);
+    }
+
+    void SetDescriptorHeaps(UINT numHeaps, ID3D12DescriptorHeap* const* descriptorHeaps)
+    {
+        bool issue = numHeaps != heapCount || numHeaps > MAX_HEAPS;
+        for (UINT i = 0; !issue && i < numHeaps; ++i)
+            issue = descriptorHeaps[i] != heaps[i];
+
+        count(Call::DescriptorHeaps, issue);
+        if (!issue) return;
+
+        heapCount = numHeaps <= MAX_HEAPS ? numHeaps : 0;
+        for (UINT i = 0; i < MAX_HEAPS; ++i)
+            heaps[i] = (i < heapCount) ? descriptorHeaps[i] : nullptr;
+
+        invalidateTables();
+        list->SetDescriptorHeaps(numHeaps, descriptorHeaps);
+    }
+
+    // ------------------------------------------------------------------------
+    // Root arguments
+    // ------------------------------------------------------------------------
+    void SetGraphicsRootDescriptorTable(UINT index, D3D12_GPU_DESCRIPTOR_HANDLE handle)
+    {
+        bool issue = setRootSlot(index, RootKind::Table, handle.ptr);
+        count(Call::RootDescriptorTable, issue);
+        if (issue) list->SetGraphicsRootDescriptorTable(index, handle);
+    }
+
+    void SetGraphicsRootConstantBufferView(UINT index, D3D12_GPU_VIRTUAL_ADDRESS address)
+    {
+        bool issue = setRootSlot(index, RootKind::CBV, address);
+        count(Call::RootCBV, issue);
+        if (issue) list->SetGraphicsRootConstantBufferView(index, address);
+    }
+
+    void SetGraphicsRootShaderResourceView(UINT index, D3D12_GPU_VIRTUAL_ADDRESS address)
+    {
+        bool issue = setRootSlot(index, RootKind::SRV, address);
+        count(Call::RootSRV, issue);
+        if (issue) list->SetGraphicsRootShaderResourceView(index, address);
+    }
+
+    void SetGraphicsRoot32BitConstants(UINT index, UINT num32BitValues, const void* data, UINT destOffset)
+    {
+        bool issue = true;
+
+        if (index < MAX_ROOT_PARAMS && destOffset + num32BitValues <= MAX_ROOT_CONSTANTS && num32BitValues > 0)
+        {
+            const uint64_t mask = ((num32BitValues == 64) ? ~uint64_t(0) : ((uint64_t(1) << num32BitValues) - 1)) << destOffset;
+
+            issue = (constantsValid[index] & mask) != mask ||
+                std::memcmp(&constants[index][destOffset], data, num32BitValues * sizeof(uint32_t)) != 0;
+
+            if (issue)
+            {
+                std::memcpy(&constants[index][destOffset], data, num32BitValues * sizeof(uint32_t));
+                constantsValid[index] |= mask;
+            }
+        }
+
+        count(Call::RootConstants, issue);
+        if (issue) list->SetGraphicsRoot32BitConstants(index, num32BitValues, data, destOffset);
+    }
+
+    // ------------------------------------------------------------------------
+    // Input assembler
+    // ------------------------------------------------------------------------
+    void IASetVertexBuffers(UINT startSlot, UINT numViews, const D3D12_VERTEX_BUFFER_VIEW* views)
+    {
+        bool issue = views == nullptr || startSlot + numViews > MAX_VERTEX_SLOTS;
+        for (UINT i = 0; !issue && i < numViews; ++i)
+        {
+            const D3D12_VERTEX_BUFFER_VIEW& cached = vertexViews[startSlot + i];
+            issue = !vertexViewValid[startSlot + i] ||
+                cached.BufferLocation != views[i].BufferLocation ||
+                cached.SizeInBytes != views[i].SizeInBytes ||
+                cached.StrideInBytes != views[i].StrideInBytes;
+        }
+
+        count(Call::VertexBuffers, issue);
+        if (!issue) return;
+
+        for (UINT i = 0; i < numViews && startSlot + i < MAX_VERTEX_SLOTS; ++i)
+        {
+            vertexViewValid[startSlot + i] = views != nullptr;
+            if (views) vertexViews[startSlot + i] = views[i];
+        }
+
+        list->IASetVertexBuffers(startSlot, numViews, views);
+    }
+
+    void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view)
+    {
+        bool issue = view == nullptr || !indexViewValid ||
+            indexView.BufferLocation != view->BufferLocation ||
+            indexView.SizeInBytes != view->SizeInBytes ||
+            indexView.Format != view->Format;
+
+        count(Call::IndexBuffer, issue);
+        if (!issue) return;
+
+        indexViewValid = view != nullptr;
+        if (view) indexView = *view;
+
+        list->IASetIndexBuffer(view);
+    }
+
+    void IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY primitiveTopology)
+    {
+        bool issue = primitiveTopology != topology;
+        count(Call::Topology, issue);
+        if (!issue) return;
+
+        topology = primitiveTopology;
+        list->IASetPrimitiveTopology(primitiveTopology);
+    }
+
+    // ------------------------------------------------------------------------
+    // Barriers
+    // ------------------------------------------------------------------------
+    void ResourceBarrier(UINT numBarriers, const D3D12_RESOURCE_BARRIER* barriers)
+    {
+        D3D12_RESOURCE_BARRIER batch[MAX_BARRIER_BATCH];
+        UINT batchSize = 0;
+
+        for (UINT i = 0; i < numBarriers; ++i)
+        {
+            const D3D12_RESOURCE_BARRIER& barrier = barriers[i];
+            const bool issue = barrier.Type != D3D12_RESOURCE_BARRIER_TYPE_TRANSITION ||
+                barrier.Transition.StateBefore != barrier.Transition.StateAfter;
+
+            count(Call::Barriers, issue);
+            if (!issue) continue;
+
+            batch[batchSize++] = barrier;
+            if (batchSize == MAX_BARRIER_BATCH)
+            {
+                list->ResourceBarrier(batchSize, batch);
+                batchSize = 0;
+            }
+        }
+
+        if (batchSize)
+            list->ResourceBarrier(batchSize, batch);
+    }
+};
+
+using FilteredCommandList = FilteredCommandListT<ID3D12GraphicsCommandList>;
+
+inline const char* filteredCallName(size_t call)
+{
+    static const char* names[] =
+    {
+        "PSO", "Root Signature", "Descriptor Heaps", "Root Tables",
+        "Root CBV", "Root SRV", "Root Constants", "Vertex Buffers",
+        "Index Buffer", "Topology", "Barriers"
+    };
+    return call < sizeof(names) / sizeof(names[0]) ? names[call] : "?";
+}
@@ -0,0 +1,314 @@
+#include "Globals.h"
+#include "GpuHeapAllocator.h"
+
+#include <algorithm>
+
+GpuHeapAllocator::GpuHeapAllocator(ID3D12Device* device) : device(device)
+{
+}
+
+GpuHeapAllocator::~GpuHeapAllocator()
+{
+}
+
+bool GpuHeapAllocator::createBufferHeap(BufferHeap& heap)
+{
+    // ------------------------------------------------------------
+    // One heap, one placed buffer over all of it: ranges of that
+    // buffer are the static buffers
+    // ------------------------------------------------------------
+    CD3DX12_HEAP_DESC heapDesc(HEAP_SIZE, D3D12_HEAP_TYPE_DEFAULT, 0, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS);
+    if (FAILED(device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap.heap))))
+        return false;
+
+    CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(HEAP_SIZE);
+    if (FAILED(device->CreatePlacedResource(heap.heap.Get(), 0, &desc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&heap.buffer))))
+    {
+        heap.heap.Reset();
+        return false;
+    }
+
+    heap.buffer->SetName(L"Static Buffer Heap");
+    return true;
+}
+
+GpuAllocationPtr GpuHeapAllocator::allocateBuffer(uint64_t size, uint64_t alignment)
+{
+    if (size > MAX_PLACED_SIZE)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // ------------------------------------------------------------
+    // First heap with room, otherwise a new one
+    // ------------------------------------------------------------
+    uint32_t heapIndex = 0;
+    HeapSuballocator::Allocation range;
+    for (; heapIndex < bufferHeaps.size(); ++heapIndex)
+    {
+        range = bufferHeaps[heapIndex]->ranges.allocate(size, alignment);
+        if (range.isValid())
+            break;
+    }
+
+    if (!range.isValid())
+    {
+        auto heap = std::make_unique<BufferHeap>();
+        if (!createBufferHeap(*heap))
+        {
+            Logger::Err("GpuHeapAllocator: failed to create a " + std::to_string(HEAP_SIZE >> 20) + "MB buffer heap");
+            return nullptr;
+        }
+
+        heapIndex = uint32_t(bufferHeaps.size());
+        range = heap->ranges.allocate(size, alignment);
+        bufferHeaps.push_back(std::move(heap));
+    }
+
+    BufferHeap& heap = *bufferHeaps[heapIndex];
+    if (heap.owners.size() <= range.handle)
+        heap.owners.resize(range.handle + 1, nullptr);
+
+    // The last copy of the owner hands the range back
+    const uint32_t handle = range.handle;
+    GpuAllocationPtr allocation(new GpuAllocation(), [this, heapIndex, handle](GpuAllocation* a)
+        {
+            release(heapIndex, handle);
+            delete a;
+        });
+
+    allocation->resource = heap.buffer.Get();
+    allocation->offset = range.offset;
+    allocation->size = size;
+    heap.owners[handle] = allocation.get();
+
+    return allocation;
+}
+
+void GpuHeapAllocator::release(uint32_t heap, uint32_t handle)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    bufferHeaps[heap]->owners[handle] = nullptr;
+
+    // In-flight frames may still read it
+    PendingFree pending;
+    pending.heap = heap;
+    pending.handle = handle;
+    pending.fence = lastFrameFence;
+    pendingFrees.push_back(std::move(pending));
+}
+
+ComPtr<ID3D12Resource> GpuHeapAllocator::createTexture(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState)
+{
+    // Render / depth targets need other heaps (and are few): committed
+    if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+        return nullptr;
+
+    // ------------------------------------------------------------
+    // Small textures may use the 4 KB placement; the device says no
+    // by reporting a different alignment
+    // ------------------------------------------------------------
+    D3D12_RESOURCE_DESC placed = desc;
+    D3D12_RESOURCE_ALLOCATION_INFO info = {};
+
+    if (desc.SampleDesc.Count <= 1)
+    {
+        placed.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+        info = device->GetResourceAllocationInfo(0, 1, &placed);
+    }
+
+    if (info.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+    {
+        placed.Alignment = 0;
+        info = device->GetResourceAllocationInfo(0, 1, &placed);
+    }
+
+    if (info.SizeInBytes == UINT64_MAX || info.SizeInBytes > MAX_PLACED_SIZE)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint32_t heapIndex = 0;
+    HeapSuballocator::Allocation range;
+    for (; heapIndex < textureHeaps.size(); ++heapIndex)
+    {
+        range = textureHeaps[heapIndex]->ranges.allocate(info.SizeInBytes, info.Alignment);
+        if (range.isValid())
+            break;
+    }
+
+    if (!range.isValid())
+    {
+        auto heap = std::make_unique<TextureHeap>();
+
+        CD3DX12_HEAP_DESC heapDesc(HEAP_SIZE, D3D12_HEAP_TYPE_DEFAULT, 0, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES);
+        if (FAILED(device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap->heap))))
+        {
+            Logger::Err("GpuHeapAllocator: failed to create a " + std::to_string(HEAP_SIZE >> 20) + "MB texture heap");
+            return nullptr;
+        }
+
+        heapIndex = uint32_t(textureHeaps.size());
+        range = heap->ranges.allocate(info.SizeInBytes, info.Alignment);
+        textureHeaps.push_back(std::move(heap));
+    }
+
+    PlacedTexture texture;
+    texture.heap = heapIndex;
+    texture.handle = range.handle;
+
+    if (FAILED(device->CreatePlacedResource(textureHeaps[heapIndex]->heap.Get(), range.offset, &placed, initialState, nullptr, IID_PPV_ARGS(&texture.resource))))
+    {
+        textureHeaps[heapIndex]->ranges.free(range.handle);
+        return nullptr;
+    }
+
+    textures.push_back(texture);
+    return texture.resource;
+}
+
+void GpuHeapAllocator::collect(uint64_t frameFence, uint64_t completedFence)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // ------------------------------------------------------------
+    // Textures only we still reference were dropped by their owner
+    // ------------------------------------------------------------
+    for (size_t i = 0; i < textures.size();)
+    {
+        ID3D12Resource* resource = textures[i].resource.Get();
+        resource->AddRef();
+        if (resource->Release() > 1)
+        {
+            ++i;
+            continue;
+        }
+
+        PendingFree pending;
+        pending.texture = true;
+        pending.heap = textures[i].heap;
+        pending.handle = textures[i].handle;
+        pending.resource = std::move(textures[i].resource);
+        pending.fence = lastFrameFence;
+        pendingFrees.push_back(std::move(pending));
+
+        if (i + 1 < textures.size())
+            textures[i] = std::move(textures.back());
+        textures.pop_back();
+    }
+
+    // ------------------------------------------------------------
+    // A frame submitted after the free has completed: nothing in
+    // flight can read the memory any more
+    // ------------------------------------------------------------
+    for (size_t i = 0; i < pendingFrees.size();)
+    {
+        PendingFree& pending = pendingFrees[i];
+        if (pending.fence >= frameFence || completedFence < frameFence)
+        {
+            ++i;
+            continue;
+        }
+
+        // Release the resource before its memory is reused
+        pending.resource.Reset();
+
+        if (pending.handle != HeapSuballocator::INVALID)
+        {
+            if (pending.texture)
+                textureHeaps[pending.heap]->ranges.free(pending.handle);
+            else
+                bufferHeaps[pending.heap]->ranges.free(pending.handle);
+        }
+
+        if (i + 1 < pendingFrees.size())
+            pendingFrees[i] = std::move(pendingFrees.back());
+        pendingFrees.pop_back();
+    }
+
+    lastFrameFence = frameFence;
+}
+
+uint32_t GpuHeapAllocator::defragment(ID3D12GraphicsCommandList* cmd, bool force)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint32_t compacted = 0;
+    for (std::unique_ptr<BufferHeap>& heap : bufferHeaps)
+    {
+        const HeapSuballocator::Stats stats = heap->ranges.getStats();
+        if (heap->ranges.isEmpty() || stats.freeBlocks <= 1 || (!force && stats.fragmentation() < DEFRAGMENT_THRESHOLD))
+            continue;
+
+        // ------------------------------------------------------------
+        // Pack the live ranges into a fresh heap: the old one keeps its
+        // contents for the frames still reading it
+        // ------------------------------------------------------------
+        BufferHeap fresh;
+        if (!createBufferHeap(fresh))
+        {
+            Logger::Warn("GpuHeapAllocator: no memory for a compacted heap, defragmentation skipped");
+            break;
+        }
+
+        for (const HeapSuballocator::Relocation& relocation : heap->ranges.defragment())
+        {
+            cmd->CopyBufferRegion(fresh.buffer.Get(), relocation.to, heap->buffer.Get(), relocation.from, relocation.size);
+            movedBytes += relocation.size;
+
+            // Freed but still pending: nobody to update
+            if (GpuAllocation* owner = heap->owners[relocation.handle])
+            {
+                owner->resource = fresh.buffer.Get();
+                owner->offset = relocation.to;
+            }
+        }
+
+        PendingFree retired;
+        retired.resource = heap->buffer;
+        retired.retiredHeap = heap->heap;
+        retired.fence = lastFrameFence;
+        pendingFrees.push_back(std::move(retired));
+
+        heap->heap = fresh.heap;
+        heap->buffer = fresh.buffer;
+
+        ++compacted;
+        ++defragmentCount;
+    }
+
+    return compacted;
+}
+
+GpuHeapAllocator::Stats GpuHeapAllocator::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Stats stats;
+    stats.bufferHeaps = uint32_t(bufferHeaps.size());
+    stats.textureHeaps = uint32_t(textureHeaps.size());
+    stats.textures = uint32_t(textures.size());
+    stats.pendingFrees = uint32_t(pendingFrees.size());
+    stats.defragmentations = defragmentCount;
+    stats.bytesMoved = movedBytes;
+
+    for (const std::unique_ptr<BufferHeap>& heap : bufferHeaps)
+    {
+        const HeapSuballocator::Stats ranges = heap->ranges.getStats();
+        stats.buffers += ranges.allocations;
+        stats.bufferBytes += ranges.used;
+        stats.bufferCapacity += ranges.capacity;
+        stats.bufferFragmentation = std::max(stats.bufferFragmentation, ranges.fragmentation());
+    }
+
+    for (const std::unique_ptr<TextureHeap>& heap : textureHeaps)
+    {
+        const HeapSuballocator::Stats ranges = heap->ranges.getStats();
+        stats.textureBytes += ranges.used;
+        stats.textureCapacity += ranges.capacity;
+        stats.textureFragmentation = std::max(stats.textureFragmentation, ranges.fragmentation());
+    }
+
+    return stats;
+}
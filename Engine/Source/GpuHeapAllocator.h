@@ -0,0 +1,141 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "HeapSuballocator.h"
+
+// ============================================================================
+// GpuHeapAllocator
+// ----------------------------------------------------------------------------
+// Static GPU memory (mesh buffers, material constants, textures) carved out
+// of a few big ID3D12Heaps instead of one committed resource each.
+//
+// - Buffers: every buffer heap holds ONE placed buffer covering it, and
+//   static buffers are ranges of it (256-byte aligned, the CBV rule). A
+//   48-byte material constant buffer no longer costs a 64 KB resource.
+//   They are handed out as GpuAllocationPtr, shared by every copy of the
+//   owner; the range is freed when the last copy goes away.
+// - Textures: placed resources in texture-only heaps (resource heap tier 1
+//   keeps buffers and textures apart). Small textures ask for the 4 KB
+//   placement, the rest get what the device reports (64 KB, 4 MB MSAA).
+//   They are returned as plain ComPtrs like before: collect() frees the
+//   ones nobody else references any more.
+// - Resources bigger than MAX_PLACED_SIZE are not worth a heap slot: the
+//   caller falls back to a committed resource.
+// - Frees wait for the GPU: a range is reused only after a frame submitted
+//   after the free has completed (collect(), called once per frame).
+// - defragment() compacts fragmented buffer heaps into fresh ones with
+//   CopyBufferRegion. Owners read the address through their allocation
+//   (getGPUAddress()), so nothing needs patching. Textures are not moved:
+//   their SRVs would have to be rewritten.
+//
+// The offset bookkeeping is HeapSuballocator (TLSF, no D3D12 inside).
+// Thread safe.
+// ============================================================================
+
+class GpuHeapAllocator;
+
+struct GpuAllocation
+{
+    ID3D12Resource* resource = nullptr;     // the pool buffer (owned by the allocator)
+    uint64_t        offset = 0;             // changes on defragment
+    uint64_t        size = 0;
+
+    D3D12_GPU_VIRTUAL_ADDRESS getGPUAddress() const { return resource->GetGPUVirtualAddress() + offset; }
+};
+
+using GpuAllocationPtr = std::shared_ptr<GpuAllocation>;
+
+class GpuHeapAllocator
+{
+public:
+    static constexpr uint64_t HEAP_SIZE = 64ull * 1024 * 1024;
+    static constexpr uint64_t MAX_PLACED_SIZE = HEAP_SIZE / 2;
+    static constexpr float    DEFRAGMENT_THRESHOLD = 0.5f;      // fragmentation of a buffer heap worth compacting
+
+    struct Stats
+    {
+        uint32_t bufferHeaps = 0;
+        uint32_t textureHeaps = 0;
+        uint32_t buffers = 0;
+        uint32_t textures = 0;
+        uint64_t bufferBytes = 0;           // used / capacity of the buffer heaps
+        uint64_t bufferCapacity = 0;
+        uint64_t textureBytes = 0;
+        uint64_t textureCapacity = 0;
+        float    bufferFragmentation = 0.0f;    // worst buffer heap
+        float    textureFragmentation = 0.0f;
+        uint32_t pendingFrees = 0;          // waiting for the GPU
+        uint32_t defragmentations = 0;      // heaps compacted so far
+        uint64_t bytesMoved = 0;
+    };
+
+private:
+    struct BufferHeap
+    {
+        ComPtr<ID3D12Heap>          heap;
+        ComPtr<ID3D12Resource>      buffer;
+        HeapSuballocator            ranges{ HEAP_SIZE };
+        std::vector<GpuAllocation*> owners;     // per range handle
+    };
+
+    struct TextureHeap
+    {
+        ComPtr<ID3D12Heap> heap;
+        HeapSuballocator   ranges{ HEAP_SIZE };
+    };
+
+    struct PlacedTexture
+    {
+        ComPtr<ID3D12Resource> resource;
+        uint32_t heap = 0;
+        uint32_t handle = HeapSuballocator::INVALID;
+    };
+
+    struct PendingFree
+    {
+        bool                   texture = false;
+        uint32_t               heap = 0;
+        uint32_t               handle = HeapSuballocator::INVALID;
+        ComPtr<ID3D12Resource> resource;    // released with the range (textures, old pool buffers)
+        ComPtr<ID3D12Heap>     retiredHeap; // old heap after a defragment (no range)
+        uint64_t               fence = 0;   // last frame fence when it was freed
+    };
+
+    ID3D12Device* device = nullptr;
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<BufferHeap>>  bufferHeaps;
+    std::vector<std::unique_ptr<TextureHeap>> textureHeaps;
+    std::vector<PlacedTexture>                textures;
+    std::vector<PendingFree>                  pendingFrees;
+    uint64_t                                  lastFrameFence = 0;
+
+    uint32_t defragmentCount = 0;
+    uint64_t movedBytes = 0;
+
+    bool createBufferHeap(BufferHeap& heap);
+    void release(uint32_t heap, uint32_t handle);
+
+public:
+    explicit GpuHeapAllocator(ID3D12Device* device);
+    ~GpuHeapAllocator();
+
+    // Range of a pool buffer (left in COMMON: copies and reads promote it). Null when it does not fit.
+    GpuAllocationPtr allocateBuffer(uint64_t size, uint64_t alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+
+    // Placed texture. Null when it is too big or the device refuses it.
+    ComPtr<ID3D12Resource> createTexture(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState);
+
+    // Once per frame: frees whatever the GPU is done with
+    void collect(uint64_t frameFence, uint64_t completedFence);
+
+    // Records the copies that compact fragmented buffer heaps. The caller
+    // executes 'cmd' before the next frame reads the buffers. Returns the
+    // number of heaps compacted.
+    uint32_t defragment(ID3D12GraphicsCommandList* cmd, bool force = false);
+
+    Stats getStats() const;
+};
@@ -0,0 +1,384 @@
+// Plain C++ on purpose (no Globals.h / precompiled header): this file has to
+// build outside the engine for headless tests.
+#include "HeapSuballocator.h"
+
+#include <algorithm>
+#include <cassert>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    inline uint64_t alignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // Index of the highest set bit (value != 0)
+    inline uint32_t highestBit(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return uint32_t(index);
+#else
+        return 63u - uint32_t(__builtin_clzll(value));
+#endif
+    }
+
+    // Index of the lowest set bit (value != 0)
+    inline uint32_t lowestBit(uint32_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, value);
+        return uint32_t(index);
+#else
+        return uint32_t(__builtin_ctz(value));
+#endif
+    }
+}
+
+HeapSuballocator::HeapSuballocator(uint64_t size) : capacity(size / GRANULARITY * GRANULARITY)
+{
+    // Biggest size the two levels can classify
+    assert(capacity / GRANULARITY < (1ull << (FL_COUNT + SL_LOG2 - 1)));
+
+    for (uint32_t fl = 0; fl < FL_COUNT; ++fl)
+    {
+        for (uint32_t sl = 0; sl < SL_COUNT; ++sl)
+            heads[fl][sl] = INVALID;
+    }
+
+    if (capacity == 0)
+        return;
+
+    const uint32_t index = newBlock();
+    blocks[index].offset = 0;
+    blocks[index].size = capacity;
+    blocks[index].free = true;
+    insertFree(index);
+}
+
+void HeapSuballocator::mapping(uint64_t units, uint32_t& fl, uint32_t& sl)
+{
+    // Small sizes: one list per size. Bigger: power of two + SL_COUNT linear steps
+    if (units < SL_COUNT)
+    {
+        fl = 0;
+        sl = uint32_t(units);
+        return;
+    }
+
+    const uint32_t top = highestBit(units);
+    sl = uint32_t(units >> (top - SL_LOG2)) ^ SL_COUNT;
+    fl = top - SL_LOG2 + 1;
+}
+
+bool HeapSuballocator::mappingSearch(uint64_t units, uint32_t& fl, uint32_t& sl)
+{
+    // Round up to the next list start: every block from that list on is big enough
+    if (units >= SL_COUNT)
+        units += (1ull << (highestBit(units) - SL_LOG2)) - 1;
+
+    mapping(units, fl, sl);
+    return fl < FL_COUNT;
+}
+
+uint32_t HeapSuballocator::newBlock()
+{
+    uint32_t index;
+    if (!unusedSlots.empty())
+    {
+        index = unusedSlots.back();
+        unusedSlots.pop_back();
+        blocks[index] = Block();
+    }
+    else
+    {
+        index = uint32_t(blocks.size());
+        blocks.emplace_back();
+    }
+
+    blocks[index].inUse = true;
+    return index;
+}
+
+void HeapSuballocator::releaseBlock(uint32_t index)
+{
+    blocks[index].inUse = false;
+    blocks[index].free = false;
+    unusedSlots.push_back(index);
+}
+
+void HeapSuballocator::insertFree(uint32_t index)
+{
+    uint32_t fl, sl;
+    mapping(blocks[index].size / GRANULARITY, fl, sl);
+
+    Block& block = blocks[index];
+    block.prevFree = INVALID;
+    block.nextFree = heads[fl][sl];
+    if (block.nextFree != INVALID)
+        blocks[block.nextFree].prevFree = index;
+
+    heads[fl][sl] = index;
+    firstLevelMap |= 1u << fl;
+    secondLevelMap[fl] |= 1u << sl;
+}
+
+void HeapSuballocator::removeFree(uint32_t index)
+{
+    uint32_t fl, sl;
+    mapping(blocks[index].size / GRANULARITY, fl, sl);
+
+    Block& block = blocks[index];
+    if (block.prevFree != INVALID)
+        blocks[block.prevFree].nextFree = block.nextFree;
+    if (block.nextFree != INVALID)
+        blocks[block.nextFree].prevFree = block.prevFree;
+
+    if (heads[fl][sl] == index)
+    {
+        heads[fl][sl] = block.nextFree;
+        if (heads[fl][sl] == INVALID)
+        {
+            secondLevelMap[fl] &= ~(1u << sl);
+            if (secondLevelMap[fl] == 0)
+                firstLevelMap &= ~(1u << fl);
+        }
+    }
+
+    block.prevFree = block.nextFree = INVALID;
+}
+
+uint32_t HeapSuballocator::findFree(uint32_t fl, uint32_t sl) const
+{
+    // Same first level, this second level or bigger
+    uint32_t slMap = secondLevelMap[fl] & (~0u << sl);
+    if (slMap == 0)
+    {
+        // Any bigger first level
+        const uint32_t flMap = fl + 1 < FL_COUNT ? firstLevelMap & (~0u << (fl + 1)) : 0;
+        if (flMap == 0)
+            return INVALID;
+
+        fl = lowestBit(flMap);
+        slMap = secondLevelMap[fl];
+    }
+
+    return heads[fl][lowestBit(slMap)];
+}
+
+uint32_t HeapSuballocator::splitFront(uint32_t index, uint64_t size)
+{
+    // 'index' keeps the first 'size' bytes, the returned block gets the rest
+    const uint32_t rest = newBlock();
+
+    Block& block = blocks[index];
+    Block& tail = blocks[rest];
+    tail.offset = block.offset + size;
+    tail.size = block.size - size;
+    tail.prevPhysical = index;
+    tail.nextPhysical = block.nextPhysical;
+    if (tail.nextPhysical != INVALID)
+        blocks[tail.nextPhysical].prevPhysical = rest;
+
+    block.nextPhysical = rest;
+    block.size = size;
+    return rest;
+}
+
+HeapSuballocator::Allocation HeapSuballocator::allocate(uint64_t size, uint64_t alignment)
+{
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    size = alignUp(std::max<uint64_t>(size, 1), GRANULARITY);
+    alignment = std::max(alignment, GRANULARITY);
+
+    // ------------------------------------------------------------
+    // Any block of size + worst-case padding fits the aligned request
+    // ------------------------------------------------------------
+    uint32_t fl, sl;
+    if (!mappingSearch((size + alignment - GRANULARITY) / GRANULARITY, fl, sl))
+        return Allocation();
+
+    uint32_t index = findFree(fl, sl);
+    if (index == INVALID)
+        return Allocation();
+
+    removeFree(index);
+
+    // Front padding goes back to the free lists
+    const uint64_t padding = alignUp(blocks[index].offset, alignment) - blocks[index].offset;
+    if (padding > 0)
+    {
+        const uint32_t aligned = splitFront(index, padding);
+        blocks[index].free = true;
+        insertFree(index);
+        index = aligned;
+    }
+
+    // So does whatever is left after the block
+    if (blocks[index].size > size)
+    {
+        const uint32_t rest = splitFront(index, size);
+        blocks[rest].free = true;
+        insertFree(rest);
+    }
+
+    Block& block = blocks[index];
+    block.free = false;
+    block.alignment = alignment;
+
+    used += size;
+    ++allocationCount;
+
+    Allocation allocation;
+    allocation.offset = block.offset;
+    allocation.size = size;
+    allocation.handle = index;
+    return allocation;
+}
+
+void HeapSuballocator::free(uint32_t handle)
+{
+    assert(handle < blocks.size() && blocks[handle].inUse && !blocks[handle].free);
+
+    used -= blocks[handle].size;
+    --allocationCount;
+
+    // ------------------------------------------------------------
+    // Merge with free physical neighbours
+    // ------------------------------------------------------------
+    uint32_t index = handle;
+
+    const uint32_t prev = blocks[index].prevPhysical;
+    if (prev != INVALID && blocks[prev].free)
+    {
+        removeFree(prev);
+        blocks[prev].size += blocks[index].size;
+        blocks[prev].nextPhysical = blocks[index].nextPhysical;
+        if (blocks[prev].nextPhysical != INVALID)
+            blocks[blocks[prev].nextPhysical].prevPhysical = prev;
+
+        releaseBlock(index);
+        index = prev;
+    }
+
+    const uint32_t next = blocks[index].nextPhysical;
+    if (next != INVALID && blocks[next].free)
+    {
+        removeFree(next);
+        blocks[index].size += blocks[next].size;
+        blocks[index].nextPhysical = blocks[next].nextPhysical;
+        if (blocks[index].nextPhysical != INVALID)
+            blocks[blocks[index].nextPhysical].prevPhysical = index;
+
+        releaseBlock(next);
+    }
+
+    blocks[index].free = true;
+    insertFree(index);
+}
+
+std::vector<HeapSuballocator::Relocation> HeapSuballocator::defragment()
+{
+    // ------------------------------------------------------------
+    // Live blocks in address order; every free block is dropped and
+    // rebuilt from the packed layout
+    // ------------------------------------------------------------
+    std::vector<uint32_t> live;
+    live.reserve(allocationCount);
+    for (uint32_t i = 0; i < uint32_t(blocks.size()); ++i)
+    {
+        if (!blocks[i].inUse)
+            continue;
+
+        if (blocks[i].free)
+            releaseBlock(i);
+        else
+            live.push_back(i);
+    }
+
+    std::sort(live.begin(), live.end(), [this](uint32_t a, uint32_t b) { return blocks[a].offset < blocks[b].offset; });
+
+    firstLevelMap = 0;
+    for (uint32_t fl = 0; fl < FL_COUNT; ++fl)
+    {
+        secondLevelMap[fl] = 0;
+        for (uint32_t sl = 0; sl < SL_COUNT; ++sl)
+            heads[fl][sl] = INVALID;
+    }
+
+    std::vector<Relocation> relocations;
+    relocations.reserve(live.size());
+
+    uint64_t cursor = 0;
+    uint32_t previous = INVALID;
+
+    auto link = [&](uint32_t index)
+        {
+            blocks[index].prevPhysical = previous;
+            blocks[index].nextPhysical = INVALID;
+            if (previous != INVALID)
+                blocks[previous].nextPhysical = index;
+            previous = index;
+        };
+
+    auto addFree = [&](uint64_t offset, uint64_t size)
+        {
+            const uint32_t index = newBlock();
+            blocks[index].offset = offset;
+            blocks[index].size = size;
+            blocks[index].free = true;
+            link(index);
+            insertFree(index);
+        };
+
+    for (uint32_t index : live)
+    {
+        // Alignment gaps stay allocatable
+        const uint64_t to = alignUp(cursor, blocks[index].alignment);
+        if (to > cursor)
+            addFree(cursor, to - cursor);
+
+        Relocation relocation;
+        relocation.handle = index;
+        relocation.from = blocks[index].offset;
+        relocation.to = to;
+        relocation.size = blocks[index].size;
+        relocations.push_back(relocation);
+
+        blocks[index].offset = to;
+        link(index);
+        cursor = to + blocks[index].size;
+    }
+
+    if (cursor < capacity)
+        addFree(cursor, capacity - cursor);
+
+    return relocations;
+}
+
+HeapSuballocator::Stats HeapSuballocator::getStats() const
+{
+    Stats stats;
+    stats.capacity = capacity;
+    stats.used = used;
+    stats.allocations = allocationCount;
+
+    for (const Block& block : blocks)
+    {
+        if (!block.inUse || !block.free)
+            continue;
+
+        stats.free += block.size;
+        stats.largestFree = std::max(stats.largestFree, block.size);
+        ++stats.freeBlocks;
+    }
+
+    return stats;
+}
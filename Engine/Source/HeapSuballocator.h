@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// ============================================================================
+// HeapSuballocator
+// ----------------------------------------------------------------------------
+// CPU half of GpuHeapAllocator: carves one range [0, capacity) into aligned
+// blocks. Plain C++17 (no Windows / D3D12 headers), so the allocation logic
+// is built and tested headless (Engine/Tests/HeapSuballocatorTest.cpp);
+// GpuHeapAllocator maps the offsets onto ID3D12Heaps and placed resources.
+//
+// TLSF (two-level segregated fit):
+// - Free blocks live in FL_COUNT x SL_COUNT lists. The first level is the
+//   power of two of the size, the second splits it in SL_COUNT linear
+//   steps. Two bitmaps say which lists are non-empty, so finding a block
+//   is a couple of bit scans: O(1) allocate and free, no searching.
+// - Sizes are multiples of GRANULARITY (256 bytes: constant buffer
+//   alignment). Placement alignments (4 KB small textures, 64 KB buffers
+//   and textures, 4 MB MSAA) are powers of two, and the front padding an
+//   aligned block needs is returned to the free lists.
+// - Freed blocks merge with free physical neighbours right away.
+//
+// Handles index the block table and stay valid until free(); the offset of
+// a block only changes in defragment().
+//
+// defragment() packs every live block from offset 0 in address order and
+// returns where each one went. Moves only go down, so copying them in the
+// returned order is safe in place (with memmove semantics) or into a fresh
+// range (what GpuHeapAllocator does).
+// ============================================================================
+
+class HeapSuballocator
+{
+public:
+    static constexpr uint32_t INVALID = 0xFFFFFFFFu;
+    static constexpr uint64_t GRANULARITY = 256;
+
+    struct Allocation
+    {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint32_t handle = INVALID;
+
+        bool isValid() const { return handle != INVALID; }
+    };
+
+    struct Relocation
+    {
+        uint32_t handle = INVALID;
+        uint64_t from = 0;
+        uint64_t to = 0;
+        uint64_t size = 0;
+    };
+
+    struct Stats
+    {
+        uint64_t capacity = 0;
+        uint64_t used = 0;              // bytes in live blocks (rounded to GRANULARITY)
+        uint64_t free = 0;
+        uint64_t largestFree = 0;
+        uint32_t allocations = 0;
+        uint32_t freeBlocks = 0;
+
+        // 0: all the free space is one block, close to 1: scattered holes
+        float fragmentation() const { return free > 0 ? 1.0f - float(largestFree) / float(free) : 0.0f; }
+    };
+
+private:
+    static constexpr uint32_t SL_LOG2 = 4;
+    static constexpr uint32_t SL_COUNT = 1u << SL_LOG2;
+    static constexpr uint32_t FL_COUNT = 32;
+
+    struct Block
+    {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint64_t alignment = GRANULARITY;   // kept for defragment()
+        uint32_t prevPhysical = INVALID;
+        uint32_t nextPhysical = INVALID;
+        uint32_t prevFree = INVALID;
+        uint32_t nextFree = INVALID;
+        bool     free = false;
+        bool     inUse = false;             // slot of the table taken
+    };
+
+    uint64_t capacity = 0;
+    uint64_t used = 0;
+    uint32_t allocationCount = 0;
+
+    std::vector<Block>    blocks;
+    std::vector<uint32_t> unusedSlots;
+
+    uint32_t firstLevelMap = 0;
+    uint32_t secondLevelMap[FL_COUNT] = {};
+    uint32_t heads[FL_COUNT][SL_COUNT];
+
+    static void mapping(uint64_t units, uint32_t& fl, uint32_t& sl);
+    static bool mappingSearch(uint64_t units, uint32_t& fl, uint32_t& sl);
+
+    uint32_t newBlock();
+    void     releaseBlock(uint32_t index);
+    void     insertFree(uint32_t index);
+    void     removeFree(uint32_t index);
+    uint32_t findFree(uint32_t fl, uint32_t sl) const;
+    uint32_t splitFront(uint32_t index, uint64_t size);
+
+public:
+    explicit HeapSuballocator(uint64_t capacity);
+
+    // Empty allocation (isValid() false) when nothing fits
+    Allocation allocate(uint64_t size, uint64_t alignment = GRANULARITY);
+    void free(uint32_t handle);
+
+    uint64_t getOffset(uint32_t handle) const { return blocks[handle].offset; }
+    uint64_t getSize(uint32_t handle) const { return blocks[handle].size; }
+    uint64_t getCapacity() const { return capacity; }
+    bool     isEmpty() const { return allocationCount == 0; }
+
+    std::vector<Relocation> defragment();
+    Stats getStats() const;
+};
@@ -0,0 +1,233 @@
+#include "Globals.h"
+#include "InstanceBatcher.h"
+
+#include "Mesh.h"
+#include "BasicMaterial.h"
+#include "RingBufferModule.h"
+#include "Application.h"
+#include "D3D12Module.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+
+void InstanceBatcher::begin(size_t stride)
+{
+    instanceStride = stride;
+
+    items.clear();
+    queue.clear();
+    instanceData.clear();
+}
+
+void* InstanceBatcher::add(uint32_t pass, ID3D12PipelineState* pso, const Mesh* mesh, const BasicMaterial* material, float depth01, bool transparent)
+{
+    _ASSERTE(instanceStride > 0);
+
+    DrawItem item;
+    item.pso = pso;
+    item.mesh = mesh;
+    item.material = material;
+    item.dataOffset = uint32_t(instanceData.size());
+
+    const uint32_t psoId = queue.getStateId(RenderQueue::StateType::PSO, pso);
+    const uint32_t materialId = queue.getStateId(RenderQueue::StateType::Material, material);
+    const uint32_t meshId = queue.getStateId(RenderQueue::StateType::Mesh, mesh);
+
+    const uint64_t key = transparent
+        ? RenderQueue::makeTransparentKey(pass, psoId, materialId, meshId, depth01)
+        : RenderQueue::makeOpaqueKey(pass, psoId, materialId, meshId, depth01);
+
+    queue.push(key, uint32_t(items.size()));
+    items.push_back(item);
+
+    instanceData.resize(instanceData.size() + instanceStride);
+
+    return instanceData.data() + item.dataOffset;
+}
+
+void InstanceBatcher::flush(FilteredCommandList& commandList, RingBufferModule* ring, UINT instanceRootParam, const BindMaterialFn& bindMaterial,
+    const SetupListFn& setupList)
+{
+    drawCalls = 0;
+    instanceCount = uint32_t(items.size());
+    psoChanges = meshChanges = materialChanges = 0;
+    recordedLists = 0;
+
+    if (items.empty())
+        return;
+
+    // ------------------------------------------------------------
+    // 1. Radix sort the keys so identical (PSO, material, mesh) end up adjacent.
+    //    We only sort keys; the instance records are moved once below.
+    // ------------------------------------------------------------
+    JobSystem* jobs = app->getJobSystem();
+    queue.sort(jobs);
+    const std::vector<RenderQueue::Entry>& order = queue.getEntries();
+
+    // ------------------------------------------------------------
+    // 2. One contiguous structured buffer for every instance of the pass.
+    // ------------------------------------------------------------
+    uint8_t* dst = nullptr;
+    D3D12_GPU_VIRTUAL_ADDRESS baseGPU = ring->allocBuffer(instanceData.size(), (void**)&dst, RingBufferModule::STRUCTURED_ALIGNMENT);
+    // Out of upload memory: skip the pass rather than draw stale instance data
+    if (RingBufferModule::isScratch(dst))
+    {
+        Logger::Err("InstanceBatcher: could not allocate " + std::to_string(instanceData.size()) + " bytes of instance data");
+        items.clear();
+        queue.clear();
+        return;
+    }
+
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        memcpy(dst + i * instanceStride, instanceData.data() + items[order[i].payload].dataOffset, instanceStride);
+    }
+
+    // ------------------------------------------------------------
+    // 3. Split the sorted list in runs of identical (PSO, mesh, material):
+    //    one instanced draw each.
+    // ------------------------------------------------------------
+    groups.clear();
+
+    size_t first = 0;
+    while (first < order.size())
+    {
+        const DrawItem& head = items[order[first].payload];
+
+        size_t last = first + 1;
+        while (last < order.size())
+        {
+            const DrawItem& next = items[order[last].payload];
+            if (next.pso != head.pso || next.mesh != head.mesh || next.material != head.material)
+                break;
+            ++last;
+        }
+
+        groups.push_back({ uint32_t(first), uint32_t(last) });
+        first = last;
+    }
+
+    // ------------------------------------------------------------
+    // 4. Record: on the caller's list, or in parallel in contiguous ranges
+    // ------------------------------------------------------------
+    size_t listCount = 1;
+    if (setupList && jobs && jobs->getWorkerCount() > 0)
+        listCount = std::min({ groups.size() / MIN_DRAWS_PER_LIST, size_t(jobs->getThreadCount()), MAX_PARALLEL_LISTS });
+
+    RecordStats total;
+
+    if (listCount < 2)
+    {
+        recordGroups(commandList, 0, groups.size(), baseGPU, instanceRootParam, bindMaterial, total);
+    }
+    else
+    {
+        D3D12Module* d3d12 = app->getD3D12();
+        CommandContextPool& contexts = d3d12->getCommandContexts();
+
+        std::vector<ID3D12GraphicsCommandList*> lists(listCount);
+        std::vector<RecordStats> listStats(listCount);
+        std::vector<FilteredCommandList::Stats> filterStats(listCount);
+
+        jobs->parallelFor(0, listCount, 1, [&](size_t begin, size_t end)
+            {
+                for (size_t l = begin; l < end; ++l)
+                {
+                    const size_t firstGroup = groups.size() * l / listCount;
+                    const size_t lastGroup = groups.size() * (l + 1) / listCount;
+
+                    CommandContextPool::Context* context = contexts.acquire();
+
+                    FilteredCommandList list;
+                    list.reset(context->list.Get());
+                    setupList(list);
+
+                    recordGroups(list, firstGroup, lastGroup, baseGPU, instanceRootParam, bindMaterial, listStats[l]);
+
+                    context->list->Close();
+                    lists[l] = context->list.Get();
+                    filterStats[l] = list.getStats();
+                }
+            });
+
+        // Keys were split in order, so submitting the lists in order keeps the draw order
+        d3d12->spliceCommandLists(lists.data(), lists.size());
+
+        // The job lists filter on their own: their counts join the frame's
+        for (const FilteredCommandList::Stats& stats : filterStats)
+            d3d12->getFilteredCommandList().addStats(stats);
+
+        for (const RecordStats& stats : listStats)
+        {
+            total.drawCalls += stats.drawCalls;
+            total.psoChanges += stats.psoChanges;
+            total.meshChanges += stats.meshChanges;
+            total.materialChanges += stats.materialChanges;
+        }
+        recordedLists = uint32_t(listCount);
+    }
+
+    drawCalls = total.drawCalls;
+    psoChanges = total.psoChanges;
+    meshChanges = total.meshChanges;
+    materialChanges = total.materialChanges;
+
+    items.clear();
+    queue.clear();
+}
+
+void InstanceBatcher::recordGroups(FilteredCommandList& commandList, size_t firstGroup, size_t lastGroup, D3D12_GPU_VIRTUAL_ADDRESS baseGPU,
+    UINT instanceRootParam, const BindMaterialFn& bindMaterial, RecordStats& out) const
+{
+    const std::vector<RenderQueue::Entry>& order = queue.getEntries();
+
+    ID3D12PipelineState* currentPSO = nullptr;
+    const Mesh* currentMesh = nullptr;
+    const BasicMaterial* currentMaterial = nullptr;
+
+    for (size_t g = firstGroup; g < lastGroup; ++g)
+    {
+        const Group& group = groups[g];
+        const DrawItem& head = items[order[group.first].payload];
+        const UINT groupCount = UINT(group.last - group.first);
+
+        if (head.pso != currentPSO)
+        {
+            commandList.SetPipelineState(head.pso);
+            currentPSO = head.pso;
+            ++out.psoChanges;
+        }
+
+        if (head.mesh != currentMesh)
+        {
+            const D3D12_VERTEX_BUFFER_VIEW& vbv = head.mesh->getVertexView();
+            commandList.IASetVertexBuffers(0, 1, &vbv);
+
+            if (head.mesh->hasIndices())
+            {
+                const D3D12_INDEX_BUFFER_VIEW& ibv = head.mesh->getIndexView();
+                commandList.IASetIndexBuffer(&ibv);
+            }
+
+            currentMesh = head.mesh;
+            ++out.meshChanges;
+        }
+
+        if (head.material != currentMaterial && bindMaterial)
+        {
+            bindMaterial(commandList, head.material);
+            currentMaterial = head.material;
+            ++out.materialChanges;
+        }
+
+        // SV_InstanceID restarts at 0 for every draw, so point the SRV at this group's first record
+        commandList.SetGraphicsRootShaderResourceView(instanceRootParam, baseGPU + group.first * instanceStride);
+
+        if (head.mesh->hasIndices())
+            commandList->DrawIndexedInstanced(head.mesh->getIndexCount(), groupCount, 0, 0, 0);
+        else
+            commandList->DrawInstanced(head.mesh->getVertexCount(), groupCount, 0, 0);
+
+        ++out.drawCalls;
+    }
+}
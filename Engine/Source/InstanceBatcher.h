@@ -0,0 +1,132 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "RenderQueue.h"
+#include "FilteredCommandList.h"
+
+// ============================================================================
+// InstanceBatcher
+// ----------------------------------------------------------------------------
+// Groups the visible draws of a pass by (PSO, mesh, material) and submits every
+// group with a single instanced draw call.
+//
+// How it works:
+// - add() registers one draw and returns a CPU pointer where the caller writes
+//   that draw's per-instance data (transforms, material overrides, ...).
+// - flush() sorts the draws with a RenderQueue (64-bit keys: pass, PSO,
+//   material, mesh, depth), copies all per-instance data into ONE contiguous
+//   structured buffer allocated from the RingBufferModule and issues one
+//   DrawIndexedInstanced per run of identical (PSO, mesh, material).
+// - Opaque instances end up front-to-back inside each group and transparent
+//   ones back-to-front, since instances are rasterized in SV_InstanceID order.
+// - The shaders fetch their data with StructuredBuffer[SV_InstanceID]. The
+//   root SRV is re-pointed at the first element of each group, so
+//   SV_InstanceID always starts at 0 inside a group.
+//
+// Notes:
+// - The batcher does not own meshes, materials or PSOs; it only references
+//   them for the duration of a pass.
+// - Material resources (texture tables, etc.) are bound through a callback,
+//   so each exercise keeps control of its own root signature layout.
+//
+// Parallel recording:
+// - When flush() gets a SetupListFn and the pass is big enough, the sorted
+//   groups are split into contiguous key ranges, one per job. Each job
+//   records its range into its own list from the D3D12Module context pool,
+//   after calling the setup callback (targets, root signature, heaps, root
+//   arguments: nothing carries over between command lists).
+// - The lists are spliced into the frame in key order, so the GPU sees the
+//   same draw order as the serial path. Afterwards recording continues on a
+//   new list: callers must re-fetch getCommandList() and rebind their state.
+// ============================================================================
+
+class Mesh;
+class BasicMaterial;
+class RingBufferModule;
+
+class InstanceBatcher
+{
+public:
+    using BindMaterialFn = std::function<void(FilteredCommandList&, const BasicMaterial*)>;
+    using SetupListFn = std::function<void(FilteredCommandList&)>;
+
+    // Fewer draws than this per list are not worth an extra command list
+    static constexpr size_t MIN_DRAWS_PER_LIST = 64;
+    static constexpr size_t MAX_PARALLEL_LISTS = 8;
+
+private:
+    struct DrawItem
+    {
+        ID3D12PipelineState* pso = nullptr;
+        const Mesh* mesh = nullptr;
+        const BasicMaterial* material = nullptr;
+        uint32_t dataOffset = 0;
+    };
+
+    struct Group
+    {
+        uint32_t first = 0;     // range in the sorted order
+        uint32_t last = 0;
+    };
+
+    struct RecordStats
+    {
+        uint32_t drawCalls = 0;
+        uint32_t psoChanges = 0;
+        uint32_t meshChanges = 0;
+        uint32_t materialChanges = 0;
+    };
+
+    std::vector<DrawItem> items;
+    std::vector<uint8_t>  instanceData;
+    size_t                instanceStride = 0;
+    RenderQueue           queue;
+    std::vector<Group>    groups;
+
+    // Stats from the last flush()
+    uint32_t drawCalls = 0;
+    uint32_t instanceCount = 0;
+    uint32_t psoChanges = 0;
+    uint32_t meshChanges = 0;
+    uint32_t materialChanges = 0;
+    uint32_t recordedLists = 0;
+
+    void recordGroups(FilteredCommandList& commandList, size_t firstGroup, size_t lastGroup, D3D12_GPU_VIRTUAL_ADDRESS baseGPU,
+        UINT instanceRootParam, const BindMaterialFn& bindMaterial, RecordStats& out) const;
+
+public:
+    InstanceBatcher() = default;
+    ~InstanceBatcher() = default;
+
+    // Starts a new batch. Every instance record has 'stride' bytes.
+    void begin(size_t stride);
+
+    // Registers one draw. The returned pointer is valid until the next add()/flush()
+    // and must be filled with 'stride' bytes of per-instance data.
+    // 'pass' orders whole passes (lower first), 'depth01' is the normalized view
+    // depth used for front-to-back / back-to-front ordering.
+    void* add(uint32_t pass, ID3D12PipelineState* pso, const Mesh* mesh, const BasicMaterial* material, float depth01, bool transparent = false);
+
+    template<class T>
+    T* add(uint32_t pass, ID3D12PipelineState* pso, const Mesh* mesh, const BasicMaterial* material, float depth01, bool transparent = false)
+    {
+        _ASSERTE(sizeof(T) == instanceStride);
+        return reinterpret_cast<T*>(add(pass, pso, mesh, material, depth01, transparent));
+    }
+
+    // Sorts, uploads and draws everything registered since begin().
+    // 'instanceRootParam' is the root SRV slot of the StructuredBuffer with the instance data.
+    // With 'setupList', large passes are recorded in parallel (see above).
+    void flush(FilteredCommandList& commandList, RingBufferModule* ring, UINT instanceRootParam, const BindMaterialFn& bindMaterial,
+        const SetupListFn& setupList = nullptr);
+
+    uint32_t getDrawCalls() const { return drawCalls; }
+    uint32_t getInstanceCount() const { return instanceCount; }
+    uint32_t getPSOChanges() const { return psoChanges; }
+    uint32_t getMeshChanges() const { return meshChanges; }
+    uint32_t getMaterialChanges() const { return materialChanges; }
+    uint32_t getRecordedLists() const { return recordedLists; }     // 0: recorded on the caller's list
+    size_t   getPendingCount() const { return items.size(); }
+};
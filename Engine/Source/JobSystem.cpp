@@ -0,0 +1,319 @@
+// Plain C++ on purpose (no Globals.h / precompiled header): this file has to
+// build outside the engine for headless tests and benchmarks.
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+namespace
+{
+    thread_local JobSystem* tlsSystem = nullptr;
+    thread_local int32_t    tlsIndex = -1;
+    thread_local void*      tlsCurrentJob = nullptr;
+
+    constexpr auto IDLE_TIMEOUT = std::chrono::milliseconds(2);
+
+    inline uint32_t nextRandom(uint32_t& state)
+    {
+        // xorshift32
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// JobSystem
+// ----------------------------------------------------------------------------
+JobSystem::JobSystem(uint32_t workerCount)
+{
+    if (workerCount == 0)
+    {
+        uint32_t hw = std::thread::hardware_concurrency();
+        workerCount = hw > 1 ? hw - 1 : 1;
+    }
+
+    mainThreadId = std::this_thread::get_id();
+    tlsSystem = this;
+    tlsIndex = 0;
+
+    workers.reserve(workerCount + 1);
+    for (uint32_t i = 0; i <= workerCount; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>());
+        workers.back()->randomState = 0x9E3779B9u * (i + 1);
+    }
+
+    running = true;
+    for (uint32_t i = 1; i <= workerCount; ++i)
+        workers[i]->thread = std::thread(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+    running = false;
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    sleepCondition.notify_all();
+
+    for (size_t i = 1; i < workers.size(); ++i)
+    {
+        if (workers[i]->thread.joinable())
+            workers[i]->thread.join();
+    }
+
+    // Anything still queued is dropped (its counter will never reach zero)
+    for (auto& worker : workers)
+    {
+        while (Job* job = worker->deque.steal())
+            delete job;
+    }
+    for (Job* job : injectionQueue)
+        delete job;
+    for (Job* job : mainThreadQueue)
+        delete job;
+
+    if (tlsSystem == this)
+    {
+        tlsSystem = nullptr;
+        tlsIndex = -1;
+    }
+}
+
+int32_t JobSystem::currentWorkerIndex() const
+{
+    return tlsSystem == this ? tlsIndex : -1;
+}
+
+void JobSystem::run(JobFn fn, JobCounter* counter)
+{
+    if (counter)
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+    push(new Job{ std::move(fn), counter });
+}
+
+void JobSystem::runChild(JobFn fn)
+{
+    const Job* parent = static_cast<const Job*>(tlsCurrentJob);
+    run(std::move(fn), parent ? parent->counter : nullptr);
+}
+
+void JobSystem::runOnMainThread(JobFn fn, JobCounter* counter)
+{
+    if (counter)
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mainThreadMutex);
+    mainThreadQueue.push_back(new Job{ std::move(fn), counter });
+}
+
+void JobSystem::push(Job* job)
+{
+    const int32_t index = currentWorkerIndex();
+
+    if (index >= 0)
+    {
+        if (!workers[index]->deque.push(job))
+        {
+            // Deque full: running inline keeps progress and bounds memory
+            workers[index]->inlined.fetch_add(1, std::memory_order_relaxed);
+            execute(job, uint32_t(index));
+            return;
+        }
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(injectionMutex);
+        injectionQueue.push_back(job);
+        hasInjected.store(true, std::memory_order_release);
+    }
+
+    wakeWorkers();
+}
+
+void JobSystem::wakeWorkers()
+{
+    // Pairs with the fence in workerLoop(): either this load sees the
+    // sleeper, or the sleeper's check sees the job published before it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepingWorkers.load(std::memory_order_relaxed) == 0)
+        return;
+
+    {
+        // Taking the lock orders this notify after a sleeper's predicate check
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    sleepCondition.notify_one();
+}
+
+JobSystem::Job* JobSystem::findJob(uint32_t index)
+{
+    Worker& self = *workers[index];
+
+    if (Job* job = self.deque.pop())
+        return job;
+
+    // Steal, starting from a random victim
+    const uint32_t count = uint32_t(workers.size());
+    const uint32_t start = nextRandom(self.randomState) % count;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t victim = (start + i) % count;
+        if (victim == index)
+            continue;
+
+        if (Job* job = workers[victim]->deque.steal())
+        {
+            self.stolen.fetch_add(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    if (hasInjected.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(injectionMutex);
+        if (!injectionQueue.empty())
+        {
+            Job* job = injectionQueue.back();
+            injectionQueue.pop_back();
+            hasInjected.store(!injectionQueue.empty(), std::memory_order_release);
+            return job;
+        }
+    }
+
+    return nullptr;
+}
+
+void JobSystem::execute(Job* job, uint32_t index)
+{
+    void* previous = tlsCurrentJob;
+    tlsCurrentJob = job;
+
+    job->fn();
+
+    tlsCurrentJob = previous;
+
+    if (job->counter)
+        job->counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+
+    workers[index]->executed.fetch_add(1, std::memory_order_relaxed);
+    delete job;
+}
+
+void JobSystem::workerLoop(uint32_t index)
+{
+    tlsSystem = this;
+    tlsIndex = int32_t(index);
+
+    while (running.load(std::memory_order_acquire))
+    {
+        if (Job* job = findJob(index))
+        {
+            execute(job, index);
+            continue;
+        }
+
+        // Nothing to do: sleep until new work is pushed (or the timeout, as a safety net)
+        sleepingWorkers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);   // pairs with wakeWorkers()
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepCondition.wait_for(lock, IDLE_TIMEOUT, [this]()
+                {
+                    if (!running.load(std::memory_order_acquire) || hasInjected.load(std::memory_order_acquire))
+                        return true;
+                    for (const auto& worker : workers)
+                    {
+                        if (!worker->deque.empty())
+                            return true;
+                    }
+                    return false;
+                });
+        }
+        sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    tlsSystem = nullptr;
+    tlsIndex = -1;
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+    const int32_t index = currentWorkerIndex();
+
+    while (!counter.isDone())
+    {
+        if (index == 0)
+            processMainThreadJobs();
+
+        Job* job = (index >= 0) ? findJob(uint32_t(index)) : nullptr;
+        if (job)
+            execute(job, uint32_t(index));
+        else
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::processMainThreadJobs()
+{
+    assert(isMainThread());
+
+    std::vector<Job*> jobs;
+    {
+        std::lock_guard<std::mutex> lock(mainThreadMutex);
+        if (mainThreadQueue.empty())
+            return;
+        jobs.swap(mainThreadQueue);
+    }
+
+    for (Job* job : jobs)
+        execute(job, 0);
+}
+
+void JobSystem::parallelFor(size_t begin, size_t end, size_t grain, const RangeFn& fn)
+{
+    if (end <= begin)
+        return;
+
+    if (grain == 0)
+        grain = std::max<size_t>(1, (end - begin) / (size_t(getThreadCount()) * 8));
+
+    if (end - begin <= grain)
+    {
+        fn(begin, end);
+        return;
+    }
+
+    JobCounter counter;
+    parallelForRange(begin, end, grain, fn, &counter);
+    wait(counter);
+}
+
+void JobSystem::parallelForRange(size_t begin, size_t end, size_t grain, const RangeFn& fn, JobCounter* counter)
+{
+    // Keep halving: the upper half becomes a stealable job, this thread continues with the lower one
+    while (end - begin > grain)
+    {
+        const size_t mid = begin + (end - begin) / 2;
+        run([this, mid, end, grain, &fn, counter]() { parallelForRange(mid, end, grain, fn, counter); }, counter);
+        end = mid;
+    }
+
+    fn(begin, end);
+}
+
+JobSystem::Stats JobSystem::getStats() const
+{
+    Stats stats;
+    for (const auto& worker : workers)
+    {
+        stats.executed += worker->executed.load(std::memory_order_relaxed);
+        stats.stolen += worker->stolen.load(std::memory_order_relaxed);
+        stats.inlined += worker->inlined.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
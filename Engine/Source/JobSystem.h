@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "WorkDeque.h"
+
+// ============================================================================
+// JobSystem
+// ----------------------------------------------------------------------------
+// Work-stealing job scheduler. Plain C++17 (no Windows / D3D12 headers), so
+// it builds headless on any platform: JobSystemTest and JobSystemBench in
+// Engine/Tests. The engine wraps it in JobSystemModule.
+//
+// Threads:
+// - The thread that creates the JobSystem is the "main thread" (slot 0). It
+//   owns a deque too, but only runs jobs while it waits or when asked to.
+// - N worker threads (default: hardware threads - 1) each own a Chase-Lev
+//   deque (WorkDeque.h): the owner pushes/pops at the bottom (LIFO, cache
+//   friendly), idle threads steal from the top (FIFO, oldest = biggest work).
+// - Idle workers sleep on a condition variable. Publishing a job and the
+//   sleeper count are ordered with seq_cst fences on both sides (pusher:
+//   publish, fence, read the count; sleeper: count, fence, look for work),
+//   so at least one of them sees the other and no wake-up is lost.
+// - Threads that are not part of the system push to a locked injection queue.
+//
+// Dependencies:
+// - JobCounter counts unfinished jobs. run() increments it, completion
+//   decrements it, wait() blocks until it reaches zero while executing other
+//   jobs (never sleeps while there is work).
+// - runChild() attaches the new job to the counter of the job currently
+//   running, so a parent is only "done" when all of its children are.
+//
+// Main-thread jobs:
+// - runOnMainThread() queues work that must run on the main thread (D3D12
+//   submission, ImGui, ...). They run in processMainThreadJobs() and while
+//   the main thread waits on a counter.
+//
+// parallelFor():
+// - Splits [begin, end) lazily: a job keeps halving its range, pushing the
+//   upper half as a stealable job, until it reaches the grain size. Idle
+//   threads therefore steal large ranges and busy threads keep small ones,
+//   so chunking adapts to the load without tuning.
+// ============================================================================
+
+class JobCounter
+{
+    friend class JobSystem;
+    std::atomic<int32_t> pending{ 0 };
+
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool    isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+    int32_t getPending() const { return pending.load(std::memory_order_acquire); }
+};
+
+class JobSystem
+{
+public:
+    using JobFn = std::function<void()>;
+    using RangeFn = std::function<void(size_t begin, size_t end)>;
+
+    struct Stats
+    {
+        uint64_t executed = 0;
+        uint64_t stolen = 0;
+        uint64_t inlined = 0;       // ran immediately because a deque was full
+    };
+
+private:
+    struct Job
+    {
+        JobFn fn;
+        JobCounter* counter = nullptr;
+    };
+
+    struct alignas(64) Worker
+    {
+        WorkDeque<Job> deque;
+        std::thread thread;
+        uint32_t randomState = 1;
+        std::atomic<uint64_t> executed{ 0 };
+        std::atomic<uint64_t> stolen{ 0 };
+        std::atomic<uint64_t> inlined{ 0 };
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;  // [0] = main thread
+    std::thread::id mainThreadId;
+
+    std::mutex         injectionMutex;
+    std::vector<Job*>  injectionQueue;
+    std::atomic<bool>  hasInjected{ false };
+
+    std::mutex         mainThreadMutex;
+    std::vector<Job*>  mainThreadQueue;
+
+    std::mutex              sleepMutex;
+    std::condition_variable sleepCondition;
+    std::atomic<uint32_t>   sleepingWorkers{ 0 };
+    std::atomic<bool>       running{ false };
+
+    void workerLoop(uint32_t index);
+
+    void push(Job* job);
+    Job* findJob(uint32_t index);
+    void execute(Job* job, uint32_t index);
+    void wakeWorkers();
+
+    int32_t currentWorkerIndex() const;
+
+    void parallelForRange(size_t begin, size_t end, size_t grain, const RangeFn& fn, JobCounter* counter);
+
+public:
+    // workerCount = 0 picks hardware threads - 1 (at least 1)
+    explicit JobSystem(uint32_t workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void run(JobFn fn, JobCounter* counter = nullptr);
+    void runChild(JobFn fn);
+    void runOnMainThread(JobFn fn, JobCounter* counter = nullptr);
+
+    // Blocks until 'counter' reaches zero, running jobs meanwhile
+    void wait(JobCounter& counter);
+
+    // Runs every queued main-thread job. Main thread only.
+    void processMainThreadJobs();
+
+    // Calls fn(chunkBegin, chunkEnd) over [begin, end) and waits for completion.
+    // 'grain' is the smallest chunk worth a job (0 = auto).
+    void parallelFor(size_t begin, size_t end, size_t grain, const RangeFn& fn);
+
+    uint32_t getWorkerCount() const { return uint32_t(workers.size()) - 1; }
+    uint32_t getThreadCount() const { return uint32_t(workers.size()); }
+    bool     isMainThread() const { return std::this_thread::get_id() == mainThreadId; }
+
+    Stats getStats() const;
+};
@@ -0,0 +1,48 @@
+#include "Globals.h"
+#include "JobSystemModule.h"
+
+JobSystemModule::JobSystemModule()
+{
+    // Created here (not in init) so modules initialized before us could still queue work
+    jobs = std::make_unique<JobSystem>();
+}
+
+JobSystemModule::~JobSystemModule()
+{
+}
+
+bool JobSystemModule::init()
+{
+    Logger::Log("JobSystem: " + std::to_string(jobs->getWorkerCount()) + " worker threads");
+    return true;
+}
+
+void JobSystemModule::preRender()
+{
+    // Main-thread jobs queued during update run before the frame is recorded
+    jobs->processMainThreadJobs();
+}
+
+void JobSystemModule::postRender()
+{
+    jobs->processMainThreadJobs();
+}
+
+bool JobSystemModule::cleanUp()
+{
+    if (jobs)
+        jobs->processMainThreadJobs();
+
+    // Joins the workers
+    jobs.reset();
+    return true;
+}
+
+ModuleAccess JobSystemModule::getAccess(ModulePhase phase) const
+{
+    // Main-thread jobs can touch anything
+    if (phase == ModulePhase::PreRender || phase == ModulePhase::PostRender)
+        return ModuleAccess();
+
+    return ModuleAccess::idle();
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "Module.h"
+#include "JobSystem.h"
+
+// ============================================================================
+// JobSystemModule
+// ----------------------------------------------------------------------------
+// Engine-wide owner of the work-stealing JobSystem.
+//
+// Purpose:
+// - Give every subsystem (import, culling, animation, skinning, sorting, ...)
+//   a shared pool of worker threads instead of spawning its own.
+// - Run main-thread-only jobs (D3D12 submission, ImGui) once per frame.
+//
+// Notes:
+// - It is the first module created, so other modules can use it from init().
+// - The thread that creates the module (the one running Application) is the
+//   job system's main thread.
+// ============================================================================
+
+class JobSystemModule : public Module
+{
+private:
+    std::unique_ptr<JobSystem> jobs;
+
+public:
+    JobSystemModule();
+    ~JobSystemModule();
+
+    bool init() override;
+    void preRender() override;
+    void postRender() override;
+    bool cleanUp() override;
+
+    const char* getName() const override { return "JobSystem"; }
+    ModuleAccess getAccess(ModulePhase phase) const override;
+
+    JobSystem* getJobSystem() const { return jobs.get(); }
+};
@@ -0,0 +1,607 @@
+// Plain C++ on purpose (no Globals.h / precompiled header): this file has to
+// build outside the engine for headless tests.
+#include "LightClusterBuilder.h"
+
+#include "LightManager.h"
+#include "JobSystem.h"
+#include "Timer.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+    constexpr float MIN_NEAR = 1e-3f;
+    constexpr float PAD_DEPTH = -1e18f;         // padding lights sit far behind the camera
+    constexpr uint32_t MAX_LIGHTS_PER_TYPE = 0xFFFF;
+
+    // ------------------------------------------------------------
+    // The tests below exist twice (scalar / 4-wide) and must round the
+    // same way: same operations in the same order, no fused multiply-add.
+    // ------------------------------------------------------------
+
+    // Distance from c to [lo, hi] along one axis (0 inside)
+    inline float axisDistance(float c, float lo, float hi)
+    {
+        return std::max(std::max(lo - c, c - hi), 0.0f);
+    }
+
+    inline XMVECTOR axisDistance(FXMVECTOR c, FXMVECTOR lo, FXMVECTOR hi)
+    {
+        return XMVectorMax(XMVectorMax(XMVectorSubtract(lo, c), XMVectorSubtract(c, hi)), XMVectorZero());
+    }
+
+    // Sphere vs box from the per-axis distances. An axis the box does not
+    // limit passes 0, which keeps the slice / row tests conservative with
+    // respect to the full test.
+    inline bool sphereHit(float ex, float ey, float ez, float r)
+    {
+        return (ex * ex + ey * ey) + ez * ez <= r * r;
+    }
+
+    inline XMVECTOR sphereHit(FXMVECTOR ex, FXMVECTOR ey, FXMVECTOR ez, GXMVECTOR r)
+    {
+        XMVECTOR dist2 = XMVectorAdd(XMVectorAdd(XMVectorMultiply(ex, ex), XMVectorMultiply(ey, ey)), XMVectorMultiply(ez, ez));
+        return XMVectorLessOrEqual(dist2, XMVectorMultiply(r, r));
+    }
+
+    struct ConeLanes
+    {
+        XMVECTOR apexX, apexY, apexD;
+        XMVECTOR dirX, dirY, dirD;
+        XMVECTOR cosAngle, sinAngle, range;
+    };
+
+    // Cone vs sphere (cx, cy, cd, sr): false when the sphere is outside the
+    // cone's angle, past its range or behind its apex
+    inline bool coneHit(float apexX, float apexY, float apexD, float dirX, float dirY, float dirD,
+        float cosAngle, float sinAngle, float range, float cx, float cy, float cd, float sr)
+    {
+        const float vx = cx - apexX;
+        const float vy = cy - apexY;
+        const float vd = cd - apexD;
+
+        const float lenSq = (vx * vx + vy * vy) + vd * vd;
+        const float v1 = (vx * dirX + vy * dirY) + vd * dirD;
+        const float distClosest = cosAngle * sqrtf(std::max(lenSq - v1 * v1, 0.0f)) - v1 * sinAngle;
+
+        return distClosest <= sr && v1 <= sr + range && v1 >= -sr;
+    }
+
+    inline XMVECTOR coneHit(const ConeLanes& c, FXMVECTOR cx, FXMVECTOR cy, FXMVECTOR cd, GXMVECTOR sr)
+    {
+        XMVECTOR vx = XMVectorSubtract(cx, c.apexX);
+        XMVECTOR vy = XMVectorSubtract(cy, c.apexY);
+        XMVECTOR vd = XMVectorSubtract(cd, c.apexD);
+
+        XMVECTOR lenSq = XMVectorAdd(XMVectorAdd(XMVectorMultiply(vx, vx), XMVectorMultiply(vy, vy)), XMVectorMultiply(vd, vd));
+        XMVECTOR v1 = XMVectorAdd(XMVectorAdd(XMVectorMultiply(vx, c.dirX), XMVectorMultiply(vy, c.dirY)), XMVectorMultiply(vd, c.dirD));
+        XMVECTOR lateral = XMVectorSqrt(XMVectorMax(XMVectorSubtract(lenSq, XMVectorMultiply(v1, v1)), XMVectorZero()));
+        XMVECTOR distClosest = XMVectorSubtract(XMVectorMultiply(c.cosAngle, lateral), XMVectorMultiply(v1, c.sinAngle));
+
+        XMVECTOR hit = XMVectorLessOrEqual(distClosest, sr);
+        hit = XMVectorAndInt(hit, XMVectorLessOrEqual(v1, XMVectorAdd(sr, c.range)));
+        hit = XMVectorAndInt(hit, XMVectorGreaterOrEqual(v1, XMVectorNegate(sr)));
+        return hit;
+    }
+
+    // One bit per lane that passed
+    inline uint32_t laneMask(FXMVECTOR mask)
+    {
+#if defined(_XM_SSE_INTRINSICS_)
+        return uint32_t(_mm_movemask_ps(mask));
+#else
+        XMUINT4 lanes;
+        XMStoreUInt4(&lanes, mask);
+        return (lanes.x ? 1u : 0u) | (lanes.y ? 2u : 0u) | (lanes.z ? 4u : 0u) | (lanes.w ? 8u : 0u);
+#endif
+    }
+
+    inline XMVECTOR load4(const std::vector<float>& v, uint32_t i)
+    {
+        return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&v[i]));
+    }
+}
+
+// ----------------------------------------------------------------------------
+// SphereSoA
+// ----------------------------------------------------------------------------
+
+void LightClusterBuilder::SphereSoA::clear()
+{
+    x.clear();
+    y.clear();
+    d.clear();
+    r.clear();
+    light.clear();
+}
+
+void LightClusterBuilder::SphereSoA::push(float px, float py, float pd, float pr, uint32_t slot)
+{
+    x.push_back(px);
+    y.push_back(py);
+    d.push_back(pd);
+    r.push_back(pr);
+    light.push_back(slot);
+}
+
+void LightClusterBuilder::SphereSoA::pad()
+{
+    // Zero radius far behind the camera: fails every test
+    while (light.size() & 3)
+        push(0.0f, 0.0f, PAD_DEPTH, 0.0f, LightManager::INVALID);
+}
+
+// ----------------------------------------------------------------------------
+// Grid and lights in view space
+// ----------------------------------------------------------------------------
+
+void LightClusterBuilder::prepare(const View& view, const LightManager& lights)
+{
+    built.dimX = std::max(settings.dimX, 1u);
+    built.dimY = std::max(settings.dimY, 1u);
+    built.dimZ = std::max(settings.dimZ, 1u);
+
+    const uint32_t X = built.dimX, Y = built.dimY, Z = built.dimZ;
+
+    nearZ = std::max(view.nearZ, MIN_NEAR);
+    farZ = std::max(view.farZ, nearZ * 1.01f);
+
+    const float logRatio = logf(farZ / nearZ);
+    depthScale = float(Z) / logRatio;
+    depthBias = -logf(nearZ) * depthScale;
+
+    // ------------------------------------------------------------
+    // Cluster bounds. A tile is a frustum slice, its box spans both
+    // depth planes.
+    // ------------------------------------------------------------
+    const float tanY = tanf(view.fovY * 0.5f);
+    const float tanX = tanY * view.aspect;
+
+    sliceNear.resize(Z);
+    sliceFar.resize(Z);
+    columnMin.resize(size_t(Z) * X);
+    columnMax.resize(size_t(Z) * X);
+    rowMin.resize(size_t(Z) * Y);
+    rowMax.resize(size_t(Z) * Y);
+
+    auto sliceDepth = [&](uint32_t z) { return z == Z ? farZ : nearZ * powf(farZ / nearZ, float(z) / float(Z)); };
+
+    for (uint32_t z = 0; z < Z; ++z)
+    {
+        const float dn = sliceDepth(z);
+        const float df = sliceDepth(z + 1);
+        sliceNear[z] = dn;
+        sliceFar[z] = df;
+
+        for (uint32_t x = 0; x < X; ++x)
+        {
+            const float ndc0 = -1.0f + 2.0f * float(x) / float(X);
+            const float ndc1 = -1.0f + 2.0f * float(x + 1) / float(X);
+            const float a = ndc0 * tanX * dn, b = ndc0 * tanX * df;
+            const float c = ndc1 * tanX * dn, d = ndc1 * tanX * df;
+            columnMin[z * X + x] = std::min({ a, b, c, d });
+            columnMax[z * X + x] = std::max({ a, b, c, d });
+        }
+
+        // Row 0 is the top of the screen
+        for (uint32_t y = 0; y < Y; ++y)
+        {
+            const float ndc0 = 1.0f - 2.0f * float(y) / float(Y);
+            const float ndc1 = 1.0f - 2.0f * float(y + 1) / float(Y);
+            const float a = ndc0 * tanY * dn, b = ndc0 * tanY * df;
+            const float c = ndc1 * tanY * dn, d = ndc1 * tanY * df;
+            rowMin[z * Y + y] = std::min({ a, b, c, d });
+            rowMax[z * Y + y] = std::max({ a, b, c, d });
+        }
+    }
+
+    // ------------------------------------------------------------
+    // Point lights: view space spheres (depth = -z, right handed view)
+    // ------------------------------------------------------------
+    const LightManager::PointSoA& p = lights.getPoints();
+    const uint32_t pointCount = std::min(lights.getCount(LightManager::POINT), MAX_LIGHTS_PER_TYPE);
+
+    const XMMATRIX viewMatrix = XMLoadFloat4x4(&view.view);
+
+    points.clear();
+    for (uint32_t i = 0; i < pointCount; ++i)
+    {
+        XMFLOAT3 c;
+        XMStoreFloat3(&c, XMVector3Transform(XMVectorSet(p.posX[i], p.posY[i], p.posZ[i], 0.0f), viewMatrix));
+        points.push(c.x, c.y, -c.z, p.radius[i], i);
+    }
+    points.pad();
+
+    // ------------------------------------------------------------
+    // Spot lights: bounding sphere of the cone capped at 'radius' along
+    // its axis (the shader attenuates with the axial distance), plus the
+    // cone itself for the last test
+    // ------------------------------------------------------------
+    const LightManager::SpotSoA& s = lights.getSpots();
+    const uint32_t spotCount = std::min(lights.getCount(LightManager::SPOT), MAX_LIGHTS_PER_TYPE);
+
+    spots.clear();
+    cones.apexX.resize(spotCount); cones.apexY.resize(spotCount); cones.apexD.resize(spotCount);
+    cones.dirX.resize(spotCount); cones.dirY.resize(spotCount); cones.dirD.resize(spotCount);
+    cones.cosAngle.resize(spotCount); cones.sinAngle.resize(spotCount); cones.range.resize(spotCount);
+
+    for (uint32_t i = 0; i < spotCount; ++i)
+    {
+        const XMVECTOR apexV = XMVector3Transform(XMVectorSet(s.posX[i], s.posY[i], s.posZ[i], 0.0f), viewMatrix);
+        const XMVECTOR dirV = XMVector3Normalize(XMVector3TransformNormal(XMVectorSet(s.dirX[i], s.dirY[i], s.dirZ[i], 0.0f), viewMatrix));
+
+        XMFLOAT3 apex, dir;
+        XMStoreFloat3(&apex, apexV);
+        XMStoreFloat3(&dir, dirV);
+
+        // Nothing behind the apex is lit: at most a hemisphere
+        const float cosA = std::clamp(s.cosOuter[i], 0.0f, 1.0f);
+        const float sinA = sqrtf(1.0f - cosA * cosA);
+        const float h = s.radius[i];
+
+        float centerT, boundRadius;
+        if (cosA * cosA >= 0.5f)
+        {
+            // Narrow cone: sphere through the apex and the rim of the cap
+            boundRadius = h / (2.0f * cosA * cosA);
+            centerT = boundRadius;
+        }
+        else
+        {
+            // Wide cone: sphere around the cap
+            boundRadius = h * sinA / std::max(cosA, 1e-3f);
+            centerT = h;
+        }
+
+        XMFLOAT3 center;
+        XMStoreFloat3(&center, XMVectorAdd(apexV, XMVectorScale(dirV, centerT)));
+        spots.push(center.x, center.y, -center.z, boundRadius, i);
+
+        cones.apexX[i] = apex.x;
+        cones.apexY[i] = apex.y;
+        cones.apexD[i] = -apex.z;
+        cones.dirX[i] = dir.x;
+        cones.dirY[i] = dir.y;
+        cones.dirD[i] = -dir.z;
+        cones.cosAngle[i] = cosA;
+        cones.sinAngle[i] = sinA;
+        cones.range[i] = h;
+    }
+    spots.pad();
+
+    clusters.resize(size_t(X) * Y * Z);
+    slices.resize(Z);
+}
+
+void LightClusterBuilder::clusterBounds(uint32_t x, uint32_t y, uint32_t z, XMFLOAT3& minB, XMFLOAT3& maxB) const
+{
+    minB = XMFLOAT3(columnMin[z * built.dimX + x], rowMin[z * built.dimY + y], sliceNear[z]);
+    maxB = XMFLOAT3(columnMax[z * built.dimX + x], rowMax[z * built.dimY + y], sliceFar[z]);
+}
+
+// ----------------------------------------------------------------------------
+// Fast path: slice -> row -> cluster, 4 lights per iteration
+// ----------------------------------------------------------------------------
+
+void LightClusterBuilder::buildSlice(uint32_t z)
+{
+    SliceWork& work = slices[z];
+    work.indices.clear();
+
+    const XMVECTOR dn = XMVectorReplicate(sliceNear[z]);
+    const XMVECTOR df = XMVectorReplicate(sliceFar[z]);
+    const XMVECTOR zero = XMVectorZero();
+
+    // Lanes of 'src' whose sphere passes 'hit' go to 'dst'
+    auto appendLanes = [](const SphereSoA& src, uint32_t i, uint32_t mask, SphereSoA& dst)
+        {
+            for (uint32_t lane = 0; lane < 4; ++lane)
+            {
+                if (mask & (1u << lane))
+                    dst.push(src.x[i + lane], src.y[i + lane], src.d[i + lane], src.r[i + lane], src.light[i + lane]);
+            }
+        };
+
+    // ------------------------------------------------------------
+    // 1. Lights that reach the slice's depth range
+    // ------------------------------------------------------------
+    auto sliceCandidates = [&](const SphereSoA& src, SphereSoA& dst)
+        {
+            dst.clear();
+            for (uint32_t i = 0; i < src.size(); i += 4)
+            {
+                XMVECTOR ez = axisDistance(load4(src.d, i), dn, df);
+                uint32_t mask = laneMask(sphereHit(zero, zero, ez, load4(src.r, i)));
+                if (mask)
+                    appendLanes(src, i, mask, dst);
+            }
+            dst.pad();
+        };
+
+    sliceCandidates(points, work.pointCandidates);
+    sliceCandidates(spots, work.spotCandidates);
+
+    for (uint32_t y = 0; y < built.dimY; ++y)
+    {
+        const XMVECTOR yMin = XMVectorReplicate(rowMin[z * built.dimY + y]);
+        const XMVECTOR yMax = XMVectorReplicate(rowMax[z * built.dimY + y]);
+
+        // ------------------------------------------------------------
+        // 2. Slice candidates that reach the row
+        // ------------------------------------------------------------
+        auto rowCandidates = [&](const SphereSoA& src, SphereSoA& dst)
+            {
+                dst.clear();
+                for (uint32_t i = 0; i < src.size(); i += 4)
+                {
+                    XMVECTOR ey = axisDistance(load4(src.y, i), yMin, yMax);
+                    XMVECTOR ez = axisDistance(load4(src.d, i), dn, df);
+                    uint32_t mask = laneMask(sphereHit(zero, ey, ez, load4(src.r, i)));
+                    if (mask)
+                        appendLanes(src, i, mask, dst);
+                }
+                dst.pad();
+            };
+
+        rowCandidates(work.pointCandidates, work.pointRow);
+        rowCandidates(work.spotCandidates, work.spotRow);
+
+        // ------------------------------------------------------------
+        // 3. Row candidates against every cluster of the row
+        // ------------------------------------------------------------
+        for (uint32_t x = 0; x < built.dimX; ++x)
+        {
+            XMFLOAT3 minB, maxB;
+            clusterBounds(x, y, z, minB, maxB);
+
+            const XMVECTOR xMin = XMVectorReplicate(minB.x);
+            const XMVECTOR xMax = XMVectorReplicate(maxB.x);
+
+            const uint32_t offset = uint32_t(work.indices.size());
+
+            const SphereSoA& pr = work.pointRow;
+            for (uint32_t i = 0; i < pr.size(); i += 4)
+            {
+                XMVECTOR ex = axisDistance(load4(pr.x, i), xMin, xMax);
+                XMVECTOR ey = axisDistance(load4(pr.y, i), yMin, yMax);
+                XMVECTOR ez = axisDistance(load4(pr.d, i), dn, df);
+                uint32_t mask = laneMask(sphereHit(ex, ey, ez, load4(pr.r, i)));
+
+                for (uint32_t lane = 0; lane < 4; ++lane)
+                {
+                    if (mask & (1u << lane))
+                        work.indices.push_back(pr.light[i + lane]);
+                }
+            }
+
+            const uint32_t pointCount = uint32_t(work.indices.size()) - offset;
+
+            // Spots: bounding sphere vs box, then the cone vs the cluster's sphere
+            const float sphereX = 0.5f * (minB.x + maxB.x), sphereY = 0.5f * (minB.y + maxB.y), sphereD = 0.5f * (minB.z + maxB.z);
+            const float hx = 0.5f * (maxB.x - minB.x), hy = 0.5f * (maxB.y - minB.y), hz = 0.5f * (maxB.z - minB.z);
+            const float sphereR = sqrtf((hx * hx + hy * hy) + hz * hz);
+
+            const XMVECTOR cx = XMVectorReplicate(sphereX);
+            const XMVECTOR cy = XMVectorReplicate(sphereY);
+            const XMVECTOR cd = XMVectorReplicate(sphereD);
+            const XMVECTOR cr = XMVectorReplicate(sphereR);
+
+            const SphereSoA& sr = work.spotRow;
+            for (uint32_t i = 0; i < sr.size(); i += 4)
+            {
+                XMVECTOR ex = axisDistance(load4(sr.x, i), xMin, xMax);
+                XMVECTOR ey = axisDistance(load4(sr.y, i), yMin, yMax);
+                XMVECTOR ez = axisDistance(load4(sr.d, i), dn, df);
+                uint32_t mask = laneMask(sphereHit(ex, ey, ez, load4(sr.r, i)));
+                if (!mask)
+                    continue;
+
+                // Gather the cones (lanes that already failed reuse a passing one)
+                uint32_t slot[4];
+                for (uint32_t lane = 0; lane < 4; ++lane)
+                    slot[lane] = sr.light[i + lane];
+                const uint32_t first = slot[(mask & 1) ? 0 : (mask & 2) ? 1 : (mask & 4) ? 2 : 3];
+                for (uint32_t lane = 0; lane < 4; ++lane)
+                {
+                    if (!(mask & (1u << lane)))
+                        slot[lane] = first;
+                }
+
+                auto gather = [&slot](const std::vector<float>& v) { return XMVectorSet(v[slot[0]], v[slot[1]], v[slot[2]], v[slot[3]]); };
+
+                ConeLanes cone;
+                cone.apexX = gather(cones.apexX);
+                cone.apexY = gather(cones.apexY);
+                cone.apexD = gather(cones.apexD);
+                cone.dirX = gather(cones.dirX);
+                cone.dirY = gather(cones.dirY);
+                cone.dirD = gather(cones.dirD);
+                cone.cosAngle = gather(cones.cosAngle);
+                cone.sinAngle = gather(cones.sinAngle);
+                cone.range = gather(cones.range);
+
+                mask &= laneMask(coneHit(cone, cx, cy, cd, cr));
+
+                for (uint32_t lane = 0; lane < 4; ++lane)
+                {
+                    if (mask & (1u << lane))
+                        work.indices.push_back(sr.light[i + lane]);
+                }
+            }
+
+            const uint32_t spotCount = uint32_t(work.indices.size()) - offset - pointCount;
+
+            // Offsets are relative to the slice until finish()
+            clusters[getClusterIndex(x, y, z)] = { offset, pointCount | (spotCount << 16) };
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Reference: every light against every cluster
+// ----------------------------------------------------------------------------
+
+void LightClusterBuilder::buildSliceReference(uint32_t z)
+{
+    SliceWork& work = slices[z];
+    work.indices.clear();
+
+    for (uint32_t y = 0; y < built.dimY; ++y)
+    {
+        for (uint32_t x = 0; x < built.dimX; ++x)
+        {
+            XMFLOAT3 minB, maxB;
+            clusterBounds(x, y, z, minB, maxB);
+
+            const uint32_t offset = uint32_t(work.indices.size());
+
+            for (uint32_t i = 0; i < points.size(); ++i)
+            {
+                if (points.light[i] == LightManager::INVALID)
+                    continue;
+
+                const float ex = axisDistance(points.x[i], minB.x, maxB.x);
+                const float ey = axisDistance(points.y[i], minB.y, maxB.y);
+                const float ez = axisDistance(points.d[i], minB.z, maxB.z);
+                if (sphereHit(ex, ey, ez, points.r[i]))
+                    work.indices.push_back(points.light[i]);
+            }
+
+            const uint32_t pointCount = uint32_t(work.indices.size()) - offset;
+
+            const float sphereX = 0.5f * (minB.x + maxB.x), sphereY = 0.5f * (minB.y + maxB.y), sphereD = 0.5f * (minB.z + maxB.z);
+            const float hx = 0.5f * (maxB.x - minB.x), hy = 0.5f * (maxB.y - minB.y), hz = 0.5f * (maxB.z - minB.z);
+            const float sphereR = sqrtf((hx * hx + hy * hy) + hz * hz);
+
+            for (uint32_t i = 0; i < spots.size(); ++i)
+            {
+                const uint32_t slot = spots.light[i];
+                if (slot == LightManager::INVALID)
+                    continue;
+
+                const float ex = axisDistance(spots.x[i], minB.x, maxB.x);
+                const float ey = axisDistance(spots.y[i], minB.y, maxB.y);
+                const float ez = axisDistance(spots.d[i], minB.z, maxB.z);
+                if (!sphereHit(ex, ey, ez, spots.r[i]))
+                    continue;
+
+                if (coneHit(cones.apexX[slot], cones.apexY[slot], cones.apexD[slot], cones.dirX[slot], cones.dirY[slot], cones.dirD[slot],
+                    cones.cosAngle[slot], cones.sinAngle[slot], cones.range[slot], sphereX, sphereY, sphereD, sphereR))
+                    work.indices.push_back(slot);
+            }
+
+            const uint32_t spotCount = uint32_t(work.indices.size()) - offset - pointCount;
+            clusters[getClusterIndex(x, y, z)] = { offset, pointCount | (spotCount << 16) };
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Build
+// ----------------------------------------------------------------------------
+
+void LightClusterBuilder::build(const View& view, const LightManager& lights, JobSystem* jobs)
+{
+    Timer timer;
+    timer.Start();
+
+    prepare(view, lights);
+
+    // One job per depth slice: each writes its own clusters and index list
+    if (jobs && jobs->getWorkerCount() > 0)
+    {
+        jobs->parallelFor(0, built.dimZ, 1, [this](size_t begin, size_t end)
+            {
+                for (size_t z = begin; z < end; ++z)
+                    buildSlice(uint32_t(z));
+            });
+    }
+    else
+    {
+        for (uint32_t z = 0; z < built.dimZ; ++z)
+            buildSlice(z);
+    }
+
+    finish();
+
+    timer.Stop();
+    stats.buildMs = timer.ReadMs();
+}
+
+void LightClusterBuilder::buildReference(const View& view, const LightManager& lights)
+{
+    Timer timer;
+    timer.Start();
+
+    prepare(view, lights);
+
+    for (uint32_t z = 0; z < built.dimZ; ++z)
+        buildSliceReference(z);
+
+    finish();
+
+    timer.Stop();
+    stats.buildMs = timer.ReadMs();
+}
+
+void LightClusterBuilder::finish()
+{
+    const uint32_t clustersPerSlice = built.dimX * built.dimY;
+
+    size_t total = 0;
+    for (uint32_t z = 0; z < built.dimZ; ++z)
+        total += slices[z].indices.size();
+
+    indices.resize(total);
+
+    // Slice-relative offsets become global, slices are concatenated in order
+    uint32_t base = 0;
+    for (uint32_t z = 0; z < built.dimZ; ++z)
+    {
+        const std::vector<uint32_t>& sliceIndices = slices[z].indices;
+        std::copy(sliceIndices.begin(), sliceIndices.end(), indices.begin() + base);
+
+        ClusterRange* range = &clusters[size_t(z) * clustersPerSlice];
+        for (uint32_t c = 0; c < clustersPerSlice; ++c)
+            range[c].offset += base;
+
+        base += uint32_t(sliceIndices.size());
+    }
+
+    stats.clusters = uint32_t(clusters.size());
+    stats.indices = uint32_t(indices.size());
+    stats.nonEmptyClusters = 0;
+    stats.maxLightsPerCluster = 0;
+
+    for (const ClusterRange& range : clusters)
+    {
+        const uint32_t count = (range.counts & 0xFFFF) + (range.counts >> 16);
+        stats.nonEmptyClusters += count > 0 ? 1 : 0;
+        stats.maxLightsPerCluster = std::max(stats.maxLightsPerCluster, count);
+    }
+}
+
+uint32_t LightClusterBuilder::compare(const LightClusterBuilder& other) const
+{
+    if (clusters.size() != other.clusters.size())
+        return uint32_t(std::max(clusters.size(), other.clusters.size()));
+
+    uint32_t differences = 0;
+    for (size_t c = 0; c < clusters.size(); ++c)
+    {
+        const ClusterRange& a = clusters[c];
+        const ClusterRange& b = other.clusters[c];
+
+        const uint32_t count = (a.counts & 0xFFFF) + (a.counts >> 16);
+        if (a.counts != b.counts ||
+            !std::equal(indices.begin() + a.offset, indices.begin() + a.offset + count, other.indices.begin() + b.offset))
+        {
+            ++differences;
+        }
+    }
+
+    return differences;
+}
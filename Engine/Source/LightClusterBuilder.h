@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <d3d12.h>
+#include <DirectXMath.h>
+
+// ============================================================================
+// LightClusterBuilder
+// ----------------------------------------------------------------------------
+// CPU clustered light culling. The view frustum is split into a 3D grid of
+// clusters (screen tiles x depth slices, 16 x 9 x 24 by default) and every
+// cluster gets the list of point / spot lights that can reach it, so the
+// pixel shader only evaluates the lights of its own cluster instead of every
+// light in the scene.
+//
+// Grid:
+// - x / y: equal screen tiles, tile (0, 0) is the top-left corner (the same
+//   as SV_Position).
+// - z: exponential slices between the near and far planes,
+//     slice(depth) = floor(log(depth) * depthScale + depthBias)
+//   so clusters stay roughly cubic at every distance.
+// - Cluster index = (z * dimY + y) * dimX + x.
+//
+// Culling (view space, 'depth' = distance along the view direction):
+// - Point lights: sphere vs cluster AABB.
+// - Spot lights: bounding sphere of the capped cone vs cluster AABB, then
+//   the cone vs the cluster's bounding sphere.
+//
+// build() is the fast path: one job per depth slice, and inside it the
+// lights are narrowed slice -> row -> cluster, testing 4 lights per
+// iteration with DirectXMath vectors (light data is SoA). buildReference()
+// tests every light against every cluster with scalar code; both use the
+// same arithmetic in the same order, so compare() against a reference build
+// must report 0 differences (Engine/Tests/LightClusterBuilderTest.cpp
+// checks it headless over random lights and grids).
+//
+// The builder is plain C++ (no Globals.h); upload() and uploadEmpty() live in
+// LightClusterUpload.cpp, next to the ring buffer.
+//
+// Output, ready for the ring buffer (upload()):
+// - clusters: one ClusterRange per cluster, offset into the index list and
+//   the point / spot counts (point lights first).
+// - indices: dense light slots of LightManager, the same indices as the
+//   persistent light buffers.
+// ============================================================================
+
+class LightManager;
+class RingBufferModule;
+class JobSystem;
+
+class LightClusterBuilder
+{
+public:
+    struct Settings
+    {
+        uint32_t dimX = 16;
+        uint32_t dimY = 9;
+        uint32_t dimZ = 24;
+    };
+
+    // View parameters (right handed view matrix, fovY in radians)
+    struct View
+    {
+        DirectX::XMFLOAT4X4 view;
+        float fovY = DirectX::XM_PIDIV4;
+        float aspect = 1.0f;
+        float nearZ = 0.1f;
+        float farZ = 100.0f;
+    };
+
+    // GPU record ('ClusterGrid' in Exercise8PS.hlsl)
+    struct ClusterRange
+    {
+        uint32_t offset;        // first index in the light index list
+        uint32_t counts;        // point lights (low 16 bits) | spot lights (high 16 bits)
+    };
+
+    struct Stats
+    {
+        double   buildMs = 0.0;
+        uint32_t clusters = 0;
+        uint32_t nonEmptyClusters = 0;
+        uint32_t indices = 0;
+        uint32_t maxLightsPerCluster = 0;
+    };
+
+    Settings settings;
+
+private:
+    // Lights in view space: x, y and depth (positive in front of the camera), padded to 4
+    struct SphereSoA
+    {
+        std::vector<float>    x, y, d, r;
+        std::vector<uint32_t> light;    // LightManager slot
+
+        void clear();
+        void push(float px, float py, float pd, float pr, uint32_t slot);
+        void pad();                     // to a multiple of 4 with lights that hit nothing
+        uint32_t size() const { return uint32_t(light.size()); }
+    };
+
+    // Spot cones in view space, indexed by LightManager slot
+    struct ConeSoA
+    {
+        std::vector<float> apexX, apexY, apexD;
+        std::vector<float> dirX, dirY, dirD;
+        std::vector<float> cosAngle, sinAngle, range;
+    };
+
+    // Per depth slice work, reused across frames (one job each)
+    struct SliceWork
+    {
+        SphereSoA pointCandidates, spotCandidates;     // touching the slice
+        SphereSoA pointRow, spotRow;                   // touching the current row
+        std::vector<uint32_t> indices;                 // lists of the slice's clusters
+    };
+
+    Settings built;                     // settings of the last build
+    float nearZ = 0.1f, farZ = 100.0f;
+    float depthScale = 0.0f, depthBias = 0.0f;
+
+    // Cluster bounds (view space), per slice
+    std::vector<float> sliceNear, sliceFar;             // [z]
+    std::vector<float> columnMin, columnMax;            // [z * dimX + x]
+    std::vector<float> rowMin, rowMax;                  // [z * dimY + y]
+
+    SphereSoA points;
+    SphereSoA spots;
+    ConeSoA   cones;
+
+    std::vector<SliceWork>    slices;
+    std::vector<ClusterRange> clusters;
+    std::vector<uint32_t>     indices;
+
+    Stats stats;
+
+    void prepare(const View& view, const LightManager& lights);
+    void buildSlice(uint32_t z);
+    void buildSliceReference(uint32_t z);
+    void finish();
+
+    void clusterBounds(uint32_t x, uint32_t y, uint32_t z, DirectX::XMFLOAT3& minB, DirectX::XMFLOAT3& maxB) const;
+
+public:
+    LightClusterBuilder() = default;
+    ~LightClusterBuilder() = default;
+
+    // SIMD + jobs (jobs can be null: runs on the caller)
+    void build(const View& view, const LightManager& lights, JobSystem* jobs);
+
+    // Brute force: every light against every cluster, scalar
+    void buildReference(const View& view, const LightManager& lights);
+
+    // Clusters whose light lists differ (0 when both builds agree)
+    uint32_t compare(const LightClusterBuilder& other) const;
+
+    // Copies both lists into the ring buffer, for root SRVs (never empty)
+    void upload(RingBufferModule* ring, D3D12_GPU_VIRTUAL_ADDRESS* clustersGPU, D3D12_GPU_VIRTUAL_ADDRESS* indicesGPU) const;
+
+    // One zeroed element per list: valid root SRVs for passes that don't read the clusters
+    static void uploadEmpty(RingBufferModule* ring, D3D12_GPU_VIRTUAL_ADDRESS* clustersGPU, D3D12_GPU_VIRTUAL_ADDRESS* indicesGPU);
+
+    uint32_t getClusterIndex(uint32_t x, uint32_t y, uint32_t z) const { return (z * built.dimY + y) * built.dimX + x; }
+    const std::vector<ClusterRange>& getClusters() const { return clusters; }
+    const std::vector<uint32_t>& getIndices() const { return indices; }
+
+    // slice(depth) = floor(log(depth) * depthScale + depthBias), for the shader
+    float getDepthScale() const { return depthScale; }
+    float getDepthBias() const { return depthBias; }
+    const Settings& getBuiltSettings() const { return built; }
+
+    const Stats& getStats() const { return stats; }
+};
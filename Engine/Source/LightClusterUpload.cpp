@@ -0,0 +1,38 @@
+#include "Globals.h"
+#include "LightClusterBuilder.h"
+
+#include "RingBufferModule.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Upload half of LightClusterBuilder: the builder itself is plain C++ and
+// builds headless, the ring buffer needs the engine.
+
+void LightClusterBuilder::upload(RingBufferModule* ring, D3D12_GPU_VIRTUAL_ADDRESS* clustersGPU, D3D12_GPU_VIRTUAL_ADDRESS* indicesGPU) const
+{
+    ClusterRange* clusterCPU = nullptr;
+    *clustersGPU = ring->allocStructured(std::max<size_t>(clusters.size(), 1), &clusterCPU);
+    if (clusters.empty())
+        clusterCPU[0] = {};
+    else
+        memcpy(clusterCPU, clusters.data(), clusters.size() * sizeof(ClusterRange));
+
+    uint32_t* indexCPU = nullptr;
+    *indicesGPU = ring->allocStructured(std::max<size_t>(indices.size(), 1), &indexCPU);
+    if (indices.empty())
+        indexCPU[0] = 0;
+    else
+        memcpy(indexCPU, indices.data(), indices.size() * sizeof(uint32_t));
+}
+
+void LightClusterBuilder::uploadEmpty(RingBufferModule* ring, D3D12_GPU_VIRTUAL_ADDRESS* clustersGPU, D3D12_GPU_VIRTUAL_ADDRESS* indicesGPU)
+{
+    ClusterRange* clusterCPU = nullptr;
+    *clustersGPU = ring->allocStructured(1, &clusterCPU);
+    clusterCPU[0] = {};
+
+    uint32_t* indexCPU = nullptr;
+    *indicesGPU = ring->allocStructured(1, &indexCPU);
+    indexCPU[0] = 0;
+}
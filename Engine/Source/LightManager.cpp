@@ -0,0 +1,376 @@
+// Plain C++ on purpose (no Globals.h / precompiled header): this file has to
+// build outside the engine for headless tests.
+#include "LightManager.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+    // Writes 'value' into 'dst' and reports whether it changed
+    inline bool assign(float& dst, float value)
+    {
+        if (dst == value)
+            return false;
+
+        dst = value;
+        return true;
+    }
+
+    template<typename... Arrays>
+    void resizeAll(uint32_t count, Arrays&... arrays)
+    {
+        (arrays.resize(count), ...);
+    }
+
+    template<typename... Arrays>
+    void moveAll(uint32_t from, uint32_t to, Arrays&... arrays)
+    {
+        ((arrays[to] = arrays[from]), ...);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Slots
+// ----------------------------------------------------------------------------
+
+uint32_t LightManager::Slots::add()
+{
+    uint32_t id;
+    if (!freeIds.empty())
+    {
+        id = freeIds.back();
+        freeIds.pop_back();
+    }
+    else
+    {
+        id = uint32_t(slotOfId.size());
+        slotOfId.push_back(INVALID);
+    }
+
+    const uint32_t slot = uint32_t(idOfSlot.size());
+    slotOfId[id] = slot;
+    idOfSlot.push_back(id);
+    dirtyFlags.push_back(0);
+    markDirty(slot);
+    return id;
+}
+
+uint32_t LightManager::Slots::remove(uint32_t id)
+{
+    const uint32_t slot = slotOfId[id];
+    const uint32_t last = size() - 1;
+
+    slotOfId[id] = INVALID;
+    freeIds.push_back(id);
+
+    // The last slot is gone: forget it if it was dirty
+    if (dirtyFlags[last])
+        dirty.erase(std::find(dirty.begin(), dirty.end(), last));
+    dirtyFlags.pop_back();
+
+    uint32_t moved = INVALID;
+    if (slot != last)
+    {
+        const uint32_t movedId = idOfSlot[last];
+        idOfSlot[slot] = movedId;
+        slotOfId[movedId] = slot;
+        markDirty(slot);
+        moved = slot;
+    }
+
+    idOfSlot.pop_back();
+    return moved;
+}
+
+void LightManager::Slots::markDirty(uint32_t slot)
+{
+    if (dirtyFlags[slot])
+        return;
+
+    dirtyFlags[slot] = 1;
+    dirty.push_back(slot);
+}
+
+void LightManager::Slots::markAllDirty()
+{
+    for (uint32_t slot = 0; slot < size(); ++slot)
+        markDirty(slot);
+}
+
+// ----------------------------------------------------------------------------
+// Storage
+// ----------------------------------------------------------------------------
+
+void LightManager::resizeArrays(LightType type, uint32_t count)
+{
+    switch (type)
+    {
+    case DIRECTIONAL:
+        resizeAll(count, directionals.dirX, directionals.dirY, directionals.dirZ,
+            directionals.colorR, directionals.colorG, directionals.colorB, directionals.intensity);
+        break;
+    case POINT:
+        resizeAll(count, points.posX, points.posY, points.posZ, points.radius,
+            points.colorR, points.colorG, points.colorB, points.intensity);
+        break;
+    case SPOT:
+        resizeAll(count, spots.posX, spots.posY, spots.posZ, spots.radius, spots.dirX, spots.dirY, spots.dirZ,
+            spots.colorR, spots.colorG, spots.colorB, spots.intensity, spots.innerAngle, spots.outerAngle, spots.cosInner, spots.cosOuter);
+        break;
+    default:
+        break;
+    }
+}
+
+void LightManager::moveLight(LightType type, uint32_t from, uint32_t to)
+{
+    switch (type)
+    {
+    case DIRECTIONAL:
+        moveAll(from, to, directionals.dirX, directionals.dirY, directionals.dirZ,
+            directionals.colorR, directionals.colorG, directionals.colorB, directionals.intensity);
+        break;
+    case POINT:
+        moveAll(from, to, points.posX, points.posY, points.posZ, points.radius,
+            points.colorR, points.colorG, points.colorB, points.intensity);
+        break;
+    case SPOT:
+        moveAll(from, to, spots.posX, spots.posY, spots.posZ, spots.radius, spots.dirX, spots.dirY, spots.dirZ,
+            spots.colorR, spots.colorG, spots.colorB, spots.intensity, spots.innerAngle, spots.outerAngle, spots.cosInner, spots.cosOuter);
+        break;
+    default:
+        break;
+    }
+}
+
+uint32_t LightManager::addDirectional(const DirectionalLight& light)
+{
+    const uint32_t id = slots[DIRECTIONAL].add();
+    resizeArrays(DIRECTIONAL, slots[DIRECTIONAL].size());
+    setDirectional(id, light);
+    return id;
+}
+
+uint32_t LightManager::addPoint(const PointLight& light)
+{
+    const uint32_t id = slots[POINT].add();
+    resizeArrays(POINT, slots[POINT].size());
+    setPoint(id, light);
+    return id;
+}
+
+uint32_t LightManager::addSpot(const SpotLight& light)
+{
+    const uint32_t id = slots[SPOT].add();
+    resizeArrays(SPOT, slots[SPOT].size());
+
+    // Fresh slot: make sure the cosines are computed
+    const uint32_t slot = slots[SPOT].slotOfId[id];
+    spots.innerAngle[slot] = spots.outerAngle[slot] = -1.0f;
+
+    setSpot(id, light);
+    return id;
+}
+
+void LightManager::remove(LightType type, uint32_t id)
+{
+    const uint32_t last = slots[type].size() - 1;
+    const uint32_t moved = slots[type].remove(id);
+    if (moved != INVALID)
+        moveLight(type, last, moved);
+
+    resizeArrays(type, slots[type].size());
+}
+
+void LightManager::setDirectional(uint32_t id, const DirectionalLight& light)
+{
+    const uint32_t slot = slots[DIRECTIONAL].slotOfId[id];
+    DirectionalSoA& d = directionals;
+
+    bool changed = false;
+    changed |= assign(d.dirX[slot], light.direction.x);
+    changed |= assign(d.dirY[slot], light.direction.y);
+    changed |= assign(d.dirZ[slot], light.direction.z);
+    changed |= assign(d.colorR[slot], light.color.x);
+    changed |= assign(d.colorG[slot], light.color.y);
+    changed |= assign(d.colorB[slot], light.color.z);
+    changed |= assign(d.intensity[slot], light.intensity);
+
+    if (changed)
+        slots[DIRECTIONAL].markDirty(slot);
+}
+
+void LightManager::setPoint(uint32_t id, const PointLight& light)
+{
+    const uint32_t slot = slots[POINT].slotOfId[id];
+    PointSoA& p = points;
+
+    bool changed = false;
+    changed |= assign(p.posX[slot], light.position.x);
+    changed |= assign(p.posY[slot], light.position.y);
+    changed |= assign(p.posZ[slot], light.position.z);
+    changed |= assign(p.radius[slot], light.radius);
+    changed |= assign(p.colorR[slot], light.color.x);
+    changed |= assign(p.colorG[slot], light.color.y);
+    changed |= assign(p.colorB[slot], light.color.z);
+    changed |= assign(p.intensity[slot], light.intensity);
+
+    if (changed)
+        slots[POINT].markDirty(slot);
+}
+
+void LightManager::setPointPosition(uint32_t id, const XMFLOAT3& position)
+{
+    const uint32_t slot = slots[POINT].slotOfId[id];
+
+    bool changed = false;
+    changed |= assign(points.posX[slot], position.x);
+    changed |= assign(points.posY[slot], position.y);
+    changed |= assign(points.posZ[slot], position.z);
+
+    if (changed)
+        slots[POINT].markDirty(slot);
+}
+
+void LightManager::setSpot(uint32_t id, const SpotLight& light)
+{
+    const uint32_t slot = slots[SPOT].slotOfId[id];
+    SpotSoA& s = spots;
+
+    bool changed = false;
+    changed |= assign(s.posX[slot], light.position.x);
+    changed |= assign(s.posY[slot], light.position.y);
+    changed |= assign(s.posZ[slot], light.position.z);
+    changed |= assign(s.radius[slot], light.radius);
+    changed |= assign(s.dirX[slot], light.direction.x);
+    changed |= assign(s.dirY[slot], light.direction.y);
+    changed |= assign(s.dirZ[slot], light.direction.z);
+    changed |= assign(s.colorR[slot], light.color.x);
+    changed |= assign(s.colorG[slot], light.color.y);
+    changed |= assign(s.colorB[slot], light.color.z);
+    changed |= assign(s.intensity[slot], light.intensity);
+
+    // Cosines only when the angles change
+    if (assign(s.innerAngle[slot], light.innerAngle))
+    {
+        s.cosInner[slot] = cosf(light.innerAngle);
+        changed = true;
+    }
+
+    if (assign(s.outerAngle[slot], light.outerAngle))
+    {
+        s.cosOuter[slot] = cosf(light.outerAngle);
+        changed = true;
+    }
+
+    if (changed)
+        slots[SPOT].markDirty(slot);
+}
+
+// ----------------------------------------------------------------------------
+// Upload
+// ----------------------------------------------------------------------------
+
+void LightManager::upload(ID3D12GraphicsCommandList* commandList, RingBufferModule* ring)
+{
+    stats.uploadedLights = 0;
+    stats.copies = 0;
+    stats.uploadedBytes = 0;
+    stats.fullBytes = 0;
+
+    for (uint32_t t = 0; t < TYPE_COUNT; ++t)
+    {
+        const LightType type = LightType(t);
+        Slots& s = slots[type];
+        PersistentGpuBuffer& buffer = gpu[type];
+
+        stats.lights[type] = s.size();
+        stats.fullBytes += size_t(s.size()) * buffer.getStride();
+
+        // A new buffer starts empty, and the benchmark mode sends everything
+        if (buffer.reserve(std::max(s.size(), 1u)) || fullUpload)
+            s.markAllDirty();
+
+        if (s.dirty.empty())
+            continue;
+
+        std::sort(s.dirty.begin(), s.dirty.end());
+
+        PersistentGpuBuffer::PackFn pack;
+        switch (type)
+        {
+        case DIRECTIONAL:
+            pack = [this](uint32_t i, void* dst)
+                {
+                    const DirectionalSoA& d = directionals;
+                    DirectionalLightGPU& out = *static_cast<DirectionalLightGPU*>(dst);
+                    out.direction = XMFLOAT3(d.dirX[i], d.dirY[i], d.dirZ[i]);
+                    out.color = XMFLOAT3(d.colorR[i], d.colorG[i], d.colorB[i]);
+                    out.intensity = d.intensity[i];
+                };
+            break;
+        case POINT:
+            pack = [this](uint32_t i, void* dst)
+                {
+                    const PointSoA& p = points;
+                    PointLightGPU& out = *static_cast<PointLightGPU*>(dst);
+                    out.position = XMFLOAT3(p.posX[i], p.posY[i], p.posZ[i]);
+                    out.color = XMFLOAT3(p.colorR[i], p.colorG[i], p.colorB[i]);
+                    out.intensity = p.intensity[i];
+                    out.radius = p.radius[i];
+                };
+            break;
+        default:
+            pack = [this](uint32_t i, void* dst)
+                {
+                    const SpotSoA& s = spots;
+                    SpotLightGPU& out = *static_cast<SpotLightGPU*>(dst);
+                    out.position = XMFLOAT3(s.posX[i], s.posY[i], s.posZ[i]);
+                    out.direction = XMFLOAT3(s.dirX[i], s.dirY[i], s.dirZ[i]);
+                    out.color = XMFLOAT3(s.colorR[i], s.colorG[i], s.colorB[i]);
+                    out.intensity = s.intensity[i];
+                    out.radius = s.radius[i];
+                    out.cosInnerAngle = s.cosInner[i];
+                    out.cosOuterAngle = s.cosOuter[i];
+                    out.pad0 = 0.0f;
+                };
+            break;
+        }
+
+        uint32_t copies = 0;
+        const size_t bytes = buffer.upload(commandList, ring, s.dirty, pack, &copies);
+
+        // No staging memory: they stay dirty for next frame
+        if (bytes == 0)
+            continue;
+
+        for (uint32_t slot : s.dirty)
+            s.dirtyFlags[slot] = 0;
+
+        stats.uploadedLights += uint32_t(s.dirty.size());
+        stats.uploadedBytes += bytes;
+        stats.copies += copies;
+        s.dirty.clear();
+    }
+
+    // ------------------------------------------------------------
+    // Benchmark window: average bytes per frame, incremental vs full
+    // ------------------------------------------------------------
+    uploadHistory[historyIndex] = stats.uploadedBytes;
+    fullHistory[historyIndex] = stats.fullBytes;
+    historyIndex = (historyIndex + 1) % HISTORY_FRAMES;
+    historyCount = std::min(historyCount + 1, HISTORY_FRAMES);
+
+    size_t uploaded = 0, full = 0;
+    for (uint32_t i = 0; i < historyCount; ++i)
+    {
+        uploaded += uploadHistory[i];
+        full += fullHistory[i];
+    }
+
+    stats.avgUploadedBytes = double(uploaded) / double(historyCount);
+    stats.avgFullBytes = double(full) / double(historyCount);
+}
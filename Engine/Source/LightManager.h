@@ -0,0 +1,210 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <DirectXMath.h>
+
+#include "PersistentGpuBuffer.h"
+
+// ============================================================================
+// LightManager
+// ----------------------------------------------------------------------------
+// Scene lights kept across frames instead of rebuilt and re-uploaded every
+// frame.
+//
+// - CPU side: structure of arrays per light type (one float array per
+//   component), densely packed. Culling / ranking code can stream just the
+//   positions and radii, and SIMD can load four lights per register.
+// - Lights are addressed by stable ids; removal swaps the last light into
+//   the hole (the dense order changes, the ids do not).
+// - set*() compares with the stored values and only marks the light dirty
+//   when something changed. Spot cone cosines are computed there, once per
+//   change, not per frame.
+// - upload() writes only the dirty lights (as the GPU structs) into
+//   persistent DEFAULT heap buffers, one copy per run of consecutive
+//   lights. A frame where nothing moved uploads nothing.
+// - The GPU structs match Exercise8PS.hlsl (StructuredBuffers t0..t2).
+//
+// Stats count the bytes uploaded per frame next to what re-uploading every
+// light would cost; setFullUpload() forces the old behaviour to compare.
+// Not thread safe: owned by the exercise that renders with it.
+//
+// Plain C++ (no Globals.h): the headless tests and LightManagerBench (dirty
+// vs full upload, Engine/Tests) link it against a fake PersistentGpuBuffer.
+// ============================================================================
+
+class RingBufferModule;
+
+class LightManager
+{
+public:
+    static constexpr uint32_t INVALID = 0xFFFFFFFFu;
+    static constexpr uint32_t HISTORY_FRAMES = 120;     // window of the averaged stats
+
+    enum LightType { DIRECTIONAL = 0, POINT, SPOT, TYPE_COUNT };
+
+    struct DirectionalLight
+    {
+        DirectX::XMFLOAT3 direction = { 0.0f, -1.0f, 0.0f };
+        DirectX::XMFLOAT3 color = { 1.0f, 1.0f, 1.0f };
+        float intensity = 1.0f;
+    };
+
+    struct PointLight
+    {
+        DirectX::XMFLOAT3 position = { 0.0f, 0.0f, 0.0f };
+        DirectX::XMFLOAT3 color = { 1.0f, 1.0f, 1.0f };
+        float intensity = 1.0f;
+        float radius = 1.0f;
+    };
+
+    struct SpotLight
+    {
+        DirectX::XMFLOAT3 position = { 0.0f, 0.0f, 0.0f };
+        DirectX::XMFLOAT3 direction = { 0.0f, -1.0f, 0.0f };
+        DirectX::XMFLOAT3 color = { 1.0f, 1.0f, 1.0f };
+        float intensity = 1.0f;
+        float radius = 1.0f;
+        float innerAngle = 0.25f;       // radians
+        float outerAngle = 0.5f;
+    };
+
+    // GPU layouts ('DirectionalLight', 'PointLight', 'SpotLight' in Exercise8PS.hlsl)
+    struct DirectionalLightGPU
+    {
+        DirectX::XMFLOAT3 direction;
+        DirectX::XMFLOAT3 color;
+        float intensity;
+    };
+
+    struct PointLightGPU
+    {
+        DirectX::XMFLOAT3 position;
+        DirectX::XMFLOAT3 color;
+        float intensity;
+        float radius;
+    };
+
+    struct SpotLightGPU
+    {
+        DirectX::XMFLOAT3 position;
+        DirectX::XMFLOAT3 direction;
+        DirectX::XMFLOAT3 color;
+        float intensity;
+        float radius;
+        float cosInnerAngle;
+        float cosOuterAngle;
+        float pad0;
+    };
+
+    // Dense SoA storage, index = dense slot
+    struct DirectionalSoA
+    {
+        std::vector<float> dirX, dirY, dirZ;
+        std::vector<float> colorR, colorG, colorB, intensity;
+    };
+
+    struct PointSoA
+    {
+        std::vector<float> posX, posY, posZ, radius;
+        std::vector<float> colorR, colorG, colorB, intensity;
+    };
+
+    struct SpotSoA
+    {
+        std::vector<float> posX, posY, posZ, radius;
+        std::vector<float> dirX, dirY, dirZ;
+        std::vector<float> colorR, colorG, colorB, intensity;
+        std::vector<float> innerAngle, outerAngle;      // as set, to detect changes
+        std::vector<float> cosInner, cosOuter;
+    };
+
+    struct Stats
+    {
+        uint32_t lights[TYPE_COUNT] = {};
+        uint32_t uploadedLights = 0;    // last upload()
+        uint32_t copies = 0;
+        size_t   uploadedBytes = 0;
+        size_t   fullBytes = 0;         // what re-uploading every light would have cost
+        double   avgUploadedBytes = 0.0;    // over HISTORY_FRAMES
+        double   avgFullBytes = 0.0;
+    };
+
+private:
+    // Stable id <-> dense slot, plus the dirty slots of one light type
+    struct Slots
+    {
+        std::vector<uint32_t> slotOfId;
+        std::vector<uint32_t> idOfSlot;
+        std::vector<uint32_t> freeIds;
+        std::vector<uint32_t> dirty;        // slots, unordered until upload()
+        std::vector<uint8_t>  dirtyFlags;
+
+        uint32_t add();                     // new id, its slot is the last one
+        uint32_t remove(uint32_t id);       // returns the slot the last light moved into (INVALID if none)
+        void     markDirty(uint32_t slot);
+        void     markAllDirty();
+        uint32_t size() const { return uint32_t(idOfSlot.size()); }
+    };
+
+    DirectionalSoA directionals;
+    PointSoA       points;
+    SpotSoA        spots;
+
+    Slots slots[TYPE_COUNT];
+
+    PersistentGpuBuffer gpu[TYPE_COUNT] =
+    {
+        PersistentGpuBuffer(sizeof(DirectionalLightGPU), L"Directional Lights"),
+        PersistentGpuBuffer(sizeof(PointLightGPU), L"Point Lights"),
+        PersistentGpuBuffer(sizeof(SpotLightGPU), L"Spot Lights"),
+    };
+
+    bool fullUpload = false;
+
+    Stats  stats;
+    size_t uploadHistory[HISTORY_FRAMES] = {};
+    size_t fullHistory[HISTORY_FRAMES] = {};
+    uint32_t historyIndex = 0;
+    uint32_t historyCount = 0;
+
+    void resizeArrays(LightType type, uint32_t count);
+    void moveLight(LightType type, uint32_t from, uint32_t to);
+
+public:
+    LightManager() = default;
+    ~LightManager() = default;
+
+    uint32_t addDirectional(const DirectionalLight& light);
+    uint32_t addPoint(const PointLight& light);
+    uint32_t addSpot(const SpotLight& light);
+
+    void setDirectional(uint32_t id, const DirectionalLight& light);
+    void setPoint(uint32_t id, const PointLight& light);
+    void setSpot(uint32_t id, const SpotLight& light);
+
+    // Only the position of a point light (animated lights)
+    void setPointPosition(uint32_t id, const DirectX::XMFLOAT3& position);
+
+    void remove(LightType type, uint32_t id);
+
+    uint32_t getCount(LightType type) const { return slots[type].size(); }
+    uint32_t getSlot(LightType type, uint32_t id) const { return slots[type].slotOfId[id]; }
+
+    const DirectionalSoA& getDirectionals() const { return directionals; }
+    const PointSoA& getPoints() const { return points; }
+    const SpotSoA& getSpots() const { return spots; }
+
+    // Before the draws that read the lights
+    void upload(ID3D12GraphicsCommandList* commandList, RingBufferModule* ring);
+
+    // Root SRVs (0 before the first upload)
+    D3D12_GPU_VIRTUAL_ADDRESS getGPUAddress(LightType type) const { return gpu[type].getGPUAddress(); }
+
+    // Benchmark switch: upload every light every frame (the old path)
+    void setFullUpload(bool enabled) { fullUpload = enabled; }
+    bool isFullUpload() const { return fullUpload; }
+
+    const Stats& getStats() const { return stats; }
+};
@@ -0,0 +1,212 @@
+#include "Globals.h"
+#include "LodSelector.h"
+
+#include <algorithm>
+#include <cfloat>
+
+namespace
+{
+    constexpr float MIN_DISTANCE = 1e-3f;       // camera inside the sphere
+    constexpr float BIAS_STEP = 0.05f;          // max bias change per frame
+    constexpr float BIAS_DEAD_ZONE = 0.05f;     // +-5% of the budget is "on target"
+
+    inline float pixelsPerUnitAtDistance(float fovY, float viewportHeight)
+    {
+        return viewportHeight / (2.0f * tanf(fovY * 0.5f));
+    }
+}
+
+void LodSelector::resize(size_t objectCount)
+{
+    count = objectCount;
+    capacity = (objectCount + 3) & ~size_t(3);
+
+    centerX.resize(capacity, 0.0f);
+    centerY.resize(capacity, 0.0f);
+    centerZ.resize(capacity, 0.0f);
+    radius.resize(capacity, 0.0f);
+    lodCount.resize(capacity, 1.0f);
+
+    for (uint32_t l = 0; l < MAX_LODS; ++l)
+        lodErrors[l].resize(capacity, l == 0 ? 0.0f : FLT_MAX);
+
+    previousLod.resize(capacity, 0);
+    currentLod.resize(capacity, 0);
+}
+
+void LodSelector::setObject(size_t index, const Vector3& center, float sphereRadius, uint32_t numLods, const float* errors)
+{
+    _ASSERTE(index < count);
+
+    numLods = std::min(std::max(numLods, 1u), MAX_LODS);
+
+    centerX[index] = center.x;
+    centerY[index] = center.y;
+    centerZ[index] = center.z;
+    radius[index] = sphereRadius;
+    lodCount[index] = float(numLods);
+
+    // Missing LODs get an infinite error so they are never chosen
+    for (uint32_t l = 0; l < MAX_LODS; ++l)
+        lodErrors[l][index] = (l < numLods && errors) ? errors[l] : (l == 0 ? 0.0f : FLT_MAX);
+}
+
+void LodSelector::select(const Vector3& cameraPos, float fovY, float viewportHeight)
+{
+    const float scale = exp2f(bias);
+    const float threshold = settings.pixelThreshold * scale;
+    const float cull = settings.cullPixels * scale;
+
+    const XMVECTOR camX = XMVectorReplicate(cameraPos.x);
+    const XMVECTOR camY = XMVectorReplicate(cameraPos.y);
+    const XMVECTOR camZ = XMVectorReplicate(cameraPos.z);
+    const XMVECTOR minDistance = XMVectorReplicate(MIN_DISTANCE);
+    const XMVECTOR k = XMVectorReplicate(pixelsPerUnitAtDistance(fovY, viewportHeight));
+
+    const XMVECTOR thresholdFiner = XMVectorReplicate(threshold);
+    const XMVECTOR thresholdCoarser = XMVectorReplicate(threshold * (1.0f - settings.hysteresis));
+    const XMVECTOR cullLimit = XMVectorReplicate(cull);
+    const XMVECTOR cullLimitBack = XMVectorReplicate(cull * (1.0f + settings.hysteresis));
+    const bool cullEnabled = cull > 0.0f;
+
+    const XMVECTOR one = g_XMOne;
+    const XMVECTOR zero = XMVectorZero();
+
+    for (size_t i = 0; i < capacity; i += 4)
+    {
+        // ------------------------------------------------------------
+        // Distance from the camera to the sphere surface
+        // ------------------------------------------------------------
+        XMVECTOR dx = XMVectorSubtract(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&centerX[i])), camX);
+        XMVECTOR dy = XMVectorSubtract(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&centerY[i])), camY);
+        XMVECTOR dz = XMVectorSubtract(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&centerZ[i])), camZ);
+        XMVECTOR r = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&radius[i]));
+
+        XMVECTOR distSq = XMVectorMultiplyAdd(dx, dx, XMVectorMultiplyAdd(dy, dy, XMVectorMultiply(dz, dz)));
+        XMVECTOR dist = XMVectorMax(XMVectorSubtract(XMVectorSqrt(distSq), r), minDistance);
+        XMVECTOR pixelsPerUnit = XMVectorDivide(k, dist);
+
+        // ------------------------------------------------------------
+        // Previous LOD (culled objects behave as their coarsest LOD)
+        // ------------------------------------------------------------
+        XMVECTOR n = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&lodCount[i]));
+
+        XMFLOAT4 prevF(
+            previousLod[i + 0] == LOD_CULLED ? -1.0f : float(previousLod[i + 0]),
+            previousLod[i + 1] == LOD_CULLED ? -1.0f : float(previousLod[i + 1]),
+            previousLod[i + 2] == LOD_CULLED ? -1.0f : float(previousLod[i + 2]),
+            previousLod[i + 3] == LOD_CULLED ? -1.0f : float(previousLod[i + 3]));
+
+        XMVECTOR prev = XMLoadFloat4(&prevF);
+        XMVECTOR prevCulled = XMVectorLess(prev, zero);
+        prev = XMVectorSelect(prev, XMVectorSubtract(n, one), prevCulled);
+
+        // ------------------------------------------------------------
+        // Errors grow with the LOD index, so the chosen LOD is the number
+        // of coarser LODs that pass the threshold
+        // ------------------------------------------------------------
+        XMVECTOR lod = zero;
+        for (uint32_t l = 1; l < MAX_LODS; ++l)
+        {
+            XMVECTOR level = XMVectorReplicate(float(l));
+            XMVECTOR limit = XMVectorSelect(thresholdFiner, thresholdCoarser, XMVectorGreater(level, prev));
+
+            XMVECTOR error = XMVectorMultiply(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&lodErrors[l][i])), pixelsPerUnit);
+            XMVECTOR pass = XMVectorLessOrEqual(error, limit);
+
+            lod = XMVectorAdd(lod, XMVectorAndInt(pass, one));
+        }
+
+        XMVECTOR culled = XMVectorFalseInt();
+        if (cullEnabled)
+        {
+            XMVECTOR radiusPixels = XMVectorMultiply(r, pixelsPerUnit);
+            culled = XMVectorLess(radiusPixels, XMVectorSelect(cullLimit, cullLimitBack, prevCulled));
+        }
+
+        XMFLOAT4 lodF;
+        XMStoreFloat4(&lodF, lod);
+
+        XMUINT4 culledU;
+        XMStoreUInt4(&culledU, culled);
+
+        currentLod[i + 0] = culledU.x ? LOD_CULLED : uint8_t(lodF.x);
+        currentLod[i + 1] = culledU.y ? LOD_CULLED : uint8_t(lodF.y);
+        currentLod[i + 2] = culledU.z ? LOD_CULLED : uint8_t(lodF.z);
+        currentLod[i + 3] = culledU.w ? LOD_CULLED : uint8_t(lodF.w);
+    }
+
+    previousLod = currentLod;
+    gatherStats();
+}
+
+void LodSelector::selectScalar(const Vector3& cameraPos, float fovY, float viewportHeight)
+{
+    const float scale = exp2f(bias);
+    const float threshold = settings.pixelThreshold * scale;
+    const float cull = settings.cullPixels * scale;
+    const float k = pixelsPerUnitAtDistance(fovY, viewportHeight);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Vector3 center(centerX[i], centerY[i], centerZ[i]);
+        const float dist = std::max(Vector3::Distance(center, cameraPos) - radius[i], MIN_DISTANCE);
+        const float pixelsPerUnit = k / dist;
+
+        const uint32_t numLods = uint32_t(lodCount[i]);
+        const bool prevCulled = previousLod[i] == LOD_CULLED;
+        const uint32_t prev = prevCulled ? numLods - 1 : previousLod[i];
+
+        if (cull > 0.0f)
+        {
+            const float limit = prevCulled ? cull * (1.0f + settings.hysteresis) : cull;
+            if (radius[i] * pixelsPerUnit < limit)
+            {
+                currentLod[i] = LOD_CULLED;
+                continue;
+            }
+        }
+
+        uint8_t lod = 0;
+        for (uint32_t l = 1; l < numLods; ++l)
+        {
+            const float limit = (l > prev) ? threshold * (1.0f - settings.hysteresis) : threshold;
+            if (lodErrors[l][i] * pixelsPerUnit > limit)
+                break;
+            lod = uint8_t(l);
+        }
+
+        currentLod[i] = lod;
+    }
+
+    previousLod = currentLod;
+    gatherStats();
+}
+
+void LodSelector::updateBudget(float frameMs)
+{
+    if (frameMs <= 0.0f || settings.budgetMs <= 0.0f)
+        return;
+
+    float error = (frameMs - settings.budgetMs) / settings.budgetMs;
+    if (fabsf(error) < BIAS_DEAD_ZONE)
+        return;
+
+    float step = std::min(std::max(error * BIAS_STEP, -BIAS_STEP), BIAS_STEP);
+    bias = std::min(std::max(bias + step, 0.0f), settings.maxBias);
+}
+
+void LodSelector::gatherStats()
+{
+    for (uint32_t& c : lodHistogram)
+        c = 0;
+    culledCount = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (currentLod[i] == LOD_CULLED)
+            ++culledCount;
+        else
+            ++lodHistogram[currentLod[i]];
+    }
+}
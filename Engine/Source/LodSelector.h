@@ -0,0 +1,98 @@
+#pragma once
+
+#include <vector>
+
+// ============================================================================
+// LodSelector
+// ----------------------------------------------------------------------------
+// Per-frame level-of-detail selection driven by screen-space error.
+//
+// For every object we know its world bounding sphere and, per LOD, the
+// geometric error (world units) that LOD introduces compared to LOD 0.
+// Each frame:
+//
+//   pixelsPerUnit = viewportHeight / (2 * tan(fovY / 2)) / distance
+//   screenError   = lodError * pixelsPerUnit
+//
+// and the coarsest LOD whose screenError stays under the pixel threshold is
+// chosen. 'distance' is measured to the sphere surface (clamped to a small
+// positive value when the camera is inside it).
+//
+// Extras:
+// - Hysteresis: moving to a coarser LOD than last frame requires the error to
+//   be (1 - hysteresis) times under the threshold, so objects sitting on a
+//   boundary do not pop back and forth.
+// - Detail culling: objects whose projected radius is below 'cullPixels' get
+//   LOD_CULLED (with the same hysteresis when coming back).
+// - Global bias: updateBudget() nudges a bias from the measured frame time;
+//   thresholds are scaled by 2^bias, so a slow frame picks coarser LODs.
+// - select() evaluates 4 objects per iteration with DirectXMath vectors
+//   (object data is stored SoA); selectScalar() is the reference path.
+//
+// Objects are identified by index. Object data can be rewritten every frame;
+// the previous LOD of each index is kept for hysteresis.
+// ============================================================================
+
+class LodSelector
+{
+public:
+    static constexpr uint32_t MAX_LODS = 8;
+    static constexpr uint8_t  LOD_CULLED = 0xFF;
+
+    struct Settings
+    {
+        float pixelThreshold = 1.0f;    // max screen-space error allowed (pixels)
+        float hysteresis = 0.2f;        // 0 = none, 0.2 = 20% margin before coarsening
+        float cullPixels = 0.0f;        // projected radius under which the object is skipped (0 = off)
+        float budgetMs = 16.6f;         // frame time target for the bias controller
+        float maxBias = 3.0f;           // thresholds scale up to 2^maxBias
+    };
+
+    Settings settings;
+
+private:
+    size_t count = 0;
+    size_t capacity = 0;                // count rounded up to 4
+
+    // SoA object data (padded to a multiple of 4)
+    std::vector<float> centerX, centerY, centerZ, radius;
+    std::vector<float> lodCount;
+    std::vector<float> lodErrors[MAX_LODS];
+
+    std::vector<uint8_t> previousLod;
+    std::vector<uint8_t> currentLod;
+
+    float bias = 0.0f;
+
+    // Stats from the last select()
+    uint32_t lodHistogram[MAX_LODS] = {};
+    uint32_t culledCount = 0;
+
+    void gatherStats();
+
+public:
+    LodSelector() = default;
+    ~LodSelector() = default;
+
+    // Sets the number of objects; new objects start at LOD 0
+    void resize(size_t objectCount);
+    size_t size() const { return count; }
+
+    // 'errors' holds 'numLods' world-space errors, increasing with the LOD index (errors[0] is normally 0)
+    void setObject(size_t index, const Vector3& center, float sphereRadius, uint32_t numLods, const float* errors);
+
+    // Picks a LOD for every object. fovY in radians, viewportHeight in pixels.
+    void select(const Vector3& cameraPos, float fovY, float viewportHeight);
+    void selectScalar(const Vector3& cameraPos, float fovY, float viewportHeight);
+
+    // Feeds the last frame time into the bias controller
+    void updateBudget(float frameMs);
+
+    uint8_t getLod(size_t index) const { return currentLod[index]; }
+    const uint8_t* getLods() const { return currentLod.data(); }
+
+    float    getBias() const { return bias; }
+    void     setBias(float value) { bias = value; }
+    uint32_t getLodCount(uint32_t lod) const { return lod < MAX_LODS ? lodHistogram[lod] : 0; }
+    uint32_t getCulledCount() const { return culledCount; }
+};
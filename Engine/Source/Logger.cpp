@@ -9,6 +9,7 @@
 
 
 std::vector<LogEntry> Logger::messages;
+std::mutex Logger::mutex;
 
 std::string Logger::getTime()
 {
@@ -38,37 +39,45 @@ void Logger::Log(const std::string& message)
 {
     std::string newMessage = "[LOG]: " + getTime() + " - " + message;
 
-    LogEntry logEntry;
-    logEntry.type = LOG_INFO;
-    logEntry.message = newMessage;
-
-    messages.push_back(logEntry);
+    add(LOG_INFO, newMessage);
 }
 
 void Logger::Err(const std::string& message)
 {
     std::string newMessage = "[ERR]: " + getTime() + " - " + message;
 
-    LogEntry logEntry;
-    logEntry.type = LOG_ERROR;
-    logEntry.message = newMessage;
-
-    messages.push_back(logEntry);
-
+    add(LOG_ERROR, newMessage);
 }
 
 void Logger::Warn(const std::string& message) 
 {
     std::string newMessage = "[WAR]: " + getTime() + " - " + message;
 
-    LogEntry logEntry;
-    logEntry.type = LOG_WARNING;
-    logEntry.message = newMessage;
-
-    messages.push_back(logEntry);
+    add(LOG_WARNING, newMessage);
 }
 
 void Logger::Clear()
 {
+    std::lock_guard<std::mutex> lock(mutex);
     messages.clear();
+}
+
+void Logger::add(LogType type, const std::string& message)
+{
+    LogEntry logEntry;
+    logEntry.type = type;
+    logEntry.message = message;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    messages.push_back(std::move(logEntry));
+}
+
+void Logger::CopyMessages(std::vector<LogEntry>& copy)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (copy.size() > messages.size())
+        copy.clear();
+
+    copy.insert(copy.end(), messages.begin() + copy.size(), messages.end());
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -14,7 +15,8 @@
 // -Warn() : Records warnings.
 // -Err() : Records errors.
 // -Clear() : Clears all stored messages.
-// -GetMessages() allows access to all stored log entries, useful for consoles, debug windows, or runtime inspection.
+// -CopyMessages() brings a copy of the stored log entries up to date, useful for consoles, debug windows, or runtime inspection.
+// -Thread safe: loading jobs log from worker threads.
 //
 // Usage Example :
 // Logger::Log("Engine initialized.");
@@ -39,7 +41,9 @@ class Logger
 {
 private:
 	static std::vector<LogEntry> messages;
+	static std::mutex mutex;
 	static std::string getTime();
+	static void add(LogType type, const std::string& message);
 
 public:
 	
@@ -47,6 +51,7 @@ public:
 	static void Err(const std::string& message);
 	static void Warn(const std::string& message);
 	static void Clear();
-	static const std::vector<LogEntry>& GetMessages() { return messages; }
+	// Appends the entries 'copy' does not have yet (starts over after a Clear())
+	static void CopyMessages(std::vector<LogEntry>& copy);
 };
 
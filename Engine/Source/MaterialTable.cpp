@@ -0,0 +1,73 @@
+#include "Globals.h"
+#include "MaterialTable.h"
+
+#include "RingBufferModule.h"
+
+#include <algorithm>
+
+uint32_t MaterialTable::add(const MaterialRecord& record)
+{
+    const uint32_t index = uint32_t(records.size());
+    records.push_back(record);
+    dirtyFlags.push_back(0);
+    markDirty(index);
+    return index;
+}
+
+void MaterialTable::set(uint32_t index, const MaterialRecord& record)
+{
+    _ASSERTE(index < records.size());
+
+    // Re-sending the same values every frame costs a memcmp, not an upload
+    if (std::memcmp(&records[index], &record, sizeof(MaterialRecord)) == 0)
+        return;
+
+    records[index] = record;
+    markDirty(index);
+}
+
+void MaterialTable::markDirty(uint32_t index)
+{
+    if (dirtyFlags[index])
+        return;
+
+    dirtyFlags[index] = 1;
+    dirty.push_back(index);
+}
+
+void MaterialTable::upload(ID3D12GraphicsCommandList* commandList, RingBufferModule* ring)
+{
+    stats.records = uint32_t(records.size());
+    stats.uploadedRecords = 0;
+    stats.copies = 0;
+
+    // A new buffer starts empty: every record goes up
+    if (gpu.reserve(uint32_t(records.size())))
+    {
+        for (uint32_t i = 0; i < uint32_t(records.size()); ++i)
+            markDirty(i);
+    }
+
+    stats.capacity = gpu.getCapacity();
+    stats.resizes = gpu.getResizes();
+
+    if (dirty.empty() || records.size() > gpu.getCapacity())
+        return;
+
+    std::sort(dirty.begin(), dirty.end());
+
+    const size_t bytes = gpu.upload(commandList, ring, dirty, [this](uint32_t index, void* dst)
+        {
+            std::memcpy(dst, &records[index], sizeof(MaterialRecord));
+        }, &stats.copies);
+
+    // No staging memory: keep them dirty and try again next frame
+    if (bytes == 0)
+        return;
+
+    for (uint32_t index : dirty)
+        dirtyFlags[index] = 0;
+
+    stats.uploadedRecords = uint32_t(dirty.size());
+    dirty.clear();
+}
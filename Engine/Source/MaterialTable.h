@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+
+#include "BasicMaterial.h"
+#include "PersistentGpuBuffer.h"
+
+// ============================================================================
+// MaterialTable
+// ----------------------------------------------------------------------------
+// Every material of a scene as one record in a GPU StructuredBuffer, for the
+// bindless path: a draw passes its material index as a root constant and the
+// shader reads the record (colours, shininess, texture index) from the table
+// and the texture from the bindless SRV range
+// (ShaderDescriptorsModule::getBindlessTable()). No per-draw descriptor
+// table, no per-instance material copies.
+//
+// - add() appends a record and returns its index, set() replaces it. Both
+//   only mark the record dirty when its bytes actually changed.
+// - upload() copies only the dirty records into the GPU copy (a
+//   PersistentGpuBuffer: ring staging, one copy per run). Frames without
+//   edits upload nothing.
+//
+// Not thread safe: owned by the exercise that renders with it.
+// ============================================================================
+
+class RingBufferModule;
+
+// 'MaterialData' in the bindless shaders (Exercise8PS.hlsl)
+struct MaterialRecord
+{
+    PBRPhongMaterialData phong;
+    uint32_t             colourTexture = 0;     // bindless SRV index (the null SRV without texture)
+    uint32_t             colourSampler = 0;     // SamplersModule slot
+    uint32_t             padding[2] = {};
+};
+
+class MaterialTable
+{
+public:
+    struct Stats
+    {
+        uint32_t records = 0;
+        uint32_t capacity = 0;
+        uint32_t uploadedRecords = 0;   // last upload()
+        uint32_t copies = 0;            // CopyBufferRegion calls of the last upload()
+        uint32_t resizes = 0;
+    };
+
+private:
+    std::vector<MaterialRecord> records;
+    std::vector<uint32_t>       dirty;          // indices, unordered until upload()
+    std::vector<uint8_t>        dirtyFlags;
+
+    PersistentGpuBuffer         gpu{ sizeof(MaterialRecord), L"Material Table" };
+
+    Stats stats;
+
+    void markDirty(uint32_t index);
+
+public:
+    MaterialTable() = default;
+    ~MaterialTable() = default;
+
+    uint32_t add(const MaterialRecord& record);
+    void set(uint32_t index, const MaterialRecord& record);
+    const MaterialRecord& get(uint32_t index) const { return records[index]; }
+    uint32_t getCount() const { return uint32_t(records.size()); }
+
+    // Before the draws that read the table
+    void upload(ID3D12GraphicsCommandList* commandList, RingBufferModule* ring);
+
+    // Root SRV of the table (0 before the first upload)
+    D3D12_GPU_VIRTUAL_ADDRESS getGPUAddress() const { return gpu.getGPUAddress(); }
+
+    const Stats& getStats() const { return stats; }
+};
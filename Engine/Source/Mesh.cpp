@@ -32,11 +32,35 @@ void Mesh::load(const tinygltf::Model& model, const tinygltf::Mesh& gltfMesh, co
 		// Load the texture coordinate data if it exists
 		loadAccessorData(vertexData + offsetof(Vertex, texCoord0), sizeof(Vector2), sizeof(Vertex), numVertices, model, primitive.attributes, "TEXCOORD_0");
 
+		// Keep positions on the CPU for picking
+		cpuPositions.resize(numVertices);
+		for (uint32_t i = 0; i < numVertices; ++i)
+			cpuPositions[i] = vertices[i].position;
+
+		// Bounding sphere: AABB center + farthest vertex (LOD selection, culling)
+		if (numVertices > 0)
+		{
+			Vector3 minP = vertices[0].position;
+			Vector3 maxP = vertices[0].position;
+			for (uint32_t i = 1; i < numVertices; ++i)
+			{
+				minP = Vector3::Min(minP, vertices[i].position);
+				maxP = Vector3::Max(maxP, vertices[i].position);
+			}
+
+			boundsCenter = (minP + maxP) * 0.5f;
+
+			float maxDistSq = 0.0f;
+			for (uint32_t i = 0; i < numVertices; ++i)
+				maxDistSq = std::max(maxDistSq, Vector3::DistanceSquared(boundsCenter, vertices[i].position));
+
+			boundsRadius = sqrtf(maxDistSq);
+		}
+
 		// Upload vertex data to GPU using the engine's default buffer creation (DEFAULT heap + staging)
-		vertexBuffer = app->getResources()->createDefaultBuffer(vertices, numVertices * sizeof(Vertex), "VertexBuffer");
+		vertexBuffer = app->getResources()->createStaticBuffer(vertices, numVertices * sizeof(Vertex), "VertexBuffer");
 
-		// Fill the D3D12_VERTEX_BUFFER_VIEW structure for IASetVertexBuffers
-		vertexView.BufferLocation = vertexBuffer->GetGPUVirtualAddress();
+		// Fill the D3D12_VERTEX_BUFFER_VIEW structure for IASetVertexBuffers (address: getVertexView())
 		vertexView.StrideInBytes = sizeof(Vertex);
 		vertexView.SizeInBytes = numVertices * sizeof(Vertex);
 
@@ -62,11 +86,17 @@ void Mesh::load(const tinygltf::Model& model, const tinygltf::Mesh& gltfMesh, co
 					if (loadAccessorData(indices, indexElementSize, indexElementSize, numIndices, model, primitive.indices)) {
 						size_t totalSize = numIndices * indexElementSize;
 
-						auto result = app->getResources()->createDefaultBuffer(indices, totalSize, "IndexBuffer");
-						indexBuffer = result;
+						cpuIndices.resize(numIndices);
+						for (uint32_t i = 0; i < numIndices; ++i)
+						{
+							if (indexElementSize == 1)      cpuIndices[i] = indices[i];
+							else if (indexElementSize == 2) cpuIndices[i] = reinterpret_cast<const uint16_t*>(indices)[i];
+							else                            cpuIndices[i] = reinterpret_cast<const uint32_t*>(indices)[i];
+						}
+
+						indexBuffer = app->getResources()->createStaticBuffer(indices, totalSize, "IndexBuffer");
 
 						if (indexBuffer != nullptr) {
-							indexView.BufferLocation = indexBuffer->GetGPUVirtualAddress();
 							static const DXGI_FORMAT formats[3] = { DXGI_FORMAT_R8_UINT, DXGI_FORMAT_R16_UINT, DXGI_FORMAT_R32_UINT };
 							indexView.Format = formats[(indexElementSize >> 1)];
 							indexView.SizeInBytes = UINT(totalSize);
@@ -85,3 +115,54 @@ void Mesh::load(const tinygltf::Model& model, const tinygltf::Mesh& gltfMesh, co
 }
 
 
+
+void Mesh::triangleAt(uint32_t triangle, uint32_t& i0, uint32_t& i1, uint32_t& i2) const
+{
+	if (cpuIndices.empty())
+	{
+		i0 = triangle * 3; i1 = i0 + 1; i2 = i0 + 2;
+	}
+	else
+	{
+		i0 = cpuIndices[triangle * 3 + 0];
+		i1 = cpuIndices[triangle * 3 + 1];
+		i2 = cpuIndices[triangle * 3 + 2];
+	}
+}
+
+const BVH& Mesh::getTriangleBVH() const
+{
+	if (!triangleBVH)
+	{
+		const uint32_t triangleCount = getTriangleCount();
+
+		std::vector<BoundingBox3> boxes(triangleCount);
+		for (uint32_t t = 0; t < triangleCount; ++t)
+		{
+			uint32_t i0, i1, i2;
+			triangleAt(t, i0, i1, i2);
+			boxes[t].grow(cpuPositions[i0]);
+			boxes[t].grow(cpuPositions[i1]);
+			boxes[t].grow(cpuPositions[i2]);
+		}
+
+		triangleBVH = std::make_shared<BVH>();
+		triangleBVH->build(boxes.data(), boxes.size());
+	}
+
+	return *triangleBVH;
+}
+
+bool Mesh::intersect(const PickRay& ray, float& t, uint32_t& triangle) const
+{
+	return getTriangleBVH().intersect(ray, t, [&](uint32_t tri, float& tMax)
+		{
+			uint32_t i0, i1, i2;
+			triangleAt(tri, i0, i1, i2);
+			if (!intersectTriangle(ray, cpuPositions[i0], cpuPositions[i1], cpuPositions[i2], tMax))
+				return false;
+
+			triangle = tri;
+			return true;
+		});
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "BVH.h"
+#include "GpuHeapAllocator.h"
+
 namespace tinygltf { class Model;  struct Mesh; struct Primitive; }
 
 struct Vertex
@@ -12,9 +15,11 @@ struct Vertex
 class Mesh
 {
 private:
-    ComPtr<ID3D12Resource> vertexBuffer;
-    ComPtr<ID3D12Resource> indexBuffer;
+    // Ranges of the static buffer heaps, shared by copies of the mesh
+    GpuAllocationPtr vertexBuffer;
+    GpuAllocationPtr indexBuffer;
 
+    // Stride / size / format; the address is read through the allocation (defragmentation moves it)
     D3D12_VERTEX_BUFFER_VIEW vertexView{};
     D3D12_INDEX_BUFFER_VIEW indexView{};
 
@@ -23,16 +28,47 @@ private:
 
     int materialIndex = -1;
 
+    // Object-space bounding sphere of the positions
+    Vector3 boundsCenter = Vector3::Zero;
+    float   boundsRadius = 0.0f;
+
+    // CPU copy of the geometry for picking. The triangle BVH is built on first use and shared by copies of the mesh.
+    std::vector<Vector3>  cpuPositions;
+    std::vector<uint32_t> cpuIndices;        // empty = non-indexed triangle list
+    mutable std::shared_ptr<BVH> triangleBVH;
+
+    void triangleAt(uint32_t triangle, uint32_t& i0, uint32_t& i1, uint32_t& i2) const;
+
 public:
 
     Mesh() = default;
 
-    const D3D12_VERTEX_BUFFER_VIEW& getVertexView() const { return vertexView; }
-    const D3D12_INDEX_BUFFER_VIEW& getIndexView()  const { return indexView; }
+    D3D12_VERTEX_BUFFER_VIEW getVertexView() const
+    {
+        D3D12_VERTEX_BUFFER_VIEW view = vertexView;
+        view.BufferLocation = vertexBuffer ? vertexBuffer->getGPUAddress() : 0;
+        return view;
+    }
+
+    D3D12_INDEX_BUFFER_VIEW getIndexView() const
+    {
+        D3D12_INDEX_BUFFER_VIEW view = indexView;
+        view.BufferLocation = indexBuffer ? indexBuffer->getGPUAddress() : 0;
+        return view;
+    }
     uint32_t getVertexCount() const { return numVertices; }
     uint32_t getIndexCount()  const { return numIndices; }
     int      getMaterialIndex() const { return materialIndex; }
 
+    const Vector3& getBoundsCenter() const { return boundsCenter; }
+    float          getBoundsRadius() const { return boundsRadius; }
+
+    uint32_t   getTriangleCount() const { return uint32_t(cpuIndices.empty() ? cpuPositions.size() / 3 : cpuIndices.size() / 3); }
+    const BVH& getTriangleBVH() const;
+
+    // Object-space ray test. On a hit closer than 't', updates 't' and 'triangle'.
+    bool intersect(const PickRay& ray, float& t, uint32_t& triangle) const;
+
     bool hasIndices() const { return numIndices > 0; }
 
     void setMaterialIndex(int idx) { materialIndex = idx; }
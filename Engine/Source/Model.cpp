@@ -3,6 +3,8 @@
 
 #include "Mesh.h"
 #include "BasicMaterial.h"
+#include "Application.h"
+#include "JobSystem.h"
 
 #define TINYGLTF_NO_STB_IMAGE_WRITE
 #define TINYGLTF_NO_STB_IMAGE
@@ -51,12 +53,22 @@ bool Model::Load(const char* folderName, const char* assetFileName, BasicMateria
         return false;
     }
 
-    // Load Material
-    for (const auto& mat : model.materials) {
-        BasicMaterial newMat;
-        newMat.load(model, mat, MatType, folderName);
-        materials.push_back(newMat);
-    }
+    // ------------------------------------------------------------
+    // Load Material: one job per material, so their textures decode
+    // in parallel (the uploads themselves go one at a time)
+    // ------------------------------------------------------------
+    materials.resize(model.materials.size());
+    auto loadMaterials = [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                materials[i].load(model, model.materials[i], MatType, folderName);
+        };
+
+    JobSystem* jobs = app->getJobSystem();
+    if (jobs && jobs->getWorkerCount() > 0 && materials.size() > 1)
+        jobs->parallelFor(0, materials.size(), 1, loadMaterials);
+    else
+        loadMaterials(0, materials.size());
 
     Logger::Log("=== MATERIALS DEBUG ===");
     for (size_t i = 0; i < materials.size(); i++)
@@ -64,7 +76,7 @@ bool Model::Load(const char* folderName, const char* assetFileName, BasicMateria
         std::string hasTexStr = materials[i].hasTexture() ? "TRUE" : "FALSE";
         std::string bufferStr = materials[i].getMaterialBuffer() ? "OK" : "NULL";
         Logger::Log("Mat[" + std::to_string(i) + "]: hasTex=" + hasTexStr +
-            " srv=" + std::to_string(materials[i].getColourTexSRV()) +
+            " srv=" + std::to_string(materials[i].getColourTexSRV().index()) +
             " buffer=" + bufferStr);
     }
     Logger::Log("=== END MATERIALS DEBUG ===");
@@ -79,6 +91,32 @@ bool Model::Load(const char* folderName, const char* assetFileName, BasicMateria
         }
     }
 
+    computeBounds();
+
     Logger::Log("FINISHED - Meshes: " + std::to_string(meshes.size()) + ", Materials: " + std::to_string(materials.size()));
     return true;
 }
+
+void Model::computeBounds()
+{
+    if (meshes.empty())
+    {
+        boundsCenter = Vector3::Zero;
+        boundsRadius = 0.0f;
+        return;
+    }
+
+    // Merge the mesh spheres through their AABB, then grow the radius to contain all of them
+    Vector3 minP = meshes[0].getBoundsCenter() - Vector3(meshes[0].getBoundsRadius());
+    Vector3 maxP = meshes[0].getBoundsCenter() + Vector3(meshes[0].getBoundsRadius());
+    for (const Mesh& mesh : meshes)
+    {
+        minP = Vector3::Min(minP, mesh.getBoundsCenter() - Vector3(mesh.getBoundsRadius()));
+        maxP = Vector3::Max(maxP, mesh.getBoundsCenter() + Vector3(mesh.getBoundsRadius()));
+    }
+
+    boundsCenter = (minP + maxP) * 0.5f;
+    boundsRadius = 0.0f;
+    for (const Mesh& mesh : meshes)
+        boundsRadius = std::max(boundsRadius, Vector3::Distance(boundsCenter, mesh.getBoundsCenter()) + mesh.getBoundsRadius());
+}
@@ -13,6 +13,12 @@ private:
 
     Matrix modelMatrix = Matrix::Identity;
 
+    // Object-space sphere enclosing every mesh
+    Vector3 boundsCenter = Vector3::Zero;
+    float   boundsRadius = 0.0f;
+
+    void computeBounds();
+
 public:
     Model();
     ~Model();
@@ -35,5 +41,8 @@ public:
     size_t getMeshCount() const { return meshes.size(); }
     const Mesh& getMesh(size_t i) const { return meshes[i]; }
 
+    const Vector3& getBoundsCenter() const { return boundsCenter; }
+    float          getBoundsRadius() const { return boundsRadius; }
+
 };
 
@@ -2,6 +2,63 @@
 
 #include "Globals.h"
 
+// ============================================================================
+// Module phases / access declarations
+// ----------------------------------------------------------------------------
+// Every module tells the ModuleScheduler, per phase, which shared engine
+// state it reads and writes. Two modules that do not conflict can run their
+// callbacks at the same time on worker threads; conflicting ones keep their
+// registration order.
+//
+// The default declaration (reads and writes everything, main thread) keeps
+// the old serial behaviour, so a module only needs to override getAccess()
+// once it knows what it touches.
+// ============================================================================
+
+enum class ModulePhase
+{
+    Update = 0,
+    PreRender,
+    Render,
+    PostRender,
+    Count
+};
+
+namespace ModuleResource
+{
+    enum : uint32_t
+    {
+        None        = 0,
+        Jobs        = 1 << 0,   // main-thread job queue
+        Input       = 1 << 1,   // keyboard / mouse / gamepad state
+        Device      = 1 << 2,   // D3D12 device, queue, swap chain, frame index
+        CommandList = 1 << 3,   // the frame command list
+        Camera      = 1 << 4,
+        Scene       = 1 << 5,   // exercises, models, materials
+        RingBuffer  = 1 << 6,
+        Descriptors = 1 << 7,   // shader descriptor / sampler heaps
+        Editor      = 1 << 8,   // ImGui frame, panels, viewport
+        All         = 0xFFFFFFFFu
+    };
+}
+
+struct ModuleAccess
+{
+    uint32_t reads = ModuleResource::All;
+    uint32_t writes = ModuleResource::All;
+    bool     mainThread = true;     // D3D12 recording, ImGui and Win32 calls must stay on the main thread
+    bool     active = true;         // false: the module does nothing in this phase and is not scheduled
+
+    static ModuleAccess idle() { ModuleAccess a; a.reads = a.writes = ModuleResource::None; a.mainThread = false; a.active = false; return a; }
+    static ModuleAccess worker(uint32_t reads, uint32_t writes) { ModuleAccess a; a.reads = reads; a.writes = writes; a.mainThread = false; return a; }
+    static ModuleAccess main(uint32_t reads, uint32_t writes) { ModuleAccess a; a.reads = reads; a.writes = writes; return a; }
+
+    bool conflictsWith(const ModuleAccess& other) const
+    {
+        return (writes & (other.reads | other.writes)) != 0 || (reads & other.writes) != 0;
+    }
+};
+
 class Module
 {
 public:
@@ -40,4 +97,20 @@ public:
 	{ 
 		return true; 
 	}
+
+    // Main thread, between frames, while no simulation runs: hand the state
+    // produced by update() over to the render stage (see SnapshotBuffer)
+    virtual void publish()
+    {
+    }
+
+    virtual const char* getName() const
+    {
+        return "Module";
+    }
+
+    virtual ModuleAccess getAccess(ModulePhase phase) const
+    {
+        return ModuleAccess();
+    }
 };
@@ -16,3 +16,20 @@ ModuleInput::ModuleInput(HWND hWnd)
 }
 
 
+void ModuleInput::update()
+{
+    mouseState = mouse->GetState();
+    keyboardState = keyboard->GetState();
+}
+
+ModuleAccess ModuleInput::getAccess(ModulePhase phase) const
+{
+    using namespace ModuleResource;
+
+    // Main thread, where the window procedure writes the devices. Declaring the
+    // write orders every module that reads Input after the copy.
+    if (phase == ModulePhase::Update)
+        return ModuleAccess::main(None, Input);
+
+    return ModuleAccess::idle();
+}
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "Module.h"
+#include "Keyboard.h"
+#include "Mouse.h"
 
-namespace DirectX { class Keyboard; class Mouse; class GamePad;  }
+namespace DirectX { class GamePad;  }
 
 class ModuleInput : public Module
 {
@@ -10,8 +12,21 @@ public:
 
     ModuleInput(HWND hWnd);
 
+    // Devices are fed from the window procedure (main thread). update() copies
+    // their state, so modules updating on workers read the copy, never the devices.
+    void update() override;
+
+    const char* getName() const override { return "Input"; }
+    ModuleAccess getAccess(ModulePhase phase) const override;
+
+    const Mouse::State&    getMouseState() const { return mouseState; }
+    const Keyboard::State& getKeyboardState() const { return keyboardState; }
+
 private:
     std::unique_ptr<Keyboard> keyboard;
     std::unique_ptr<Mouse> mouse;
     std::unique_ptr<GamePad> gamePad;
+
+    Mouse::State    mouseState = {};
+    Keyboard::State keyboardState = {};
 };
@@ -0,0 +1,208 @@
+#include "Globals.h"
+#include "ModuleScheduler.h"
+
+#include "JobSystem.h"
+
+#include <algorithm>
+
+namespace
+{
+    void callPhase(Module* module, ModulePhase phase)
+    {
+        switch (phase)
+        {
+        case ModulePhase::Update:     module->update(); break;
+        case ModulePhase::PreRender:  module->preRender(); break;
+        case ModulePhase::Render:     module->render(); break;
+        case ModulePhase::PostRender: module->postRender(); break;
+        default: break;
+        }
+    }
+}
+
+const char* ModuleScheduler::getPhaseName(ModulePhase phase)
+{
+    static const char* names[] = { "Update", "PreRender", "Render", "PostRender" };
+    return size_t(phase) < size_t(ModulePhase::Count) ? names[size_t(phase)] : "?";
+}
+
+void ModuleScheduler::build(const std::vector<Module*>& moduleList)
+{
+    modules = moduleList;
+
+    timings.assign(modules.size(), ModuleTiming());
+    for (size_t i = 0; i < modules.size(); ++i)
+        timings[i].name = modules[i]->getName();
+
+    for (size_t p = 0; p < size_t(ModulePhase::Count); ++p)
+    {
+        const ModulePhase phase = ModulePhase(p);
+        PhaseGraph& graph = graphs[p];
+        graph.nodes.clear();
+        graph.edges = 0;
+        graph.width = 0;
+
+        for (uint32_t m = 0; m < uint32_t(modules.size()); ++m)
+        {
+            ModuleAccess access = modules[m]->getAccess(phase);
+            if (!access.active)
+                continue;
+
+            Node node;
+            node.module = m;
+            node.access = access;
+
+            // Depend on every earlier node we conflict with
+            const uint32_t index = uint32_t(graph.nodes.size());
+            for (uint32_t prev = 0; prev < index; ++prev)
+            {
+                if (access.conflictsWith(graph.nodes[prev].access))
+                {
+                    graph.nodes[prev].successors.push_back(index);
+                    ++node.dependencies;
+                    ++graph.edges;
+                }
+            }
+
+            if (node.dependencies == 0)
+                ++graph.width;
+
+            graph.nodes.push_back(std::move(node));
+        }
+
+        graph.pending = std::make_unique<std::atomic<uint32_t>[]>(graph.nodes.size());
+        graph.nodeMs.assign(graph.nodes.size(), 0.0f);
+    }
+}
+
+void ModuleScheduler::runNode(ModulePhase phase, uint32_t nodeIndex)
+{
+    const Node& node = graphs[size_t(phase)].nodes[nodeIndex];
+
+    Timer t;
+    t.Start();
+    callPhase(modules[node.module], phase);
+    t.Stop();
+
+    // Each slot is written by one node only; the job counter publishes it to the main thread
+    graphs[size_t(phase)].nodeMs[nodeIndex] += float(t.ReadMs());
+}
+
+void ModuleScheduler::commitTimings(ModulePhase phase)
+{
+    const PhaseGraph& graph = graphs[size_t(phase)];
+    for (size_t i = 0; i < graph.nodes.size(); ++i)
+        timings[graph.nodes[i].module].ms[size_t(phase)] = graph.nodeMs[i];
+}
+
+void ModuleScheduler::submitRoots(ModulePhase phase, JobSystem& jobs, JobCounter& counter)
+{
+    PhaseGraph& graph = graphs[size_t(phase)];
+
+    for (size_t i = 0; i < graph.nodes.size(); ++i)
+        graph.pending[i].store(graph.nodes[i].dependencies, std::memory_order_relaxed);
+    graph.remainingNodes.store(uint32_t(graph.nodes.size()), std::memory_order_relaxed);
+
+    for (uint32_t i = 0; i < uint32_t(graph.nodes.size()); ++i)
+    {
+        if (graph.nodes[i].dependencies == 0)
+            submit(phase, i, jobs, counter);
+    }
+}
+
+void ModuleScheduler::submit(ModulePhase phase, uint32_t nodeIndex, JobSystem& jobs, JobCounter& counter)
+{
+    auto fn = [this, phase, nodeIndex, &jobs, &counter]()
+        {
+            runNode(phase, nodeIndex);
+
+            // Release successors; the last dependency to finish submits them.
+            // They are added to 'counter' before this job completes, so it cannot reach zero early.
+            PhaseGraph& graph = graphs[size_t(phase)];
+            for (uint32_t next : graph.nodes[nodeIndex].successors)
+            {
+                if (graph.pending[next].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    submit(phase, next, jobs, counter);
+            }
+
+            // Last node of the iteration: start the next repeat
+            if (graph.remainingNodes.fetch_sub(1, std::memory_order_acq_rel) == 1 && graph.repeatsLeft > 0)
+            {
+                --graph.repeatsLeft;
+                submitRoots(phase, jobs, counter);
+            }
+        };
+
+    if (graphs[size_t(phase)].nodes[nodeIndex].access.mainThread)
+        jobs.runOnMainThread(std::move(fn), &counter);
+    else
+        jobs.run(std::move(fn), &counter);
+}
+
+void ModuleScheduler::start(ModulePhase phase, JobSystem& jobs, JobCounter& counter, uint32_t repeat)
+{
+    PhaseGraph& graph = graphs[size_t(phase)];
+    std::fill(graph.nodeMs.begin(), graph.nodeMs.end(), 0.0f);
+
+    if (repeat == 0 || graph.nodes.empty())
+        return;
+
+    graph.repeatsLeft = repeat - 1;
+    submitRoots(phase, jobs, counter);
+}
+
+void ModuleScheduler::run(ModulePhase phase, JobSystem* jobs, uint32_t repeat)
+{
+    PhaseGraph& graph = graphs[size_t(phase)];
+
+    Timer t;
+    t.Start();
+
+    const bool parallel = jobs && jobs->getWorkerCount() > 0 && jobs->isMainThread() && graph.nodes.size() > 1;
+
+    if (!parallel)
+    {
+        std::fill(graph.nodeMs.begin(), graph.nodeMs.end(), 0.0f);
+
+        // Registration order is a valid topological order
+        for (uint32_t r = 0; r < repeat; ++r)
+        {
+            for (uint32_t i = 0; i < uint32_t(graph.nodes.size()); ++i)
+                runNode(phase, i);
+        }
+    }
+    else
+    {
+        JobCounter counter;
+        start(phase, *jobs, counter, repeat);
+
+        // Runs the main-thread nodes as they become ready
+        jobs->wait(counter);
+    }
+
+    t.Stop();
+    phaseMs[size_t(phase)] = float(t.ReadMs());
+    commitTimings(phase);
+}
+
+void ModuleScheduler::runAsync(ModulePhase phase, JobSystem& jobs, JobCounter& counter, uint32_t repeat)
+{
+    asyncTimers[size_t(phase)].Start();
+    start(phase, jobs, counter, repeat);
+}
+
+void ModuleScheduler::waitAsync(ModulePhase phase, JobSystem& jobs, JobCounter& counter)
+{
+    jobs.wait(counter);
+
+    // Wall time includes whatever the main thread did meanwhile
+    asyncTimers[size_t(phase)].Stop();
+    phaseMs[size_t(phase)] = float(asyncTimers[size_t(phase)].ReadMs());
+    commitTimings(phase);
+}
+
+void ModuleScheduler::publish()
+{
+    for (Module* module : modules)
+        module->publish();
+}
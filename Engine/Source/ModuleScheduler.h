@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Module.h"
+
+#include <atomic>
+#include <vector>
+
+class JobSystem;
+class JobCounter;
+
+// ============================================================================
+// ModuleScheduler
+// ----------------------------------------------------------------------------
+// Runs the per-frame module callbacks as a dependency graph instead of a
+// plain loop.
+//
+// Build (once, after registration):
+// - For every phase, each active module becomes a node.
+// - A node depends on every earlier module whose ModuleAccess conflicts with
+//   its own (write/read or write/write on the same resource bit). Edges only
+//   point forward, so registration order is still the tie-breaker and is
+//   always a valid topological order.
+//
+// Run (every phase, every frame):
+// - Nodes without pending dependencies are submitted to the JobSystem;
+//   mainThread nodes go to the main-thread queue, the rest to the workers.
+// - When a node finishes it releases its successors.
+// - Without a JobSystem (or without workers) the phase runs serially.
+// - runAsync()/waitAsync() split a phase in two, so the main thread can do
+//   other work meanwhile (pipelined update, see Application::update).
+// - 'repeat' runs the whole graph several times back to back (fixed-step
+//   simulation). When an iteration's last node finishes it submits the next
+//   one, so async phases need no help from the main thread.
+//
+// publish():
+// - Calls Module::publish() on every module, in registration order. Only
+//   valid between frames, with no phase in flight.
+//
+// Timings:
+// - Every module records its own ms per phase; the phase wall time is kept
+//   too, so (sum of modules - wall) shows how much work overlapped.
+// ============================================================================
+
+class ModuleScheduler
+{
+public:
+    struct ModuleTiming
+    {
+        const char* name = "";
+        float ms[size_t(ModulePhase::Count)] = {};
+    };
+
+private:
+    struct Node
+    {
+        uint32_t module = 0;                // index into 'modules'
+        ModuleAccess access;
+        std::vector<uint32_t> successors;
+        uint32_t dependencies = 0;
+    };
+
+    struct PhaseGraph
+    {
+        std::vector<Node> nodes;
+        std::unique_ptr<std::atomic<uint32_t>[]> pending;
+        std::vector<float> nodeMs;          // summed over repeats, copied to 'timings' once the phase is done
+        std::atomic<uint32_t> remainingNodes{ 0 };
+        uint32_t repeatsLeft = 0;           // only touched by the node that finishes an iteration
+        uint32_t edges = 0;
+        uint32_t width = 0;                 // nodes with no dependencies
+    };
+
+    std::vector<Module*> modules;
+    std::vector<ModuleTiming> timings;
+
+    PhaseGraph graphs[size_t(ModulePhase::Count)];
+    float phaseMs[size_t(ModulePhase::Count)] = {};
+    Timer asyncTimers[size_t(ModulePhase::Count)];
+
+    void runNode(ModulePhase phase, uint32_t nodeIndex);
+    void submit(ModulePhase phase, uint32_t nodeIndex, JobSystem& jobs, JobCounter& counter);
+    void submitRoots(ModulePhase phase, JobSystem& jobs, JobCounter& counter);
+    void start(ModulePhase phase, JobSystem& jobs, JobCounter& counter, uint32_t repeat);
+    void commitTimings(ModulePhase phase);
+
+public:
+    void build(const std::vector<Module*>& moduleList);
+
+    void run(ModulePhase phase, JobSystem* jobs, uint32_t repeat = 1);
+
+    // Starts a phase on the JobSystem and returns at once. Main thread only;
+    // mainThread nodes run the next time the main thread drains its queue.
+    void runAsync(ModulePhase phase, JobSystem& jobs, JobCounter& counter, uint32_t repeat = 1);
+    void waitAsync(ModulePhase phase, JobSystem& jobs, JobCounter& counter);
+
+    void publish();
+
+    float getPhaseMs(ModulePhase phase) const { return phaseMs[size_t(phase)]; }
+    const std::vector<ModuleTiming>& getTimings() const { return timings; }
+
+    uint32_t getNodeCount(ModulePhase phase) const { return uint32_t(graphs[size_t(phase)].nodes.size()); }
+    uint32_t getEdgeCount(ModulePhase phase) const { return graphs[size_t(phase)].edges; }
+    uint32_t getRootCount(ModulePhase phase) const { return graphs[size_t(phase)].width; }
+
+    static const char* getPhaseName(ModulePhase phase);
+};
@@ -0,0 +1,310 @@
+#include "Globals.h"
+#include "ObjectLightAssigner.h"
+
+#include "LightManager.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr float    MIN_RADIUS = 1e-4f;                  // EpicAttenuation clamps the radius the same way
+    constexpr size_t   MAX_OVERLAP_TESTS = 4u * 1024 * 1024;  // past it every object is re-ranked
+    constexpr uint32_t MIN_OBJECTS_PER_JOB = 16;
+
+    inline uint32_t laneMask(FXMVECTOR mask)
+    {
+        XMUINT4 lanes;
+        XMStoreUInt4(&lanes, mask);
+        return (lanes.x ? 1u : 0u) | (lanes.y ? 2u : 0u) | (lanes.z ? 4u : 0u) | (lanes.w ? 8u : 0u);
+    }
+
+    inline XMVECTOR load4(const std::vector<float>& v, uint32_t i)
+    {
+        return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&v[i]));
+    }
+}
+
+// ----------------------------------------------------------------------------
+// LightSoA
+// ----------------------------------------------------------------------------
+
+void ObjectLightAssigner::LightSoA::clear()
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    radius.clear();
+    weight.clear();
+    entry.clear();
+}
+
+void ObjectLightAssigner::LightSoA::push(float px, float py, float pz, float r, float w, uint32_t e)
+{
+    x.push_back(px);
+    y.push_back(py);
+    z.push_back(pz);
+    radius.push_back(r);
+    weight.push_back(w);
+    entry.push_back(e);
+}
+
+// ----------------------------------------------------------------------------
+// Objects
+// ----------------------------------------------------------------------------
+
+void ObjectLightAssigner::resize(size_t objectCount)
+{
+    objects.resize(objectCount);
+    lists.resize(objectCount, ObjectLights{});
+}
+
+void ObjectLightAssigner::setObject(size_t index, const Vector3& center, float radius, bool visible)
+{
+    Object& object = objects[index];
+
+    if (object.center != center || object.radius != radius)
+    {
+        object.center = center;
+        object.radius = radius;
+        object.stale = true;
+    }
+
+    object.visible = visible;
+}
+
+void ObjectLightAssigner::invalidate()
+{
+    for (Object& object : objects)
+        object.stale = true;
+}
+
+// ----------------------------------------------------------------------------
+// Light changes
+// ----------------------------------------------------------------------------
+
+void ObjectLightAssigner::gatherLights(const LightManager& lights)
+{
+    std::swap(previous, current);
+    previousCount = currentCount;
+    current.clear();
+
+    const LightManager::PointSoA& p = lights.getPoints();
+    const uint32_t pointCount = std::min(lights.getCount(LightManager::POINT), MAX_LIGHT_INDEX + 1);
+    for (uint32_t i = 0; i < pointCount; ++i)
+    {
+        const float weight = p.intensity[i] * std::max({ p.colorR[i], p.colorG[i], p.colorB[i], 0.0f });
+        current.push(p.posX[i], p.posY[i], p.posZ[i], p.radius[i], weight, i);
+    }
+
+    const LightManager::SpotSoA& s = lights.getSpots();
+    const uint32_t spotCount = std::min(lights.getCount(LightManager::SPOT), MAX_LIGHT_INDEX + 1);
+    for (uint32_t i = 0; i < spotCount; ++i)
+    {
+        const float weight = s.intensity[i] * std::max({ s.colorR[i], s.colorG[i], s.colorB[i], 0.0f });
+        current.push(s.posX[i], s.posY[i], s.posZ[i], s.radius[i], weight, i | SPOT_BIT);
+    }
+
+    currentCount = current.size();
+
+    // Zero weight scores 0 and never makes a list
+    while (current.size() & 3)
+        current.push(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0);
+}
+
+void ObjectLightAssigner::findChangedLights()
+{
+    changedSpheres.clear();
+    stats.changedLights = 0;
+
+    const uint32_t count = std::max(currentCount, previousCount);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const bool inCurrent = i < currentCount;
+        const bool inPrevious = i < previousCount;
+
+        if (inCurrent && inPrevious &&
+            current.x[i] == previous.x[i] && current.y[i] == previous.y[i] && current.z[i] == previous.z[i] &&
+            current.radius[i] == previous.radius[i] && current.weight[i] == previous.weight[i] && current.entry[i] == previous.entry[i])
+        {
+            continue;
+        }
+
+        // Objects in reach of either sphere may rank differently now
+        if (inPrevious)
+            changedSpheres.push_back(XMFLOAT4(previous.x[i], previous.y[i], previous.z[i], previous.radius[i]));
+        if (inCurrent)
+            changedSpheres.push_back(XMFLOAT4(current.x[i], current.y[i], current.z[i], current.radius[i]));
+
+        ++stats.changedLights;
+    }
+}
+
+void ObjectLightAssigner::markStaleObjects()
+{
+    if (changedSpheres.empty())
+        return;
+
+    // Many lights moving: testing them all costs more than ranking again
+    if (changedSpheres.size() * objects.size() > MAX_OVERLAP_TESTS)
+    {
+        invalidate();
+        return;
+    }
+
+    for (Object& object : objects)
+    {
+        if (object.stale)
+            continue;
+
+        for (const XMFLOAT4& sphere : changedSpheres)
+        {
+            const Vector3 d = object.center - Vector3(sphere.x, sphere.y, sphere.z);
+            const float reach = object.radius + sphere.w;
+            if (d.LengthSquared() <= reach * reach)
+            {
+                object.stale = true;
+                break;
+            }
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Ranking
+// ----------------------------------------------------------------------------
+
+void ObjectLightAssigner::rankObject(uint32_t index)
+{
+    const Object& object = objects[index];
+
+    const XMVECTOR cx = XMVectorReplicate(object.center.x);
+    const XMVECTOR cy = XMVectorReplicate(object.center.y);
+    const XMVECTOR cz = XMVectorReplicate(object.center.z);
+    const XMVECTOR objectRadius = XMVectorReplicate(object.radius);
+    const XMVECTOR minRadius = XMVectorReplicate(MIN_RADIUS);
+    const XMVECTOR zero = XMVectorZero();
+    const XMVECTOR one = g_XMOne;
+
+    // Best first
+    float    bestScore[MAX_LIGHTS];
+    uint32_t bestEntry[MAX_LIGHTS];
+    uint32_t count = 0;
+    float    threshold = 0.0f;      // a light must beat it to enter the list
+
+    for (uint32_t i = 0; i < current.size(); i += 4)
+    {
+        // ------------------------------------------------------------
+        // Distance to the object's sphere (0 inside)
+        // ------------------------------------------------------------
+        XMVECTOR dx = XMVectorSubtract(load4(current.x, i), cx);
+        XMVECTOR dy = XMVectorSubtract(load4(current.y, i), cy);
+        XMVECTOR dz = XMVectorSubtract(load4(current.z, i), cz);
+        XMVECTOR distSq = XMVectorMultiplyAdd(dx, dx, XMVectorMultiplyAdd(dy, dy, XMVectorMultiply(dz, dz)));
+        XMVECTOR dist = XMVectorMax(XMVectorSubtract(XMVectorSqrt(distSq), objectRadius), zero);
+
+        // ------------------------------------------------------------
+        // EpicAttenuation(dist, radius), as in Exercise8PS.hlsl
+        // ------------------------------------------------------------
+        XMVECTOR r = XMVectorMax(load4(current.radius, i), minRadius);
+        XMVECTOR d = XMVectorDivide(dist, r);
+        XMVECTOR d2 = XMVectorMultiply(d, d);
+        XMVECTOR falloff = XMVectorSaturate(XMVectorSubtract(one, XMVectorMultiply(d2, d2)));
+        falloff = XMVectorMultiply(falloff, falloff);
+        XMVECTOR attenuation = XMVectorDivide(falloff, XMVectorMultiplyAdd(dist, dist, one));
+
+        XMVECTOR score = XMVectorMultiply(load4(current.weight, i), attenuation);
+
+        uint32_t mask = laneMask(XMVectorGreater(score, XMVectorReplicate(threshold)));
+        if (!mask)
+            continue;
+
+        XMFLOAT4 scores;
+        XMStoreFloat4(&scores, score);
+        const float laneScores[4] = { scores.x, scores.y, scores.z, scores.w };
+
+        // ------------------------------------------------------------
+        // Insert into the sorted top list
+        // ------------------------------------------------------------
+        for (uint32_t lane = 0; lane < 4; ++lane)
+        {
+            const float s = laneScores[lane];
+            if (!(mask & (1u << lane)) || s <= threshold)
+                continue;
+
+            uint32_t pos = std::min(count, MAX_LIGHTS - 1);
+            while (pos > 0 && bestScore[pos - 1] < s)
+            {
+                bestScore[pos] = bestScore[pos - 1];
+                bestEntry[pos] = bestEntry[pos - 1];
+                --pos;
+            }
+
+            bestScore[pos] = s;
+            bestEntry[pos] = current.entry[i + lane];
+            count = std::min(count + 1, MAX_LIGHTS);
+
+            if (count == MAX_LIGHTS)
+                threshold = bestScore[MAX_LIGHTS - 1];
+        }
+    }
+
+    ObjectLights& list = lists[index];
+    list = {};
+    list.count = count;
+    for (uint32_t i = 0; i < count; ++i)
+        list.packed[i / 2] |= bestEntry[i] << (16 * (i & 1));
+}
+
+void ObjectLightAssigner::assign(const LightManager& lights, JobSystem* jobs)
+{
+    Timer timer;
+    timer.Start();
+
+    gatherLights(lights);
+    findChangedLights();
+    markStaleObjects();
+
+    // ------------------------------------------------------------
+    // Visible objects whose cached list is out of date
+    // ------------------------------------------------------------
+    stats.objects = uint32_t(objects.size());
+    stats.visible = 0;
+    stats.cached = 0;
+
+    toAssign.clear();
+    for (uint32_t i = 0; i < uint32_t(objects.size()); ++i)
+    {
+        if (!objects[i].visible)
+            continue;
+
+        ++stats.visible;
+        if (objects[i].stale)
+            toAssign.push_back(i);
+        else
+            ++stats.cached;
+    }
+
+    if (jobs && jobs->getWorkerCount() > 0 && toAssign.size() > MIN_OBJECTS_PER_JOB)
+    {
+        jobs->parallelFor(0, toAssign.size(), MIN_OBJECTS_PER_JOB, [this](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; ++i)
+                    rankObject(toAssign[i]);
+            });
+    }
+    else
+    {
+        for (uint32_t index : toAssign)
+            rankObject(index);
+    }
+
+    for (uint32_t index : toAssign)
+        objects[index].stale = false;
+
+    stats.assigned = uint32_t(toAssign.size());
+
+    timer.Stop();
+    stats.assignMs = timer.ReadMs();
+}
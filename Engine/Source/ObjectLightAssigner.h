@@ -0,0 +1,121 @@
+#pragma once
+
+#include <vector>
+
+// ============================================================================
+// ObjectLightAssigner
+// ----------------------------------------------------------------------------
+// Per-object light lists for forward rendering: every visible object gets
+// the MAX_LIGHTS point / spot lights that influence it the most, and the
+// pixel shader only evaluates those. Shading cost follows the lights per
+// object, not the lights in the scene (the alternative to clustered lists
+// when lights are many, small and cover few pixels).
+//
+// Ranking:
+//   influence = intensity * max(color) * EpicAttenuation(dist, radius)
+// with the same EpicAttenuation as Exercise8PS.hlsl and 'dist' measured to
+// the object's bounding sphere (0 inside it). Spot lights are ranked like
+// point lights, the cone is left to the shader. Lights with no influence
+// (object outside their radius) are never listed. assign() scores 4 lights
+// per iteration with DirectXMath vectors over an SoA copy of the lights,
+// objects are spread over the job system.
+//
+// Temporal caching: the lights are compared with last frame's copy; an
+// object is re-ranked only when it moved (setObject() with a different
+// sphere) or a light that changed (moved, resized, recoloured, added or
+// removed) reaches it before or after the change. Objects that are not
+// visible keep their stale flag until they are visible again.
+//
+// Lists are stored packed for the instance data: 16-bit entries, the light
+// slot in LightManager's dense order plus SPOT_BIT for spot lights.
+// Not thread safe: owned by the exercise that renders with it.
+// ============================================================================
+
+class LightManager;
+class JobSystem;
+
+class ObjectLightAssigner
+{
+public:
+    static constexpr uint32_t MAX_LIGHTS = 8;
+    static constexpr uint32_t SPOT_BIT = 0x8000;
+    static constexpr uint32_t MAX_LIGHT_INDEX = 0x7FFF;    // lights past it are not ranked
+
+    // GPU layout, embedded in the instance data ('InstanceData' in Exercise8VS/PS.hlsl)
+    struct ObjectLights
+    {
+        uint32_t count;
+        uint32_t pad[3];
+        uint32_t packed[MAX_LIGHTS / 2];        // entry i in bits 16 * (i & 1) of packed[i / 2]
+    };
+
+    struct Stats
+    {
+        uint32_t objects = 0;
+        uint32_t visible = 0;
+        uint32_t assigned = 0;      // re-ranked this frame
+        uint32_t cached = 0;        // visible and skipped
+        uint32_t changedLights = 0;
+        double   assignMs = 0.0;
+    };
+
+private:
+    // Lights as ranked: points then spots, padded to 4 with zero weight
+    struct LightSoA
+    {
+        std::vector<float>    x, y, z, radius, weight;
+        std::vector<uint32_t> entry;    // packed list entry
+
+        void clear();
+        void push(float px, float py, float pz, float r, float w, uint32_t e);
+        uint32_t size() const { return uint32_t(entry.size()); }
+    };
+
+    struct Object
+    {
+        Vector3 center;
+        float   radius = -1.0f;
+        bool    visible = false;
+        bool    stale = true;       // needs ranking before it is used
+    };
+
+    std::vector<Object>       objects;
+    std::vector<ObjectLights> lists;
+
+    LightSoA current;
+    LightSoA previous;
+    uint32_t currentCount = 0;      // real lights in 'current' (without padding)
+    uint32_t previousCount = 0;
+
+    // Old and new spheres of the lights that changed since last frame
+    std::vector<XMFLOAT4> changedSpheres;
+
+    std::vector<uint32_t> toAssign;
+
+    Stats stats;
+
+    void gatherLights(const LightManager& lights);
+    void findChangedLights();
+    void markStaleObjects();
+    void rankObject(uint32_t index);
+
+public:
+    ObjectLightAssigner() = default;
+    ~ObjectLightAssigner() = default;
+
+    // New objects start stale
+    void resize(size_t objectCount);
+    size_t size() const { return objects.size(); }
+
+    // World bounding sphere; a different sphere than last frame marks it stale
+    void setObject(size_t index, const Vector3& center, float radius, bool visible);
+
+    // Ranks the visible stale objects
+    void assign(const LightManager& lights, JobSystem* jobs);
+
+    // Next assign() re-ranks every visible object
+    void invalidate();
+
+    const ObjectLights& getLights(size_t index) const { return lists[index]; }
+    const Stats& getStats() const { return stats; }
+};
@@ -0,0 +1,107 @@
+#include "Globals.h"
+#include "PersistentGpuBuffer.h"
+
+#include "Application.h"
+#include "D3D12Module.h"
+#include "RingBufferModule.h"
+
+#include <algorithm>
+
+PersistentGpuBuffer::PersistentGpuBuffer(uint32_t stride, const wchar_t* name) : stride(stride), name(name)
+{
+}
+
+bool PersistentGpuBuffer::reserve(uint32_t count)
+{
+    // Old buffers nobody reads any more
+    const uint64_t completedFence = app->getD3D12()->getCompletedFenceValue();
+    retired.erase(std::remove_if(retired.begin(), retired.end(),
+        [completedFence](const RetiredBuffer& r) { return r.fence <= completedFence; }), retired.end());
+
+    if (buffer && count <= capacity)
+        return false;
+
+    uint32_t newCapacity = std::max(capacity, INITIAL_CAPACITY);
+    while (newCapacity < count)
+        newCapacity *= 2;
+
+    ComPtr<ID3D12Resource> newBuffer;
+    auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+    auto desc = CD3DX12_RESOURCE_DESC::Buffer(UINT64(newCapacity) * stride);
+
+    if (FAILED(app->getD3D12()->getDevice()->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+        D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&newBuffer))))
+    {
+        Logger::Err("PersistentGpuBuffer: failed to create a buffer of " + std::to_string(newCapacity) + " elements");
+        return false;
+    }
+
+    newBuffer->SetName(name);
+
+    // ------------------------------------------------------------
+    // Frames in flight may still read the old buffer
+    // ------------------------------------------------------------
+    if (buffer)
+    {
+        RetiredBuffer old;
+        old.buffer = std::move(buffer);
+        old.fence = app->getD3D12()->getLastFrameFence();
+        retired.push_back(std::move(old));
+        ++resizes;
+    }
+
+    buffer = std::move(newBuffer);
+    capacity = newCapacity;
+    return true;
+}
+
+size_t PersistentGpuBuffer::upload(ID3D12GraphicsCommandList* commandList, RingBufferModule* ring, const std::vector<uint32_t>& dirty,
+    const PackFn& pack, uint32_t* copies)
+{
+    if (dirty.empty() || !buffer)
+        return 0;
+
+    _ASSERTE(dirty.back() < capacity);
+
+    // ------------------------------------------------------------
+    // Every dirty element in one ring allocation, in index order
+    // ------------------------------------------------------------
+    uint8_t* staging = nullptr;
+    const D3D12_GPU_VIRTUAL_ADDRESS stagingGPU = ring->allocBuffer(dirty.size() * stride, reinterpret_cast<void**>(&staging),
+        RingBufferModule::STRUCTURED_ALIGNMENT);
+
+    ID3D12Resource* source = nullptr;
+    UINT64 sourceOffset = 0;
+    if (!ring->getCopySource(stagingGPU, &source, &sourceOffset))
+    {
+        Logger::Warn("PersistentGpuBuffer: no staging memory, upload postponed");
+        return 0;
+    }
+
+    for (size_t i = 0; i < dirty.size(); ++i)
+        pack(dirty[i], staging + i * stride);
+
+    // One copy per run of consecutive indices
+    uint32_t runs = 0;
+    for (size_t first = 0; first < dirty.size();)
+    {
+        size_t last = first + 1;
+        while (last < dirty.size() && dirty[last] == dirty[last - 1] + 1)
+            ++last;
+
+        commandList->CopyBufferRegion(buffer.Get(), UINT64(dirty[first]) * stride,
+            source, sourceOffset + UINT64(first) * stride, UINT64(last - first) * stride);
+
+        ++runs;
+        first = last;
+    }
+
+    CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(buffer.Get(),
+        D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    commandList->ResourceBarrier(1, &barrier);
+
+    if (copies)
+        *copies = runs;
+
+    return dirty.size() * stride;
+}
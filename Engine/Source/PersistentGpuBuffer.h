@@ -0,0 +1,68 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <d3d12.h>
+#include <wrl/client.h>
+
+// ============================================================================
+// PersistentGpuBuffer
+// ----------------------------------------------------------------------------
+// A DEFAULT heap array of fixed-stride elements that lives across frames and
+// is patched in place: the owner keeps the CPU copy, tracks which elements
+// changed and calls upload() with their indices. upload() packs them into
+// one ring buffer allocation and records one CopyBufferRegion per run of
+// consecutive indices, followed by the transition to shader resource.
+//
+// - reserve() doubles the buffer when it is too small. The new buffer starts
+//   empty (it returns true: the owner re-uploads everything); the old one is
+//   released once the frames reading it are done.
+// - Buffers decay to COMMON after every ExecuteCommandLists: the copy
+//   promotes it to COPY_DEST, and frames without uploads read it through
+//   implicit promotion.
+//
+// Used by MaterialTable and LightManager. Not thread safe. The header only
+// needs the SDK headers, so plain C++ users (LightManager) can include it.
+// ============================================================================
+
+class RingBufferModule;
+
+class PersistentGpuBuffer
+{
+public:
+    static constexpr uint32_t INITIAL_CAPACITY = 64;
+
+    // Writes element 'index' (stride bytes) to 'dst'
+    using PackFn = std::function<void(uint32_t index, void* dst)>;
+
+private:
+    struct RetiredBuffer
+    {
+        Microsoft::WRL::ComPtr<ID3D12Resource> buffer;
+        uint64_t                               fence = 0;   // frame fence of the last frame that read it
+    };
+
+    Microsoft::WRL::ComPtr<ID3D12Resource> buffer;
+    uint32_t                               capacity = 0;    // elements
+    uint32_t                               stride = 0;
+    const wchar_t*                         name = L"Persistent Buffer";
+    std::vector<RetiredBuffer>             retired;
+    uint32_t                               resizes = 0;
+
+public:
+    explicit PersistentGpuBuffer(uint32_t stride, const wchar_t* name);
+
+    // True when the buffer was (re)created: its contents are undefined
+    bool reserve(uint32_t count);
+
+    // 'dirty' is sorted. Returns the bytes copied (0 when the staging memory
+    // was not usable: the caller keeps the elements dirty).
+    size_t upload(ID3D12GraphicsCommandList* commandList, RingBufferModule* ring, const std::vector<uint32_t>& dirty,
+        const PackFn& pack, uint32_t* copies = nullptr);
+
+    D3D12_GPU_VIRTUAL_ADDRESS getGPUAddress() const { return buffer ? buffer->GetGPUVirtualAddress() : 0; }
+    uint32_t getCapacity() const { return capacity; }
+    uint32_t getStride() const { return stride; }
+    uint32_t getResizes() const { return resizes; }
+};
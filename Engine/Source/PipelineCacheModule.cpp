@@ -0,0 +1,387 @@
+#include "Globals.h"
+#include "PipelineCacheModule.h"
+
+#include "Application.h"
+#include "D3D12Module.h"
+#include "ReadData.h"
+
+#include <cwchar>
+#include <fstream>
+#include <thread>
+
+// ----------------------------------------------------------------------------
+// OwnedGraphicsDesc
+// ----------------------------------------------------------------------------
+
+PipelineCacheModule::OwnedGraphicsDesc::OwnedGraphicsDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& source)
+    : desc(source), rootSignature(source.pRootSignature)
+{
+    // ------------------------------------------------------------
+    // Input layout (names reserved first: their c_str() must not move)
+    // ------------------------------------------------------------
+    const UINT elementCount = source.InputLayout.pInputElementDescs ? source.InputLayout.NumElements : 0;
+    elements.assign(source.InputLayout.pInputElementDescs, source.InputLayout.pInputElementDescs + elementCount);
+    semanticNames.reserve(elementCount);
+    for (D3D12_INPUT_ELEMENT_DESC& element : elements)
+    {
+        semanticNames.emplace_back(element.SemanticName ? element.SemanticName : "");
+        element.SemanticName = semanticNames.back().c_str();
+    }
+    desc.InputLayout = { elements.data(), elementCount };
+
+    // ------------------------------------------------------------
+    // Shaders (the archive's bytecode outlives every job: not copied)
+    // ------------------------------------------------------------
+    const ShaderArchive& archive = app->getShaderArchive();
+
+    D3D12_SHADER_BYTECODE* stages[5] = { &desc.VS, &desc.PS, &desc.DS, &desc.HS, &desc.GS };
+    for (size_t i = 0; i < 5; ++i)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(stages[i]->pShaderBytecode);
+        if (!bytes || archive.contains(bytes))
+            continue;
+
+        shaders[i].assign(bytes, bytes + stages[i]->BytecodeLength);
+        *stages[i] = { shaders[i].data(), shaders[i].size() };
+    }
+
+    // ------------------------------------------------------------
+    // Stream output
+    // ------------------------------------------------------------
+    const D3D12_STREAM_OUTPUT_DESC& so = source.StreamOutput;
+    if (so.pSODeclaration)
+        soEntries.assign(so.pSODeclaration, so.pSODeclaration + so.NumEntries);
+    soNames.reserve(soEntries.size());
+    for (D3D12_SO_DECLARATION_ENTRY& entry : soEntries)
+    {
+        soNames.emplace_back(entry.SemanticName ? entry.SemanticName : "");
+        entry.SemanticName = entry.SemanticName ? soNames.back().c_str() : nullptr;
+    }
+    if (so.pBufferStrides)
+        soStrides.assign(so.pBufferStrides, so.pBufferStrides + so.NumStrides);
+
+    desc.StreamOutput.pSODeclaration = soEntries.empty() ? nullptr : soEntries.data();
+    desc.StreamOutput.NumEntries = UINT(soEntries.size());
+    desc.StreamOutput.pBufferStrides = soStrides.empty() ? nullptr : soStrides.data();
+    desc.StreamOutput.NumStrides = UINT(soStrides.size());
+
+    desc.pRootSignature = rootSignature.Get();
+    desc.CachedPSO = {};
+}
+
+// ----------------------------------------------------------------------------
+// Module
+// ----------------------------------------------------------------------------
+
+bool PipelineCacheModule::init()
+{
+    loadLibrary();
+    return true;
+}
+
+bool PipelineCacheModule::cleanUp()
+{
+    if (JobSystem* jobs = app->getJobSystem())
+        jobs->wait(pendingJobs);
+
+    saveLibrary();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    pipelines.clear();
+    rootSignatureHashes.clear();
+    rootSignatures.clear();
+
+    library.Reset();
+    libraryData.clear();
+    return true;
+}
+
+void PipelineCacheModule::loadLibrary()
+{
+    ID3D12Device5* device = app->getD3D12()->getDevice();
+    const std::string fileName(LIBRARY_FILE, LIBRARY_FILE + std::wcslen(LIBRARY_FILE));
+
+    // ReadData throws when there is no file yet (first run)
+    try
+    {
+        libraryData = DX::ReadData(LIBRARY_FILE);
+    }
+    catch (const std::exception&)
+    {
+        libraryData.clear();
+    }
+
+    HRESULT hr = E_FAIL;
+    if (!libraryData.empty())
+    {
+        hr = device->CreatePipelineLibrary(libraryData.data(), libraryData.size(), IID_PPV_ARGS(&library));
+        if (SUCCEEDED(hr))
+            Logger::Log("PipelineCache: " + fileName + " loaded (" + std::to_string(libraryData.size()) + " bytes)");
+        else
+            Logger::Warn("PipelineCache: " + fileName + " is from another driver or adapter, rebuilding it");
+    }
+
+    if (FAILED(hr))
+    {
+        libraryData.clear();
+        if (FAILED(device->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&library))))
+        {
+            library.Reset();
+            Logger::Warn("PipelineCache: no pipeline library support, pipelines compile every run");
+        }
+    }
+}
+
+void PipelineCacheModule::saveLibrary()
+{
+    if (!library || !libraryDirty)
+        return;
+
+    const std::string fileName(LIBRARY_FILE, LIBRARY_FILE + std::wcslen(LIBRARY_FILE));
+
+    std::vector<uint8_t> data(library->GetSerializedSize());
+    if (FAILED(library->Serialize(data.data(), data.size())))
+    {
+        Logger::Warn("PipelineCache: failed to serialize the pipeline library");
+        return;
+    }
+
+    std::ofstream out(LIBRARY_FILE, std::ios::out | std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(data.data()), std::streamsize(data.size()));
+    if (!out)
+    {
+        Logger::Warn("PipelineCache: failed to write " + fileName);
+        return;
+    }
+
+    libraryDirty = false;
+    Logger::Log("PipelineCache: " + fileName + " saved (" + std::to_string(data.size()) + " bytes)");
+}
+
+PipelineCacheModule::Stats PipelineCacheModule::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+// ----------------------------------------------------------------------------
+// Root signatures
+// ----------------------------------------------------------------------------
+
+HRESULT PipelineCacheModule::createRootSignature(UINT nodeMask, const void* blob, SIZE_T blobSize, REFIID riid, void** rootSignature)
+{
+    if (!blob || !rootSignature)
+        return E_POINTER;
+
+    PipelineKeyWriter writer;
+    writer.write(nodeMask);
+    writer.write(blob, blobSize);
+    PipelineKey key = writer.finish();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = rootSignatures.find(key);
+    if (it == rootSignatures.end())
+    {
+        // Cheap to create: done under the lock
+        ComPtr<ID3D12RootSignature> created;
+        HRESULT hr = app->getD3D12()->getDevice()->CreateRootSignature(nodeMask, blob, blobSize, IID_PPV_ARGS(&created));
+        if (FAILED(hr))
+            return hr;
+
+        rootSignatureHashes[created.Get()] = key.hash;
+        it = rootSignatures.emplace(std::move(key), created).first;
+        stats.rootSignatures = uint32_t(rootSignatures.size());
+    }
+
+    return it->second->QueryInterface(riid, rootSignature);
+}
+
+// ----------------------------------------------------------------------------
+// Graphics pipelines
+// ----------------------------------------------------------------------------
+
+PipelineKey PipelineCacheModule::makeKey(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, bool& persistent) const
+{
+    // No root signature: the shaders embed it, and they are hashed
+    uint64_t rootSignatureHash = 0;
+    persistent = true;
+
+    if (desc.pRootSignature)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = rootSignatureHashes.find(desc.pRootSignature);
+        if (it != rootSignatureHashes.end())
+        {
+            rootSignatureHash = it->second;
+        }
+        else
+        {
+            // Not ours: the address is all we know, valid for this run only
+            rootSignatureHash = uint64_t(reinterpret_cast<uintptr_t>(desc.pRootSignature));
+            persistent = false;
+        }
+    }
+
+    // Hashes the shaders: outside the lock
+    PipelineKey key = makeGraphicsPipelineKey(desc, rootSignatureHash);
+
+    // Keep addresses and stable keys apart
+    if (!persistent)
+        key.bytes.push_back(0);
+
+    return key;
+}
+
+ComPtr<ID3D12PipelineState> PipelineCacheModule::compile(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t hash, bool persistent)
+{
+    Timer timer;
+    timer.Start();
+
+    wchar_t name[17];
+    swprintf_s(name, L"%016llX", static_cast<unsigned long long>(hash));
+
+    const bool useLibrary = persistent && library;
+
+    ComPtr<ID3D12PipelineState> pipeline;
+    bool loaded = useLibrary && SUCCEEDED(library->LoadGraphicsPipeline(name, &desc, IID_PPV_ARGS(&pipeline)));
+
+    if (!loaded)
+    {
+        pipeline.Reset();
+        if (FAILED(app->getD3D12()->getDevice()->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pipeline))))
+            pipeline.Reset();
+        else if (useLibrary && SUCCEEDED(library->StorePipeline(name, pipeline.Get())))
+            libraryDirty = true;
+    }
+
+    timer.Stop();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.compileMs += timer.ReadMs();
+    if (loaded)
+        ++stats.libraryLoads;
+    else if (pipeline)
+        ++stats.compiled;
+
+    return pipeline;
+}
+
+void PipelineCacheModule::finish(Entry& entry, ComPtr<ID3D12PipelineState> pipeline, bool async)
+{
+    const bool ok = pipeline != nullptr;
+    entry.pipeline = std::move(pipeline);
+    entry.status.store(ok ? Status::Ready : Status::Failed, std::memory_order_release);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (ok)
+        ++stats.pipelines;
+    else
+        ++stats.failures;
+    if (async)
+        --stats.pending;
+}
+
+void PipelineCacheModule::waitFor(const Entry& entry)
+{
+    JobSystem* jobs = app->getJobSystem();
+
+    // Compiling on a worker (async request) or on another thread (create)
+    while (entry.status.load(std::memory_order_acquire) == Status::Pending)
+    {
+        if (jobs)
+            jobs->wait(pendingJobs);    // runs jobs meanwhile, returns at once when there are none
+        std::this_thread::yield();
+    }
+}
+
+HRESULT PipelineCacheModule::createGraphicsPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC* desc, REFIID riid, void** pipelineState)
+{
+    if (!desc || !pipelineState)
+        return E_POINTER;
+
+    bool persistent = false;
+    PipelineKey key = makeKey(*desc, persistent);
+    const uint64_t hash = key.hash;
+
+    std::shared_ptr<Entry> entry;
+    bool owner = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.requests;
+
+        auto it = pipelines.find(key);
+        if (it != pipelines.end())
+        {
+            entry = it->second;
+            ++stats.hits;
+        }
+        else
+        {
+            entry = std::make_shared<Entry>();
+            pipelines.emplace(std::move(key), entry);
+            owner = true;
+        }
+    }
+
+    if (owner)
+        finish(*entry, compile(*desc, hash, persistent), false);
+    else
+        waitFor(*entry);
+
+    if (entry->status.load(std::memory_order_acquire) != Status::Ready)
+        return E_FAIL;
+
+    return entry->pipeline->QueryInterface(riid, pipelineState);
+}
+
+PipelineCacheModule::Status PipelineCacheModule::requestGraphicsPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, ComPtr<ID3D12PipelineState>& pipeline)
+{
+    bool persistent = false;
+    PipelineKey key = makeKey(desc, persistent);
+    const uint64_t hash = key.hash;
+
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = pipelines.find(key);
+        if (it != pipelines.end())
+        {
+            const Status status = it->second->status.load(std::memory_order_acquire);
+            if (status == Status::Ready)
+                pipeline = it->second->pipeline;
+
+            // Polling a pending pipeline is not a new request
+            if (status != Status::Pending)
+            {
+                ++stats.requests;
+                ++stats.hits;
+            }
+            return status;
+        }
+
+        ++stats.requests;
+        ++stats.pending;
+        entry = std::make_shared<Entry>();
+        pipelines.emplace(std::move(key), entry);
+    }
+
+    JobSystem* jobs = app->getJobSystem();
+    if (!jobs || jobs->getWorkerCount() == 0)
+    {
+        finish(*entry, compile(desc, hash, persistent), true);
+        if (entry->status.load(std::memory_order_acquire) == Status::Ready)
+            pipeline = entry->pipeline;
+        return entry->status.load(std::memory_order_acquire);
+    }
+
+    // std::function needs a copyable callable
+    auto owned = std::make_shared<OwnedGraphicsDesc>(desc);
+    jobs->run([this, entry, owned, hash, persistent]()
+        {
+            finish(*entry, compile(owned->desc, hash, persistent), true);
+        }, &pendingJobs);
+
+    return Status::Pending;
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include "Module.h"
+#include "PipelineHash.h"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================================
+// PipelineCacheModule
+// ----------------------------------------------------------------------------
+// Every pipeline state and root signature of the engine goes through here.
+//
+// Deduplication:
+// - createRootSignature() hashes the serialized blob: equal blobs share one
+//   ID3D12RootSignature.
+// - createGraphicsPipeline() keys the whole description (PipelineHash.h, the
+//   root signature by its blob hash): identical states share one
+//   ID3D12PipelineState, whichever exercise asks for it.
+// - Both are drop-in for the device calls (same HRESULT / REFIID / void**).
+//
+// Persistence:
+// - Pipelines live in an ID3D12PipelineLibrary named after their key hash.
+//   init() loads LIBRARY_FILE, cleanUp() writes it back when pipelines were
+//   added, so the next run loads them instead of compiling. A library from
+//   another driver / adapter is dropped and rebuilt.
+// - Pipelines whose root signature was not created here have no stable key:
+//   they are deduplicated but not stored.
+//
+// Async:
+// - requestGraphicsPipeline() copies the description and compiles it on the
+//   job system; callers poll it each frame and draw with a fallback until it
+//   is Ready. A synchronous create of a pending pipeline waits for it.
+//
+// Thread safe. Objects are kept until cleanUp().
+// ============================================================================
+
+class PipelineCacheModule : public Module
+{
+public:
+    static constexpr const wchar_t* LIBRARY_FILE = L"pipelines.cache";
+
+    enum class Status
+    {
+        Pending,
+        Ready,
+        Failed
+    };
+
+    struct Stats
+    {
+        uint32_t pipelines = 0;         // unique pipelines created or loaded
+        uint32_t rootSignatures = 0;    // unique root signatures
+        uint32_t requests = 0;          // pipeline create / request calls
+        uint32_t hits = 0;              // answered with an existing pipeline
+        uint32_t libraryLoads = 0;      // loaded from the pipeline library
+        uint32_t compiled = 0;          // compiled by the driver
+        uint32_t failures = 0;
+        uint32_t pending = 0;           // async compiles in flight
+        double   compileMs = 0.0;       // total, loads and compiles
+    };
+
+private:
+    struct Entry
+    {
+        std::atomic<Status>         status{ Status::Pending };
+        ComPtr<ID3D12PipelineState> pipeline;       // written before status leaves Pending
+    };
+
+    // A description that outlives the caller's arrays and shaders
+    struct OwnedGraphicsDesc
+    {
+        D3D12_GRAPHICS_PIPELINE_STATE_DESC      desc = {};
+        ComPtr<ID3D12RootSignature>             rootSignature;
+        std::vector<D3D12_INPUT_ELEMENT_DESC>   elements;
+        std::vector<std::string>                semanticNames;
+        std::vector<uint8_t>                    shaders[5];     // VS, PS, DS, HS, GS (unless in the ShaderArchive)
+        std::vector<D3D12_SO_DECLARATION_ENTRY> soEntries;
+        std::vector<std::string>                soNames;
+        std::vector<UINT>                       soStrides;
+
+        explicit OwnedGraphicsDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& source);
+    };
+
+    // Free threaded; only loads of the same pipeline need locking, and
+    // entries already make sure one thread compiles each key
+    ComPtr<ID3D12PipelineLibrary> library;
+    std::vector<uint8_t>          libraryData;      // the library reads from it until released
+    std::atomic<bool>             libraryDirty{ false };
+
+    mutable std::mutex mutex;
+    std::unordered_map<PipelineKey, std::shared_ptr<Entry>, PipelineKeyHash> pipelines;
+    std::unordered_map<PipelineKey, ComPtr<ID3D12RootSignature>, PipelineKeyHash> rootSignatures;  // by blob
+    std::unordered_map<ID3D12RootSignature*, uint64_t> rootSignatureHashes;
+    Stats stats;
+
+    JobCounter pendingJobs;
+
+    PipelineKey makeKey(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, bool& persistent) const;
+
+    // Library load, or driver compile (stored in the library when 'persistent')
+    ComPtr<ID3D12PipelineState> compile(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t hash, bool persistent);
+    void finish(Entry& entry, ComPtr<ID3D12PipelineState> pipeline, bool async);
+    void waitFor(const Entry& entry);
+
+    void loadLibrary();
+    void saveLibrary();
+
+public:
+    PipelineCacheModule() {}
+    ~PipelineCacheModule() {}
+
+    bool init() override;
+    bool cleanUp() override;
+
+    const char* getName() const override { return "PipelineCache"; }
+    ModuleAccess getAccess(ModulePhase) const override { return ModuleAccess::idle(); }
+
+    // ID3D12Device::CreateRootSignature, shared by blob contents
+    HRESULT createRootSignature(UINT nodeMask, const void* blob, SIZE_T blobSize, REFIID riid, void** rootSignature);
+
+    // ID3D12Device::CreateGraphicsPipelineState, shared by description
+    HRESULT createGraphicsPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC* desc, REFIID riid, void** pipelineState);
+
+    // Non-blocking: Ready fills 'pipeline', Pending queued a compile (once) and
+    // asks to try again later, Failed will not get better
+    Status requestGraphicsPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, ComPtr<ID3D12PipelineState>& pipeline);
+
+    Stats getStats() const;
+};
@@ -0,0 +1,161 @@
+// Plain C++ on purpose (no Globals.h / precompiled header): this file has to
+// build outside the engine for headless tests.
+#include "PipelineHash.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Tags the kind of pipeline, so keys of different kinds never compare equal
+    constexpr uint32_t GRAPHICS_KEY = 0x47524146u;     // 'GRAF'
+
+    void writeBlend(PipelineKeyWriter& w, const D3D12_RENDER_TARGET_BLEND_DESC& rt)
+    {
+        w.write(rt.BlendEnable);
+        w.write(rt.LogicOpEnable);
+        w.write(rt.SrcBlend);
+        w.write(rt.DestBlend);
+        w.write(rt.BlendOp);
+        w.write(rt.SrcBlendAlpha);
+        w.write(rt.DestBlendAlpha);
+        w.write(rt.BlendOpAlpha);
+        w.write(rt.LogicOp);
+        w.write(rt.RenderTargetWriteMask);
+    }
+
+    void writeBytecode(PipelineKeyWriter& w, const D3D12_SHADER_BYTECODE& bytecode)
+    {
+        w.writeHashed(bytecode.pShaderBytecode, size_t(bytecode.BytecodeLength));
+    }
+
+    void writeStencilOp(PipelineKeyWriter& w, const D3D12_DEPTH_STENCILOP_DESC& op)
+    {
+        w.write(op.StencilFailOp);
+        w.write(op.StencilDepthFailOp);
+        w.write(op.StencilPassOp);
+        w.write(op.StencilFunc);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Graphics pipelines
+// ----------------------------------------------------------------------------
+
+PipelineKey makeGraphicsPipelineKey(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash)
+{
+    PipelineKeyWriter w;
+    w.write(GRAPHICS_KEY);
+    w.write(rootSignatureHash);
+
+    // ------------------------------------------------------------
+    // Shaders
+    // ------------------------------------------------------------
+    writeBytecode(w, desc.VS);
+    writeBytecode(w, desc.PS);
+    writeBytecode(w, desc.DS);
+    writeBytecode(w, desc.HS);
+    writeBytecode(w, desc.GS);
+
+    // ------------------------------------------------------------
+    // Stream output
+    // ------------------------------------------------------------
+    const D3D12_STREAM_OUTPUT_DESC& so = desc.StreamOutput;
+    const UINT soEntries = so.pSODeclaration ? so.NumEntries : 0;
+    const UINT soStrides = so.pBufferStrides ? so.NumStrides : 0;
+    w.write(soEntries);
+    for (UINT i = 0; i < soEntries; ++i)
+    {
+        const D3D12_SO_DECLARATION_ENTRY& entry = so.pSODeclaration[i];
+        w.write(entry.Stream);
+        w.writeString(entry.SemanticName);
+        w.write(entry.SemanticIndex);
+        w.write(entry.StartComponent);
+        w.write(entry.ComponentCount);
+        w.write(entry.OutputSlot);
+    }
+    w.write(soStrides);
+    for (UINT i = 0; i < soStrides; ++i)
+        w.write(so.pBufferStrides[i]);
+    w.write(soEntries ? so.RasterizedStream : 0u);
+
+    // ------------------------------------------------------------
+    // Blend
+    // ------------------------------------------------------------
+    const D3D12_BLEND_DESC& blend = desc.BlendState;
+    w.write(blend.AlphaToCoverageEnable);
+    w.write(blend.IndependentBlendEnable);
+
+    const UINT blendTargets = blend.IndependentBlendEnable ? D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT : 1;
+    for (UINT i = 0; i < blendTargets; ++i)
+        writeBlend(w, blend.RenderTarget[i]);
+
+    w.write(desc.SampleMask);
+
+    // ------------------------------------------------------------
+    // Rasterizer
+    // ------------------------------------------------------------
+    const D3D12_RASTERIZER_DESC& raster = desc.RasterizerState;
+    w.write(raster.FillMode);
+    w.write(raster.CullMode);
+    w.write(raster.FrontCounterClockwise);
+    w.write(raster.DepthBias);
+    w.writeFloat(raster.DepthBiasClamp);
+    w.writeFloat(raster.SlopeScaledDepthBias);
+    w.write(raster.DepthClipEnable);
+    w.write(raster.MultisampleEnable);
+    w.write(raster.AntialiasedLineEnable);
+    w.write(raster.ForcedSampleCount);
+    w.write(raster.ConservativeRaster);
+
+    // ------------------------------------------------------------
+    // Depth / stencil
+    // ------------------------------------------------------------
+    const D3D12_DEPTH_STENCIL_DESC& depth = desc.DepthStencilState;
+    w.write(depth.DepthEnable);
+    w.write(depth.DepthWriteMask);
+    w.write(depth.DepthFunc);
+    w.write(depth.StencilEnable);
+    if (depth.StencilEnable)
+    {
+        w.write(depth.StencilReadMask);
+        w.write(depth.StencilWriteMask);
+        writeStencilOp(w, depth.FrontFace);
+        writeStencilOp(w, depth.BackFace);
+    }
+
+    // ------------------------------------------------------------
+    // Input layout
+    // ------------------------------------------------------------
+    const UINT elements = desc.InputLayout.pInputElementDescs ? desc.InputLayout.NumElements : 0;
+    w.write(elements);
+    for (UINT i = 0; i < elements; ++i)
+    {
+        const D3D12_INPUT_ELEMENT_DESC& element = desc.InputLayout.pInputElementDescs[i];
+        w.writeString(element.SemanticName);
+        w.write(element.SemanticIndex);
+        w.write(element.Format);
+        w.write(element.InputSlot);
+        w.write(element.AlignedByteOffset);
+        w.write(element.InputSlotClass);
+        w.write(element.InstanceDataStepRate);
+    }
+
+    // ------------------------------------------------------------
+    // Output merger and the rest
+    // ------------------------------------------------------------
+    w.write(desc.IBStripCutValue);
+    w.write(desc.PrimitiveTopologyType);
+
+    const UINT renderTargets = std::min<UINT>(desc.NumRenderTargets, D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT);
+    w.write(renderTargets);
+    for (UINT i = 0; i < renderTargets; ++i)
+        w.write(desc.RTVFormats[i]);
+
+    w.write(desc.DSVFormat);
+    w.write(desc.SampleDesc.Count);
+    w.write(desc.SampleDesc.Quality);
+    w.write(desc.NodeMask);
+    w.write(desc.Flags);
+
+    return w.finish();
+}
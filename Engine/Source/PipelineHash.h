@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <d3d12.h>
+
+#include "PipelineKey.h"
+
+// ============================================================================
+// PipelineHash
+// ----------------------------------------------------------------------------
+// Keys of the pipeline cache (PipelineCacheModule). Only reads description
+// structs, never a device: plain C++ over the D3D12 structs, tested headless
+// (PipelineHashTest in Engine/Tests).
+//
+// makeGraphicsPipelineKey() writes everything that shapes a pipeline into a
+// canonical byte string, field by field (the D3D12 structs have padding):
+// - shaders and the root signature by the hash of their contents, not their
+//   address: the key is the same from run to run, and the pipeline library
+//   on disk is indexed by it;
+// - input / stream output elements with their semantic names;
+// - state the pipeline ignores is left out: blend of RenderTarget[1..7]
+//   without IndependentBlendEnable, stencil ops without StencilEnable,
+//   formats past NumRenderTargets; -0.0f is written as 0.0f.
+// CachedPSO is not part of the key.
+//
+// The hash is FNV-1a of those bytes and equality compares the bytes, so the
+// state itself never aliases: two descriptions only share a key when every
+// field written matches. Shaders and the root signature are the exception,
+// they are in the key as size + 64-bit FNV-1a of their contents, so two
+// different shaders of the same size whose hashes collide would share one
+// pipeline (a 64-bit collision, accepted to keep keys small).
+// ============================================================================
+
+// 'rootSignatureHash': hash of the serialized root signature (see
+// PipelineCacheModule::createRootSignature), desc.pRootSignature is not read
+PipelineKey makeGraphicsPipelineKey(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash);
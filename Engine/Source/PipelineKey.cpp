@@ -0,0 +1,66 @@
+// Plain C++ on purpose (no Globals.h / precompiled header): this file has to
+// build outside the engine for headless tests.
+#include "PipelineKey.h"
+
+#include <cstring>
+
+namespace
+{
+    constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+    constexpr uint64_t FNV_PRIME = 1099511628211ull;
+}
+
+// ----------------------------------------------------------------------------
+// PipelineKeyWriter
+// ----------------------------------------------------------------------------
+
+uint64_t hashBytes(const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = FNV_OFFSET;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+void PipelineKeyWriter::write(const void* data, size_t size)
+{
+    const uint8_t* first = static_cast<const uint8_t*>(data);
+    bytes.insert(bytes.end(), first, first + size);
+}
+
+void PipelineKeyWriter::writeFloat(float value)
+{
+    // -0.0f and 0.0f are the same state
+    if (value == 0.0f)
+        value = 0.0f;
+    write(&value, sizeof(float));
+}
+
+void PipelineKeyWriter::writeString(const char* text)
+{
+    const uint32_t length = text ? uint32_t(std::strlen(text)) + 1 : 0;
+    write(length);
+    if (length)
+        write(text, length);
+}
+
+void PipelineKeyWriter::writeHashed(const void* data, size_t size)
+{
+    const uint64_t length = data ? uint64_t(size) : 0;
+    write(length);
+    if (length)
+        write(hashBytes(data, size));
+}
+
+PipelineKey PipelineKeyWriter::finish()
+{
+    PipelineKey key;
+    key.hash = hashBytes(bytes.data(), bytes.size());
+    key.bytes = std::move(bytes);
+    bytes.clear();
+    return key;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// ============================================================================
+// PipelineKey
+// ----------------------------------------------------------------------------
+// Canonical byte strings used as cache keys (PipelineCacheModule): the bytes
+// are written value by value through PipelineKeyWriter, never as whole
+// structs, so padding and the order fields sit in memory never reach a key.
+// The hash is FNV-1a of the bytes, equality compares the bytes.
+//
+// Plain C++ (no Windows / D3D12 headers): PipelineHash.h builds pipeline
+// keys on top of it, and both are tested headless (Engine/Tests).
+// ============================================================================
+
+struct PipelineKey
+{
+    uint64_t             hash = 0;
+    std::vector<uint8_t> bytes;
+
+    bool operator==(const PipelineKey& other) const { return hash == other.hash && bytes == other.bytes; }
+    bool operator!=(const PipelineKey& other) const { return !(*this == other); }
+};
+
+struct PipelineKeyHash
+{
+    size_t operator()(const PipelineKey& key) const { return size_t(key.hash); }
+};
+
+class PipelineKeyWriter
+{
+    std::vector<uint8_t> bytes;
+
+public:
+    void write(const void* data, size_t size);
+
+    // Scalars and enums only: structs go field by field
+    template<typename T>
+    void write(const T& value)
+    {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "write structs field by field");
+        write(&value, sizeof(T));
+    }
+
+    void writeFloat(float value);
+    void writeString(const char* text);                 // nullptr and "" differ
+    void writeHashed(const void* data, size_t size);    // size + FNV-1a of the contents (nullptr: empty)
+
+    PipelineKey finish();
+};
+
+// FNV-1a, 64 bit
+uint64_t hashBytes(const void* data, size_t size);
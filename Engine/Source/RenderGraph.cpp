@@ -0,0 +1,268 @@
+#include "Globals.h"
+#include "RenderGraph.h"
+
+#include "D3D12Module.h"
+
+#include <algorithm>
+
+namespace
+{
+    bool sameDesc(const RenderGraph::TextureDesc& a, const RenderGraph::TextureDesc& b)
+    {
+        return a.width == b.width && a.height == b.height && a.format == b.format && a.flags == b.flags &&
+            memcmp(&a.clearValue, &b.clearValue, sizeof(D3D12_CLEAR_VALUE)) == 0;
+    }
+
+    D3D12_RESOURCE_DESC toResourceDesc(const RenderGraph::TextureDesc& desc)
+    {
+        return CD3DX12_RESOURCE_DESC::Tex2D(desc.format, desc.width, desc.height, 1, 1, 1, 0, desc.flags);
+    }
+}
+
+RenderGraph::RenderGraph(ID3D12Device* device) : device(device)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+}
+
+D3D12_RESOURCE_STATES RenderGraph::toD3D12(uint32_t state)
+{
+    D3D12_RESOURCE_STATES result = D3D12_RESOURCE_STATE_COMMON;
+    if (state & RenderGraphState::RenderTarget)           result |= D3D12_RESOURCE_STATE_RENDER_TARGET;
+    if (state & RenderGraphState::DepthWrite)             result |= D3D12_RESOURCE_STATE_DEPTH_WRITE;
+    if (state & RenderGraphState::DepthRead)              result |= D3D12_RESOURCE_STATE_DEPTH_READ;
+    if (state & RenderGraphState::PixelShaderResource)    result |= D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+    if (state & RenderGraphState::NonPixelShaderResource) result |= D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+    if (state & RenderGraphState::UnorderedAccess)        result |= D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+    if (state & RenderGraphState::CopySource)             result |= D3D12_RESOURCE_STATE_COPY_SOURCE;
+    if (state & RenderGraphState::CopyDest)               result |= D3D12_RESOURCE_STATE_COPY_DEST;
+    return result;
+}
+
+void RenderGraph::reset()
+{
+    resources.clear();
+    passes.clear();
+    executes.clear();
+    physical.clear();
+    transientIndex.clear();
+    transientDescs.clear();
+}
+
+RenderGraph::Handle RenderGraph::importResource(const char* name, ID3D12Resource* resource, uint32_t initialState, uint32_t finalState)
+{
+    RenderGraphResourceDesc desc;
+    desc.name = name;
+    desc.imported = true;
+    desc.initialState = initialState;
+    desc.finalState = finalState;
+
+    resources.push_back(desc);
+    physical.push_back(resource);
+    transientIndex.push_back(-1);
+    return Handle(resources.size() - 1);
+}
+
+RenderGraph::Handle RenderGraph::createTexture(const char* name, const TextureDesc& desc)
+{
+    TextureDesc texture = desc;
+    texture.clearValue.Format = desc.format;
+
+    // Size and alignment of the placed resource
+    D3D12_RESOURCE_DESC resourceDesc = toResourceDesc(texture);
+    D3D12_RESOURCE_ALLOCATION_INFO info = device->GetResourceAllocationInfo(0, 1, &resourceDesc);
+
+    RenderGraphResourceDesc graphDesc;
+    graphDesc.name = name;
+    graphDesc.size = info.SizeInBytes;
+    graphDesc.alignment = info.Alignment;
+
+    resources.push_back(graphDesc);
+    physical.push_back(nullptr);
+    transientIndex.push_back(int32_t(transientDescs.size()));
+    transientDescs.push_back(texture);
+    return Handle(resources.size() - 1);
+}
+
+void RenderGraph::addPass(const char* name, const std::function<void(PassBuilder&)>& setup, ExecuteFn execute)
+{
+    passes.emplace_back();
+    passes.back().name = name;
+
+    PassBuilder builder(passes.back());
+    setup(builder);
+
+    executes.push_back(std::move(execute));
+}
+
+void RenderGraph::compile()
+{
+    // ------------------------------------------------------------
+    // Transient start states: last frame's state when the texture is
+    // kept, otherwise the state of its first use (it is created in it)
+    // ------------------------------------------------------------
+    for (size_t r = 0; r < resources.size(); ++r)
+    {
+        const int32_t index = transientIndex[r];
+        if (index < 0)
+            continue;
+
+        if (size_t(index) < transients.size() && transients[index].resource && sameDesc(transients[index].desc, transientDescs[index]))
+        {
+            resources[r].initialState = transients[index].state;
+            continue;
+        }
+
+        for (const RenderGraphPassDesc& pass : passes)
+        {
+            auto it = std::find_if(pass.accesses.begin(), pass.accesses.end(), [r](const RenderGraphPassDesc::Access& a) { return a.resource == r; });
+            if (it != pass.accesses.end())
+            {
+                resources[r].initialState = it->state;
+                break;
+            }
+        }
+    }
+
+    compiled = RenderGraphCompiler::compile(resources, passes);
+
+    allocateTransients();
+}
+
+void RenderGraph::allocateTransients()
+{
+    // ------------------------------------------------------------
+    // Keep the heap and placed resources while nothing changes
+    // ------------------------------------------------------------
+    bool rebuild = transients.size() != transientDescs.size() || heapSize < compiled.stats.heapSize;
+
+    for (size_t r = 0; r < resources.size() && !rebuild; ++r)
+    {
+        const int32_t index = transientIndex[r];
+        if (index < 0)
+            continue;
+
+        const Transient& transient = transients[index];
+        const uint64_t offset = compiled.placements[r].offset;
+        rebuild = !sameDesc(transient.desc, transientDescs[index]) || transient.offset != offset ||
+            (offset != CompiledRenderGraph::Placement::NONE && !transient.resource);
+    }
+
+    if (rebuild)
+    {
+        // D3D12Module waits for the GPU at the end of every frame, so the old memory is idle
+        transients.clear();
+        transients.resize(transientDescs.size());
+
+        if (heapSize < compiled.stats.heapSize)
+        {
+            heap.Reset();
+            heapSize = 0;
+
+            CD3DX12_HEAP_DESC heapDesc(compiled.stats.heapSize, D3D12_HEAP_TYPE_DEFAULT, 0, D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES);
+            if (FAILED(device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap))))
+            {
+                Logger::Err("RenderGraph: failed to create a " + std::to_string(compiled.stats.heapSize) + " byte transient heap");
+                return;
+            }
+            heapSize = compiled.stats.heapSize;
+        }
+
+        for (size_t r = 0; r < resources.size(); ++r)
+        {
+            const int32_t index = transientIndex[r];
+            if (index < 0)
+                continue;
+
+            Transient& transient = transients[index];
+            transient.desc = transientDescs[index];
+            transient.offset = compiled.placements[r].offset;
+            transient.state = resources[r].initialState;
+
+            // Culled: nothing to create
+            if (transient.offset == CompiledRenderGraph::Placement::NONE)
+                continue;
+
+            D3D12_RESOURCE_DESC desc = toResourceDesc(transient.desc);
+            const bool hasClear = (transient.desc.flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) != 0;
+
+            if (FAILED(device->CreatePlacedResource(heap.Get(), transient.offset, &desc, toD3D12(transient.state),
+                hasClear ? &transient.desc.clearValue : nullptr, IID_PPV_ARGS(&transient.resource))))
+            {
+                Logger::Err("RenderGraph: failed to place transient '" + resources[r].name + "'");
+                continue;
+            }
+            transient.resource->SetName(std::wstring(resources[r].name.begin(), resources[r].name.end()).c_str());
+        }
+    }
+
+    for (size_t r = 0; r < resources.size(); ++r)
+    {
+        if (transientIndex[r] >= 0)
+            physical[r] = transients[transientIndex[r]].resource.Get();
+    }
+}
+
+void RenderGraph::submit(ID3D12GraphicsCommandList* cmd, const std::vector<RenderGraphBarrier>& batch)
+{
+    if (batch.empty())
+        return;
+
+    scratch.clear();
+    for (const RenderGraphBarrier& barrier : batch)
+    {
+        ID3D12Resource* resource = physical[barrier.resource];
+        if (!resource)
+            continue;
+
+        switch (barrier.type)
+        {
+        case RenderGraphBarrier::Type::Transition:
+        {
+            D3D12_RESOURCE_BARRIER_FLAGS flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+            if (barrier.split == RenderGraphBarrier::Split::Begin) flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+            if (barrier.split == RenderGraphBarrier::Split::End)   flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+
+            scratch.push_back(CD3DX12_RESOURCE_BARRIER::Transition(resource, toD3D12(barrier.before), toD3D12(barrier.after),
+                D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, flags));
+            break;
+        }
+        case RenderGraphBarrier::Type::Aliasing:
+        {
+            ID3D12Resource* before = barrier.before != RenderGraphBarrier::NONE ? physical[barrier.before] : nullptr;
+            scratch.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(before, resource));
+            break;
+        }
+        case RenderGraphBarrier::Type::UAV:
+            scratch.push_back(CD3DX12_RESOURCE_BARRIER::UAV(resource));
+            break;
+        }
+    }
+
+    // One call per batch
+    if (!scratch.empty())
+        cmd->ResourceBarrier(UINT(scratch.size()), scratch.data());
+}
+
+void RenderGraph::execute(D3D12Module* d3d12)
+{
+    for (const CompiledRenderGraph::PassBarriers& pass : compiled.passes)
+    {
+        submit(d3d12->getCommandList(), pass.before);
+        executes[pass.pass](d3d12->getCommandList());
+
+        // The pass may have continued on another list
+        submit(d3d12->getCommandList(), pass.after);
+    }
+
+    submit(d3d12->getCommandList(), compiled.finalBarriers);
+
+    // Transients keep their state for the next frame
+    for (size_t r = 0; r < resources.size(); ++r)
+    {
+        if (transientIndex[r] >= 0)
+            transients[transientIndex[r]].state = compiled.endStates[r];
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "RenderGraphCompiler.h"
+
+// ============================================================================
+// RenderGraph
+// ----------------------------------------------------------------------------
+// Frame graph: passes declare what they read and write, the graph inserts
+// every resource barrier. Rebuilt every frame:
+//
+//   graph.reset();
+//   Handle back = graph.importResource("BackBuffer", buffer, Present, Present);
+//   graph.addPass("Scene",
+//       [&](RenderGraph::PassBuilder& b) { b.write(back, RenderGraphState::RenderTarget); },
+//       [&](ID3D12GraphicsCommandList* cmd) { ... });
+//   graph.compile();
+//   graph.execute(d3d12);
+//
+// - Imported resources (back buffer, viewport texture, ...) are owned
+//   outside and given with the state they are in and must be left in.
+// - Transient textures (render / depth targets) are owned by the graph:
+//   placed resources in a single heap, aliased when their lifetimes do not
+//   overlap. They persist between frames while their descriptions do not
+//   change. A transient that shares memory has undefined contents on first
+//   use (clear it).
+// - compile() is RenderGraphCompiler (culling, barrier merging / batching /
+//   splitting, placement); this class only talks to D3D12.
+// - execute() fetches D3D12Module::getCommandList() around every pass, so
+//   passes may splice command lists (parallel recording); such passes call
+//   changesCommandList() so no split barrier spans them.
+// ============================================================================
+
+class D3D12Module;
+
+class RenderGraph
+{
+public:
+    using Handle = uint32_t;
+    using ExecuteFn = std::function<void(ID3D12GraphicsCommandList*)>;
+
+    static constexpr Handle INVALID = 0xFFFFFFFFu;
+
+    struct TextureDesc
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+        D3D12_CLEAR_VALUE clearValue = {};      // format filled in automatically
+    };
+
+    class PassBuilder
+    {
+        friend class RenderGraph;
+        RenderGraphPassDesc& desc;
+        explicit PassBuilder(RenderGraphPassDesc& d) : desc(d) {}
+
+    public:
+        void read(Handle resource, uint32_t state) { desc.accesses.push_back({ resource, state }); }
+        void write(Handle resource, uint32_t state) { desc.accesses.push_back({ resource, state }); }
+        void sideEffects() { desc.sideEffects = true; }
+        void changesCommandList() { desc.changesCommandList = true; }
+    };
+
+private:
+    struct Transient
+    {
+        TextureDesc desc;
+        ComPtr<ID3D12Resource> resource;
+        uint64_t offset = 0;
+        uint32_t state = RenderGraphState::Common;
+    };
+
+    ID3D12Device* device = nullptr;
+
+    // Frame description
+    std::vector<RenderGraphResourceDesc> resources;
+    std::vector<RenderGraphPassDesc> passes;
+    std::vector<ExecuteFn> executes;
+    std::vector<ID3D12Resource*> physical;      // per handle, valid after compile()
+    std::vector<int32_t> transientIndex;        // per handle, -1: imported
+    std::vector<TextureDesc> transientDescs;    // this frame's transients
+
+    // Persistent transient memory
+    ComPtr<ID3D12Heap> heap;
+    uint64_t heapSize = 0;
+    std::vector<Transient> transients;
+
+    CompiledRenderGraph compiled;
+    std::vector<D3D12_RESOURCE_BARRIER> scratch;
+
+    void allocateTransients();
+    void submit(ID3D12GraphicsCommandList* cmd, const std::vector<RenderGraphBarrier>& batch);
+
+public:
+    explicit RenderGraph(ID3D12Device* device);
+    ~RenderGraph();
+
+    // Starts a new frame description (keeps the transient memory)
+    void reset();
+
+    Handle importResource(const char* name, ID3D12Resource* resource, uint32_t initialState, uint32_t finalState);
+    Handle createTexture(const char* name, const TextureDesc& desc);
+    void addPass(const char* name, const std::function<void(PassBuilder&)>& setup, ExecuteFn execute);
+
+    void compile();
+    void execute(D3D12Module* d3d12);
+
+    // Valid between compile() and the next reset()
+    ID3D12Resource* getResource(Handle handle) const { return physical[handle]; }
+    bool isAliased(Handle handle) const { return compiled.placements[handle].aliased; }
+
+    const CompiledRenderGraph::Stats& getStats() const { return compiled.stats; }
+    uint32_t getPassCount() const { return uint32_t(passes.size()); }
+    const char* getPassName(uint32_t pass) const { return passes[pass].name.c_str(); }
+    const CompiledRenderGraph& getCompiled() const { return compiled; }
+
+    static D3D12_RESOURCE_STATES toD3D12(uint32_t state);
+};
@@ -0,0 +1,310 @@
+// Plain C++ on purpose (no Globals.h / precompiled header): this file has to
+// build outside the engine for headless tests.
+#include "RenderGraphCompiler.h"
+
+#include <algorithm>
+
+namespace
+{
+    constexpr uint32_t NO_PASS = 0xFFFFFFFFu;
+
+    struct Use
+    {
+        uint32_t pass = 0;      // executed-pass index
+        uint32_t state = 0;
+    };
+
+    inline uint64_t alignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    RenderGraphBarrier transition(uint32_t resource, uint32_t before, uint32_t after, RenderGraphBarrier::Split split)
+    {
+        RenderGraphBarrier barrier;
+        barrier.type = RenderGraphBarrier::Type::Transition;
+        barrier.split = split;
+        barrier.resource = resource;
+        barrier.before = before;
+        barrier.after = after;
+        return barrier;
+    }
+}
+
+CompiledRenderGraph RenderGraphCompiler::compile(const std::vector<RenderGraphResourceDesc>& resources,
+    const std::vector<RenderGraphPassDesc>& passes)
+{
+    CompiledRenderGraph result;
+    const uint32_t resourceCount = uint32_t(resources.size());
+
+    // ------------------------------------------------------------
+    // Culling (backwards): keep passes whose output is consumed
+    // ------------------------------------------------------------
+    std::vector<bool> needed(resourceCount, false);
+    for (uint32_t r = 0; r < resourceCount; ++r)
+        needed[r] = resources[r].imported;
+
+    std::vector<bool> alive(passes.size(), false);
+    for (size_t p = passes.size(); p-- > 0;)
+    {
+        const RenderGraphPassDesc& pass = passes[p];
+
+        bool keep = pass.sideEffects;
+        for (const RenderGraphPassDesc::Access& access : pass.accesses)
+        {
+            if (RenderGraphState::isWrite(access.state) && needed[access.resource])
+                keep = true;
+        }
+
+        if (!keep)
+            continue;
+
+        alive[p] = true;
+        for (const RenderGraphPassDesc::Access& access : pass.accesses)
+        {
+            // Unordered access reads too
+            if (!RenderGraphState::isWrite(access.state) || (access.state & RenderGraphState::UnorderedAccess))
+                needed[access.resource] = true;
+        }
+    }
+
+    // ------------------------------------------------------------
+    // Uses per resource, in executed order
+    // ------------------------------------------------------------
+    std::vector<std::vector<Use>> uses(resourceCount);
+    for (uint32_t p = 0; p < uint32_t(passes.size()); ++p)
+    {
+        if (!alive[p])
+        {
+            ++result.stats.culledPasses;
+            continue;
+        }
+
+        const uint32_t executed = uint32_t(result.passes.size());
+        result.passes.emplace_back();
+        result.passes.back().pass = p;
+
+        for (const RenderGraphPassDesc::Access& access : passes[p].accesses)
+        {
+            std::vector<Use>& list = uses[access.resource];
+
+            // The same resource twice in one pass: one combined state
+            if (!list.empty() && list.back().pass == executed)
+                list.back().state |= access.state;
+            else
+                list.push_back({ executed, access.state });
+        }
+    }
+
+    const uint32_t executedCount = uint32_t(result.passes.size());
+    result.stats.passes = executedCount;
+
+    // Consecutive reads share one combined read state
+    for (std::vector<Use>& list : uses)
+    {
+        size_t i = 0;
+        while (i < list.size())
+        {
+            if (RenderGraphState::isWrite(list[i].state))
+            {
+                ++i;
+                continue;
+            }
+
+            size_t end = i;
+            uint32_t combined = 0;
+            while (end < list.size() && !RenderGraphState::isWrite(list[end].state))
+                combined |= list[end++].state;
+
+            for (; i < end; ++i)
+                list[i].state = combined;
+        }
+    }
+
+    // ------------------------------------------------------------
+    // Transient placement (first-fit, largest first)
+    // ------------------------------------------------------------
+    result.placements.assign(resourceCount, CompiledRenderGraph::Placement());
+
+    std::vector<uint32_t> transients;
+    for (uint32_t r = 0; r < resourceCount; ++r)
+    {
+        if (uses[r].empty())
+            continue;
+
+        CompiledRenderGraph::Placement& placement = result.placements[r];
+        placement.firstPass = uses[r].front().pass;
+        placement.lastPass = uses[r].back().pass;
+
+        if (!resources[r].imported)
+            transients.push_back(r);
+    }
+
+    std::sort(transients.begin(), transients.end(), [&](uint32_t a, uint32_t b)
+        {
+            if (resources[a].size != resources[b].size)
+                return resources[a].size > resources[b].size;
+            return result.placements[a].firstPass < result.placements[b].firstPass;
+        });
+
+    auto lifetimesOverlap = [&](uint32_t a, uint32_t b)
+        {
+            const CompiledRenderGraph::Placement& pa = result.placements[a];
+            const CompiledRenderGraph::Placement& pb = result.placements[b];
+            return pa.firstPass <= pb.lastPass && pb.firstPass <= pa.lastPass;
+        };
+
+    auto memoryOverlaps = [&](uint32_t a, uint32_t b)
+        {
+            const uint64_t aBegin = result.placements[a].offset, aEnd = aBegin + resources[a].size;
+            const uint64_t bBegin = result.placements[b].offset, bEnd = bBegin + resources[b].size;
+            return aBegin < bEnd && bBegin < aEnd;
+        };
+
+    std::vector<uint32_t> placed;
+    std::vector<std::pair<uint64_t, uint64_t>> busy;
+    for (uint32_t r : transients)
+    {
+        const uint64_t size = resources[r].size;
+        const uint64_t alignment = std::max<uint64_t>(resources[r].alignment, 1);
+
+        busy.clear();
+        for (uint32_t other : placed)
+        {
+            if (lifetimesOverlap(r, other))
+                busy.push_back({ result.placements[other].offset, result.placements[other].offset + resources[other].size });
+        }
+        std::sort(busy.begin(), busy.end());
+
+        uint64_t offset = 0;
+        for (const auto& range : busy)
+        {
+            offset = alignUp(offset, alignment);
+            if (offset + size <= range.first)
+                break;
+            offset = std::max(offset, range.second);
+        }
+        offset = alignUp(offset, alignment);
+
+        result.placements[r].offset = offset;
+        placed.push_back(r);
+
+        result.stats.heapSize = std::max(result.stats.heapSize, offset + size);
+        result.stats.unaliasedSize = alignUp(result.stats.unaliasedSize, alignment) + size;
+    }
+
+    // ------------------------------------------------------------
+    // Aliasing barriers: activate shared memory before first use
+    // ------------------------------------------------------------
+    for (uint32_t r : transients)
+    {
+        uint32_t previous = RenderGraphBarrier::NONE;
+        uint32_t previousLast = 0;
+        bool shared = false;
+
+        for (uint32_t other : transients)
+        {
+            if (other == r || !memoryOverlaps(r, other))
+                continue;
+
+            shared = true;
+
+            // Latest occupant this frame; otherwise it was last frame's
+            const CompiledRenderGraph::Placement& p = result.placements[other];
+            if (p.lastPass < result.placements[r].firstPass && (previous == RenderGraphBarrier::NONE || p.lastPass >= previousLast))
+            {
+                previous = other;
+                previousLast = p.lastPass;
+            }
+        }
+
+        if (!shared)
+            continue;
+
+        result.placements[r].aliased = true;
+
+        RenderGraphBarrier barrier;
+        barrier.type = RenderGraphBarrier::Type::Aliasing;
+        barrier.resource = r;
+        barrier.before = previous;
+        result.passes[result.placements[r].firstPass].before.push_back(barrier);
+        ++result.stats.aliasingBarriers;
+    }
+
+    // ------------------------------------------------------------
+    // Transitions
+    // ------------------------------------------------------------
+    result.endStates.resize(resourceCount);
+
+    // listChanges[e]: executed passes before e that may switch command list
+    std::vector<uint32_t> listChanges(executedCount + 1, 0);
+    for (uint32_t e = 0; e < executedCount; ++e)
+        listChanges[e + 1] = listChanges[e] + (passes[result.passes[e].pass].changesCommandList ? 1 : 0);
+
+    for (uint32_t r = 0; r < resourceCount; ++r)
+    {
+        uint32_t state = resources[r].initialState;
+        uint32_t lastUse = NO_PASS;
+
+        // The final batch behaves as one more pass after the last one
+        auto addTransition = [&](uint32_t target, uint32_t pass, std::vector<RenderGraphBarrier>& batch)
+            {
+                if (lastUse != NO_PASS && pass > lastUse + 1 && listChanges[pass] == listChanges[lastUse + 1])
+                {
+                    result.passes[lastUse].after.push_back(transition(r, state, target, RenderGraphBarrier::Split::Begin));
+                    batch.push_back(transition(r, state, target, RenderGraphBarrier::Split::End));
+                    ++result.stats.splitBarriers;
+                }
+                else
+                {
+                    batch.push_back(transition(r, state, target, RenderGraphBarrier::Split::None));
+                }
+                state = target;
+            };
+
+        for (const Use& use : uses[r])
+        {
+            std::vector<RenderGraphBarrier>& batch = result.passes[use.pass].before;
+
+            if (use.state != state)
+            {
+                addTransition(use.state, use.pass, batch);
+            }
+            else if (state == RenderGraphState::UnorderedAccess && lastUse != NO_PASS)
+            {
+                // UAV -> UAV: the writes of the previous pass must be visible
+                RenderGraphBarrier barrier;
+                barrier.type = RenderGraphBarrier::Type::UAV;
+                barrier.resource = r;
+                batch.push_back(barrier);
+            }
+
+            lastUse = use.pass;
+        }
+
+        if (resources[r].imported && state != resources[r].finalState)
+            addTransition(resources[r].finalState, executedCount, result.finalBarriers);
+
+        result.endStates[r] = state;
+    }
+
+    // ------------------------------------------------------------
+    // Stats
+    // ------------------------------------------------------------
+    auto countBatch = [&](const std::vector<RenderGraphBarrier>& batch)
+        {
+            if (batch.empty())
+                return;
+            ++result.stats.batches;
+            result.stats.barriers += uint32_t(batch.size());
+        };
+
+    for (const CompiledRenderGraph::PassBarriers& pass : result.passes)
+    {
+        countBatch(pass.before);
+        countBatch(pass.after);
+    }
+    countBatch(result.finalBarriers);
+
+    return result;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// RenderGraphCompiler
+// ----------------------------------------------------------------------------
+// CPU half of the RenderGraph. Plain C++17 (no Windows / D3D12 headers), so
+// the whole compile step is built and tested headless
+// (Engine/Tests/RenderGraphCompilerTest.cpp); RenderGraph translates its
+// output to D3D12 barriers and placed resources.
+//
+// Input: resources and passes in submission order. Every pass lists the
+// resources it touches and the state it needs them in.
+//
+// compile():
+// - Culling: walking backwards, a pass survives if it has side effects or
+//   writes something a surviving pass (or the outside world, for imported
+//   resources) reads later.
+// - Read merging: consecutive read-only uses of a resource are folded into
+//   one combined state (e.g. PixelShaderResource | CopySource), so a
+//   resource read by several passes transitions once.
+// - Batching: all the barriers a pass needs go in one batch (one
+//   ResourceBarrier call). Transitions back to the imported final states go
+//   in one last batch.
+// - Split barriers: when a resource is idle for at least one pass between
+//   two uses, the transition begins right after its last use and ends
+//   right before the next one, so the GPU can overlap it with the passes
+//   in between. Both halves must be on the same command list, so a split
+//   never spans a pass flagged changesCommandList.
+// - Aliasing: transient resources get a lifetime [first, last] pass and are
+//   packed first-fit (largest first) into ONE heap; resources whose
+//   lifetimes do not overlap share memory. Every transient that shares
+//   memory gets an aliasing barrier before its first use.
+//
+// Transient resources are persistent objects, so their state carries over
+// between frames: the caller passes the state left by the previous frame
+// as 'initialState' and reads the new one back from endStates.
+// ============================================================================
+
+namespace RenderGraphState
+{
+    enum : uint32_t
+    {
+        Common                 = 0,       // also Present
+        RenderTarget           = 1 << 0,
+        DepthWrite             = 1 << 1,
+        DepthRead              = 1 << 2,
+        PixelShaderResource    = 1 << 3,
+        NonPixelShaderResource = 1 << 4,
+        UnorderedAccess        = 1 << 5,
+        CopySource             = 1 << 6,
+        CopyDest               = 1 << 7,
+
+        Present                = Common,
+        WriteMask              = RenderTarget | DepthWrite | UnorderedAccess | CopyDest
+    };
+
+    inline bool isWrite(uint32_t state) { return (state & WriteMask) != 0; }
+}
+
+struct RenderGraphResourceDesc
+{
+    std::string name;
+    bool     imported = false;
+    uint32_t initialState = RenderGraphState::Common;
+    uint32_t finalState = RenderGraphState::Common;    // imported only
+
+    // Transient only: memory requirements of the placed resource
+    uint64_t size = 0;
+    uint64_t alignment = 64 * 1024;
+};
+
+struct RenderGraphPassDesc
+{
+    struct Access
+    {
+        uint32_t resource = 0;
+        uint32_t state = RenderGraphState::Common;
+    };
+
+    std::string name;
+    std::vector<Access> accesses;
+    bool sideEffects = false;           // never culled (e.g. writes outside the graph)
+    bool changesCommandList = false;    // may splice command lists (parallel recording)
+};
+
+struct RenderGraphBarrier
+{
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    enum class Type : uint8_t { Transition, Aliasing, UAV };
+    enum class Split : uint8_t { None, Begin, End };
+
+    Type     type = Type::Transition;
+    Split    split = Split::None;
+    uint32_t resource = NONE;       // Aliasing: the resource that becomes active
+    uint32_t before = 0;            // Transition: states. Aliasing: previous occupant (or NONE)
+    uint32_t after = 0;
+};
+
+struct CompiledRenderGraph
+{
+    struct PassBarriers
+    {
+        uint32_t pass = 0;                          // index into the input passes
+        std::vector<RenderGraphBarrier> before;     // one batch before the pass
+        std::vector<RenderGraphBarrier> after;      // split begins, one batch after the pass
+    };
+
+    struct Placement
+    {
+        static constexpr uint64_t NONE = ~0ull;
+
+        uint64_t offset = NONE;     // NONE: imported or unused
+        uint32_t firstPass = 0;     // lifetime, in executed-pass indices
+        uint32_t lastPass = 0;
+        bool     aliased = false;   // shares memory: contents are undefined on first use
+    };
+
+    struct Stats
+    {
+        uint32_t passes = 0;
+        uint32_t culledPasses = 0;
+        uint32_t barriers = 0;
+        uint32_t batches = 0;       // ResourceBarrier calls
+        uint32_t splitBarriers = 0;
+        uint32_t aliasingBarriers = 0;
+        uint64_t heapSize = 0;      // transient memory with aliasing
+        uint64_t unaliasedSize = 0; // transient memory without it
+    };
+
+    std::vector<PassBarriers> passes;               // executed passes, in order
+    std::vector<RenderGraphBarrier> finalBarriers;  // one batch after the last pass
+    std::vector<Placement> placements;              // per resource
+    std::vector<uint32_t> endStates;                // per resource, after finalBarriers
+    Stats stats;
+};
+
+class RenderGraphCompiler
+{
+public:
+    static CompiledRenderGraph compile(const std::vector<RenderGraphResourceDesc>& resources,
+        const std::vector<RenderGraphPassDesc>& passes);
+};
@@ -0,0 +1,204 @@
+#include "Globals.h"
+#include "RenderQueue.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+
+namespace
+{
+    constexpr uint32_t RADIX_BITS = 8;
+    constexpr uint32_t RADIX_SIZE = 1u << RADIX_BITS;
+    constexpr uint32_t RADIX_PASSES = 64 / RADIX_BITS;
+    constexpr uint32_t MAX_SORT_THREADS = 8;
+
+    inline uint32_t digitOf(uint64_t key, uint32_t pass)
+    {
+        return uint32_t(key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1);
+    }
+
+    inline uint64_t field(uint32_t value, uint32_t bits)
+    {
+        return uint64_t(value) & ((uint64_t(1) << bits) - 1);
+    }
+
+    // ------------------------------------------------------------
+    // Single threaded: every histogram is built in one read of the data,
+    // then one scatter per digit. Digits where all keys agree are skipped.
+    // ------------------------------------------------------------
+    void radixSortSerial(std::vector<RenderQueue::Entry>& data, std::vector<RenderQueue::Entry>& tmp)
+    {
+        const size_t count = data.size();
+
+        uint32_t histograms[RADIX_PASSES][RADIX_SIZE] = {};
+        for (const RenderQueue::Entry& e : data)
+        {
+            for (uint32_t p = 0; p < RADIX_PASSES; ++p)
+                ++histograms[p][digitOf(e.key, p)];
+        }
+
+        RenderQueue::Entry* src = data.data();
+        RenderQueue::Entry* dst = tmp.data();
+
+        for (uint32_t p = 0; p < RADIX_PASSES; ++p)
+        {
+            uint32_t* histogram = histograms[p];
+
+            if (histogram[digitOf(src[0].key, p)] == count)
+                continue;
+
+            uint32_t offset = 0;
+            for (uint32_t d = 0; d < RADIX_SIZE; ++d)
+            {
+                uint32_t c = histogram[d];
+                histogram[d] = offset;
+                offset += c;
+            }
+
+            for (size_t i = 0; i < count; ++i)
+                dst[histogram[digitOf(src[i].key, p)]++] = src[i];
+
+            std::swap(src, dst);
+        }
+
+        if (src != data.data())
+            data.swap(tmp);
+    }
+
+    // ------------------------------------------------------------
+    // Multi threaded: the array is split in contiguous chunks. For every digit
+    // each thread builds the histogram of its chunk, offsets are resolved per
+    // (bucket, chunk) so the scatter stays stable, and each thread scatters
+    // its own chunk.
+    // ------------------------------------------------------------
+    void radixSortParallel(std::vector<RenderQueue::Entry>& data, std::vector<RenderQueue::Entry>& tmp, JobSystem& jobs, uint32_t threadCount)
+    {
+        const size_t count = data.size();
+        const size_t chunkSize = (count + threadCount - 1) / threadCount;
+
+        std::vector<uint32_t> histograms(size_t(threadCount) * RADIX_SIZE);
+
+        auto runChunks = [&](auto&& fn)
+            {
+                jobs.parallelFor(0, threadCount, 1, [&](size_t first, size_t last)
+                    {
+                        for (size_t t = first; t < last; ++t)
+                            fn(uint32_t(t));
+                    });
+            };
+
+        RenderQueue::Entry* src = data.data();
+        RenderQueue::Entry* dst = tmp.data();
+
+        for (uint32_t p = 0; p < RADIX_PASSES; ++p)
+        {
+            std::fill(histograms.begin(), histograms.end(), 0u);
+
+            runChunks([&](uint32_t t)
+                {
+                    const size_t begin = std::min(count, t * chunkSize);
+                    const size_t end = std::min(count, begin + chunkSize);
+                    uint32_t* h = &histograms[size_t(t) * RADIX_SIZE];
+                    for (size_t i = begin; i < end; ++i)
+                        ++h[digitOf(src[i].key, p)];
+                });
+
+            // Skip the digit if every key shares it
+            const uint32_t firstDigit = digitOf(src[0].key, p);
+            uint32_t sameDigit = 0;
+            for (uint32_t t = 0; t < threadCount; ++t)
+                sameDigit += histograms[size_t(t) * RADIX_SIZE + firstDigit];
+            if (sameDigit == count)
+                continue;
+
+            uint32_t offset = 0;
+            for (uint32_t d = 0; d < RADIX_SIZE; ++d)
+            {
+                for (uint32_t t = 0; t < threadCount; ++t)
+                {
+                    uint32_t& h = histograms[size_t(t) * RADIX_SIZE + d];
+                    uint32_t c = h;
+                    h = offset;
+                    offset += c;
+                }
+            }
+
+            runChunks([&](uint32_t t)
+                {
+                    const size_t begin = std::min(count, t * chunkSize);
+                    const size_t end = std::min(count, begin + chunkSize);
+                    uint32_t* h = &histograms[size_t(t) * RADIX_SIZE];
+                    for (size_t i = begin; i < end; ++i)
+                        dst[h[digitOf(src[i].key, p)]++] = src[i];
+                });
+
+            std::swap(src, dst);
+        }
+
+        if (src != data.data())
+            data.swap(tmp);
+    }
+}
+
+void RenderQueue::sort(JobSystem* jobs)
+{
+    radixSort(entries, scratch, jobs);
+}
+
+void RenderQueue::radixSort(std::vector<Entry>& data, std::vector<Entry>& tmp, JobSystem* jobs)
+{
+    if (data.size() < 2)
+        return;
+
+    tmp.resize(data.size());
+
+    uint32_t threadCount = jobs ? std::min(jobs->getThreadCount(), MAX_SORT_THREADS) : 1;
+
+    if (data.size() < PARALLEL_THRESHOLD || threadCount < 2)
+        radixSortSerial(data, tmp);
+    else
+        radixSortParallel(data, tmp, *jobs, threadCount);
+}
+
+uint32_t RenderQueue::getStateId(StateType type, const void* state)
+{
+    auto& ids = stateIds[size_t(type)];
+
+    auto it = ids.find(state);
+    if (it != ids.end())
+        return it->second;
+
+    uint32_t id = uint32_t(ids.size());
+    ids.emplace(state, id);
+    return id;
+}
+
+uint32_t RenderQueue::quantizeDepth(float depth01)
+{
+    const float maxValue = float((1u << DEPTH_BITS) - 1);
+    float d = std::min(std::max(depth01, 0.0f), 1.0f);
+    return uint32_t(d * maxValue);
+}
+
+uint64_t RenderQueue::makeOpaqueKey(uint32_t pass, uint32_t psoId, uint32_t materialId, uint32_t meshId, float depth01)
+{
+    uint64_t key = field(pass, PASS_BITS);
+    key = (key << 1);                                   // opaque
+    key = (key << PSO_BITS) | field(psoId, PSO_BITS);
+    key = (key << MATERIAL_BITS) | field(materialId, MATERIAL_BITS);
+    key = (key << MESH_BITS) | field(meshId, MESH_BITS);
+    key = (key << DEPTH_BITS) | field(quantizeDepth(depth01), DEPTH_BITS);
+    return key;
+}
+
+uint64_t RenderQueue::makeTransparentKey(uint32_t pass, uint32_t psoId, uint32_t materialId, uint32_t meshId, float depth01)
+{
+    const uint32_t invDepth = ((1u << DEPTH_BITS) - 1) - quantizeDepth(depth01);
+
+    uint64_t key = field(pass, PASS_BITS);
+    key = (key << 1) | 1;                               // transparent
+    key = (key << DEPTH_BITS) | field(invDepth, DEPTH_BITS);
+    key = (key << PSO_BITS) | field(psoId, PSO_BITS);
+    key = (key << MATERIAL_BITS) | field(materialId, MATERIAL_BITS);
+    key = (key << MESH_BITS) | field(meshId, MESH_BITS);
+    return key;
+}
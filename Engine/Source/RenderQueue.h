@@ -0,0 +1,103 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+class JobSystem;
+
+// ============================================================================
+// RenderQueue
+// ----------------------------------------------------------------------------
+// Collects the visible draws of a frame as 64-bit sort keys and orders them
+// with an LSD radix sort, so draws sharing the same state end up adjacent.
+//
+// Key layout (MSB -> LSB):
+//
+//   Opaque:       | pass:4 | 0:1 | pso:11 | material:16 | mesh:12 | depth:20    |
+//   Transparent:  | pass:4 | 1:1 | ~depth:20   | pso:11 | material:16 | mesh:12 |
+//
+// - Passes are always played in order.
+// - Opaque draws are sorted by state first, then front-to-back inside each
+//   state group (better early-Z rejection).
+// - Transparent draws are sorted back-to-front; state only breaks ties.
+//
+// Notes:
+// - State ids (pso / material / mesh) are small integers handed out on first
+//   use by getStateId(). Ids wrap if a field overflows, so the consumer must
+//   still compare the real state when deciding whether to change it.
+// - Ids only have to agree within one sort, so clear() forgets them too: the
+//   maps don't grow as pipelines and materials are recreated, and an address
+//   reused by a new object never inherits an old id.
+// - Every entry carries a 32-bit payload (normally an index into the
+//   caller's own draw array); the queue never touches the draws themselves.
+// - Large queues are sorted on the JobSystem (histograms and scatters per
+//   chunk); small ones, or calls without a JobSystem, stay single threaded.
+// ============================================================================
+
+class RenderQueue
+{
+public:
+    struct Entry
+    {
+        uint64_t key = 0;
+        uint32_t payload = 0;
+    };
+
+    enum class StateType
+    {
+        PSO = 0,
+        Material,
+        Mesh,
+        Count
+    };
+
+    static constexpr uint32_t PASS_BITS = 4;
+    static constexpr uint32_t PSO_BITS = 11;
+    static constexpr uint32_t MATERIAL_BITS = 16;
+    static constexpr uint32_t MESH_BITS = 12;
+    static constexpr uint32_t DEPTH_BITS = 20;
+
+    static constexpr uint32_t MAX_PASSES = 1u << PASS_BITS;
+
+    // Below this many entries the sort stays on the calling thread
+    static constexpr size_t PARALLEL_THRESHOLD = 16 * 1024;
+
+private:
+    std::vector<Entry> entries;
+    std::vector<Entry> scratch;
+
+    std::unordered_map<const void*, uint32_t> stateIds[size_t(StateType::Count)];
+
+public:
+    RenderQueue() = default;
+    ~RenderQueue() = default;
+
+    void clear()
+    {
+        entries.clear();
+        for (auto& ids : stateIds)
+            ids.clear();
+    }
+    void reserve(size_t count) { entries.reserve(count); }
+
+    void push(uint64_t key, uint32_t payload) { entries.push_back({ key, payload }); }
+
+    // Sorts the queue by key (stable, ascending)
+    void sort(JobSystem* jobs = nullptr);
+
+    const std::vector<Entry>& getEntries() const { return entries; }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    // Returns a compact id for a state object, assigned on first use since clear()
+    uint32_t getStateId(StateType type, const void* state);
+
+    // depth01 is the view depth normalized to [0, 1] (0 = near)
+    static uint64_t makeOpaqueKey(uint32_t pass, uint32_t psoId, uint32_t materialId, uint32_t meshId, float depth01);
+    static uint64_t makeTransparentKey(uint32_t pass, uint32_t psoId, uint32_t materialId, uint32_t meshId, float depth01);
+
+    static uint32_t quantizeDepth(float depth01);
+
+    // Plain LSD radix sort over an Entry array. 'tmp' is resized as needed.
+    static void radixSort(std::vector<Entry>& data, std::vector<Entry>& tmp, JobSystem* jobs = nullptr);
+};
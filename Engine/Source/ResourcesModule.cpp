@@ -34,17 +34,93 @@ bool ResourcesModule::init()
 	commandList->Reset(commandAllocator.Get(), nullptr);
 	commandList->Close();
 
+	device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&uploadFence));
+	uploadEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+	// ------------------------------------------------------------
+	// Heaps for static buffers and textures (created on first use)
+	// ------------------------------------------------------------
+	heapAllocator = std::make_unique<GpuHeapAllocator>(device);
+
 	t.Stop();
 	Logger::Log("ResourceModule initialized in: " + std::to_string(t.ReadMs()) + " ms.");
 
 	return true;
 }
 
+void ResourcesModule::preRender()
+{
+	D3D12Module* d3d12 = app->getD3D12();
+
+	// ------------------------------------------------------------
+	// Static resources dropped by their owners go back to the heaps
+	// once the GPU has finished the frames that could read them
+	// ------------------------------------------------------------
+	heapAllocator->collect(d3d12->getLastFrameFence(), d3d12->getCompletedFenceValue());
+
+	if (!defragmentRequested)
+		return;
+
+	defragmentRequested = false;
+
+	// ------------------------------------------------------------
+	// Compact before this frame records: its draws read the new
+	// addresses through their allocations
+	// ------------------------------------------------------------
+	std::lock_guard<std::mutex> lock(uploadMutex);
+
+	commandAllocator->Reset();
+	commandList->Reset(commandAllocator.Get(), nullptr);
+
+	const uint32_t compacted = heapAllocator->defragment(commandList.Get(), true);
+	submitAndWait();
+
+	Logger::Log("ResourcesModule: defragmented " + std::to_string(compacted) + " buffer heap(s)");
+}
+
 bool ResourcesModule::cleanUp()
 {
+	if (uploadEvent)
+	{
+		CloseHandle(uploadEvent);
+		uploadEvent = nullptr;
+	}
+
 	return true;
 }
 
+ModuleAccess ResourcesModule::getAccess(ModulePhase phase) const
+{
+	using namespace ModuleResource;
+
+	// preRender submits copies on the queue and waits for them
+	if (phase == ModulePhase::PreRender)
+		return ModuleAccess::main(Device, Device);
+
+	return ModuleAccess::idle();
+}
+
+void ResourcesModule::submitAndWait()
+{
+	ID3D12CommandQueue* queue = app->getD3D12()->getCommandQueue();
+
+	commandList->Close();
+	ID3D12CommandList* lists[] = { commandList.Get() };
+	queue->ExecuteCommandLists(_countof(lists), lists);
+
+	// ------------------------------------------------------------
+	// The queue runs in order: once the fence passes, the list and
+	// everything submitted before it are done. A fence of our own,
+	// so a loading job never touches the frame fence of D3D12Module
+	// ------------------------------------------------------------
+	queue->Signal(uploadFence.Get(), ++uploadFenceValue);
+	if (uploadFence->GetCompletedValue() < uploadFenceValue)
+	{
+		uploadFence->SetEventOnCompletion(uploadFenceValue, uploadEvent);
+		WaitForSingleObject(uploadEvent, INFINITE);
+	}
+}
+
 
 // ----------------------------------------------------------------------------
 // createUploadBuffer()
@@ -100,7 +176,6 @@ ComPtr<ID3D12Resource> ResourcesModule::createDefaultBuffer(const void* data, si
 {
 	D3D12Module* d3d12 = app->getD3D12();
 	ID3D12Device2* device = d3d12->getDevice();
-	ID3D12CommandQueue* queue = d3d12->getCommandQueue();
 
 	ComPtr<ID3D12Resource> vertexBuffer;
 	ComPtr<ID3D12Resource> stagingBuffer;
@@ -130,25 +205,81 @@ ComPtr<ID3D12Resource> ResourcesModule::createDefaultBuffer(const void* data, si
 	// -----------------------------------------------------------------
 	// ---  RECORD COMMANDS & GPU: COPY DATA ---
 	// -----------------------------------------------------------------
+	std::lock_guard<std::mutex> lock(uploadMutex);
+
 	commandAllocator->Reset();
 	commandList->Reset(commandAllocator.Get(), nullptr);
 	commandList->CopyResource(vertexBuffer.Get(), stagingBuffer.Get());    // GPU copy data
-	commandList->Close();
-
-	// ----------------------------------------------------------------
-	// --- EXECUTE ---
-	// ----------------------------------------------------------------
-	ID3D12CommandList* lists[] = { commandList.Get() };
-	queue->ExecuteCommandLists(_countof(lists), lists);
 
 	// ----------------------------------------------------------------
-	// --- WAIT ---
+	// --- EXECUTE & WAIT ---
 	// ----------------------------------------------------------------
-	d3d12->waitForGPU();
+	submitAndWait();
 
 	return vertexBuffer;
 }
 
+// ---------------------------------------------------------------------------
+// createStaticBuffer()
+// Same as createDefaultBuffer(), but the data lands in a range of a shared
+// DEFAULT heap buffer instead of its own resource (no 64 KB minimum, no
+// per-buffer kernel allocation). The range is freed when the last copy of
+// the returned allocation is released.
+// ----------------------------------------------------------------------------
+GpuAllocationPtr ResourcesModule::createStaticBuffer(const void* data, size_t size, const char* name)
+{
+	GpuAllocationPtr allocation = heapAllocator->allocateBuffer(size);
+
+	if (!allocation)
+	{
+		// -----------------------------------------------------------------
+		// Too big for a heap: own committed buffer, same interface
+		// -----------------------------------------------------------------
+		ComPtr<ID3D12Resource> buffer = createDefaultBuffer(data, size, name);
+		if (!buffer)
+			return nullptr;
+
+		++committedFallbacks;
+
+		ID3D12Resource* resource = buffer.Detach();
+		allocation = GpuAllocationPtr(new GpuAllocation(), [resource](GpuAllocation* a)
+			{
+				resource->Release();
+				delete a;
+			});
+		allocation->resource = resource;
+		allocation->size = size;
+		return allocation;
+	}
+
+	// -----------------------------------------------------------------
+	// --- THE STAGING BUFFER (UPLOAD HEAP) ---
+	// -----------------------------------------------------------------
+	ComPtr<ID3D12Resource> stagingBuffer = getUploadHeap(size);
+	if (!stagingBuffer)
+		return nullptr;
+
+	BYTE* pData = nullptr;
+	CD3DX12_RANGE readRange(0, 0);
+	stagingBuffer->Map(0, &readRange, reinterpret_cast<void**>(&pData));
+	memcpy(pData, data, size);
+	stagingBuffer->Unmap(0, nullptr);
+
+	// -----------------------------------------------------------------
+	// --- GPU: COPY INTO THE RANGE ---
+	// The heap buffer stays in COMMON: the copy promotes it to COPY_DEST
+	// and it decays back when the list finishes.
+	// -----------------------------------------------------------------
+	std::lock_guard<std::mutex> lock(uploadMutex);
+
+	commandAllocator->Reset();
+	commandList->Reset(commandAllocator.Get(), nullptr);
+	commandList->CopyBufferRegion(allocation->resource, allocation->offset, stagingBuffer.Get(), 0, size);
+	submitAndWait();
+
+	return allocation;
+}
+
 ComPtr<ID3D12Resource> ResourcesModule::createTextureFromFile(const std::filesystem::path& path, bool defaultSRGB)
 {
 	const wchar_t* fileName = path.c_str();
@@ -179,7 +310,6 @@ ComPtr<ID3D12Resource> ResourcesModule::createTextureFromImage(const ScratchImag
 {
 	D3D12Module* d3d12 = app->getD3D12();
 	ID3D12Device2* device = d3d12->getDevice();
-	ID3D12CommandQueue* queue = d3d12->getCommandQueue();
 
 	ComPtr<ID3D12Resource> texture;
 	const TexMetadata& metaData = image.GetMetadata();
@@ -198,9 +328,16 @@ ComPtr<ID3D12Resource> ResourcesModule::createTextureFromImage(const ScratchImag
 		UINT16(metaData.mipLevels)
 	);
 
-	CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_DEFAULT);
-	if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&texture))))
-		return nullptr;
+	// Placed in a texture heap; committed when it does not fit one
+	texture = heapAllocator->createTexture(desc, D3D12_RESOURCE_STATE_COPY_DEST);
+	if (!texture)
+	{
+		CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_DEFAULT);
+		if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&texture))))
+			return nullptr;
+
+		++committedFallbacks;
+	}
 
 	// ------------------------------------------------------------
 	// Create upload heap buffer (CPU -> GPU transfer)
@@ -229,8 +366,10 @@ ComPtr<ID3D12Resource> ResourcesModule::createTextureFromImage(const ScratchImag
 	}
 
 	// ------------------------------------------------------------
-	// Reset command list for texture upload
+	// Reset command list for texture upload (one upload at a time)
 	// ------------------------------------------------------------
+	std::lock_guard<std::mutex> lock(uploadMutex);
+
 	commandAllocator->Reset();
 	commandList->Reset(commandAllocator.Get(), nullptr);
 
@@ -248,10 +387,7 @@ ComPtr<ID3D12Resource> ResourcesModule::createTextureFromImage(const ScratchImag
 	// ------------------------------------------------------------
 	// Execute command list and wait for GPU
 	// ------------------------------------------------------------
-	commandList->Close();
-	ID3D12CommandList* lists[] = { commandList.Get() };
-	queue->ExecuteCommandLists(1, lists);
-	d3d12->waitForGPU();
+	submitAndWait();
 
 	// ------------------------------------------------------------
 	// Set debug name for GPU debugging tools
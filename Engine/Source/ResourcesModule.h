@@ -2,12 +2,23 @@
 #include "Module.h"
 #include "D3D12Module.h"
 #include "DirectXTex.h"
+#include "GpuHeapAllocator.h"
+#include <atomic>
 #include <filesystem>
+#include <mutex>
 
 // ------------------------------------------------------------------------------------------
 // ResourcesModule handles creation and management of GPU resources in DirectX 12.
 // It provides functions to create buffers, textures, render targets, and depth stencils.
 // The class manages temporary upload buffers and command lists for resource initialization.
+//
+// Static data (mesh buffers, material constants, textures) lives in GpuHeapAllocator heaps:
+// createStaticBuffer() returns a range of a shared buffer, textures are placed resources.
+// preRender() frees what the GPU is done with and compacts the buffer heaps on request.
+//
+// The create*() functions can be called from loading jobs: uploads share one command list,
+// so they go one at a time, each waiting on a fence of its own rather than the whole frame.
+// File decoding and mip generation happen before that and run in parallel.
 // ------------------------------------------------------------------------------------------
 
 class ResourcesModule : public Module
@@ -17,21 +28,45 @@ private:
 	ComPtr<ID3D12CommandAllocator> commandAllocator;
 	ComPtr<ID3D12GraphicsCommandList> commandList;
 
+	// Guards the command list; the fence tells when an upload is done
+	std::mutex uploadMutex;
+	ComPtr<ID3D12Fence> uploadFence;
+	HANDLE uploadEvent = nullptr;
+	uint64_t uploadFenceValue = 0;
+
+	std::unique_ptr<GpuHeapAllocator> heapAllocator;
+	bool defragmentRequested = false;
+	std::atomic<uint32_t> committedFallbacks{ 0 };	// static resources too big (or odd) for the heaps
+
+	// Caller holds uploadMutex
+	void submitAndWait();
+
 public:
 	ResourcesModule();
 	~ResourcesModule();
 
 	bool init() override;
-	//void preRender() override;
+	void preRender() override;
 	bool cleanUp() override;
+
+	const char* getName() const override { return "Resources"; }
+	ModuleAccess getAccess(ModulePhase phase) const override;
 	
 	ComPtr<ID3D12Resource> createUploadBuffer(const void* data, size_t size, const char* name);
 	ComPtr<ID3D12Resource> createDefaultBuffer(const void* data, size_t size, const char* name);
 
+	// DEFAULT heap data suballocated from the static buffer heaps (committed when too big)
+	GpuAllocationPtr createStaticBuffer(const void* data, size_t size, const char* name);
+
 	ComPtr<ID3D12Resource> createRawTexture2D(const void* data, size_t rowSize, size_t width, size_t height, DXGI_FORMAT format);
 	ComPtr<ID3D12Resource> createTextureFromMemory(const void* data, size_t size, const char* name);
 	ComPtr<ID3D12Resource> createTextureFromFile(const std::filesystem::path& path, bool defaultSRGB = false);
 
+	// Compacts fragmented buffer heaps at the start of the next frame
+	void requestDefragment() { defragmentRequested = true; }
+	GpuHeapAllocator::Stats getHeapStats() const { return heapAllocator->getStats(); }
+	uint32_t getCommittedFallbacks() const { return committedFallbacks; }
+
 private:
 
 	ComPtr<ID3D12Resource> createTextureFromImage(const ScratchImage& image, const char* name);
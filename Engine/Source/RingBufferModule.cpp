@@ -4,13 +4,46 @@
 #include "D3D12Module.h"
 #include "Application.h"
 
+#include <algorithm>
+
 // ------------------------------------------------------------
-// Total size of the ring buffer (10 MB).
+// Initial size of the ring buffer (10 MB).
 // This buffer will be reused every frame to store dynamic data
-// such as constant buffers (PerFrame / PerInstance).
+// such as constant buffers (PerFrame / PerInstance). It grows or
+// shrinks later with the per-frame high-water mark (adaptSize).
 // ------------------------------------------------------------
 #define MEMORY_TOTAL_SIZE 10 * (1 << 20)
 
+namespace
+{
+    // ------------------------------------------------------------
+    // Block the calling thread is suballocating from.
+    // Stale once the frame epoch changes (or for another ring).
+    // ------------------------------------------------------------
+    struct ThreadBlock
+    {
+        const RingBufferModule* owner = nullptr;
+        uint64_t epoch = 0;
+        uint64_t cursor = 0;        // virtual positions
+        uint64_t end = 0;
+    };
+
+    thread_local ThreadBlock tlsBlock;
+
+    // Last resort when not even an overflow page can be created: the
+    // caller writes here instead of through a null pointer
+    thread_local std::vector<char> tlsScratch;
+
+    // 256B -> 0, 512B -> 1, ... 1MB and bigger -> SIZE_CLASSES - 1
+    uint32_t sizeClass(size_t size)
+    {
+        uint32_t index = 0;
+        for (size_t limit = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT; size > limit && index + 1 < RingBufferModule::SIZE_CLASSES; limit <<= 1)
+            ++index;
+        return index;
+    }
+}
+
 RingBufferModule::RingBufferModule()
 {
 }
@@ -21,16 +54,7 @@ RingBufferModule::~RingBufferModule()
 
 bool RingBufferModule::init()
 {
-    // ------------------------------------------------------------
-    // Create a fixed-size buffer in the UPLOAD heap.
-    //
-    // Conceptually:
-    // - This buffer lives in CPU-visible memory.
-    // - We will write CPU data every frame.
-    // - The GPU will read from it while rendering.
-    //
-    // The buffer behaves like a circular (ring) allocator.
-    // ------------------------------------------------------------
+    D3D12Module* d3d12 = app->getD3D12();
 
     // ------------------------------------------------------------
     // The total size must be aligned to the constant buffer
@@ -39,34 +63,38 @@ bool RingBufferModule::init()
     // This guarantees that every allocation inside the buffer
     // can be safely used as a Constant Buffer View.
     // ------------------------------------------------------------
+    if (!createRing(alignUp(MEMORY_TOTAL_SIZE, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT)))
+        return false;
 
-    totalMemorySize = alignUp(MEMORY_TOTAL_SIZE, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+    // Current frame index (used to know what memory can be freed)
+    currentFrame = d3d12->getCurrentBackBufferIdx();
 
-    D3D12Module* d3d12 = app->getD3D12();
-    ID3D12Device2* device = d3d12->getDevice();
+    return true;
+}
 
+bool RingBufferModule::createRing(size_t size)
+{
     // ------------------------------------------------------------
-    // Create an UPLOAD heap resource.
+    // Create a fixed-size buffer in the UPLOAD heap.
     //
-    // Upload heap:
-    // - CPU writes directly to it
-    // - GPU can read from it
-    // - Slower than DEFAULT heap, but ideal for dynamic data
+    // Conceptually:
+    // - This buffer lives in CPU-visible memory.
+    // - We will write CPU data every frame.
+    // - The GPU will read from it while rendering.
+    //
+    // The buffer behaves like a circular (ring) allocator.
     // ------------------------------------------------------------
-    CD3DX12_HEAP_PROPERTIES heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-    CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(totalMemorySize);
-    device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&buffer));
-    buffer->SetName(L"Dynamic Ring Buffer");
+    UploadPage ring;
+    if (!createPage(size, ring, L"Dynamic Ring Buffer"))
+    {
+        Logger::Err("RingBuffer: failed to create a " + std::to_string(size / 1024) + "KB ring");
+        return false;
+    }
 
-    // ------------------------------------------------------------
-   // Map the resource once and keep it mapped.
-   //
-   // Conceptually:
-   // - bufferData is a raw CPU pointer to the entire ring buffer.
-   // - We will manually manage offsets inside this memory.
-   // ------------------------------------------------------------
-    CD3DX12_RANGE readRange(0, 0); // We never read from CPU
-    buffer->Map(0, &readRange, reinterpret_cast<void**>(&bufferData));
+    buffer = ring.resource;
+    bufferData = ring.cpu;
+    bufferGPU = ring.gpu;
+    totalMemorySize = size;
 
     // ------------------------------------------------------------
     // Initialize ring buffer state.
@@ -74,12 +102,8 @@ bool RingBufferModule::init()
     // head -> where the next allocation will happen
     // tail -> where old memory will be reclaimed
     // ------------------------------------------------------------
-    head = 0;
-    tail = 0;
-
-    // Current frame index (used to know what memory can be freed)
-    currentFrame = d3d12->getCurrentBackBufferIdx();
-    totalAllocated = 0;
+    head.store(0);
+    tail.store(0);
 
     // ------------------------------------------------------------
     // Track how much memory each frame has allocated.
@@ -89,12 +113,47 @@ bool RingBufferModule::init()
     // ------------------------------------------------------------
     for (int i = 0; i < FRAMES_IN_FLIGHT; ++i)
     {
-        allocatedInFrame[i] = 0;
+        allocatedInFrame[i].store(0);
     }
 
     return true;
 }
 
+bool RingBufferModule::createPage(size_t size, UploadPage& page, const wchar_t* name)
+{
+    ID3D12Device2* device = app->getD3D12()->getDevice();
+
+    // ------------------------------------------------------------
+    // Create an UPLOAD heap resource.
+    //
+    // Upload heap:
+    // - CPU writes directly to it
+    // - GPU can read from it
+    // - Slower than DEFAULT heap, but ideal for dynamic data
+    // ------------------------------------------------------------
+    CD3DX12_HEAP_PROPERTIES heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+    CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(size);
+    if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&page.resource))))
+        return false;
+    page.resource->SetName(name);
+
+    // ------------------------------------------------------------
+    // Map the resource once and keep it mapped.
+    //
+    // Conceptually:
+    // - cpu is a raw CPU pointer to the entire buffer.
+    // - We will manually manage offsets inside this memory.
+    // ------------------------------------------------------------
+    CD3DX12_RANGE readRange(0, 0); // We never read from CPU
+    page.resource->Map(0, &readRange, reinterpret_cast<void**>(&page.cpu));
+    page.gpu = page.resource->GetGPUVirtualAddress();
+    page.size = size;
+    page.used = 0;
+    page.fenceValue = 0;
+
+    return true;
+}
+
 void RingBufferModule::preRender()
 {
     // ------------------------------------------------------------
@@ -102,7 +161,33 @@ void RingBufferModule::preRender()
     //
     // Its responsibility is to reclaim memory that was used
     // by a previous frame and is now safe to reuse.
+    //
+    // No thread allocates while it runs, so plain loads / stores
+    // of the atomics are enough here.
     // ------------------------------------------------------------
+
+    // ------------------------------------------------------------
+    // Keep the stats of the frame that just finished recording.
+    // ------------------------------------------------------------
+    Stats& stats = lastFrameStats;
+    stats.blocks = blockCount.exchange(0, std::memory_order_relaxed);
+    stats.directAllocations = directCount.exchange(0, std::memory_order_relaxed);
+    stats.subAllocations = subAllocCount.exchange(0, std::memory_order_relaxed);
+    stats.casRetries = retryCount.exchange(0, std::memory_order_relaxed);
+    stats.overflowAllocations = overflowCount.exchange(0, std::memory_order_relaxed);
+    stats.failures = failureCount.exchange(0, std::memory_order_relaxed);
+    stats.reserved = allocatedInFrame[currentFrame].load(std::memory_order_relaxed);
+    stats.used = usedInFrame.exchange(0, std::memory_order_relaxed);
+    stats.overflow = overflowInFrame.exchange(0, std::memory_order_relaxed);
+    stats.wasted = stats.reserved + stats.overflow - stats.used;
+    stats.padding = paddingInFrame.exchange(0, std::memory_order_relaxed);
+    stats.cbvPadding = cbvPaddingInFrame.exchange(0, std::memory_order_relaxed);
+
+    for (uint32_t i = 0; i < SIZE_CLASSES; ++i)
+    {
+        stats.histogram[i] = histogram[i].exchange(0, std::memory_order_relaxed);
+    }
+
     D3D12Module* d3d12 = app->getD3D12();
     currentFrame = d3d12->getCurrentBackBufferIdx();
 
@@ -113,121 +198,370 @@ void RingBufferModule::preRender()
     // Conceptually:
     // - The GPU has finished using this memory.
     // - We can safely mark it as free.
+    // - Frames allocate one after another, so this lands exactly
+    //   where the next frame started (skipped bytes included).
+    // ------------------------------------------------------------
+    tail.fetch_add(allocatedInFrame[currentFrame].exchange(0, std::memory_order_relaxed), std::memory_order_release);
+
+    // ------------------------------------------------------------
+    // Overflow pages written by the last frame wait for its fence,
+    // then the ring adapts to the recent high-water mark.
+    // ------------------------------------------------------------
+    const uint64_t frameFence = d3d12->getLastFrameFence();
+    retirePages(frameFence, d3d12->getCompletedFenceValue());
+    adaptSize(stats.reserved + stats.overflow, stats.overflowAllocations > 0 || stats.failures > 0, frameFence);
+
+    stats.highWater = *std::max_element(history, history + HISTORY_FRAMES);
+    stats.pages = uint32_t(pendingPages.size() + freePages.size());
+    stats.resizes = resizeCount;
+
     // ------------------------------------------------------------
-    tail = (tail + allocatedInFrame[currentFrame]) % totalMemorySize;
-    totalAllocated -= allocatedInFrame[currentFrame]; // Update total allocated memory
-    allocatedInFrame[currentFrame] = 0;  // Reset allocation counter for this frame
+    // Thread blocks from the previous frame must not be reused:
+    // their memory is charged to that frame (and after a resize
+    // they point into the old buffer).
+    // ------------------------------------------------------------
+    frameEpoch.fetch_add(1, std::memory_order_release);
 }
 
-D3D12_GPU_VIRTUAL_ADDRESS RingBufferModule::allocBuffer(size_t size, void** cpuPtr)
+void RingBufferModule::retirePages(uint64_t frameFence, uint64_t completedFence)
+{
+    // ------------------------------------------------------------
+    // Pages the last frame wrote to can be reused once the GPU
+    // reaches the fence signalled after that frame.
+    // ------------------------------------------------------------
+    for (UploadPage& page : framePages)
+    {
+        page.fenceValue = frameFence;
+        pendingPages.push_back(std::move(page));
+    }
+    framePages.clear();
+
+    for (size_t i = 0; i < pendingPages.size();)
+    {
+        UploadPage& page = pendingPages[i];
+        if (page.fenceValue > completedFence)
+        {
+            ++i;
+            continue;
+        }
+
+        // Keep a couple of standard pages for the next spike, release the rest
+        // (including old rings retired by a resize)
+        if (page.size == OVERFLOW_PAGE_SIZE && freePages.size() < MAX_FREE_PAGES)
+        {
+            page.used = 0;
+            freePages.push_back(std::move(page));
+        }
+
+        if (i + 1 < pendingPages.size())
+            pendingPages[i] = std::move(pendingPages.back());
+        pendingPages.pop_back();
+    }
+}
+
+void RingBufferModule::adaptSize(size_t frameBytes, bool overflowed, uint64_t frameFence)
+{
+    history[historyIndex] = frameBytes;
+    historyIndex = (historyIndex + 1) % HISTORY_FRAMES;
+    historyCount = std::min(historyCount + 1, HISTORY_FRAMES);
+
+    // ------------------------------------------------------------
+    // The ring holds every frame in flight: size it for the peak
+    // frame of the window times FRAMES_IN_FLIGHT, plus 25% headroom
+    // for thread block leftovers and wrap skips.
+    // ------------------------------------------------------------
+    const size_t peak = *std::max_element(history, history + HISTORY_FRAMES);
+    const size_t needed = std::max(alignUp(peak * FRAMES_IN_FLIGHT * 5 / 4, size_t(1) << 20), MIN_RING_SIZE);
+
+    size_t newSize = 0;
+    if (overflowed && needed > totalMemorySize)
+        newSize = needed;                                       // grow right after a spike
+    else if (historyCount == HISTORY_FRAMES && needed < totalMemorySize / 4)
+        newSize = needed;                                       // a whole window far below: shrink
+
+    if (newSize == 0)
+        return;
+
+    // ------------------------------------------------------------
+    // Frames in flight may still read the old ring: retire it like
+    // an overflow page instead of releasing it now. It stays mapped
+    // and complete, since a MIN_RING_SIZE ring has the size of an
+    // overflow page and may be recycled as one.
+    // ------------------------------------------------------------
+    UploadPage old;
+    old.resource = buffer;
+    old.cpu = bufferData;
+    old.gpu = bufferGPU;
+    old.size = totalMemorySize;
+    old.fenceValue = frameFence;
+
+    const size_t oldSize = totalMemorySize;
+    if (!createRing(newSize))
+        return;
+
+    pendingPages.push_back(std::move(old));
+    historyCount = 0;
+    ++resizeCount;
+
+    Logger::Log("RingBuffer: resized from " + std::to_string(oldSize / 1024) + "KB to " + std::to_string(newSize / 1024) +
+        "KB (peak frame " + std::to_string(peak / 1024) + "KB)");
+}
+
+uint64_t RingBufferModule::reserve(size_t size)
+{
+    // ------------------------------------------------------------
+    // Lock-free reservation from the shared head.
+    //
+    // A plain fetch-add cannot be undone when the buffer is full, and
+    // cannot skip the unusable bytes at the end, so the new head is
+    // computed first and published with a compare-exchange. Losing the
+    // race just means trying again with the new head.
+    // ------------------------------------------------------------
+    uint64_t current = head.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        uint64_t start = current;
+
+        // Does not fit before the end of the buffer: skip to the start
+        const uint64_t offset = current % totalMemorySize;
+        if (offset + size > totalMemorySize)
+            start += totalMemorySize - offset;
+
+        const uint64_t end = start + size;
+
+        // Would overwrite memory still in use by the GPU
+        if (end - tail.load(std::memory_order_acquire) > totalMemorySize)
+            return NO_SPACE;
+
+        if (head.compare_exchange_weak(current, end, std::memory_order_acq_rel, std::memory_order_relaxed))
+        {
+            // Charge everything the head moved over to this frame
+            allocatedInFrame[currentFrame].fetch_add(size_t(end - current), std::memory_order_relaxed);
+            return start;
+        }
+
+        retryCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS RingBufferModule::allocBuffer(size_t size, void** cpuPtr, size_t alignment)
 {
     // ------------------------------------------------------------
     // Allocate a chunk of memory from the ring buffer.
     //
     // Conceptually:
-    // - This is a linear allocator with wrap-around.
-    // - head always points to the start of free memory.
-    // - tail marks the boundary of memory still in use by the GPU.
+    // - Small requests come from the calling thread's block: no atomics
+    //   at all, just a cursor increment.
+    // - When the block is used up (or belongs to an older frame) a new
+    //   one is reserved from the shared head.
+    // - Big requests are reserved from the head directly, so they do not
+    //   waste most of a block.
     // ------------------------------------------------------------
 
     // ------------------------------------------------------------
-    // 1. Align requested size to 256 bytes.
+    // 1. Alignment of this request.
     //
-    // D3D12 requires constant buffers to be aligned to
-    // D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT.
+    // Only constant buffers need
+    // D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT (256 bytes).
+    // Structured and vertex data are fine with much less, so the
+    // size itself is not rounded: the next request just starts at
+    // its own alignment. Reservations from the head (blocks, big
+    // requests) stay 256-byte aligned, so any alignment up to 256
+    // holds inside them.
     // ------------------------------------------------------------
-    size = alignUp(size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+    _ASSERTE(alignment > 0 && alignment <= CONSTANT_ALIGNMENT && (alignment & (alignment - 1)) == 0);
 
-    size_t freeSpace = 0;
+    if (size == 0)
+        size = alignment;
 
-    if (head >= tail)
+    histogram[sizeClass(size)].fetch_add(1, std::memory_order_relaxed);
+    usedInFrame.fetch_add(size, std::memory_order_relaxed);
+    cbvPaddingInFrame.fetch_add(alignUp(size, CONSTANT_ALIGNMENT) - size, std::memory_order_relaxed);
+
+    // ------------------------------------------------------------
+    // 2. Find the position (virtual) of the allocation.
+    // ------------------------------------------------------------
+    uint64_t start = NO_SPACE;
+
+    if (size <= MAX_SUBALLOC_SIZE)
     {
-        // --------------------------------------------------------
-        // Case A:
-        // Free space is from head to the end of the buffer.
-        //
-        // [tail .... head ........ end]
-        // --------------------------------------------------------
-        freeSpace = totalMemorySize - head;
+        ThreadBlock& block = tlsBlock;
+        const uint64_t epoch = frameEpoch.load(std::memory_order_acquire);
 
-        if (size > freeSpace)
+        if (block.owner != this || block.epoch != epoch || alignUp(block.cursor, alignment) + size > block.end)
         {
-            // ----------------------------------------------------
-            // Not enough space at the end.
-            // Try to wrap around to the beginning of the buffer.
-            // ----------------------------------------------------
-            if (size > tail)
+            const uint64_t blockStart = reserve(BLOCK_SIZE);
+            if (blockStart != NO_SPACE)
+            {
+                block.owner = this;
+                block.epoch = epoch;
+                block.cursor = blockStart;
+                block.end = blockStart + BLOCK_SIZE;
+                blockCount.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
             {
-                // ------------------------------------------------
-                // Not enough space even after wrapping.
-                // Ring buffer is out of memory.
-                // ------------------------------------------------
-                Logger::Err("RingBuffer->NO MEMORY LEFT: needs " + std::to_string(size / 1024) +
-                    "KB but only " + std::to_string(tail / 1024) + "KB total left");
-
-                return 0;
+                // Not room for a whole block: try the exact size
+                block.owner = nullptr;
             }
-            // ----------------------------------------------------
-            // Discard remaining space and wrap head to start.
-            // ----------------------------------------------------
-            head = 0;
+        }
+
+        if (block.owner == this)
+        {
+            start = alignUp(block.cursor, alignment);
+            paddingInFrame.fetch_add(size_t(start - block.cursor), std::memory_order_relaxed);
+            block.cursor = start + size;
+            subAllocCount.fetch_add(1, std::memory_order_relaxed);
         }
     }
-    else
+
+    if (start == NO_SPACE)
     {
-        // --------------------------------------------------------
-       // Case B:
-       // Free space is between head and tail.
-       //
-       // [head .... free .... tail]
-       // --------------------------------------------------------
-        freeSpace = tail - head;
+        const size_t reserveSize = alignUp(size, CONSTANT_ALIGNMENT);
 
-        if (size > freeSpace)
+        start = reserve(reserveSize);
+        if (start == NO_SPACE)
         {
-            // ----------------------------------------------------
-            // Not enough contiguous space.
-            // Allocation fails.
-            // ----------------------------------------------------
-            Logger::Err("RingBuffer->MEMORY SPLIT: needs " + std::to_string(size / 1024) +
-                "KB together but only " + std::to_string(freeSpace / 1024) + "KB in one piece");
-
-            return 0;
+            // ------------------------------------------------
+            // Ring buffer is full: serve from an overflow page.
+            // ------------------------------------------------
+            return allocOverflow(size, alignment, cpuPtr);
         }
+        paddingInFrame.fetch_add(reserveSize - size, std::memory_order_relaxed);
+        directCount.fetch_add(1, std::memory_order_relaxed);
     }
 
     // ------------------------------------------------------------
-    // 3. Compute GPU virtual address for this allocation.
+    // 3. Compute GPU virtual address and CPU pointer.
     //
-    // This is what will be bound to the pipeline.
+    // The GPU address is what will be bound to the pipeline,
+    // the caller writes constant buffer data through the CPU one.
     // ------------------------------------------------------------
-    D3D12_GPU_VIRTUAL_ADDRESS gpuAddress = buffer->GetGPUVirtualAddress() + head;
+    const size_t offset = size_t(start % totalMemorySize);
 
-    // ------------------------------------------------------------
-     // 4. Return CPU pointer to the allocated memory.
-     //
-     // The caller will write constant buffer data here.
-     // ------------------------------------------------------------
     if (cpuPtr)
     {
-        *cpuPtr = bufferData + head;
+        *cpuPtr = bufferData + offset;
     }
 
+    return bufferGPU + offset;
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS RingBufferModule::allocPacked(size_t elementSize, size_t stride, size_t count, void** cpuPtr)
+{
     // ------------------------------------------------------------
-   // 5. Advance the head by the allocated size.
-   //
-   // Modulo makes the buffer circular.
-   // ------------------------------------------------------------
-    head += size;
-    head %= totalMemorySize;
+    // One reservation for 'count' constant buffers laid out every
+    // 'stride' bytes: a single trip through the allocator instead
+    // of one per element. The tail of every element up to the 256
+    // byte boundary is padding, not data.
+    // ------------------------------------------------------------
+    const D3D12_GPU_VIRTUAL_ADDRESS gpu = allocBuffer(stride * count, cpuPtr, CONSTANT_ALIGNMENT);
+
+    const size_t padding = (stride - elementSize) * count;
+    usedInFrame.fetch_sub(padding, std::memory_order_relaxed);
+    paddingInFrame.fetch_add(padding, std::memory_order_relaxed);
+    cbvPaddingInFrame.fetch_add(padding, std::memory_order_relaxed);
+
+    return gpu;
+}
 
+D3D12_GPU_VIRTUAL_ADDRESS RingBufferModule::allocOverflow(size_t size, size_t alignment, void** cpuPtr)
+{
+    // ------------------------------------------------------------
+    // Only frames the ring cannot hold get here, so a mutex is fine.
+    // Pages are linear: allocations just bump 'used' and the whole
+    // page is recycled once the frame is done on the GPU.
     // ------------------------------------------------------------
-   // 6. Track how much memory this frame has used.
-   //
-   // This is critical for safe reclamation in preRender().
-   // ------------------------------------------------------------
-    allocatedInFrame[currentFrame] += size;
-    totalAllocated += size;
+    std::lock_guard<std::mutex> lock(overflowMutex);
+
+    if (overflowCount.fetch_add(1, std::memory_order_relaxed) == 0)
+    {
+        Logger::Warn("RingBuffer: full (" + std::to_string(totalMemorySize / 1024) + "KB), using overflow pages this frame");
+    }
+
+    if (framePages.empty() || alignUp(framePages.back().used, alignment) + size > framePages.back().size)
+    {
+        UploadPage page;
+        const size_t pageSize = std::max(OVERFLOW_PAGE_SIZE, alignUp(size, CONSTANT_ALIGNMENT));
+
+        auto it = std::find_if(freePages.begin(), freePages.end(), [size](const UploadPage& p) { return p.size >= size; });
+        if (it != freePages.end())
+        {
+            page = std::move(*it);
+            freePages.erase(it);
+        }
+        else if (!createPage(pageSize, page, L"Ring Buffer Overflow Page"))
+        {
+            // ------------------------------------------------
+            // Out of memory: never hand out a null pointer. The
+            // draw reads stale data from the ring instead.
+            // ------------------------------------------------
+            failureCount.fetch_add(1, std::memory_order_relaxed);
+            usedInFrame.fetch_sub(size, std::memory_order_relaxed);
+            Logger::Err("RingBuffer->NO MEMORY LEFT: could not create a " + std::to_string(pageSize / 1024) + "KB overflow page");
+
+            if (tlsScratch.size() < size)
+                tlsScratch.resize(size);
+            if (cpuPtr)
+                *cpuPtr = tlsScratch.data();
+
+            return bufferGPU;
+        }
+
+        framePages.push_back(std::move(page));
+    }
+
+    UploadPage& page = framePages.back();
+    const size_t offset = alignUp(page.used, alignment);
+    overflowInFrame.fetch_add(offset + size - page.used, std::memory_order_relaxed);
+    paddingInFrame.fetch_add(offset - page.used, std::memory_order_relaxed);
+    page.used = offset + size;
+
+    if (cpuPtr)
+    {
+        *cpuPtr = page.cpu + offset;
+    }
+
+    return page.gpu + offset;
+}
+
+bool RingBufferModule::isScratch(const void* cpu)
+{
+    return cpu != nullptr && cpu == tlsScratch.data();
+}
+
+bool RingBufferModule::getCopySource(D3D12_GPU_VIRTUAL_ADDRESS address, ID3D12Resource** resource, UINT64* offset)
+{
+    if (address >= bufferGPU && address < bufferGPU + totalMemorySize)
+    {
+        *resource = buffer.Get();
+        *offset = address - bufferGPU;
+        return true;
+    }
+
+    // Overflow pages of this frame
+    std::lock_guard<std::mutex> lock(overflowMutex);
+    for (const UploadPage& page : framePages)
+    {
+        if (address >= page.gpu && address < page.gpu + page.size)
+        {
+            *resource = page.resource.Get();
+            *offset = address - page.gpu;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+ModuleAccess RingBufferModule::getAccess(ModulePhase phase) const
+{
+    using namespace ModuleResource;
+
+    // Only bookkeeping, so it can run on a worker once the frame index is known
+    if (phase == ModulePhase::PreRender)
+        return ModuleAccess::worker(Device, RingBuffer);
 
-    return gpuAddress;
+    return ModuleAccess::idle();
 }
@@ -1,6 +1,10 @@
 #pragma once
 #include "Module.h"
 
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 // ----------------------------------------------------------------------------
 // RingBufferModule
 // ----------------------------------------------------------------------------
@@ -34,6 +38,53 @@
 // - Bind the returned GPU virtual address to the pipeline.
 // - The CPU pointer returned allows writing the data directly.
 //
+// Typed helpers (prefer them over raw allocBuffer):
+// - allocConstants<T>()         CBV data, 256-byte aligned.
+// - allocStructured<T>(count)   root SRV / structured data, 16-byte aligned.
+// - allocVertices<T>(count)     returns a ready D3D12_VERTEX_BUFFER_VIEW.
+// - allocConstantBatch<T>(n)    n CBVs packed every 256 bytes in one
+//                               reservation (one trip per draw list
+//                               instead of one per draw).
+// Only constants pay the 256-byte rounding. getLastFrameStats() reports
+// the padding actually paid next to what rounding every request to 256
+// bytes (the old behaviour) would have cost.
+//
+// Multi-threaded allocation (lock-free):
+// - head and tail are "virtual" positions that only grow; the byte offset
+//   is position % totalMemorySize. The used size is simply head - tail.
+// - Every thread suballocates from its own BLOCK_SIZE block without any
+//   synchronization. Only reserving a new block touches the shared head
+//   (one compare-exchange), so threads recording in parallel do not
+//   contend per draw. Requests bigger than MAX_SUBALLOC_SIZE reserve
+//   straight from the head.
+// - A reservation that does not fit before the end of the buffer skips to
+//   the start. The skipped bytes are charged to the frame, so reclaiming
+//   allocatedInFrame in preRender() still moves the tail exactly to where
+//   the next frame began.
+// - Blocks belong to one frame: preRender() bumps frameEpoch and what is
+//   left in every thread block becomes waste (see getLastFrameStats()).
+// - Any thread may allocate while the frame is recorded. preRender() must
+//   not overlap allocations (the scheduler runs it before recording).
+//
+// Overflow (spike frames):
+// - When the ring is full, allocations fall back to extra upload pages
+//   (OVERFLOW_PAGE_SIZE, or bigger for a bigger request). This path takes
+//   a mutex, but it only runs in frames the ring could not hold.
+// - Pages used by a frame are tagged with that frame's fence in the next
+//   preRender() and go back to a small free list once the GPU passes it.
+// - allocBuffer() never returns a null CPU pointer: if even a page cannot
+//   be created the write lands in a scratch buffer (the draw reads stale
+//   data) and the failure is counted. Callers that would rather skip the
+//   draw check isScratch() on the returned pointer.
+//
+// Adaptive size:
+// - The bytes reserved per frame are kept for the last HISTORY_FRAMES
+//   frames. A frame that overflowed grows the ring to hold the peak for
+//   every frame in flight (plus headroom); a ring much larger than the
+//   peak of a whole window shrinks back (never below MIN_RING_SIZE).
+// - Resizing retires the old buffer like an overflow page, so frames
+//   still in flight keep reading valid memory.
+//
 // This class is infrastructure-only:
 // - It does NOT know what data is stored (PerFrame, PerInstance, etc.).
 // - It only manages when and where memory is allocated and reclaimed.
@@ -41,16 +92,120 @@
 
 class RingBufferModule : public Module
 {
+public:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;             // per-thread reservation
+    static constexpr size_t MAX_SUBALLOC_SIZE = BLOCK_SIZE / 4; // bigger: straight from the head
+    static constexpr size_t OVERFLOW_PAGE_SIZE = 4 * 1024 * 1024;
+    static constexpr size_t MIN_RING_SIZE = 4 * 1024 * 1024;
+    static constexpr size_t MAX_FREE_PAGES = 2;                 // retired pages kept for reuse
+    static constexpr uint32_t HISTORY_FRAMES = 120;             // window of the high-water mark
+    static constexpr uint32_t SIZE_CLASSES = 13;                // 256B, 512B, ... 1MB and bigger
+
+    static constexpr size_t CONSTANT_ALIGNMENT = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+    static constexpr size_t STRUCTURED_ALIGNMENT = 16;
+    static constexpr size_t VERTEX_ALIGNMENT = 4;
+
+    // Constant buffers reserved together (allocConstantBatch)
+    template<typename T>
+    struct ConstantBatch
+    {
+        char*                     cpu = nullptr;
+        D3D12_GPU_VIRTUAL_ADDRESS gpu = 0;
+        size_t                    stride = 0;
+        size_t                    count = 0;
+
+        T* operator[](size_t i) const { return reinterpret_cast<T*>(cpu + i * stride); }
+        D3D12_GPU_VIRTUAL_ADDRESS address(size_t i) const { return gpu + i * stride; }
+    };
+
+    struct Stats
+    {
+        uint32_t blocks = 0;            // per-thread blocks reserved
+        uint32_t directAllocations = 0; // big requests reserved from the head
+        uint32_t subAllocations = 0;    // served from a thread block
+        uint32_t casRetries = 0;        // lost races on the shared head (contention)
+        uint32_t overflowAllocations = 0;   // served from an overflow page
+        uint32_t failures = 0;          // not even a page: wrote to scratch memory
+        size_t   reserved = 0;          // bytes the frame took from the ring
+        size_t   used = 0;              // bytes handed out
+        size_t   wasted = 0;            // reserved - used (block leftovers, wrap skips)
+        size_t   overflow = 0;          // bytes served from overflow pages
+        size_t   padding = 0;           // alignment padding actually paid
+        size_t   cbvPadding = 0;        // padding if every request were rounded to 256 bytes
+        size_t   highWater = 0;         // peak reserved + overflow over the history window
+        uint32_t pages = 0;             // overflow pages alive (in use, in flight or free)
+        uint32_t resizes = 0;           // ring resizes so far
+        uint32_t histogram[SIZE_CLASSES] = {};  // allocations per size class
+    };
+
 private:
     char* bufferData = nullptr;
     ComPtr<ID3D12Resource> buffer;
+    D3D12_GPU_VIRTUAL_ADDRESS bufferGPU = 0;
     size_t                 totalMemorySize = 0;
-    size_t                 head = 0;
-    size_t                 tail = 0;
-    size_t                 allocatedInFrame[FRAMES_IN_FLIGHT];
-    size_t                 totalAllocated = 0;
+
+    // Virtual positions (offset = position % totalMemorySize)
+    std::atomic<uint64_t>  head{ 0 };
+    std::atomic<uint64_t>  tail{ 0 };
+    std::atomic<size_t>    allocatedInFrame[FRAMES_IN_FLIGHT] = {};
+    std::atomic<uint64_t>  frameEpoch{ 0 };     // thread blocks from older epochs are stale
     unsigned               currentFrame = 0;
 
+    // Counters of the frame being recorded
+    std::atomic<uint32_t>  blockCount{ 0 };
+    std::atomic<uint32_t>  directCount{ 0 };
+    std::atomic<uint32_t>  subAllocCount{ 0 };
+    std::atomic<uint32_t>  retryCount{ 0 };
+    std::atomic<uint32_t>  failureCount{ 0 };
+    std::atomic<size_t>    usedInFrame{ 0 };
+    std::atomic<size_t>    paddingInFrame{ 0 };
+    std::atomic<size_t>    cbvPaddingInFrame{ 0 };
+    Stats                  lastFrameStats;
+
+    std::atomic<uint32_t>  histogram[SIZE_CLASSES] = {};
+    uint32_t               resizeCount = 0;
+
+    // Overflow pages (also used to retire an old ring after a resize)
+    struct UploadPage
+    {
+        ComPtr<ID3D12Resource>    resource;
+        char*                     cpu = nullptr;
+        D3D12_GPU_VIRTUAL_ADDRESS gpu = 0;
+        size_t                    size = 0;
+        size_t                    used = 0;
+        uint64_t                  fenceValue = 0;   // reusable once the GPU passes it
+    };
+
+    std::mutex               overflowMutex;
+    std::vector<UploadPage>  framePages;        // written by the frame being recorded
+    std::vector<UploadPage>  pendingPages;      // waiting for their fence
+    std::vector<UploadPage>  freePages;
+    std::atomic<size_t>      overflowInFrame{ 0 };
+    std::atomic<uint32_t>    overflowCount{ 0 };
+
+    // Per-frame reserved bytes (ring + overflow), circular
+    size_t                 history[HISTORY_FRAMES] = {};
+    uint32_t               historyIndex = 0;
+    uint32_t               historyCount = 0;
+
+    static constexpr uint64_t NO_SPACE = ~0ull;
+
+    bool createRing(size_t size);
+    bool createPage(size_t size, UploadPage& page, const wchar_t* name);
+
+    // Reserves 'size' contiguous bytes from the shared head (lock-free)
+    uint64_t reserve(size_t size);
+
+    // Fallback when the ring is full (locks overflowMutex)
+    D3D12_GPU_VIRTUAL_ADDRESS allocOverflow(size_t size, size_t alignment, void** cpuPtr);
+
+    // 'count' elements every 'stride' bytes, one reservation
+    D3D12_GPU_VIRTUAL_ADDRESS allocPacked(size_t elementSize, size_t stride, size_t count, void** cpuPtr);
+
+    // preRender() helpers
+    void retirePages(uint64_t frameFence, uint64_t completedFence);
+    void adaptSize(size_t frameBytes, bool overflowed, uint64_t frameFence);
+
 public:
 	RingBufferModule();
 	~RingBufferModule();
@@ -58,13 +213,56 @@ public:
 	bool init() override;
 	void preRender() override;
 
-	D3D12_GPU_VIRTUAL_ADDRESS allocBuffer(size_t size, void** cpuPtr);
+	const char* getName() const override { return "RingBuffer"; }
+	ModuleAccess getAccess(ModulePhase phase) const override;
+
+	// Thread safe. Always returns usable memory (see "Overflow" above)
+	D3D12_GPU_VIRTUAL_ADDRESS allocBuffer(size_t size, void** cpuPtr, size_t alignment = CONSTANT_ALIGNMENT);
+
+    template<typename T>
+    D3D12_GPU_VIRTUAL_ADDRESS allocConstants(T** cpuPtr)
+    {
+        return allocBuffer(sizeof(T), reinterpret_cast<void**>(cpuPtr), CONSTANT_ALIGNMENT);
+    }
+
+    template<typename T>
+    D3D12_GPU_VIRTUAL_ADDRESS allocStructured(size_t count, T** cpuPtr)
+    {
+        return allocBuffer(sizeof(T) * count, reinterpret_cast<void**>(cpuPtr), STRUCTURED_ALIGNMENT);
+    }
+
+    template<typename T>
+    D3D12_VERTEX_BUFFER_VIEW allocVertices(size_t count, T** cpuPtr)
+    {
+        D3D12_VERTEX_BUFFER_VIEW view = {};
+        view.BufferLocation = allocBuffer(sizeof(T) * count, reinterpret_cast<void**>(cpuPtr), VERTEX_ALIGNMENT);
+        view.SizeInBytes = UINT(sizeof(T) * count);
+        view.StrideInBytes = UINT(sizeof(T));
+        return view;
+    }
+
+    template<typename T>
+    ConstantBatch<T> allocConstantBatch(size_t count)
+    {
+        ConstantBatch<T> batch;
+        batch.stride = alignUp(sizeof(T), CONSTANT_ALIGNMENT);
+        batch.count = count;
+        batch.gpu = allocPacked(sizeof(T), batch.stride, count, reinterpret_cast<void**>(&batch.cpu));
+        return batch;
+    }
+
+    // Resource and offset behind an address handed out this frame, for CopyBufferRegion
+    // sources (staging for DEFAULT heap buffers). False if it is not ring memory.
+    bool getCopySource(D3D12_GPU_VIRTUAL_ADDRESS address, ID3D12Resource** resource, UINT64* offset);
+
+    // True when 'cpu' is the scratch memory of a failed allocation on this thread
+    static bool isScratch(const void* cpu);
 
     size_t getTotalSize() const { return totalMemorySize; }
-    size_t getHead() const { return head; }
-    size_t getTail() const { return tail; }
-    size_t getTotalAllocated() const { return totalAllocated; }
-    size_t getAllocatedInFrame() const { return allocatedInFrame[currentFrame]; }
+    size_t getHead() const { return size_t(head.load(std::memory_order_relaxed) % totalMemorySize); }
+    size_t getTail() const { return size_t(tail.load(std::memory_order_relaxed) % totalMemorySize); }
+    size_t getTotalAllocated() const { return size_t(head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed)); }
+    size_t getAllocatedInFrame() const { return allocatedInFrame[currentFrame].load(std::memory_order_relaxed); }
     unsigned getCurrentFrame() const { return currentFrame; }
+    const Stats& getLastFrameStats() const { return lastFrameStats; }
 };
-
@@ -16,19 +16,143 @@ bool SamplersModule::init()
     if (FAILED(hr)) return false;
 
     descriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
-    nextFreeSlot = 0;
+
+    // ------------------------------------------------------------
+    // Fixed slots, in the order of the DEFAULT_* constants
+    // ------------------------------------------------------------
+    createSampler(makeDesc(D3D12_FILTER_MIN_MAG_MIP_LINEAR, D3D12_TEXTURE_ADDRESS_MODE_WRAP));
+    createSampler(makeDesc(D3D12_FILTER_MIN_MAG_MIP_LINEAR, D3D12_TEXTURE_ADDRESS_MODE_CLAMP));
+    createSampler(makeDesc(D3D12_FILTER_MIN_MAG_MIP_POINT, D3D12_TEXTURE_ADDRESS_MODE_WRAP));
+    createSampler(makeDesc(D3D12_FILTER_MIN_MAG_MIP_POINT, D3D12_TEXTURE_ADDRESS_MODE_CLAMP));
+
+    _ASSERTE(descs.size() == DEFAULT_POINT_CLAMP + 1);
     return true;
 }
 
+D3D12_SAMPLER_DESC SamplersModule::makeDesc(D3D12_FILTER filter, D3D12_TEXTURE_ADDRESS_MODE address, UINT maxAnisotropy)
+{
+    D3D12_SAMPLER_DESC desc = {};
+    desc.Filter = filter;
+    desc.AddressU = desc.AddressV = desc.AddressW = address;
+    desc.MipLODBias = 0.0f;
+    desc.MaxAnisotropy = maxAnisotropy;
+    desc.ComparisonFunc = D3D12_COMPARISON_FUNC_NEVER;
+    desc.MinLOD = 0.0f;
+    desc.MaxLOD = D3D12_FLOAT32_MAX;
+    return desc;
+}
+
+D3D12_SAMPLER_DESC SamplersModule::normalise(const D3D12_SAMPLER_DESC& desc)
+{
+    D3D12_SAMPLER_DESC out = desc;
+
+    // ------------------------------------------------------------
+    // Zero what the filter / address modes never read, so equal
+    // samplers compare equal byte for byte
+    // ------------------------------------------------------------
+    if (!D3D12_DECODE_IS_ANISOTROPIC_FILTER(out.Filter))
+        out.MaxAnisotropy = 1;
+
+    if (D3D12_DECODE_FILTER_REDUCTION(out.Filter) != D3D12_FILTER_REDUCTION_TYPE_COMPARISON)
+        out.ComparisonFunc = D3D12_COMPARISON_FUNC_NEVER;
+
+    const bool border = out.AddressU == D3D12_TEXTURE_ADDRESS_MODE_BORDER ||
+        out.AddressV == D3D12_TEXTURE_ADDRESS_MODE_BORDER || out.AddressW == D3D12_TEXTURE_ADDRESS_MODE_BORDER;
+    if (!border)
+        out.BorderColor[0] = out.BorderColor[1] = out.BorderColor[2] = out.BorderColor[3] = 0.0f;
+
+    // -0.0f and 0.0f are the same sampler
+    auto fixZero = [](float& f) { if (f == 0.0f) f = 0.0f; };
+    fixZero(out.MipLODBias);
+    fixZero(out.MinLOD);
+    fixZero(out.MaxLOD);
+    for (float& c : out.BorderColor)
+        fixZero(c);
+
+    return out;
+}
+
+size_t SamplersModule::DescHash::operator()(const D3D12_SAMPLER_DESC& desc) const
+{
+    // FNV-1a over the (normalised, padding free) struct
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&desc);
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < sizeof(D3D12_SAMPLER_DESC); ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return size_t(hash);
+}
+
+bool SamplersModule::DescEqual::operator()(const D3D12_SAMPLER_DESC& a, const D3D12_SAMPLER_DESC& b) const
+{
+    return std::memcmp(&a, &b, sizeof(D3D12_SAMPLER_DESC)) == 0;
+}
+
 UINT SamplersModule::createSampler(const D3D12_SAMPLER_DESC& desc)
 {
-    if (nextFreeSlot >= MAX_SAMPLERS) return UINT_MAX;
+    const D3D12_SAMPLER_DESC key = normalise(desc);
 
-    ID3D12Device* device = app->getD3D12()->getDevice();
-    D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = getCPUHandle(nextFreeSlot);
+    std::lock_guard<std::mutex> lock(mutex);
+    ++stats.requests;
+
+    auto it = cache.find(key);
+    if (it != cache.end())
+    {
+        ++stats.hits;
+        return it->second;
+    }
+
+    if (descs.size() >= MAX_SAMPLERS)
+    {
+        if (stats.failures++ == 0)
+            Logger::Err("Samplers: heap full (" + std::to_string(MAX_SAMPLERS) + " unique samplers), using linear/wrap");
+        return DEFAULT_LINEAR_WRAP;
+    }
+
+    const UINT index = UINT(descs.size());
+    app->getD3D12()->getDevice()->CreateSampler(&key, getCPUHandle(index));
+
+    descs.push_back(key);
+    cache.emplace(key, index);
+    stats.samplers = UINT(descs.size());
+
+    return index;
+}
+
+D3D12_STATIC_SAMPLER_DESC SamplersModule::getStaticSampler(UINT index, UINT shaderRegister, UINT registerSpace, D3D12_SHADER_VISIBILITY visibility) const
+{
+    D3D12_SAMPLER_DESC desc;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        desc = descs[index < descs.size() ? index : DEFAULT_LINEAR_WRAP];
+    }
+
+    D3D12_STATIC_SAMPLER_DESC out = {};
+    out.Filter = desc.Filter;
+    out.AddressU = desc.AddressU;
+    out.AddressV = desc.AddressV;
+    out.AddressW = desc.AddressW;
+    out.MipLODBias = desc.MipLODBias;
+    out.MaxAnisotropy = desc.MaxAnisotropy;
+    out.ComparisonFunc = desc.ComparisonFunc;
+    out.MinLOD = desc.MinLOD;
+    out.MaxLOD = desc.MaxLOD;
+    out.ShaderRegister = shaderRegister;
+    out.RegisterSpace = registerSpace;
+    out.ShaderVisibility = visibility;
 
-    device->CreateSampler(&desc, cpuHandle);
-    return nextFreeSlot++;
+    // Closest of the three static border colours
+    const float* c = desc.BorderColor;
+    if (c[3] < 0.5f)
+        out.BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
+    else if (c[0] + c[1] + c[2] < 1.5f)
+        out.BorderColor = D3D12_STATIC_BORDER_COLOR_OPAQUE_BLACK;
+    else
+        out.BorderColor = D3D12_STATIC_BORDER_COLOR_OPAQUE_WHITE;
+
+    return out;
 }
 
 D3D12_CPU_DESCRIPTOR_HANDLE SamplersModule::getCPUHandle(UINT index) const
@@ -44,3 +168,9 @@ D3D12_GPU_DESCRIPTOR_HANDLE SamplersModule::getGPUHandle(UINT index) const
     handle.ptr += index * descriptorSize;
     return handle;
 }
+
+SamplersModule::Stats SamplersModule::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
@@ -1,13 +1,62 @@
 #pragma once
 #include "Module.h"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Shader-visible sampler heap with a cache in front of it:
+// - createSampler() hashes the whole D3D12_SAMPLER_DESC and returns the slot
+//   of an identical sampler when there is one. Fields the filter ignores
+//   (anisotropy, comparison, border colour) are normalised first, so
+//   samplers that only differ there share a slot too.
+// - The DEFAULT_* samplers exist from init(): slot 0 is linear/wrap no matter
+//   which exercise asks for samplers first.
+// - Equal slot means equal sampler, so draws can be batched by sampler.
+// - getStaticSampler() turns a cached sampler into a D3D12_STATIC_SAMPLER_DESC
+//   for root signatures that embed it instead of using the heap.
+// ----------------------------------------------------------------------------
+
 class SamplersModule : public Module
 {
+public:
+    static const UINT MAX_SAMPLERS = 64;
+
+    // Created in init(), always in these slots
+    static const UINT DEFAULT_LINEAR_WRAP = 0;
+    static const UINT DEFAULT_LINEAR_CLAMP = 1;
+    static const UINT DEFAULT_POINT_WRAP = 2;
+    static const UINT DEFAULT_POINT_CLAMP = 3;
+
+    struct Stats
+    {
+        uint32_t samplers = 0;      // slots in use
+        uint32_t requests = 0;      // createSampler() calls
+        uint32_t hits = 0;          // answered with an existing slot
+        uint32_t failures = 0;      // heap full, got DEFAULT_LINEAR_WRAP
+    };
+
 private:
+    struct DescHash
+    {
+        size_t operator()(const D3D12_SAMPLER_DESC& desc) const;
+    };
+
+    struct DescEqual
+    {
+        bool operator()(const D3D12_SAMPLER_DESC& a, const D3D12_SAMPLER_DESC& b) const;
+    };
+
     ComPtr<ID3D12DescriptorHeap> samplerHeap;
     UINT descriptorSize = 0;
-    UINT nextFreeSlot = 0;
-    static const UINT MAX_SAMPLERS = 64;
 
+    mutable std::mutex mutex;
+    std::vector<D3D12_SAMPLER_DESC> descs;      // per slot
+    std::unordered_map<D3D12_SAMPLER_DESC, UINT, DescHash, DescEqual> cache;
+    Stats stats;
+
+    static D3D12_SAMPLER_DESC normalise(const D3D12_SAMPLER_DESC& desc);
 
 public:
     SamplersModule() {}
@@ -15,12 +64,23 @@ public:
 
     bool init() override;
 
+    const char* getName() const override { return "Samplers"; }
+    ModuleAccess getAccess(ModulePhase) const override { return ModuleAccess::idle(); }
+
+    // Thread safe. Existing slot for an equal sampler, a new one otherwise
     UINT createSampler(const D3D12_SAMPLER_DESC& desc);
 
+    static D3D12_SAMPLER_DESC makeDesc(D3D12_FILTER filter, D3D12_TEXTURE_ADDRESS_MODE address, UINT maxAnisotropy = 1);
+
+    // The sampler in 'index' as a root signature static sampler (border colours
+    // are limited to the three static ones)
+    D3D12_STATIC_SAMPLER_DESC getStaticSampler(UINT index, UINT shaderRegister, UINT registerSpace = 0,
+        D3D12_SHADER_VISIBILITY visibility = D3D12_SHADER_VISIBILITY_PIXEL) const;
+
     D3D12_CPU_DESCRIPTOR_HANDLE getCPUHandle(UINT index) const;
     D3D12_GPU_DESCRIPTOR_HANDLE getGPUHandle(UINT index) const;
 
     ID3D12DescriptorHeap* getHeap() const { return samplerHeap.Get(); }
     UINT getDescriptorSize() const { return descriptorSize; }
+    Stats getStats() const;
 };
-
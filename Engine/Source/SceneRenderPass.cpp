@@ -7,14 +7,26 @@
 
 void SceneRenderPass::begin(ID3D12GraphicsCommandList* cmd, const float clearColor[4]) const
 {
+    // The frame render graph (EditorModule) already moved the target to RENDER_TARGET
+    if (usingViewport && viewport)
+        viewport->hideSplash();
+
     // ------------------------------------------------------------
-    // Resource state (Viewport only)
+    // Viewport, scissor and targets
     // ------------------------------------------------------------
-    // If rendering to the editor viewport texture, transition it from SRV
-    // (ImGui sampling) to RTV (scene rendering).
-    if (usingViewport && viewport)
-        viewport->transitionToRenderTarget(cmd);
+    bind(cmd);
 
+    // ------------------------------------------------------------
+    // Output merger: clear
+    // ------------------------------------------------------------
+    if(clearColor)
+        cmd->ClearRenderTargetView(rtv, clearColor, 0, nullptr); // Clear color buffer
+    cmd->ClearDepthStencilView(dsv, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr); // Clear depth (and stencil if used)
+
+}
+
+void SceneRenderPass::bind(ID3D12GraphicsCommandList* cmd) const
+{
     // ------------------------------------------------------------
     // Raster state: viewport & scissor
     // ------------------------------------------------------------
@@ -25,23 +37,15 @@ void SceneRenderPass::begin(ID3D12GraphicsCommandList* cmd, const float clearCol
     cmd->RSSetScissorRects(1, &sc);
 
     // ------------------------------------------------------------
-    // Output merger: bind targets + clear
+    // Output merger: bind targets
     // ------------------------------------------------------------
     cmd->OMSetRenderTargets(1, &rtv, FALSE, &dsv);  // Bind color + depth targets
-    if(clearColor)
-        cmd->ClearRenderTargetView(rtv, clearColor, 0, nullptr); // Clear color buffer
-    cmd->ClearDepthStencilView(dsv, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr); // Clear depth (and stencil if used)
-
 }
 
 void SceneRenderPass::end(ID3D12GraphicsCommandList* cmd) const
 {
-    // ------------------------------------------------------------
-    // Resource state (Viewport only)
-    // ------------------------------------------------------------
-    // Restore the viewport texture to SRV so ImGui can sample it in ImGui::Image
-    if (usingViewport && viewport)
-        viewport->transitionToShaderResource(cmd);
+    // Nothing to restore: the frame render graph transitions the viewport
+    // texture back to SRV before the ImGui pass samples it
 }
 
 SceneRenderPass GetSceneRenderPass(Application* app)
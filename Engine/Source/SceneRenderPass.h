@@ -21,17 +21,18 @@
 //
 // Responsibilities:
 // - begin(): prepares the render target for scene rendering.
-//     * (Viewport path) transitions the viewport texture to RENDER_TARGET state.
 //     * sets D3D12 viewport and scissor to match the chosen target.
 //     * binds RTV/DSV and clears color + depth.
-// - end(): restores the target state after scene rendering.
-//     * (Viewport path) transitions the viewport texture back to SRV so ImGui
-//       can sample it (ImGui::Image).
+// - bind(): sets viewport/scissor and RTV/DSV only, without transitions or
+//   clears (for extra command lists recorded in parallel, or after one).
+// - end(): closes the pass (kept for symmetry, records nothing).
 //
 // Notes:
 // - SceneRenderPass does NOT own the resources. It only references them.
-// - The viewport transitions are delegated to ViewportModule, since it owns
-//   the offscreen texture and knows the intended final state (SRV).
+// - Resource states are not handled here: the frame RenderGraph built by
+//   EditorModule::render() declares the scene target as written, so the
+//   target is in RENDER_TARGET inside the pass and the viewport texture
+//   goes back to SRV before ImGui samples it.
 // ============================================================================
 
 class Application;
@@ -52,10 +53,11 @@ struct SceneRenderPass
     uint32_t height = 0;
     float aspect = 1.0f;
 
-    // Owner used for resource state transitions (viewport texture).
+    // Owner of the viewport texture (offscreen path only).
     ViewportModule* viewport = nullptr;
 
     void begin(ID3D12GraphicsCommandList* cmd, const float clearColor[4]) const;
+    void bind(ID3D12GraphicsCommandList* cmd) const;
     void end(ID3D12GraphicsCommandList* cmd) const;
 };
 
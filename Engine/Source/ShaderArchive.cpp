@@ -0,0 +1,288 @@
+#include "Globals.h"
+#include "ShaderArchive.h"
+
+#include "ReadData.h"
+
+#include <algorithm>
+#include <cwchar>
+
+namespace
+{
+    std::string narrow(const std::wstring& text)
+    {
+        // Shader names are plain ASCII file names
+        return std::string(text.begin(), text.end());
+    }
+
+    HANDLE openNextToExe(const wchar_t* fileName)
+    {
+        wchar_t moduleName[_MAX_PATH] = {};
+        if (!GetModuleFileNameW(nullptr, moduleName, _MAX_PATH))
+            return INVALID_HANDLE_VALUE;
+
+        wchar_t drive[_MAX_DRIVE];
+        wchar_t path[_MAX_PATH];
+        wchar_t fullName[_MAX_PATH];
+        if (_wsplitpath_s(moduleName, drive, _MAX_DRIVE, path, _MAX_PATH, nullptr, 0, nullptr, 0) ||
+            _wmakepath_s(fullName, _MAX_PATH, drive, path, fileName, nullptr))
+        {
+            return INVALID_HANDLE_VALUE;
+        }
+
+        return CreateFileW(fullName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    }
+}
+
+ShaderArchive::~ShaderArchive()
+{
+    close();
+}
+
+// ----------------------------------------------------------------------------
+// Names
+// ----------------------------------------------------------------------------
+
+std::wstring ShaderArchive::getFileName(const std::wstring& name, uint32_t permutation)
+{
+    if (permutation == NO_PERMUTATION)
+        return name + L".cso";
+
+    wchar_t suffix[16];
+    swprintf_s(suffix, L"_%02X.cso", permutation);
+    return name + suffix;
+}
+
+uint64_t ShaderArchive::hashName(const std::string& name)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : name)
+    {
+        hash ^= uint8_t(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// ----------------------------------------------------------------------------
+// Mapping
+// ----------------------------------------------------------------------------
+
+bool ShaderArchive::open(const wchar_t* fileName)
+{
+    close();
+
+    const std::string name = narrow(fileName);
+
+    file = CreateFileW(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        file = openNextToExe(fileName);
+
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        Logger::Warn("ShaderArchive: " + name + " not found, shaders are read from their .cso files");
+        return false;
+    }
+
+    LARGE_INTEGER size = {};
+    if (GetFileSizeEx(file, &size) && size.QuadPart >= LONGLONG(sizeof(Header)))
+    {
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping)
+            view = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+
+    if (!view)
+    {
+        Logger::Err("ShaderArchive: failed to map " + name);
+        close();
+        return false;
+    }
+
+    viewSize = uint64_t(size.QuadPart);
+    header = reinterpret_cast<const Header*>(view);
+
+    if (!validate())
+    {
+        Logger::Err("ShaderArchive: " + name + " is damaged or from another version, rebuild it");
+        close();
+        return false;
+    }
+
+    records = reinterpret_cast<const Record*>(view + header->recordsOffset);
+    bindings = reinterpret_cast<const Binding*>(view + header->bindingsOffset);
+    strings = reinterpret_cast<const char*>(view + header->stringsOffset);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.archived = header->shaderCount;
+        stats.mappedBytes = viewSize;
+    }
+
+    Logger::Log("ShaderArchive: " + name + " mapped, " + std::to_string(header->shaderCount) + " shaders (" +
+        std::to_string(viewSize) + " bytes)");
+    return true;
+}
+
+void ShaderArchive::close()
+{
+    if (view)
+        UnmapViewOfFile(view);
+    if (mapping)
+        CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+
+    file = INVALID_HANDLE_VALUE;
+    mapping = nullptr;
+    view = nullptr;
+    viewSize = 0;
+    header = nullptr;
+    records = nullptr;
+    bindings = nullptr;
+    strings = nullptr;
+}
+
+bool ShaderArchive::validate() const
+{
+    auto inside = [this](uint64_t offset, uint64_t bytes)
+        {
+            return offset <= viewSize && bytes <= viewSize - offset;
+        };
+
+    if (header->magic != MAGIC || header->version != VERSION || header->fileSize != viewSize)
+        return false;
+
+    if (!inside(header->recordsOffset, uint64_t(header->shaderCount) * sizeof(Record)) ||
+        !inside(header->bindingsOffset, uint64_t(header->bindingCount) * sizeof(Binding)) ||
+        !inside(header->stringsOffset, header->stringsSize) ||
+        (header->recordsOffset % alignof(Record)) != 0 || (header->bindingsOffset % alignof(Binding)) != 0)
+    {
+        return false;
+    }
+
+    // Strings end in '\0', so a bad offset can't read past them
+    if (header->stringsSize == 0 || view[header->stringsOffset + header->stringsSize - 1] != 0)
+        return false;
+
+    const Record* first = reinterpret_cast<const Record*>(view + header->recordsOffset);
+    const Binding* firstBinding = reinterpret_cast<const Binding*>(view + header->bindingsOffset);
+
+    for (uint32_t i = 0; i < header->shaderCount; ++i)
+    {
+        const Record& record = first[i];
+        if (!inside(record.bytecodeOffset, record.bytecodeSize) || record.nameOffset >= header->stringsSize ||
+            uint64_t(record.firstBinding) + record.bindingCount > header->bindingCount)
+        {
+            return false;
+        }
+
+        for (uint32_t b = 0; b < record.bindingCount; ++b)
+        {
+            if (firstBinding[record.firstBinding + b].nameOffset >= header->stringsSize)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool ShaderArchive::contains(const void* data) const
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    return view && p >= view && p < view + viewSize;
+}
+
+// ----------------------------------------------------------------------------
+// Lookup
+// ----------------------------------------------------------------------------
+
+const ShaderArchive::Record* ShaderArchive::findRecord(const std::string& name, uint32_t permutation) const
+{
+    if (!records)
+        return nullptr;
+
+    const uint64_t hash = hashName(name);
+    const Record* end = records + header->shaderCount;
+
+    const Record* it = std::lower_bound(records, end, std::make_pair(hash, permutation),
+        [](const Record& record, const std::pair<uint64_t, uint32_t>& key)
+        {
+            return record.nameHash < key.first || (record.nameHash == key.first && record.permutation < key.second);
+        });
+
+    // Equal hashes: the names decide
+    for (; it != end && it->nameHash == hash && it->permutation == permutation; ++it)
+    {
+        if (name == strings + it->nameOffset)
+            return it;
+    }
+
+    return nullptr;
+}
+
+D3D12_SHADER_BYTECODE ShaderArchive::get(const wchar_t* name, uint32_t permutation)
+{
+    if (const Record* record = findRecord(narrow(name), permutation))
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.mappedHits;
+        return { view + record->bytecodeOffset, SIZE_T(record->bytecodeSize) };
+    }
+
+    // ------------------------------------------------------------
+    // Not archived: the .cso, read once and kept (misses too)
+    // ------------------------------------------------------------
+    const std::wstring fileName = getFileName(name, permutation);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = looseFiles.find(fileName);
+    if (it == looseFiles.end())
+    {
+        std::vector<uint8_t> data;
+
+        // ReadData throws when the file is not there
+        try
+        {
+            data = DX::ReadData(fileName.c_str());
+        }
+        catch (const std::exception&)
+        {
+            data.clear();
+        }
+
+        if (data.empty())
+            ++stats.missing;
+        else
+            ++stats.looseFiles;
+
+        if (!data.empty() && view)
+            Logger::Warn("ShaderArchive: " + narrow(fileName) + " is not in the archive, read from disk");
+
+        it = looseFiles.emplace(fileName, std::move(data)).first;
+    }
+
+    if (it->second.empty())
+        return { nullptr, 0 };
+
+    return { it->second.data(), it->second.size() };
+}
+
+bool ShaderArchive::getReflection(const wchar_t* name, uint32_t permutation, Reflection& reflection) const
+{
+    const Record* record = findRecord(narrow(name), permutation);
+    if (!record)
+        return false;
+
+    reflection.bindings = bindings + record->firstBinding;
+    reflection.bindingCount = record->bindingCount;
+    reflection.shaderType = record->shaderType;
+    reflection.shaderModel = record->shaderModel;
+    return true;
+}
+
+ShaderArchive::Stats ShaderArchive::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================================
+// ShaderArchive
+// ----------------------------------------------------------------------------
+// Every compiled shader of the build in one file (ARCHIVE_FILE), written by
+// the packing step (ShaderArchivePacker, run after the build as
+// 'Engine.exe -packshaders <archive> <directory>').
+//
+// Runtime:
+// - open() memory-maps the archive: one file open at start-up instead of
+//   one per .cso. get() returns D3D12_SHADER_BYTECODE pointing into the
+//   mapping, handed to PSO creation as is (no copies). Pointers stay valid
+//   while the archive is open (the Application lifetime).
+// - Shaders are found by name and permutation key: '<name>.cso' is
+//   (name, NO_PERMUTATION), '<name>_<KK>.cso' is (name, 0xKK) (the naming
+//   of ShaderPermutations).
+// - A shader that is not in the archive (or no archive at all, e.g. a build
+//   that skipped the packing step) is read from its .cso and kept, so
+//   callers get the same kind of pointer either way.
+//
+// Layout (little endian, offsets from the start of the file):
+//   Header
+//   Record[shaderCount]        sorted by (nameHash, permutation)
+//   Binding[bindingCount]      reflection, a range per record
+//   strings                    '\0' terminated UTF-8 names
+//   bytecode                   each blob BYTECODE_ALIGNMENT aligned
+//
+// Reflection (D3DReflect at packing time) is stored per shader: every bound
+// resource with its type, register, space and count, and the size of each
+// constant buffer. That is what a root signature has to provide for the
+// shader, so layouts can be checked or built without the compiler.
+//
+// Thread safe.
+// ============================================================================
+
+class ShaderArchive
+{
+public:
+    static constexpr const wchar_t* ARCHIVE_FILE = L"shaders.pak";
+
+    static constexpr uint32_t MAGIC = 0x4B415053u;             // 'SPAK'
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t NO_PERMUTATION = 0xFFFFFFFFu;     // ShaderPermutations::UBER_KEY
+    static constexpr uint32_t BYTECODE_ALIGNMENT = 16;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t shaderCount;
+        uint32_t bindingCount;
+        uint64_t recordsOffset;
+        uint64_t bindingsOffset;
+        uint64_t stringsOffset;
+        uint64_t stringsSize;
+        uint64_t fileSize;
+    };
+
+    struct Record
+    {
+        uint64_t nameHash;          // hashName() of the name
+        uint32_t permutation;
+        uint32_t nameOffset;        // into the strings
+        uint64_t bytecodeOffset;
+        uint64_t bytecodeSize;
+        uint32_t firstBinding;
+        uint32_t bindingCount;
+        uint32_t shaderType;        // D3D12_SHADER_VERSION_TYPE
+        uint32_t shaderModel;       // major * 10 + minor
+    };
+
+    struct Binding
+    {
+        uint32_t nameOffset;        // into the strings
+        uint32_t type;              // D3D_SHADER_INPUT_TYPE
+        uint32_t bindPoint;         // register
+        uint32_t bindCount;         // 0: unbounded array
+        uint32_t space;
+        uint32_t size;              // constant buffers: bytes, others 0
+    };
+
+    struct Reflection
+    {
+        const Binding* bindings = nullptr;
+        uint32_t       bindingCount = 0;
+        uint32_t       shaderType = 0;
+        uint32_t       shaderModel = 0;
+    };
+
+    struct Stats
+    {
+        uint32_t archived = 0;      // shaders in the archive
+        uint32_t mappedHits = 0;    // get() answered from the mapping
+        uint32_t looseFiles = 0;    // read from a .cso instead
+        uint32_t missing = 0;       // neither
+        uint64_t mappedBytes = 0;
+    };
+
+    static_assert(sizeof(Header) == 48, "ShaderArchive::Header layout");
+    static_assert(sizeof(Record) == 48, "ShaderArchive::Record layout");
+    static_assert(sizeof(Binding) == 24, "ShaderArchive::Binding layout");
+
+private:
+    HANDLE         file = INVALID_HANDLE_VALUE;
+    HANDLE         mapping = nullptr;
+    const uint8_t* view = nullptr;
+    uint64_t       viewSize = 0;
+
+    const Header*  header = nullptr;
+    const Record*  records = nullptr;
+    const Binding* bindings = nullptr;
+    const char*    strings = nullptr;
+
+    // Shaders read from .cso files, by file name
+    mutable std::mutex mutex;
+    std::unordered_map<std::wstring, std::vector<uint8_t>> looseFiles;
+    Stats stats;
+
+    bool validate() const;
+    const Record* findRecord(const std::string& name, uint32_t permutation) const;
+
+public:
+    ShaderArchive() = default;
+    ~ShaderArchive();
+
+    ShaderArchive(const ShaderArchive&) = delete;
+    ShaderArchive& operator=(const ShaderArchive&) = delete;
+
+    // Looks next to the working directory first, then next to the exe
+    bool open(const wchar_t* fileName);
+    void close();
+    bool isOpen() const { return view != nullptr; }
+
+    // 'name' without extension. Empty bytecode when the shader exists nowhere.
+    D3D12_SHADER_BYTECODE get(const wchar_t* name, uint32_t permutation = NO_PERMUTATION);
+
+    // Archived shaders only
+    bool getReflection(const wchar_t* name, uint32_t permutation, Reflection& reflection) const;
+    const char* getString(uint32_t offset) const { return strings ? strings + offset : ""; }
+
+    // True when 'data' points into the mapping (lives as long as the archive)
+    bool contains(const void* data) const;
+
+    Stats getStats() const;
+
+    // '<name>.cso', or '<name>_<KK>.cso' for a permutation
+    static std::wstring getFileName(const std::wstring& name, uint32_t permutation);
+
+    // FNV-1a of the UTF-8 name
+    static uint64_t hashName(const std::string& name);
+};
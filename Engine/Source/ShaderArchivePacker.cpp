@@ -0,0 +1,339 @@
+#include "Globals.h"
+#include "ShaderArchivePacker.h"
+
+#include "ShaderArchive.h"
+
+#include <d3dcompiler.h>
+#include <d3d12shader.h>
+
+#include <algorithm>
+#include <cwchar>
+#include <cwctype>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <unordered_map>
+
+namespace
+{
+    struct PackedShader
+    {
+        std::string                          name;
+        uint32_t                             permutation = ShaderArchive::NO_PERMUTATION;
+        uint64_t                             nameHash = 0;
+        std::vector<uint8_t>                 bytecode;
+        std::vector<ShaderArchive::Binding>  bindings;
+        std::vector<std::string>             bindingNames;
+        uint32_t                             shaderType = 0;
+        uint32_t                             shaderModel = 0;
+    };
+
+    // Deduplicated '\0' terminated strings
+    class StringTable
+    {
+        std::vector<char> bytes;
+        std::unordered_map<std::string, uint32_t> offsets;
+
+    public:
+        uint32_t add(const std::string& text)
+        {
+            auto it = offsets.find(text);
+            if (it != offsets.end())
+                return it->second;
+
+            const uint32_t offset = uint32_t(bytes.size());
+            bytes.insert(bytes.end(), text.begin(), text.end());
+            bytes.push_back('\0');
+            offsets.emplace(text, offset);
+            return offset;
+        }
+
+        const std::vector<char>& getBytes() const { return bytes; }
+    };
+
+    uint64_t alignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    // Paths and shader names are plain ASCII here
+    std::string narrow(const std::wstring& text)
+    {
+        return std::string(text.begin(), text.end());
+    }
+
+    // ------------------------------------------------------------
+    // The engine is a GUI-subsystem executable: there is no console
+    // for printf. The Logger messages go to the standard output the
+    // build step inherited (when there is one) and next to the archive.
+    // ------------------------------------------------------------
+    void writeReport(const std::wstring& logPath)
+    {
+        std::vector<LogEntry> messages;
+        Logger::CopyMessages(messages);
+
+        std::string text;
+        for (const LogEntry& entry : messages)
+            text += entry.message + "\n";
+
+        HANDLE output = GetStdHandle(STD_OUTPUT_HANDLE);
+        if (output && output != INVALID_HANDLE_VALUE)
+        {
+            DWORD written = 0;
+            WriteFile(output, text.data(), DWORD(text.size()), &written, nullptr);
+        }
+
+        if (!logPath.empty())
+        {
+            std::ofstream log(logPath, std::ios::out | std::ios::trunc);
+            log << text;
+        }
+    }
+
+    bool isHex(wchar_t c)
+    {
+        return std::iswxdigit(c) != 0;
+    }
+
+    bool readFile(const std::filesystem::path& path, std::vector<uint8_t>& data)
+    {
+        std::ifstream in(path, std::ios::in | std::ios::binary | std::ios::ate);
+        if (!in)
+            return false;
+
+        data.resize(size_t(in.tellg()));
+        in.seekg(0, std::ios::beg);
+        in.read(reinterpret_cast<char*>(data.data()), std::streamsize(data.size()));
+        return bool(in);
+    }
+
+    // ------------------------------------------------------------
+    // Bound resources and constant buffer sizes
+    // ------------------------------------------------------------
+    bool reflect(PackedShader& shader)
+    {
+        ComPtr<ID3D12ShaderReflection> reflection;
+        if (FAILED(D3DReflect(shader.bytecode.data(), shader.bytecode.size(), IID_PPV_ARGS(&reflection))))
+            return false;
+
+        D3D12_SHADER_DESC desc = {};
+        if (FAILED(reflection->GetDesc(&desc)))
+            return false;
+
+        shader.shaderType = D3D12_SHVER_GET_TYPE(desc.Version);
+        shader.shaderModel = D3D12_SHVER_GET_MAJOR(desc.Version) * 10 + D3D12_SHVER_GET_MINOR(desc.Version);
+
+        for (UINT i = 0; i < desc.BoundResources; ++i)
+        {
+            D3D12_SHADER_INPUT_BIND_DESC bind = {};
+            if (FAILED(reflection->GetResourceBindingDesc(i, &bind)))
+                continue;
+
+            ShaderArchive::Binding binding = {};
+            binding.type = uint32_t(bind.Type);
+            binding.bindPoint = bind.BindPoint;
+            binding.bindCount = bind.BindCount;
+            binding.space = bind.Space;
+
+            if (bind.Type == D3D_SIT_CBUFFER)
+            {
+                D3D12_SHADER_BUFFER_DESC buffer = {};
+                ID3D12ShaderReflectionConstantBuffer* cbuffer = reflection->GetConstantBufferByName(bind.Name);
+                if (cbuffer && SUCCEEDED(cbuffer->GetDesc(&buffer)))
+                    binding.size = buffer.Size;
+            }
+
+            shader.bindings.push_back(binding);
+            shader.bindingNames.emplace_back(bind.Name ? bind.Name : "");
+        }
+
+        return true;
+    }
+}
+
+bool ShaderArchivePacker::runFromCommandLine(int argc, wchar_t** argv, int& exitCode)
+{
+    if (argc < 2 || std::wcscmp(argv[1], L"-packshaders") != 0)
+        return false;
+
+    if (argc != 4)
+    {
+        Logger::Err("usage: Engine.exe -packshaders <archive> <directory>");
+        writeReport(std::wstring());
+        exitCode = 2;
+        return true;
+    }
+
+    exitCode = pack(argv[2], argv[3]) ? 0 : 1;
+    writeReport(std::wstring(argv[2]) + L".log");
+    return true;
+}
+
+bool ShaderArchivePacker::pack(const wchar_t* archivePath, const wchar_t* directory)
+{
+    namespace fs = std::filesystem;
+
+    // ------------------------------------------------------------
+    // Every .cso of the directory
+    // ------------------------------------------------------------
+    std::error_code error;
+    std::set<std::wstring> stems;
+    std::unordered_map<std::wstring, fs::path> paths;
+
+    for (const fs::directory_entry& entry : fs::directory_iterator(directory, error))
+    {
+        if (!entry.is_regular_file())
+            continue;
+
+        std::wstring extension = entry.path().extension().wstring();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::towlower);
+        if (extension != L".cso")
+            continue;
+
+        const std::wstring stem = entry.path().stem().wstring();
+        stems.insert(stem);
+        paths.emplace(stem, entry.path());
+    }
+
+    if (error)
+    {
+        Logger::Err("ShaderArchivePacker: can't list " + narrow(directory) + ": " + error.message());
+        return false;
+    }
+
+    // ------------------------------------------------------------
+    // Name and permutation: '<name>_<KK>' is a permutation of
+    // '<name>' when '<name>.cso' is there too
+    // ------------------------------------------------------------
+    std::vector<PackedShader> shaders;
+    shaders.reserve(stems.size());
+
+    for (const std::wstring& stem : stems)
+    {
+        PackedShader shader;
+        std::wstring name = stem;
+
+        const size_t length = stem.size();
+        if (length > 3 && stem[length - 3] == L'_' && isHex(stem[length - 2]) && isHex(stem[length - 1]) &&
+            stems.count(stem.substr(0, length - 3)))
+        {
+            name = stem.substr(0, length - 3);
+            shader.permutation = uint32_t(std::wcstoul(stem.c_str() + length - 2, nullptr, 16));
+        }
+
+        shader.name.assign(name.begin(), name.end());
+        shader.nameHash = ShaderArchive::hashName(shader.name);
+
+        if (!readFile(paths[stem], shader.bytecode) || shader.bytecode.empty())
+        {
+            Logger::Err("ShaderArchivePacker: can't read " + narrow(stem) + ".cso");
+            return false;
+        }
+
+        if (!reflect(shader))
+            Logger::Warn("ShaderArchivePacker: no reflection for " + narrow(stem) + ".cso");
+
+        shaders.push_back(std::move(shader));
+    }
+
+    std::sort(shaders.begin(), shaders.end(), [](const PackedShader& a, const PackedShader& b)
+        {
+            return a.nameHash < b.nameHash || (a.nameHash == b.nameHash && a.permutation < b.permutation);
+        });
+
+    // ------------------------------------------------------------
+    // Records, bindings and strings
+    // ------------------------------------------------------------
+    StringTable strings;
+    std::vector<ShaderArchive::Record> records(shaders.size());
+    std::vector<ShaderArchive::Binding> bindings;
+
+    for (size_t i = 0; i < shaders.size(); ++i)
+    {
+        const PackedShader& shader = shaders[i];
+        ShaderArchive::Record& record = records[i];
+
+        record = {};
+        record.nameHash = shader.nameHash;
+        record.permutation = shader.permutation;
+        record.nameOffset = strings.add(shader.name);
+        record.bytecodeSize = shader.bytecode.size();
+        record.firstBinding = uint32_t(bindings.size());
+        record.bindingCount = uint32_t(shader.bindings.size());
+        record.shaderType = shader.shaderType;
+        record.shaderModel = shader.shaderModel;
+
+        for (size_t b = 0; b < shader.bindings.size(); ++b)
+        {
+            ShaderArchive::Binding binding = shader.bindings[b];
+            binding.nameOffset = strings.add(shader.bindingNames[b]);
+            bindings.push_back(binding);
+        }
+    }
+
+    // Never empty: validation relies on the final '\0'
+    strings.add("");
+
+    // ------------------------------------------------------------
+    // Layout
+    // ------------------------------------------------------------
+    ShaderArchive::Header header = {};
+    header.magic = ShaderArchive::MAGIC;
+    header.version = ShaderArchive::VERSION;
+    header.shaderCount = uint32_t(records.size());
+    header.bindingCount = uint32_t(bindings.size());
+    header.recordsOffset = sizeof(ShaderArchive::Header);
+    header.bindingsOffset = header.recordsOffset + records.size() * sizeof(ShaderArchive::Record);
+    header.stringsOffset = header.bindingsOffset + bindings.size() * sizeof(ShaderArchive::Binding);
+    header.stringsSize = strings.getBytes().size();
+
+    uint64_t offset = header.stringsOffset + header.stringsSize;
+    for (ShaderArchive::Record& record : records)
+    {
+        offset = alignUp(offset, ShaderArchive::BYTECODE_ALIGNMENT);
+        record.bytecodeOffset = offset;
+        offset += record.bytecodeSize;
+    }
+    header.fileSize = offset;
+
+    // ------------------------------------------------------------
+    // Write next to the archive, then replace it
+    // ------------------------------------------------------------
+    const std::wstring tempPath = std::wstring(archivePath) + L".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+        auto writeAt = [&out](uint64_t at, const void* data, size_t size)
+            {
+                // Gaps before an aligned offset are zeros
+                const uint64_t position = uint64_t(out.tellp());
+                for (uint64_t i = position; i < at; ++i)
+                    out.put('\0');
+                out.write(static_cast<const char*>(data), std::streamsize(size));
+            };
+
+        writeAt(0, &header, sizeof(header));
+        writeAt(header.recordsOffset, records.data(), records.size() * sizeof(ShaderArchive::Record));
+        writeAt(header.bindingsOffset, bindings.data(), bindings.size() * sizeof(ShaderArchive::Binding));
+        writeAt(header.stringsOffset, strings.getBytes().data(), strings.getBytes().size());
+        for (size_t i = 0; i < records.size(); ++i)
+            writeAt(records[i].bytecodeOffset, shaders[i].bytecode.data(), shaders[i].bytecode.size());
+
+        if (!out)
+        {
+            Logger::Err("ShaderArchivePacker: failed to write " + narrow(tempPath));
+            return false;
+        }
+    }
+
+    if (!MoveFileExW(tempPath.c_str(), archivePath, MOVEFILE_REPLACE_EXISTING))
+    {
+        Logger::Err("ShaderArchivePacker: failed to replace " + narrow(archivePath) + " (in use?)");
+        DeleteFileW(tempPath.c_str());
+        return false;
+    }
+
+    Logger::Log("ShaderArchivePacker: " + std::to_string(records.size()) + " shaders, " + std::to_string(bindings.size()) +
+        " bindings, " + std::to_string(header.fileSize) + " bytes -> " + narrow(archivePath));
+    return true;
+}
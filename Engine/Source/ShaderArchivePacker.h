@@ -0,0 +1,29 @@
+#pragma once
+
+// ============================================================================
+// ShaderArchivePacker
+// ----------------------------------------------------------------------------
+// Build step that writes a ShaderArchive: every .cso in a directory, named
+// and keyed the way ShaderArchive::getFileName() names them, with their
+// D3DReflect bindings. Runs from the engine executable itself, so it needs
+// no other tool:
+//
+//   Engine.exe -packshaders <archive> <directory>
+//
+// (the PackShaderArchive target of Engine.vcxproj, after every build).
+// Messages go through the Logger. The engine is a GUI-subsystem executable
+// with no console, so at exit they are written to the standard output the
+// build inherited and to '<archive>.log'. The exit code is 0 on success.
+// The archive is written to a temporary file and renamed, so a failed pack
+// never leaves a half written one behind.
+// ============================================================================
+
+class ShaderArchivePacker
+{
+public:
+    static bool pack(const wchar_t* archivePath, const wchar_t* directory);
+
+    // 'Engine.exe -packshaders ...': true when the command line asks for it,
+    // 'exitCode' is then the result of pack()
+    static bool runFromCommandLine(int argc, wchar_t** argv, int& exitCode);
+};
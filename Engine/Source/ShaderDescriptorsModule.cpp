@@ -17,34 +17,187 @@ bool ShaderDescriptorsModule::init()
         return false;
 
     descriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-    nextFreeSlot = 1;
+
+    generations.assign(MAX_DESCRIPTORS, 0);
+    rangeCounts.assign(MAX_DESCRIPTORS, 0);
+
+    // ------------------------------------------------------------
+    // Reserved slots never go through the free lists
+    // ------------------------------------------------------------
+    rangeCounts[IMGUI_SLOT] = 1;
+    rangeCounts[NULL_SRV_SLOT] = 1;
+    allocatedCount = 2;
+    freeRanges[2] = MAX_DESCRIPTORS - 2;
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Texture2D.MostDetailedMip = 0;
+    srvDesc.Texture2D.MipLevels = 1;
+    srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
+
+    device->CreateShaderResourceView(nullptr, &srvDesc, getCPUHandle(NULL_SRV_SLOT));
 
     return true;
 }
 
-void ShaderDescriptorsModule::reset()
+void ShaderDescriptorsModule::preRender()
 {
-    // slot 0 reserved for ImGui
-    nextFreeSlot = 1;
+    D3D12Module* d3d12 = app->getD3D12();
+    const uint64_t frameFence = d3d12->getLastFrameFence();
+    const uint64_t completedFence = d3d12->getCompletedFenceValue();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // ------------------------------------------------------------
+    // A frame submitted after the free has completed: no command
+    // list in flight can still reference the slots
+    // ------------------------------------------------------------
+    for (size_t i = 0; i < pendingFrees.size();)
+    {
+        const PendingFree& pending = pendingFrees[i];
+        if (pending.fence >= frameFence || completedFence < frameFence)
+        {
+            ++i;
+            continue;
+        }
+
+        releaseRange(pending.index, pending.count);
+
+        if (i + 1 < pendingFrees.size())
+            pendingFrees[i] = pendingFrees.back();
+        pendingFrees.pop_back();
+    }
+
+    lastFrameFence = frameFence;
 }
 
-UINT ShaderDescriptorsModule::allocate()
+ModuleAccess ShaderDescriptorsModule::getAccess(ModulePhase phase) const
 {
-    return nextFreeSlot++;
+    using namespace ModuleResource;
+
+    // preRender only reads the fence values
+    if (phase == ModulePhase::PreRender)
+        return ModuleAccess::worker(Device, Descriptors);
+
+    return ModuleAccess::idle();
 }
 
-UINT ShaderDescriptorsModule::createSRV(ID3D12Resource* resource)
+DescriptorHandle ShaderDescriptorsModule::allocate()
 {
+    return allocateRange(1);
+}
 
-    if (!resource)
+DescriptorHandle ShaderDescriptorsModule::allocateRange(UINT count)
+{
+    if (count == 0)
+        return DescriptorHandle();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // ------------------------------------------------------------
+    // First fit, lowest slots first: keeps the used part of the
+    // heap packed at the front
+    // ------------------------------------------------------------
+    for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it)
+    {
+        if (it->second < count)
+            continue;
+
+        const uint32_t index = it->first;
+        const uint32_t rest = it->second - count;
+        freeRanges.erase(it);
+        if (rest > 0)
+            freeRanges[index + count] = rest;
+
+        rangeCounts[index] = count;
+        allocatedCount += count;
+        return DescriptorHandle(index, generations[index]);
+    }
+
+    if (failureCount++ == 0)
+        Logger::Err("ShaderDescriptors: no room for " + std::to_string(count) + " descriptors (" + std::to_string(allocatedCount) + " / " + std::to_string(MAX_DESCRIPTORS) + " in use)");
+
+    return DescriptorHandle();
+}
+
+void ShaderDescriptorsModule::free(DescriptorHandle handle)
+{
+    if (!handle.isValid())
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const uint32_t index = handle.index();
+    if (index >= MAX_DESCRIPTORS || index <= NULL_SRV_SLOT || rangeCounts[index] == 0 || generations[index] != handle.generation())
     {
-        OutputDebugStringA("Error: createSRV called with nullptr resource!\n");
-        return UINT_MAX; 
+        Logger::Err("ShaderDescriptors: free of a stale or foreign descriptor (slot " + std::to_string(index) + ")");
+        return;
     }
 
-    UINT index = allocate();
+    // Stale from now on, reusable once the GPU is done with it
+    generations[index] = uint16_t((generations[index] + 1) & DescriptorHandle::GENERATION_MASK);
+
+    PendingFree pending;
+    pending.index = index;
+    pending.count = rangeCounts[index];
+    pending.fence = lastFrameFence;
+    pendingFrees.push_back(pending);
 
-    D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = getCPUHandle(index);
+    rangeCounts[index] = 0;
+}
+
+SharedDescriptor ShaderDescriptorsModule::share(DescriptorHandle handle)
+{
+    if (!handle.isValid())
+        return nullptr;
+
+    return SharedDescriptor(new DescriptorHandle(handle), [this](const DescriptorHandle* h)
+        {
+            free(*h);
+            delete h;
+        });
+}
+
+void ShaderDescriptorsModule::releaseRange(uint32_t index, uint32_t count)
+{
+    allocatedCount -= count;
+
+    // ------------------------------------------------------------
+    // Merge with the free ranges right before and after
+    // ------------------------------------------------------------
+    auto next = freeRanges.lower_bound(index);
+    if (next != freeRanges.end() && next->first == index + count)
+    {
+        count += next->second;
+        next = freeRanges.erase(next);
+    }
+
+    if (next != freeRanges.begin())
+    {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == index)
+        {
+            prev->second += count;
+            return;
+        }
+    }
+
+    freeRanges.emplace_hint(next, index, count);
+}
+
+DescriptorHandle ShaderDescriptorsModule::createSRV(ID3D12Resource* resource)
+{
+    if (!resource)
+    {
+        Logger::Err("ShaderDescriptors: createSRV called with a null resource");
+        return DescriptorHandle();
+    }
+
+    DescriptorHandle handle = allocate();
+    if (!handle.isValid())
+        return handle;
 
     D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
     srvDesc.Format = resource->GetDesc().Format;
@@ -52,38 +205,64 @@ UINT ShaderDescriptorsModule::createSRV(ID3D12Resource* resource)
     srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
     srvDesc.Texture2D.MipLevels = resource->GetDesc().MipLevels;
 
-    app->getD3D12()->getDevice()->CreateShaderResourceView(resource, &srvDesc, cpuHandle);
+    app->getD3D12()->getDevice()->CreateShaderResourceView(resource, &srvDesc, getCPUHandle(handle.index()));
 
-    return index;
+    return handle;
 }
 
-UINT ShaderDescriptorsModule::createNullTexture2DSRV()
+UINT ShaderDescriptorsModule::getIndex(DescriptorHandle handle, UINT offset) const
 {
-    _ASSERTE(nextFreeSlot < MAX_DESCRIPTORS);
-    UINT index = nextFreeSlot++;
-    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-    srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-    srvDesc.Texture2D.MostDetailedMip = 0;
-    srvDesc.Texture2D.MipLevels = 1;
-    srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
+    // Never allocated (no texture, heap full): the null SRV, quietly
+    if (!handle.isValid())
+        return NULL_SRV_SLOT;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const uint32_t index = handle.index();
+    const bool live = index < MAX_DESCRIPTORS && generations[index] == handle.generation() && offset < rangeCounts[index];
+    if (live)
+        return index + offset;
+
+    if (staleCount++ == 0)
+        Logger::Err("ShaderDescriptors: stale descriptor handle used (slot " + std::to_string(index) + ", generation " + std::to_string(handle.generation()) + "), bound the null SRV instead");
+
+    return NULL_SRV_SLOT;
+}
 
-    D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = getCPUHandle(index);
-    app->getD3D12()->getDevice()->CreateShaderResourceView(nullptr, &srvDesc, cpuHandle);
-    return index;
+D3D12_CPU_DESCRIPTOR_HANDLE ShaderDescriptorsModule::getCPUHandle(DescriptorHandle handle, UINT offset) const
+{
+    return getCPUHandle(getIndex(handle, offset));
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE ShaderDescriptorsModule::getGPUHandle(DescriptorHandle handle, UINT offset) const
+{
+    return getGPUHandle(getIndex(handle, offset));
 }
 
 D3D12_CPU_DESCRIPTOR_HANDLE ShaderDescriptorsModule::getCPUHandle(UINT index) const
 {
     D3D12_CPU_DESCRIPTOR_HANDLE handle = descriptorHeap->GetCPUDescriptorHandleForHeapStart();
-    handle.ptr += index * descriptorSize;
+    handle.ptr += SIZE_T(index) * descriptorSize;
     return handle;
 }
 
 D3D12_GPU_DESCRIPTOR_HANDLE ShaderDescriptorsModule::getGPUHandle(UINT index) const
 {
     D3D12_GPU_DESCRIPTOR_HANDLE handle = descriptorHeap->GetGPUDescriptorHandleForHeapStart();
-    handle.ptr += index * descriptorSize;
+    handle.ptr += UINT64(index) * descriptorSize;
     return handle;
-}
\ No newline at end of file
+}
+
+ShaderDescriptorsModule::Stats ShaderDescriptorsModule::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Stats stats;
+    stats.capacity = MAX_DESCRIPTORS;
+    stats.allocated = allocatedCount;
+    stats.pendingFrees = uint32_t(pendingFrees.size());
+    stats.freeRanges = uint32_t(freeRanges.size());
+    stats.staleAccesses = staleCount;
+    stats.failures = failureCount;
+    return stats;
+}
@@ -1,35 +1,121 @@
 #pragma once
 #include "Module.h"
 
+#include <map>
+#include <mutex>
+#include <vector>
+
 	/*class that will manage :
 	A single Shader - Visible Descriptor Heap for CBV, SRV, and UAV descriptors.
-	An index for tracking the next free slot in the heap.
+	Free lists of slots (single descriptors and contiguous ranges for tables).
 	Utility functions for descriptor allocation and heap management.*/
 
+// ----------------------------------------------------------------------------
+// - Slots are handed out as generational handles: the slot index plus the
+//   generation the slot had when it was allocated. free() bumps the
+//   generation, so a handle kept after its free is caught (logged, and the
+//   shared null SRV is returned instead of a descriptor someone else owns).
+// - free() is deferred: the slot is reused only after a frame submitted
+//   after the free has completed on the GPU (preRender()).
+// - The heap is created once with MAX_DESCRIPTORS (the resource binding
+//   tier 1/2 limit). Growing a shader-visible heap would move every GPU
+//   handle already given out (ImGui font, viewport texture).
+// - Slot 0 is ImGui's font, slot 1 a null Texture2D SRV shared by every
+//   material without a texture.
+// ----------------------------------------------------------------------------
+
+struct DescriptorHandle
+{
+    static constexpr uint32_t INDEX_BITS = 20;                  // 1M slots
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static constexpr uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+
+    uint32_t bits = 0xFFFFFFFFu;
+
+    DescriptorHandle() = default;
+    DescriptorHandle(uint32_t index, uint32_t generation) : bits(index | ((generation & GENERATION_MASK) << INDEX_BITS)) {}
+
+    uint32_t index() const { return bits & INDEX_MASK; }
+    uint32_t generation() const { return bits >> INDEX_BITS; }
+    bool isValid() const { return bits != 0xFFFFFFFFu; }
+};
+
+// Frees its descriptor when the last copy goes away (owners that get copied, like materials)
+using SharedDescriptor = std::shared_ptr<const DescriptorHandle>;
+
 class ShaderDescriptorsModule : public Module
 {
+public:
+    static const UINT MAX_DESCRIPTORS = 1000000;
+    static const UINT IMGUI_SLOT = 0;
+    static const UINT NULL_SRV_SLOT = 1;
+
+    struct Stats
+    {
+        uint32_t capacity = 0;
+        uint32_t allocated = 0;         // slots in use (pending frees included)
+        uint32_t pendingFrees = 0;
+        uint32_t freeRanges = 0;        // fragmentation of the free space
+        uint32_t staleAccesses = 0;     // handles used after their free
+        uint32_t failures = 0;          // heap full / no contiguous range
+    };
+
 private:
+    struct PendingFree
+    {
+        uint32_t index = 0;
+        uint32_t count = 0;
+        uint64_t fence = 0;             // last frame fence when it was freed
+    };
+
     ComPtr<ID3D12DescriptorHeap> descriptorHeap;
-    UINT nextFreeSlot = 0;
     UINT descriptorSize = 0;
-    static const UINT MAX_DESCRIPTORS = 1024;
+
+    mutable std::mutex mutex;
+    std::map<uint32_t, uint32_t> freeRanges;    // first slot -> count, coalesced
+    std::vector<uint16_t> generations;          // per slot
+    std::vector<uint32_t> rangeCounts;          // per allocated first slot, 0 = not allocated
+    std::vector<PendingFree> pendingFrees;
+    uint64_t lastFrameFence = 0;
+    uint32_t allocatedCount = 0;
+    mutable uint32_t staleCount = 0;
+    uint32_t failureCount = 0;
+
+    void releaseRange(uint32_t index, uint32_t count);
 
 public:
     ShaderDescriptorsModule() {}
     ~ShaderDescriptorsModule() {}
 
     bool init() override;
-    void reset();
+    void preRender() override;
+
+    const char* getName() const override { return "ShaderDescriptors"; }
+    ModuleAccess getAccess(ModulePhase phase) const override;
+
+    // Thread safe. Invalid handle when the heap is full
+    DescriptorHandle allocate();
+    DescriptorHandle allocateRange(UINT count);        // contiguous, for descriptor tables
+    void free(DescriptorHandle handle);                // a single slot or a whole range
+    SharedDescriptor share(DescriptorHandle handle);
+
+    DescriptorHandle createSRV(ID3D12Resource* resource);
+    DescriptorHandle getNullSRV() const { return DescriptorHandle(NULL_SRV_SLOT, 0); }
 
-    UINT allocate();
-    UINT createSRV(ID3D12Resource* resource);
-    UINT createNullTexture2DSRV();
+    // Checked: a stale handle gets the null SRV. 'offset' selects a slot inside a range
+    D3D12_CPU_DESCRIPTOR_HANDLE getCPUHandle(DescriptorHandle handle, UINT offset = 0) const;
+    D3D12_GPU_DESCRIPTOR_HANDLE getGPUHandle(DescriptorHandle handle, UINT offset = 0) const;
 
+    // Checked slot number: the index bindless shaders use into getBindlessTable()
+    UINT getIndex(DescriptorHandle handle, UINT offset = 0) const;
+
+    // The whole heap as one descriptor table (unbounded ranges, slot = index)
+    D3D12_GPU_DESCRIPTOR_HANDLE getBindlessTable() const { return getGPUHandle(0u); }
+
+    // Reserved slots (IMGUI_SLOT, NULL_SRV_SLOT)
     D3D12_CPU_DESCRIPTOR_HANDLE getCPUHandle(UINT index) const;
     D3D12_GPU_DESCRIPTOR_HANDLE getGPUHandle(UINT index) const;
 
     ID3D12DescriptorHeap* getHeap() const { return descriptorHeap.Get(); }
-
-
+    Stats getStats() const;
 };
-
@@ -0,0 +1,54 @@
+#include "Globals.h"
+#include "ShaderPermutations.h"
+
+#include "Application.h"
+#include "ShaderArchive.h"
+
+static_assert(ShaderPermutations::UBER_KEY == ShaderArchive::NO_PERMUTATION, "the archive keys the uber shader as no permutation");
+
+ShaderPermutations::ShaderPermutations(const wchar_t* baseName) : baseName(baseName)
+{
+}
+
+ShaderPermutations::Variant& ShaderPermutations::load(uint32_t key)
+{
+    auto it = variants.find(key);
+    if (it != variants.end())
+        return it->second;
+
+    Variant& variant = variants[key];
+    const std::wstring fileName = ShaderArchive::getFileName(baseName, key);
+
+    // Empty: a variant the build did not produce
+    variant.bytecode = app->getShaderArchive().get(baseName.c_str(), key);
+    variant.found = variant.bytecode.BytecodeLength > 0;
+
+    if (key != UBER_KEY)
+    {
+        if (variant.found)
+            ++stats.loaded;
+        else
+            ++stats.missing;
+    }
+
+    if (!variant.found)
+    {
+        const std::string name(fileName.begin(), fileName.end());
+        if (key == UBER_KEY)
+            Logger::Err("ShaderPermutations: " + name + " not found");
+        else
+            Logger::Warn("ShaderPermutations: " + name + " not found, using the uber shader");
+    }
+
+    return variant;
+}
+
+uint32_t ShaderPermutations::resolve(uint32_t key)
+{
+    return load(key).found ? key : UBER_KEY;
+}
+
+D3D12_SHADER_BYTECODE ShaderPermutations::get(uint32_t resolvedKey)
+{
+    return load(resolvedKey).bytecode;
+}
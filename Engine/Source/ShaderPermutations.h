@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+// ============================================================================
+// ShaderPermutations
+// ----------------------------------------------------------------------------
+// Compiled variants of one shader, specialized on feature bits at compile
+// time instead of branching on them at run time.
+//
+// - A permutation key is a set of feature bits owned by the shader (for
+//   Exercise8PS: colour texture, tone mapping, lighting path). The build
+//   compiles each key with the matching defines plus PERMUTATION into
+//   '<baseName>_<KK>.cso' (key in two hex digits, the ShaderPermutation
+//   items of Engine.vcxproj).
+// - '<baseName>.cso', compiled without PERMUTATION, is the uber shader that
+//   reads the features at run time. Keys whose variant is missing resolve
+//   to it (UBER_KEY), so a partial build still renders.
+// - Variants are looked up in the ShaderArchive on first use (the archive
+//   keys them the same way; loose .cso files when it is missing) and kept.
+//
+// Pipelines key on resolve(key): all missing variants share the uber PSO.
+// Not thread safe: used while building pipelines on the render thread.
+// ============================================================================
+
+class ShaderPermutations
+{
+public:
+    static constexpr uint32_t UBER_KEY = 0xFFFFFFFFu;
+
+    struct Stats
+    {
+        uint32_t loaded = 0;        // variants found on disk
+        uint32_t missing = 0;       // keys answered by the uber shader
+    };
+
+private:
+    struct Variant
+    {
+        D3D12_SHADER_BYTECODE bytecode = {};     // into the shader archive
+        bool found = false;
+    };
+
+    std::wstring baseName;
+    std::unordered_map<uint32_t, Variant> variants;     // by key, UBER_KEY included
+    Stats stats;
+
+    Variant& load(uint32_t key);
+
+public:
+    explicit ShaderPermutations(const wchar_t* baseName);
+
+    // The key itself when its variant exists, UBER_KEY otherwise
+    uint32_t resolve(uint32_t key);
+
+    // Bytecode of a resolved key (empty if not even the uber shader loads)
+    D3D12_SHADER_BYTECODE get(uint32_t resolvedKey);
+
+    const Stats& getStats() const { return stats; }
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+// ============================================================================
+// SnapshotBuffer
+// ----------------------------------------------------------------------------
+// Double-buffered state shared between the simulation and the render stage.
+//
+// - The simulation (possibly on a worker) fills write() during update.
+// - The render stage (main thread) only looks at read().
+// - publish() flips the two slots. It must run on the main thread while the
+//   simulation is idle (ModuleScheduler::publish between frames), which is
+//   the only synchronization needed.
+// - Frames without a simulation step (fixed timestep) write nothing, so
+//   publish() keeps the current read slot for them.
+//
+// Render data is copied into the ring buffer when the frame is recorded, so
+// two slots are enough no matter how many frames the GPU has in flight.
+// ============================================================================
+
+template<typename T>
+class SnapshotBuffer
+{
+private:
+    T slots[2];
+    uint32_t readIndex = 0;
+    bool written = false;
+
+public:
+    T& write() { written = true; return slots[readIndex ^ 1]; }
+    const T& read() const { return slots[readIndex]; }
+
+    void publish()
+    {
+        if (!written)
+            return;
+
+        readIndex ^= 1;
+        written = false;
+    }
+
+    // Both slots start with the same state
+    void reset(const T& value) { slots[0] = value; slots[1] = value; written = false; }
+};
@@ -0,0 +1,106 @@
+#include "Globals.h"
+#include "TimeService.h"
+
+#include <algorithm>
+#include <thread>
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+TimeService::TimeService()
+{
+    start = frameStart = clock::now();
+
+    // High resolution timers (Windows 10 1803+) wake within ~0.5 ms; fall back to a normal one
+    waitableTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!waitableTimer)
+        waitableTimer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+}
+
+TimeService::~TimeService()
+{
+    if (waitableTimer)
+        CloseHandle(waitableTimer);
+}
+
+int64_t TimeService::nowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(clock::now().time_since_epoch()).count();
+}
+
+void TimeService::setFixedStepHz(double hz)
+{
+    hz = std::min(std::max(hz, 1.0), 1000.0);
+    fixedStepUs = int64_t(1e6 / hz + 0.5);
+    accumulatorUs = std::min(accumulatorUs, fixedStepUs);
+}
+
+void TimeService::reset()
+{
+    frameStart = clock::now();
+    frameUs = 0;
+    accumulatorUs = 0;
+}
+
+uint32_t TimeService::beginFrame()
+{
+    clock::time_point now = clock::now();
+
+    frameUs = std::chrono::duration_cast<std::chrono::microseconds>(now - frameStart).count();
+    frameUs = std::min(std::max<int64_t>(frameUs, 0), MAX_FRAME_US);
+    frameStart = now;
+
+    totalUs = std::chrono::duration_cast<std::chrono::microseconds>(now - start).count();
+    ++frameCount;
+
+    // ------------------------------------------------------------
+    // Fixed-step accumulator
+    // ------------------------------------------------------------
+    accumulatorUs += frameUs;
+
+    uint32_t steps = uint32_t(accumulatorUs / fixedStepUs);
+    if (steps > maxStepsPerFrame)
+    {
+        // Spiral of death guard: simulate what we can, forget the rest
+        droppedSteps += steps - maxStepsPerFrame;
+        steps = maxStepsPerFrame;
+        accumulatorUs = fixedStepUs * steps + (accumulatorUs % fixedStepUs);
+    }
+
+    accumulatorUs -= fixedStepUs * steps;
+    lastSteps = steps;
+
+    return steps;
+}
+
+void TimeService::limitFrame()
+{
+    if (targetFps <= 0.0)
+        return;
+
+    const auto frameDuration = std::chrono::microseconds(int64_t(1e6 / targetFps));
+    sleepUntil(frameStart + frameDuration);
+}
+
+void TimeService::sleepUntil(clock::time_point deadline)
+{
+    // ------------------------------------------------------------
+    // Coarse part: waitable timer (no busy waiting)
+    // ------------------------------------------------------------
+    int64_t remainingUs = std::chrono::duration_cast<std::chrono::microseconds>(deadline - clock::now()).count();
+    if (waitableTimer && remainingUs > SPIN_THRESHOLD_US)
+    {
+        LARGE_INTEGER dueTime;
+        dueTime.QuadPart = -(remainingUs - SPIN_THRESHOLD_US) * 10;    // relative, 100 ns units
+
+        if (SetWaitableTimerEx(waitableTimer, &dueTime, 0, nullptr, nullptr, nullptr, 0))
+            WaitForSingleObject(waitableTimer, INFINITE);
+    }
+
+    // ------------------------------------------------------------
+    // Fine part: yield until the deadline
+    // ------------------------------------------------------------
+    while (clock::now() < deadline)
+        std::this_thread::yield();
+}
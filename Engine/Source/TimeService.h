@@ -0,0 +1,83 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// ============================================================================
+// TimeService
+// ----------------------------------------------------------------------------
+// Frame clock of the Application.
+//
+// - steady_clock, kept in integer microseconds (no ms quantization, never
+//   goes backwards).
+// - Fixed-step simulation: beginFrame() adds the frame time to an
+//   accumulator and returns how many fixed steps to simulate. Steps are
+//   capped (maxStepsPerFrame) so a slow frame cannot snowball; the time that
+//   does not fit is dropped.
+// - getAlpha() is how far the render time is between the last two
+//   simulated steps, for render-side interpolation.
+// - limitFrame() waits until the frame reaches the target duration: a high
+//   resolution waitable timer sleeps most of it and only the last
+//   SPIN_THRESHOLD_US are spent yielding.
+// ============================================================================
+
+class TimeService
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr int64_t SPIN_THRESHOLD_US = 500;
+    static constexpr int64_t MAX_FRAME_US = 250000;     // clamp (breakpoints, window drags)
+
+private:
+    clock::time_point start;
+    clock::time_point frameStart;
+
+    int64_t  frameUs = 0;           // last frame, clamped
+    int64_t  totalUs = 0;
+    int64_t  accumulatorUs = 0;
+    int64_t  fixedStepUs = 16667;   // 60 Hz
+    uint32_t maxStepsPerFrame = 5;
+    uint32_t lastSteps = 0;
+    uint64_t droppedSteps = 0;
+    uint64_t frameCount = 0;
+
+    double   targetFps = 0.0;       // 0: no limit
+    void*    waitableTimer = nullptr;
+
+public:
+    TimeService();
+    ~TimeService();
+
+    TimeService(const TimeService&) = delete;
+    TimeService& operator=(const TimeService&) = delete;
+
+    // Restarts the frame clock (after loading, so init time is not simulated)
+    void reset();
+
+    // Call once at the start of every frame. Returns the fixed steps to simulate.
+    uint32_t beginFrame();
+
+    // Call once at the end of every frame
+    void limitFrame();
+
+    void     setFixedStepHz(double hz);
+    double   getFixedStepHz() const { return 1e6 / double(fixedStepUs); }
+    void     setMaxStepsPerFrame(uint32_t steps) { maxStepsPerFrame = steps > 0 ? steps : 1; }
+    uint32_t getMaxStepsPerFrame() const { return maxStepsPerFrame; }
+    void     setTargetFps(double fps) { targetFps = fps > 0.0 ? fps : 0.0; }
+    double   getTargetFps() const { return targetFps; }
+
+    int64_t  getFrameUs() const { return frameUs; }
+    float    getFrameSeconds() const { return float(frameUs) * 1e-6f; }
+    int64_t  getTotalUs() const { return totalUs; }
+    float    getFixedStepSeconds() const { return float(fixedStepUs) * 1e-6f; }
+    float    getAlpha() const { return float(accumulatorUs) / float(fixedStepUs); }
+    uint32_t getLastSteps() const { return lastSteps; }
+    uint64_t getDroppedSteps() const { return droppedSteps; }
+    uint64_t getFrameCount() const { return frameCount; }
+
+    static int64_t nowUs();
+
+private:
+    void sleepUntil(clock::time_point deadline);
+};
@@ -1,4 +1,5 @@
-#include "Globals.h"
+// Plain C++ on purpose (no Globals.h / precompiled header): this file has to
+// build outside the engine for headless tests.
 #include "Timer.h"
 
 Timer::Timer() : running(false)
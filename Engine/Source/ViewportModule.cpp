@@ -75,7 +75,7 @@ bool ViewportModule::init()
 
     if (splashTexture)
     {
-        UINT idx = shaders->createSRV(splashTexture.Get());
+        DescriptorHandle idx = shaders->createSRV(splashTexture.Get());
         splashSrvCpuHandle = shaders->getCPUHandle(idx);
         splashSrvGpuHandle = shaders->getGPUHandle(idx);
 
@@ -158,6 +158,12 @@ void ViewportModule::preRender()
     hovered = ImGui::IsWindowHovered(ImGuiHoveredFlags_AllowWhenBlockedByActiveItem);
     focused = ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows);
 
+    ImVec2 mouse = ImGui::GetMousePos();
+    mousePos = ImVec2(mouse.x - viewportPos.x, mouse.y - viewportPos.y);
+
+    clicked = hovered && !io.KeyAlt && ImGui::IsMouseClicked(ImGuiMouseButton_Left) &&
+        mousePos.x >= 0.0f && mousePos.y >= 0.0f && mousePos.x < viewportSize.x && mousePos.y < viewportSize.y;
+
     ImGui::End();
 }
 
@@ -179,37 +185,26 @@ bool ViewportModule::cleanUp()
 	return true;
 }
 
-void ViewportModule::transitionToRenderTarget(ID3D12GraphicsCommandList* cmd)
+bool ViewportModule::isUsable() const
 {
-    showSplash = false; // first time we render into the viewport, stop showing the splash
-
-    // ------------------------------------------------------------
-    // Viewport texture: SRV -> RTV
-    // ------------------------------------------------------------
-    // Before the scene renders into the viewport texture, we must transition it
-    // from PIXEL_SHADER_RESOURCE (ImGui sampling) to RENDER_TARGET.
-    if (!colorTexture) return;
-
-    auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(colorTexture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET);
-    cmd->ResourceBarrier(1, &barrier);
+    return visible && width > 0 && height > 0 && colorTexture != nullptr;
 }
 
-void ViewportModule::transitionToShaderResource(ID3D12GraphicsCommandList* cmd)
+PickRay ViewportModule::getMouseRay(const Matrix& view, const Matrix& proj) const
 {
-    // ------------------------------------------------------------
-    // Viewport texture: RTV -> SRV
-    // ------------------------------------------------------------
-    // After scene rendering, we transition back to PIXEL_SHADER_RESOURCE so ImGui
-    // can sample it in ImGui::Image.
-    if (!colorTexture) return;
+    // Mouse -> NDC (y up), then unproject the near and far plane points
+    float ndcX = 2.0f * (mousePos.x / std::max(viewportSize.x, 1.0f)) - 1.0f;
+    float ndcY = 1.0f - 2.0f * (mousePos.y / std::max(viewportSize.y, 1.0f));
 
-    auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(colorTexture, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-    cmd->ResourceBarrier(1, &barrier);
-}
+    Matrix invViewProj = (view * proj).Invert();
 
-bool ViewportModule::isUsable() const
-{
-    return visible && width > 0 && height > 0 && colorTexture != nullptr;
+    Vector3 nearPoint = Vector3::Transform(Vector3(ndcX, ndcY, 0.0f), invViewProj);
+    Vector3 farPoint = Vector3::Transform(Vector3(ndcX, ndcY, 1.0f), invViewProj);
+
+    Vector3 dir = farPoint - nearPoint;
+    dir.Normalize();
+
+    return PickRay(nearPoint, dir);
 }
 
 
@@ -16,15 +16,16 @@
 // Key responsibilities:
 // - Create and destroy the viewport color/depth GPU resources.
 // - Recreate resources when the ImGui viewport region is resized.
-// - Manage the viewport texture state transitions:
-//     * SRV  -> RTV before scene rendering
-//     * RTV  -> SRV after scene rendering (ready for ImGui sampling)
+// - The viewport texture stays in PIXEL_SHADER_RESOURCE between frames; the
+//   frame RenderGraph (EditorModule) moves it to RENDER_TARGET for the scene
+//   pass and back before ImGui samples it.
 // ============================================================================
 
 #include "Module.h"
+#include "BVH.h"
+#include "ShaderDescriptorsModule.h"
 
 class D3D12Module;
-class ShaderDescriptorsModule;
 class ImGuiPass;
 
 class ViewportModule : public Module
@@ -44,6 +45,8 @@ private:
     bool visible = true;
     bool focused = false;
     bool hovered = false;
+    bool clicked = false;           // left click inside the image this frame (Alt excluded: orbit)
+    ImVec2 mousePos = {};           // mouse position relative to the viewport image
     ImDrawList* drawList = nullptr;
 
     // --------------------------------------------------
@@ -71,7 +74,7 @@ private:
     // SRV handle for sampling the viewport texture (ImGui::Image)
     D3D12_CPU_DESCRIPTOR_HANDLE srvCpuHandle = {};
     D3D12_GPU_DESCRIPTOR_HANDLE srvGpuHandle = {};
-    uint32_t srvIndex = 0;
+    DescriptorHandle srvIndex;
 
     // Descriptor heaps (CPU-only)
     ComPtr<ID3D12DescriptorHeap> rtvHeap;
@@ -114,6 +117,8 @@ public:
 
     bool isFocused() const { return focused; }
     bool isHovered() const { return hovered; }
+    bool wasClicked() const { return clicked; }
+    ImVec2 getMousePos() const { return mousePos; }
 
     bool isUsable() const;
 
@@ -136,10 +141,10 @@ public:
     uint32_t getWidth() const { return width; }
     uint32_t getHeight() const { return height; }
 
-    // ------------------------------------------------------------
-    // Resource transitions (viewport texture owner)
-    // ------------------------------------------------------------
-    void transitionToRenderTarget(ID3D12GraphicsCommandList* cmd);
-    void transitionToShaderResource(ID3D12GraphicsCommandList* cmd);
+    // World-space ray through the current mouse position (for picking)
+    PickRay getMouseRay(const Matrix& view, const Matrix& proj) const;
+
+    // First scene rendered into the texture: stop showing the splash
+    void hideSplash() { showSplash = false; }
 };
 
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// ============================================================================
+// WorkDeque
+// ----------------------------------------------------------------------------
+// Chase-Lev work-stealing deque ("Correct and Efficient Work-Stealing for
+// Weak Memory Models", Le et al. 2013) over a fixed ring buffer of pointers.
+//
+// - The owner thread push()es and pop()s at the bottom (LIFO).
+// - Any other thread steal()s from the top (FIFO). A steal can fail
+//   spuriously when it loses the race for the same element.
+// - push() returns false when the deque holds CAPACITY elements; the
+//   caller decides what to do with the element (JobSystem runs it inline).
+//
+// Used by JobSystem, one per thread. Header-only so the headless tests
+// (Engine/Tests) can race it directly.
+// ============================================================================
+
+template<typename T, int64_t Capacity = 4096>
+class WorkDeque
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    static constexpr int64_t CAPACITY = Capacity;
+
+    // Owner only
+    bool push(T* item)
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+
+        if (b - t >= CAPACITY)
+            return false;
+
+        buffer[b & (CAPACITY - 1)].store(item, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_release);   // publishes the item to thieves (acquire in steal)
+        return true;
+    }
+
+    // Owner only
+    T* pop()
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            // Empty
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T* item = buffer[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (t == b)
+        {
+            // Last element: race against thieves
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                item = nullptr;
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Any thread
+    T* steal()
+    {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+
+        if (t >= b)
+            return nullptr;
+
+        T* item = buffer[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+
+        return item;
+    }
+
+    bool empty() const
+    {
+        return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> top{ 0 };
+    alignas(64) std::atomic<int64_t> bottom{ 0 };
+    alignas(64) std::atomic<T*>      buffer[CAPACITY] = {};
+};
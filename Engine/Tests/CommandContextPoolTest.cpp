@@ -0,0 +1,257 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <thread>
+
+#include "CommandContextPool.h"
+
+namespace
+{
+    // Stands in for the GPU: the fence value it has completed
+    struct MockGpu
+    {
+        uint64_t completed = 0;
+        uint32_t allocators = 0;
+        uint32_t lists = 0;
+        uint32_t resets = 0;
+        uint32_t resetsInFlight = 0;    // allocator reset while the GPU may still read it
+        std::mutex mutex;
+    };
+
+    struct MockAllocator
+    {
+        uint32_t id = 0;
+        uint64_t submittedFence = 0;    // set on submission, 0: never submitted
+    };
+
+    struct MockList
+    {
+        uint32_t id = 0;
+        bool open = false;
+    };
+
+    struct MockDevice
+    {
+        using Allocator = std::shared_ptr<MockAllocator>;
+        using List = std::shared_ptr<MockList>;
+
+        MockGpu* gpu = nullptr;
+
+        Allocator createAllocator()
+        {
+            std::lock_guard<std::mutex> lock(gpu->mutex);
+            auto allocator = std::make_shared<MockAllocator>();
+            allocator->id = ++gpu->allocators;
+            return allocator;
+        }
+
+        List createList(Allocator&)
+        {
+            std::lock_guard<std::mutex> lock(gpu->mutex);
+            auto list = std::make_shared<MockList>();
+            list->id = ++gpu->lists;
+            return list;
+        }
+
+        void reset(Allocator& allocator, List& list)
+        {
+            std::lock_guard<std::mutex> lock(gpu->mutex);
+            ++gpu->resets;
+            if (allocator->submittedFence > gpu->completed)
+                ++gpu->resetsInFlight;
+            list->open = true;
+        }
+    };
+
+    using Pool = CommandContextPoolT<MockDevice>;
+
+    // Closes the frame's lists and "submits" them with the frame's fence
+    void submit(Pool& pool, const std::vector<Pool::Context*>& recorded, uint64_t fenceValue)
+    {
+        for (Pool::Context* context : recorded)
+        {
+            context->list->open = false;
+            context->allocator->submittedFence = fenceValue;
+        }
+        pool.endFrame(fenceValue);
+    }
+}
+
+TEST_CASE("acquire returns open lists and creates on demand")
+{
+    MockGpu gpu;
+    Pool pool(MockDevice{ &gpu });
+
+    pool.beginFrame(0);
+    Pool::Context* a = pool.acquire();
+    Pool::Context* b = pool.acquire();
+
+    CHECK(a != b);
+    CHECK(a->list->open && b->list->open);
+    CHECK(a->fenceValue == 0);
+    CHECK(gpu.allocators == 2);
+    CHECK(pool.getStats().acquiredThisFrame == 2);
+
+    submit(pool, { a, b }, 1);
+    Pool::Stats stats = pool.getStats();
+    CHECK(stats.pending == 2);
+    CHECK(stats.free == 0);
+    CHECK(stats.acquiredThisFrame == 0);
+    CHECK(stats.acquiredLastFrame == 2);
+    CHECK(a->fenceValue == 1);
+}
+
+TEST_CASE("allocators are not reused before their fence completes")
+{
+    MockGpu gpu;
+    Pool pool(MockDevice{ &gpu });
+
+    pool.beginFrame(gpu.completed);
+    Pool::Context* first = pool.acquire();
+    submit(pool, { first }, 1);
+
+    // GPU still on frame 1: a new context, not the submitted one
+    pool.beginFrame(gpu.completed);
+    Pool::Context* second = pool.acquire();
+    CHECK(second != first);
+    CHECK(second->allocator != first->allocator);
+    submit(pool, { second }, 2);
+
+    // Frame 1 done: its context comes back, frame 2's stays pending
+    gpu.completed = 1;
+    pool.beginFrame(gpu.completed);
+    CHECK(pool.getStats().free == 1);
+    CHECK(pool.getStats().pending == 1);
+
+    Pool::Context* third = pool.acquire();
+    CHECK(third == first);
+    submit(pool, { third }, 3);
+
+    CHECK(gpu.allocators == 2);
+    CHECK(gpu.resetsInFlight == 0);
+}
+
+TEST_CASE("frames in flight rotate through the pool")
+{
+    MockGpu gpu;
+    Pool pool(MockDevice{ &gpu });
+
+    constexpr uint64_t FRAMES_IN_FLIGHT = 2;
+    constexpr size_t CONTEXTS_PER_FRAME = 3;
+
+    for (uint64_t frame = 1; frame <= 50; ++frame)
+    {
+        // The CPU runs at most FRAMES_IN_FLIGHT frames ahead of the GPU
+        if (frame > FRAMES_IN_FLIGHT)
+            gpu.completed = frame - FRAMES_IN_FLIGHT;
+
+        pool.beginFrame(gpu.completed);
+
+        std::vector<Pool::Context*> recorded;
+        for (size_t i = 0; i < CONTEXTS_PER_FRAME; ++i)
+            recorded.push_back(pool.acquire());
+
+        submit(pool, recorded, frame);
+
+        Pool::Stats stats = pool.getStats();
+        CHECK(stats.acquiredLastFrame == CONTEXTS_PER_FRAME);
+        CHECK(stats.created == stats.free + stats.pending);
+    }
+
+    // The frame being recorded and the ones the GPU has not finished, never more
+    CHECK(pool.getStats().created == CONTEXTS_PER_FRAME * FRAMES_IN_FLIGHT);
+    CHECK(gpu.resetsInFlight == 0);
+    CHECK(gpu.resets == 50 * CONTEXTS_PER_FRAME);
+}
+
+TEST_CASE("the pool grows when every context is in flight")
+{
+    MockGpu gpu;
+    Pool pool(MockDevice{ &gpu });
+
+    // Warm up with 2 contexts, all retired
+    pool.beginFrame(0);
+    submit(pool, { pool.acquire(), pool.acquire() }, 1);
+    gpu.completed = 1;
+    pool.beginFrame(gpu.completed);
+    CHECK(pool.getStats().free == 2);
+
+    // A heavier frame takes both free ones and creates 3 more
+    std::vector<Pool::Context*> heavy;
+    for (int i = 0; i < 5; ++i)
+        heavy.push_back(pool.acquire());
+    submit(pool, heavy, 2);
+    CHECK(pool.getStats().created == 5);
+
+    // The GPU stalls: the next frame has nothing free and grows again
+    pool.beginFrame(gpu.completed);
+    CHECK(pool.getStats().free == 0);
+    Pool::Context* extra = pool.acquire();
+    CHECK(std::find(heavy.begin(), heavy.end(), extra) == heavy.end());
+    CHECK(pool.getStats().created == 6);
+    submit(pool, { extra }, 3);
+
+    // Everything completes: all of it is reusable, nothing new is created
+    gpu.completed = 3;
+    pool.beginFrame(gpu.completed);
+    CHECK(pool.getStats().free == 6);
+    for (int i = 0; i < 6; ++i)
+        pool.acquire();
+    CHECK(pool.getStats().created == 6);
+    CHECK(gpu.resetsInFlight == 0);
+}
+
+TEST_CASE("acquire from many threads")
+{
+    MockGpu gpu;
+    Pool pool(MockDevice{ &gpu });
+
+    constexpr int THREADS = 8;
+    constexpr int PER_THREAD = 16;
+
+    for (uint64_t frame = 1; frame <= 4; ++frame)
+    {
+        gpu.completed = frame - 1;
+        pool.beginFrame(gpu.completed);
+
+        std::vector<Pool::Context*> acquired(THREADS * PER_THREAD);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t)
+        {
+            threads.emplace_back([&, t]()
+                {
+                    for (int i = 0; i < PER_THREAD; ++i)
+                        acquired[t * PER_THREAD + i] = pool.acquire();
+                });
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+
+        // No context handed out twice
+        std::set<Pool::Context*> unique(acquired.begin(), acquired.end());
+        CHECK(unique.size() == acquired.size());
+
+        submit(pool, acquired, frame);
+    }
+
+    // The previous frame is always complete: the pool never grows past one frame
+    CHECK(pool.getStats().created == THREADS * PER_THREAD);
+    CHECK(gpu.resetsInFlight == 0);
+}
+
+TEST_CASE("clear drops every context")
+{
+    MockGpu gpu;
+    Pool pool(MockDevice{ &gpu });
+
+    pool.beginFrame(0);
+    submit(pool, { pool.acquire(), pool.acquire() }, 1);
+    pool.clear();
+
+    Pool::Stats stats = pool.getStats();
+    CHECK(stats.created == 0);
+    CHECK(stats.free == 0);
+    CHECK(stats.pending == 0);
+}
@@ -0,0 +1,61 @@
+// Link seam: PersistentGpuBuffer without a device, for the headless tests of
+// its owners (LightManager). reserve() grows like the real one, upload()
+// packs the dirty elements into CPU staging memory (what the real one writes
+// into the ring buffer) and counts one copy per run of consecutive indices.
+// There is never a GPU buffer: getGPUAddress() stays 0.
+#include "PersistentGpuBuffer.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace
+{
+    std::vector<uint8_t> staging;
+}
+
+PersistentGpuBuffer::PersistentGpuBuffer(uint32_t stride, const wchar_t* name) : stride(stride), name(name)
+{
+}
+
+bool PersistentGpuBuffer::reserve(uint32_t count)
+{
+    if (capacity > 0 && count <= capacity)
+        return false;
+
+    uint32_t newCapacity = std::max(capacity, INITIAL_CAPACITY);
+    while (newCapacity < count)
+        newCapacity *= 2;
+
+    if (capacity > 0)
+        ++resizes;
+
+    capacity = newCapacity;
+    return true;
+}
+
+size_t PersistentGpuBuffer::upload(ID3D12GraphicsCommandList* commandList, RingBufferModule* ring, const std::vector<uint32_t>& dirty,
+    const PackFn& pack, uint32_t* copies)
+{
+    if (dirty.empty() || capacity == 0)
+        return 0;
+
+    staging.resize(std::max(staging.size(), dirty.size() * stride));
+    for (size_t i = 0; i < dirty.size(); ++i)
+        pack(dirty[i], staging.data() + i * stride);
+
+    uint32_t runs = 0;
+    for (size_t first = 0; first < dirty.size();)
+    {
+        size_t last = first + 1;
+        while (last < dirty.size() && dirty[last] == dirty[last - 1] + 1)
+            ++last;
+
+        ++runs;
+        first = last;
+    }
+
+    if (copies)
+        *copies = runs;
+
+    return dirty.size() * stride;
+}
@@ -0,0 +1,285 @@
+#include "Test.h"
+
+#include <d3d12.h>
+#include <string>
+
+#include "FilteredCommandList.h"
+
+namespace
+{
+    // Records the calls that reach the command list
+    struct MockCommandList
+    {
+        std::vector<std::string> calls;
+        std::vector<D3D12_RESOURCE_BARRIER> barriers;
+        std::vector<UINT> barrierBatches;
+
+        void SetPipelineState(ID3D12PipelineState*) { calls.push_back("PSO"); }
+        void SetGraphicsRootSignature(ID3D12RootSignature*) { calls.push_back("RootSignature"); }
+        void SetDescriptorHeaps(UINT, ID3D12DescriptorHeap* const*) { calls.push_back("DescriptorHeaps"); }
+        void SetGraphicsRootDescriptorTable(UINT, D3D12_GPU_DESCRIPTOR_HANDLE) { calls.push_back("Table"); }
+        void SetGraphicsRootConstantBufferView(UINT, D3D12_GPU_VIRTUAL_ADDRESS) { calls.push_back("CBV"); }
+        void SetGraphicsRootShaderResourceView(UINT, D3D12_GPU_VIRTUAL_ADDRESS) { calls.push_back("SRV"); }
+        void SetGraphicsRoot32BitConstants(UINT, UINT, const void*, UINT) { calls.push_back("Constants"); }
+        void IASetVertexBuffers(UINT, UINT, const D3D12_VERTEX_BUFFER_VIEW*) { calls.push_back("VertexBuffers"); }
+        void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW*) { calls.push_back("IndexBuffer"); }
+        void IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY) { calls.push_back("Topology"); }
+
+        void ResourceBarrier(UINT numBarriers, const D3D12_RESOURCE_BARRIER* list)
+        {
+            calls.push_back("Barrier");
+            barrierBatches.push_back(numBarriers);
+            barriers.insert(barriers.end(), list, list + numBarriers);
+        }
+
+        size_t count(const char* call) const
+        {
+            size_t n = 0;
+            for (const std::string& c : calls)
+                n += c == call ? 1 : 0;
+            return n;
+        }
+    };
+
+    using MockFiltered = FilteredCommandListT<MockCommandList>;
+    using Call = MockFiltered::Call;
+
+    // Fake interface pointers, never dereferenced
+    template<typename T>
+    T* fake(uintptr_t id) { return reinterpret_cast<T*>(id * 16); }
+
+    D3D12_RESOURCE_BARRIER transition(uintptr_t resource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after)
+    {
+        D3D12_RESOURCE_BARRIER barrier = {};
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barrier.Transition.pResource = fake<ID3D12Resource>(resource);
+        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+        barrier.Transition.StateBefore = before;
+        barrier.Transition.StateAfter = after;
+        return barrier;
+    }
+}
+
+TEST_CASE("pipeline state and root signature")
+{
+    MockCommandList mock;
+    MockFiltered cmd(&mock);
+
+    cmd.SetPipelineState(fake<ID3D12PipelineState>(1));
+    cmd.SetPipelineState(fake<ID3D12PipelineState>(1));
+    cmd.SetPipelineState(fake<ID3D12PipelineState>(2));
+    CHECK(mock.count("PSO") == 2);
+
+    cmd.SetGraphicsRootSignature(fake<ID3D12RootSignature>(1));
+    cmd.SetGraphicsRootSignature(fake<ID3D12RootSignature>(1));
+    CHECK(mock.count("RootSignature") == 1);
+
+    CHECK(cmd.getStats().issued[size_t(Call::PipelineState)] == 2);
+    CHECK(cmd.getStats().filtered[size_t(Call::PipelineState)] == 1);
+    CHECK(cmd.getStats().filtered[size_t(Call::RootSignature)] == 1);
+}
+
+TEST_CASE("root arguments go stale with a new root signature")
+{
+    MockCommandList mock;
+    MockFiltered cmd(&mock);
+
+    cmd.SetGraphicsRootSignature(fake<ID3D12RootSignature>(1));
+    cmd.SetGraphicsRootConstantBufferView(0, 0x1000);
+    cmd.SetGraphicsRootConstantBufferView(0, 0x1000);
+    cmd.SetGraphicsRootShaderResourceView(1, 0x2000);
+    cmd.SetGraphicsRootShaderResourceView(1, 0x3000);
+    CHECK(mock.count("CBV") == 1);
+    CHECK(mock.count("SRV") == 2);
+
+    // Same address, new signature: issued again
+    cmd.SetGraphicsRootSignature(fake<ID3D12RootSignature>(2));
+    cmd.SetGraphicsRootConstantBufferView(0, 0x1000);
+    CHECK(mock.count("CBV") == 2);
+
+    // Same value, other kind of root argument
+    cmd.SetGraphicsRootShaderResourceView(0, 0x1000);
+    CHECK(mock.count("SRV") == 3);
+}
+
+TEST_CASE("root constants compare per DWORD")
+{
+    MockCommandList mock;
+    MockFiltered cmd(&mock);
+
+    const uint32_t a[4] = { 1, 2, 3, 4 };
+    const uint32_t b[4] = { 1, 2, 3, 5 };
+
+    cmd.SetGraphicsRoot32BitConstants(2, 4, a, 0);
+    cmd.SetGraphicsRoot32BitConstants(2, 4, a, 0);
+    CHECK(mock.count("Constants") == 1);
+
+    // A cached subrange
+    cmd.SetGraphicsRoot32BitConstants(2, 2, a + 1, 1);
+    CHECK(mock.count("Constants") == 1);
+
+    cmd.SetGraphicsRoot32BitConstants(2, 4, b, 0);
+    CHECK(mock.count("Constants") == 2);
+
+    // Past what was written: not cached yet
+    cmd.SetGraphicsRoot32BitConstants(2, 1, a, 4);
+    CHECK(mock.count("Constants") == 3);
+}
+
+TEST_CASE("descriptor heaps invalidate tables only")
+{
+    MockCommandList mock;
+    MockFiltered cmd(&mock);
+
+    ID3D12DescriptorHeap* heaps[2] = { fake<ID3D12DescriptorHeap>(1), fake<ID3D12DescriptorHeap>(2) };
+    ID3D12DescriptorHeap* other[2] = { fake<ID3D12DescriptorHeap>(1), fake<ID3D12DescriptorHeap>(3) };
+
+    cmd.SetDescriptorHeaps(2, heaps);
+    cmd.SetDescriptorHeaps(2, heaps);
+    CHECK(mock.count("DescriptorHeaps") == 1);
+
+    cmd.SetGraphicsRootDescriptorTable(0, { 0x100 });
+    cmd.SetGraphicsRootConstantBufferView(1, 0x1000);
+    cmd.SetGraphicsRootDescriptorTable(0, { 0x100 });
+    CHECK(mock.count("Table") == 1);
+
+    cmd.SetDescriptorHeaps(2, other);
+    CHECK(mock.count("DescriptorHeaps") == 2);
+
+    cmd.SetGraphicsRootDescriptorTable(0, { 0x100 });
+    cmd.SetGraphicsRootConstantBufferView(1, 0x1000);
+    CHECK(mock.count("Table") == 2);
+    CHECK(mock.count("CBV") == 1);
+}
+
+TEST_CASE("topology, vertex and index buffers")
+{
+    MockCommandList mock;
+    MockFiltered cmd(&mock);
+
+    cmd.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    cmd.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    cmd.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_LINELIST);
+    CHECK(mock.count("Topology") == 2);
+
+    D3D12_VERTEX_BUFFER_VIEW vb[2] = { { 0x1000, 256, 32 }, { 0x2000, 128, 16 } };
+    cmd.IASetVertexBuffers(0, 2, vb);
+    cmd.IASetVertexBuffers(0, 2, vb);
+    cmd.IASetVertexBuffers(1, 1, &vb[1]);
+    CHECK(mock.count("VertexBuffers") == 1);
+
+    // Any field of the view counts
+    D3D12_VERTEX_BUFFER_VIEW stride = vb[0];
+    stride.StrideInBytes = 16;
+    cmd.IASetVertexBuffers(0, 1, &stride);
+    CHECK(mock.count("VertexBuffers") == 2);
+
+    // Unbinding is always forwarded
+    cmd.IASetVertexBuffers(0, 1, nullptr);
+    cmd.IASetVertexBuffers(0, 1, &stride);
+    CHECK(mock.count("VertexBuffers") == 4);
+
+    D3D12_INDEX_BUFFER_VIEW ib = { 0x3000, 600, DXGI_FORMAT_R16_UINT };
+    cmd.IASetIndexBuffer(&ib);
+    cmd.IASetIndexBuffer(&ib);
+    CHECK(mock.count("IndexBuffer") == 1);
+
+    ib.Format = DXGI_FORMAT_R32_UINT;
+    cmd.IASetIndexBuffer(&ib);
+    CHECK(mock.count("IndexBuffer") == 2);
+
+    CHECK(cmd.getStats().filtered[size_t(Call::Topology)] == 1);
+    CHECK(cmd.getStats().filtered[size_t(Call::VertexBuffers)] == 2);
+    CHECK(cmd.getStats().filtered[size_t(Call::IndexBuffer)] == 1);
+}
+
+TEST_CASE("barriers drop no-op transitions only")
+{
+    MockCommandList mock;
+    MockFiltered cmd(&mock);
+
+    D3D12_RESOURCE_BARRIER barriers[4] =
+    {
+        transition(1, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+        transition(2, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_DEST),
+        {},
+        transition(3, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST),
+    };
+    barriers[2].Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+    barriers[2].UAV.pResource = fake<ID3D12Resource>(4);
+
+    cmd.ResourceBarrier(4, barriers);
+
+    // One call, the no-op left out, order kept
+    REQUIRE(mock.barrierBatches.size() == 1);
+    REQUIRE(mock.barriers.size() == 3);
+    CHECK(mock.barriers[0].Transition.pResource == fake<ID3D12Resource>(1));
+    CHECK(mock.barriers[1].Type == D3D12_RESOURCE_BARRIER_TYPE_UAV);
+    CHECK(mock.barriers[2].Transition.pResource == fake<ID3D12Resource>(3));
+
+    // Barriers are commands, not state: the same batch again is forwarded
+    cmd.ResourceBarrier(1, barriers);
+    CHECK(mock.barrierBatches.size() == 2);
+
+    // Nothing left: no call at all
+    cmd.ResourceBarrier(1, &barriers[1]);
+    CHECK(mock.barrierBatches.size() == 2);
+
+    CHECK(cmd.getStats().issued[size_t(Call::Barriers)] == 4);
+    CHECK(cmd.getStats().filtered[size_t(Call::Barriers)] == 2);
+}
+
+TEST_CASE("large barrier batches are split")
+{
+    MockCommandList mock;
+    MockFiltered cmd(&mock);
+
+    std::vector<D3D12_RESOURCE_BARRIER> barriers;
+    for (uintptr_t i = 0; i < MockFiltered::MAX_BARRIER_BATCH * 2 + 3; ++i)
+        barriers.push_back(transition(i + 1, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_SOURCE));
+
+    cmd.ResourceBarrier(UINT(barriers.size()), barriers.data());
+
+    REQUIRE(mock.barriers.size() == barriers.size());
+    CHECK(mock.barrierBatches.size() == 3);
+    for (size_t i = 0; i < barriers.size(); ++i)
+        CHECK(mock.barriers[i].Transition.pResource == barriers[i].Transition.pResource);
+}
+
+TEST_CASE("reset and invalidate forget the cache")
+{
+    MockCommandList first, second;
+    MockFiltered cmd(&first);
+
+    cmd.SetPipelineState(fake<ID3D12PipelineState>(1));
+    cmd.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    cmd.reset(&second);
+    cmd.SetPipelineState(fake<ID3D12PipelineState>(1));
+    cmd.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    CHECK(second.count("PSO") == 1);
+    CHECK(second.count("Topology") == 1);
+
+    // State recorded through get() is not seen by the cache
+    cmd.invalidate();
+    cmd.SetPipelineState(fake<ID3D12PipelineState>(1));
+    CHECK(second.count("PSO") == 2);
+    CHECK(cmd.get() == &second);
+}
+
+TEST_CASE("stats of parallel lists add up")
+{
+    MockCommandList mock;
+    MockFiltered a(&mock), b(&mock);
+
+    a.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    a.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    b.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    a.addStats(b.getStats());
+    CHECK(a.getStats().totalIssued() == 2);
+    CHECK(a.getStats().totalFiltered() == 1);
+
+    a.resetStats();
+    CHECK(a.getStats().totalIssued() == 0);
+}
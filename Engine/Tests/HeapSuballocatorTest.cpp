@@ -0,0 +1,396 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "HeapSuballocator.h"
+
+namespace
+{
+    constexpr uint64_t KB = 1024;
+    constexpr uint64_t MB = 1024 * KB;
+
+    using Allocation = HeapSuballocator::Allocation;
+
+    // Live blocks never overlap and every byte is either used or free
+    bool consistent(const HeapSuballocator& heap, const std::vector<Allocation>& live)
+    {
+        std::vector<Allocation> sorted = live;
+        std::sort(sorted.begin(), sorted.end(), [](const Allocation& a, const Allocation& b) { return a.offset < b.offset; });
+
+        uint64_t used = 0;
+        for (size_t i = 0; i < sorted.size(); ++i)
+        {
+            if (sorted[i].offset + sorted[i].size > heap.getCapacity())
+                return false;
+            if (i > 0 && sorted[i - 1].offset + sorted[i - 1].size > sorted[i].offset)
+                return false;
+            used += sorted[i].size;
+        }
+
+        const HeapSuballocator::Stats stats = heap.getStats();
+        return stats.used == used && stats.used + stats.free == stats.capacity && stats.allocations == live.size();
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Allocate / free
+// ----------------------------------------------------------------------------
+
+TEST_CASE("allocate rounds to the granularity and packs from offset 0")
+{
+    HeapSuballocator heap(1 * MB + 100);
+    CHECK(heap.getCapacity() == 1 * MB);
+    CHECK(heap.isEmpty());
+
+    Allocation a = heap.allocate(1000);
+    Allocation b = heap.allocate(1);
+    Allocation c = heap.allocate(256);
+    REQUIRE(a.isValid() && b.isValid() && c.isValid());
+
+    CHECK(a.offset == 0 && a.size == 1024);
+    CHECK(b.offset == 1024 && b.size == 256);
+    CHECK(c.offset == 1280 && c.size == 256);
+    CHECK(heap.getOffset(b.handle) == b.offset);
+    CHECK(heap.getSize(a.handle) == a.size);
+
+    HeapSuballocator::Stats stats = heap.getStats();
+    CHECK(stats.used == 1536);
+    CHECK(stats.free == 1 * MB - 1536);
+    CHECK(stats.allocations == 3);
+    CHECK(stats.freeBlocks == 1);
+
+    heap.free(a.handle);
+    heap.free(b.handle);
+    heap.free(c.handle);
+    CHECK(heap.isEmpty());
+    CHECK(heap.getStats().used == 0);
+}
+
+TEST_CASE("freed space is reused")
+{
+    HeapSuballocator heap(1 * MB);
+
+    Allocation a = heap.allocate(64 * KB);
+    Allocation b = heap.allocate(64 * KB);
+    heap.free(a.handle);
+
+    // Same size goes back where a was
+    Allocation c = heap.allocate(64 * KB);
+    CHECK(c.offset == 0);
+    CHECK(b.offset == 64 * KB);
+
+    heap.free(b.handle);
+    heap.free(c.handle);
+}
+
+TEST_CASE("coalescing merges both neighbours")
+{
+    HeapSuballocator heap(1 * MB);
+
+    Allocation a = heap.allocate(16 * KB);
+    Allocation b = heap.allocate(16 * KB);
+    Allocation c = heap.allocate(16 * KB);
+    Allocation d = heap.allocate(16 * KB);
+    CHECK(heap.getStats().freeBlocks == 1);
+
+    // a on its own, c merges with nothing (b and d are live)
+    heap.free(a.handle);
+    heap.free(c.handle);
+    HeapSuballocator::Stats stats = heap.getStats();
+    CHECK(stats.freeBlocks == 3);
+    CHECK(stats.largestFree == 1 * MB - 64 * KB);
+
+    // b joins a (previous) and c (next)
+    heap.free(b.handle);
+    stats = heap.getStats();
+    CHECK(stats.freeBlocks == 2);
+    CHECK(stats.largestFree == 1 * MB - 64 * KB);
+    CHECK(stats.free == 1 * MB - 16 * KB);
+
+    // The merged block serves a request none of its parts could
+    Allocation big = heap.allocate(48 * KB);
+    REQUIRE(big.isValid());
+    CHECK(big.offset == 0);
+    heap.free(big.handle);
+
+    // d joins the front and the tail: one block again
+    heap.free(d.handle);
+    stats = heap.getStats();
+    CHECK(stats.freeBlocks == 1);
+    CHECK(stats.largestFree == 1 * MB);
+    CHECK(stats.fragmentation() == 0.0f);
+
+    Allocation all = heap.allocate(1 * MB);
+    CHECK(all.isValid() && all.offset == 0);
+}
+
+// ----------------------------------------------------------------------------
+// Alignment
+// ----------------------------------------------------------------------------
+
+TEST_CASE("placement alignments: 256 B, 4 KB, 64 KB")
+{
+    HeapSuballocator heap(4 * MB);
+
+    // Misalign the front on purpose
+    Allocation small = heap.allocate(256);
+    CHECK(small.offset == 0);
+
+    Allocation texture = heap.allocate(10 * KB, 4 * KB);
+    REQUIRE(texture.isValid());
+    CHECK(texture.offset == 4 * KB);
+    CHECK(texture.size == 10 * KB);
+
+    Allocation buffer = heap.allocate(100 * KB, 64 * KB);
+    REQUIRE(buffer.isValid());
+    CHECK(buffer.offset == 64 * KB);
+
+    // The padding in front of both went back to the free lists
+    Allocation fill = heap.allocate(3 * KB + 768);
+    REQUIRE(fill.isValid());
+    CHECK(fill.offset == 256);
+
+    Allocation gap = heap.allocate(256, 256);
+    REQUIRE(gap.isValid());
+    CHECK(gap.offset >= 14 * KB && gap.offset < 64 * KB);
+
+    // Smaller alignments are raised to the granularity
+    Allocation odd = heap.allocate(100, 16);
+    REQUIRE(odd.isValid());
+    CHECK(odd.offset % HeapSuballocator::GRANULARITY == 0);
+
+    std::vector<Allocation> live = { small, texture, buffer, fill, gap, odd };
+    CHECK(consistent(heap, live));
+}
+
+TEST_CASE("random sizes and alignments stay aligned and disjoint")
+{
+    const uint64_t alignments[] = { 256, 4 * KB, 64 * KB };
+
+    HeapSuballocator heap(16 * MB);
+    std::vector<Allocation> live;
+    std::mt19937 random(1234);
+
+    for (int step = 0; step < 4000; ++step)
+    {
+        if (live.empty() || random() % 3 != 0)
+        {
+            const uint64_t alignment = alignments[random() % 3];
+            const uint64_t size = 1 + random() % (alignment == 256 ? 8 * KB : 256 * KB);
+
+            Allocation allocation = heap.allocate(size, alignment);
+            if (!allocation.isValid())
+                continue;
+
+            CHECK(allocation.offset % alignment == 0);
+            CHECK(allocation.size >= size && allocation.size % HeapSuballocator::GRANULARITY == 0);
+            live.push_back(allocation);
+        }
+        else
+        {
+            const size_t i = random() % live.size();
+            heap.free(live[i].handle);
+            live[i] = live.back();
+            live.pop_back();
+        }
+
+        if (step % 100 == 0)
+            REQUIRE(consistent(heap, live));
+    }
+
+    REQUIRE(consistent(heap, live));
+
+    for (const Allocation& allocation : live)
+        heap.free(allocation.handle);
+
+    // Everything merged back
+    HeapSuballocator::Stats stats = heap.getStats();
+    CHECK(stats.freeBlocks == 1);
+    CHECK(stats.largestFree == 16 * MB);
+}
+
+// ----------------------------------------------------------------------------
+// Out of space
+// ----------------------------------------------------------------------------
+
+TEST_CASE("out of space returns an invalid allocation")
+{
+    HeapSuballocator heap(64 * KB);
+
+    CHECK(!heap.allocate(64 * KB + 1).isValid());
+    CHECK(!heap.allocate(1 * MB).isValid());
+
+    Allocation all = heap.allocate(64 * KB);
+    REQUIRE(all.isValid());
+    CHECK(!heap.allocate(256).isValid());
+
+    // Failures change nothing
+    HeapSuballocator::Stats stats = heap.getStats();
+    CHECK(stats.used == 64 * KB && stats.allocations == 1);
+
+    heap.free(all.handle);
+    CHECK(heap.allocate(256).isValid());
+}
+
+TEST_CASE("out of space: enough bytes but no block big enough")
+{
+    HeapSuballocator heap(64 * KB);
+
+    Allocation parts[4];
+    for (Allocation& part : parts)
+        part = heap.allocate(16 * KB);
+
+    heap.free(parts[0].handle);
+    heap.free(parts[2].handle);
+
+    HeapSuballocator::Stats stats = heap.getStats();
+    CHECK(stats.free == 32 * KB);
+    CHECK(stats.largestFree == 16 * KB);
+    CHECK(stats.fragmentation() == 0.5f);
+
+    CHECK(!heap.allocate(32 * KB).isValid());
+    CHECK(heap.allocate(16 * KB).isValid());
+}
+
+TEST_CASE("out of space: alignment padding does not fit")
+{
+    HeapSuballocator heap(128 * KB);
+
+    Allocation front = heap.allocate(256);
+    Allocation aligned = heap.allocate(32 * KB, 64 * KB);
+    REQUIRE(aligned.isValid());
+    CHECK(aligned.offset == 64 * KB);
+
+    // 64 KB - 256 B are free, but both 64 KB boundaries are taken
+    CHECK(!heap.allocate(64 * KB, 64 * KB).isValid());
+    CHECK(!heap.allocate(32 * KB, 64 * KB).isValid());
+    CHECK(heap.allocate(32 * KB, 4 * KB).isValid());
+
+    heap.free(front.handle);
+}
+
+TEST_CASE("empty heap")
+{
+    HeapSuballocator heap(100);
+    CHECK(heap.getCapacity() == 0);
+    CHECK(!heap.allocate(1).isValid());
+    CHECK(heap.defragment().empty());
+}
+
+// ----------------------------------------------------------------------------
+// Defragmentation
+// ----------------------------------------------------------------------------
+
+TEST_CASE("defragment packs live blocks and reports where they went")
+{
+    HeapSuballocator heap(1 * MB);
+
+    Allocation a = heap.allocate(8 * KB);
+    Allocation hole1 = heap.allocate(20 * KB);
+    Allocation b = heap.allocate(4 * KB, 4 * KB);
+    Allocation hole2 = heap.allocate(32 * KB);
+    Allocation c = heap.allocate(64 * KB, 64 * KB);
+    Allocation d = heap.allocate(256);
+
+    heap.free(hole1.handle);
+    heap.free(hole2.handle);
+
+    const uint64_t aFrom = a.offset, bFrom = b.offset, cFrom = c.offset, dFrom = d.offset;
+    CHECK(heap.getStats().freeBlocks == 3);
+
+    std::vector<HeapSuballocator::Relocation> moves = heap.defragment();
+    REQUIRE(moves.size() == 4);
+
+    // Address order, every block once
+    CHECK(moves[0].handle == a.handle && moves[0].from == aFrom);
+    CHECK(moves[1].handle == b.handle && moves[1].from == bFrom);
+    CHECK(moves[2].handle == c.handle && moves[2].from == cFrom);
+    CHECK(moves[3].handle == d.handle && moves[3].from == dFrom);
+
+    // Packed from 0, alignments kept
+    CHECK(moves[0].to == 0);
+    CHECK(moves[1].to == 8 * KB);
+    CHECK(moves[2].to == 64 * KB);          // next 64 KB boundary after 12 KB: stays
+    CHECK(moves[3].to == 128 * KB);
+
+    for (const HeapSuballocator::Relocation& move : moves)
+    {
+        CHECK(move.to <= move.from);
+        CHECK(heap.getOffset(move.handle) == move.to);
+        CHECK(heap.getSize(move.handle) == move.size);
+    }
+
+    // The alignment gap and the tail are free; handles still work
+    HeapSuballocator::Stats stats = heap.getStats();
+    CHECK(stats.freeBlocks == 2);
+    CHECK(stats.largestFree == 1 * MB - 128 * KB - 256);
+    CHECK(stats.used + stats.free == stats.capacity);
+
+    Allocation gap = heap.allocate(52 * KB);
+    REQUIRE(gap.isValid());
+    CHECK(gap.offset == 12 * KB);
+
+    heap.free(b.handle);
+    heap.free(gap.handle);
+    heap.free(a.handle);
+    heap.free(c.handle);
+    heap.free(d.handle);
+    CHECK(heap.getStats().freeBlocks == 1);
+}
+
+TEST_CASE("defragment relocations copy in place with memmove")
+{
+    const uint64_t alignments[] = { 256, 4 * KB, 64 * KB };
+
+    HeapSuballocator heap(4 * MB);
+    std::vector<uint8_t> memory(heap.getCapacity(), 0);
+    std::vector<Allocation> live;
+    std::mt19937 random(99);
+
+    auto pattern = [](uint32_t handle, uint64_t i) { return uint8_t(handle * 31 + i * 7); };
+
+    // Fragment the heap, filling every block with a pattern of its own
+    for (int i = 0; i < 200; ++i)
+    {
+        Allocation allocation = heap.allocate(1 + random() % (32 * KB), alignments[random() % 3]);
+        if (!allocation.isValid())
+            break;
+        for (uint64_t b = 0; b < allocation.size; ++b)
+            memory[allocation.offset + b] = pattern(allocation.handle, b);
+        live.push_back(allocation);
+    }
+    for (size_t i = 0; i < live.size(); i += 2)
+        heap.free(live[i].handle);
+
+    std::vector<Allocation> kept;
+    for (size_t i = 1; i < live.size(); i += 2)
+        kept.push_back(live[i]);
+
+    const float before = heap.getStats().fragmentation();
+
+    std::vector<HeapSuballocator::Relocation> moves = heap.defragment();
+    REQUIRE(moves.size() == kept.size());
+
+    for (const HeapSuballocator::Relocation& move : moves)
+        std::memmove(&memory[move.to], &memory[move.from], move.size);
+
+    for (Allocation& allocation : kept)
+    {
+        allocation.offset = heap.getOffset(allocation.handle);
+
+        bool intact = true;
+        for (uint64_t b = 0; b < allocation.size; ++b)
+            intact &= memory[allocation.offset + b] == pattern(allocation.handle, b);
+        CHECK(intact);
+    }
+
+    CHECK(consistent(heap, kept));
+    CHECK(heap.getStats().fragmentation() < before);
+
+    // Still a working heap
+    Allocation more = heap.allocate(1 * MB, 64 * KB);
+    CHECK(more.isValid());
+}
@@ -0,0 +1,139 @@
+// JobSystem benchmark: job throughput, parallelFor scaling over the grain
+// size and the latency of waking an idle worker. '--quick' runs a short
+// pass (ctest smoke run).
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "JobSystem.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double msSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Some arithmetic per element, so chunks are not free
+    float work(size_t i)
+    {
+        float x = float(i & 1023) * 0.001f;
+        for (int k = 0; k < 16; ++k)
+            x = std::sqrt(x * x + 1.0f) - 0.5f * x;
+        return x;
+    }
+
+    void benchThroughput(JobSystem& jobs, uint32_t count, uint32_t rounds)
+    {
+        std::atomic<uint32_t> executed{ 0 };
+        double best = 1e30;
+
+        for (uint32_t r = 0; r < rounds; ++r)
+        {
+            const Clock::time_point start = Clock::now();
+
+            JobCounter counter;
+            for (uint32_t i = 0; i < count; ++i)
+                jobs.run([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); }, &counter);
+            jobs.wait(counter);
+
+            best = std::min(best, msSince(start));
+        }
+
+        std::printf("run + wait     %7u empty jobs   %8.3f ms   %6.0f ns/job\n", count, best, best * 1e6 / count);
+    }
+
+    void benchParallelFor(JobSystem& jobs, size_t count, uint32_t rounds)
+    {
+        std::vector<float> out(count);
+
+        double serial = 1e30;
+        for (uint32_t r = 0; r < rounds; ++r)
+        {
+            const Clock::time_point start = Clock::now();
+            for (size_t i = 0; i < count; ++i)
+                out[i] = work(i);
+            serial = std::min(serial, msSince(start));
+        }
+        std::printf("serial         %7zu elements   %8.3f ms\n", count, serial);
+
+        const size_t grains[] = { 0, 64, 1024, 16384 };
+        for (size_t grain : grains)
+        {
+            double best = 1e30;
+            for (uint32_t r = 0; r < rounds; ++r)
+            {
+                const Clock::time_point start = Clock::now();
+                jobs.parallelFor(0, count, grain, [&out](size_t b, size_t e)
+                    {
+                        for (size_t i = b; i < e; ++i)
+                            out[i] = work(i);
+                    });
+                best = std::min(best, msSince(start));
+            }
+
+            std::printf("parallelFor    grain %6zu       %8.3f ms   x%.2f\n", grain, best, serial / best);
+        }
+    }
+
+    // Push from outside the system once every worker sleeps, time until a worker runs it
+    void benchWake(JobSystem& jobs, uint32_t samples)
+    {
+        std::vector<double> latency;
+        latency.reserve(samples);
+
+        for (uint32_t s = 0; s < samples; ++s)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+            std::atomic<bool> ran{ false };
+            Clock::time_point pushed, started;
+
+            std::thread outside([&]()
+                {
+                    pushed = Clock::now();
+                    jobs.run([&]()
+                        {
+                            started = Clock::now();
+                            ran.store(true, std::memory_order_release);
+                        });
+                });
+            outside.join();
+
+            while (!ran.load(std::memory_order_acquire))
+                std::this_thread::yield();
+
+            latency.push_back(std::chrono::duration<double, std::micro>(started - pushed).count());
+        }
+
+        std::sort(latency.begin(), latency.end());
+        std::printf("wake idle      %7u samples    median %.1f us   p99 %.1f us   max %.1f us\n", samples,
+            latency[latency.size() / 2], latency[latency.size() * 99 / 100], latency.back());
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool quick = false;
+    for (int i = 1; i < argc; ++i)
+        quick |= std::strcmp(argv[i], "--quick") == 0;
+
+    JobSystem jobs;
+    std::printf("JobSystem: %u workers%s\n", jobs.getWorkerCount(), quick ? " (quick)" : "");
+
+    benchThroughput(jobs, quick ? 10000 : 200000, quick ? 2 : 10);
+    benchParallelFor(jobs, quick ? 100000 : 4000000, quick ? 2 : 10);
+    benchWake(jobs, quick ? 20 : 500);
+
+    JobSystem::Stats stats = jobs.getStats();
+    std::printf("executed %llu, stolen %llu, inlined %llu\n", (unsigned long long)stats.executed,
+        (unsigned long long)stats.stolen, (unsigned long long)stats.inlined);
+    return 0;
+}
@@ -0,0 +1,417 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "JobSystem.h"
+
+namespace
+{
+    struct Item
+    {
+        uint32_t id = 0;
+    };
+
+    // Owner pushes / pops, 'thieves' threads steal: every item must come out exactly once
+    template<int64_t Capacity>
+    void raceDeque(uint32_t items, uint32_t thieves, uint32_t popEvery)
+    {
+        WorkDeque<Item, Capacity> deque;
+        std::vector<Item> storage(items);
+        std::unique_ptr<std::atomic<uint32_t>[]> taken(new std::atomic<uint32_t>[items]);
+        for (uint32_t i = 0; i < items; ++i)
+        {
+            storage[i].id = i;
+            taken[i] = 0;
+        }
+
+        std::atomic<bool> done{ false };
+        std::atomic<uint32_t> stolen{ 0 };
+
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < thieves; ++t)
+        {
+            threads.emplace_back([&]()
+                {
+                    while (!done.load(std::memory_order_acquire) || !deque.empty())
+                    {
+                        if (Item* item = deque.steal())
+                        {
+                            taken[item->id].fetch_add(1, std::memory_order_relaxed);
+                            stolen.fetch_add(1, std::memory_order_relaxed);
+                        }
+                    }
+                });
+        }
+
+        uint32_t popped = 0;
+        for (uint32_t i = 0; i < items; ++i)
+        {
+            while (!deque.push(&storage[i]))
+            {
+                // Full: the owner drains some itself
+                if (Item* item = deque.pop())
+                {
+                    taken[item->id].fetch_add(1, std::memory_order_relaxed);
+                    ++popped;
+                }
+            }
+
+            // Pops often hit the last element, the case that races the thieves
+            if (i % popEvery == 0)
+            {
+                if (Item* item = deque.pop())
+                {
+                    taken[item->id].fetch_add(1, std::memory_order_relaxed);
+                    ++popped;
+                }
+            }
+        }
+
+        while (Item* item = deque.pop())
+        {
+            taken[item->id].fetch_add(1, std::memory_order_relaxed);
+            ++popped;
+        }
+
+        done.store(true, std::memory_order_release);
+        for (std::thread& thread : threads)
+            thread.join();
+
+        uint32_t wrong = 0;
+        for (uint32_t i = 0; i < items; ++i)
+            wrong += taken[i].load() == 1 ? 0 : 1;
+
+        CHECK(wrong == 0);
+        CHECK(popped + stolen.load() == items);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// WorkDeque
+// ----------------------------------------------------------------------------
+
+TEST_CASE("deque: owner order and capacity")
+{
+    WorkDeque<Item, 4> deque;
+    Item items[5];
+
+    CHECK(deque.empty());
+    CHECK(deque.pop() == nullptr);
+    CHECK(deque.steal() == nullptr);
+
+    for (int i = 0; i < 4; ++i)
+        CHECK(deque.push(&items[i]));
+    CHECK(!deque.push(&items[4]));
+
+    // Owner: LIFO, thieves: FIFO
+    CHECK(deque.pop() == &items[3]);
+    CHECK(deque.steal() == &items[0]);
+    CHECK(deque.push(&items[4]));
+    CHECK(deque.pop() == &items[4]);
+    CHECK(deque.pop() == &items[2]);
+    CHECK(deque.pop() == &items[1]);
+    CHECK(deque.pop() == nullptr);
+    CHECK(deque.empty());
+}
+
+TEST_CASE("deque: push / pop / steal races")
+{
+    const uint32_t thieves = std::max(2u, std::min(std::thread::hardware_concurrency(), 8u));
+
+    raceDeque<4096>(200000, thieves, 3);
+    raceDeque<4096>(200000, thieves, 1);        // owner and thieves fight for every element
+    raceDeque<8>(100000, thieves, 5);           // small ring: wraps around and fills up
+}
+
+// ----------------------------------------------------------------------------
+// Counters
+// ----------------------------------------------------------------------------
+
+TEST_CASE("wait returns after every job of the counter")
+{
+    JobSystem jobs(4);
+
+    for (int round = 0; round < 50; ++round)
+    {
+        std::atomic<int> executed{ 0 };
+        JobCounter counter;
+
+        for (int i = 0; i < 1000; ++i)
+            jobs.run([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); }, &counter);
+
+        jobs.wait(counter);
+        CHECK(counter.isDone());
+        CHECK(executed.load() == 1000);
+    }
+}
+
+TEST_CASE("wait inside a job and from outside threads")
+{
+    JobSystem jobs(3);
+
+    // A job waiting on its own jobs runs them meanwhile (no deadlock with few workers)
+    std::atomic<int> inner{ 0 };
+    JobCounter outer;
+    for (int i = 0; i < 16; ++i)
+    {
+        jobs.run([&]()
+            {
+                JobCounter local;
+                for (int j = 0; j < 64; ++j)
+                    jobs.run([&inner]() { inner.fetch_add(1, std::memory_order_relaxed); }, &local);
+                jobs.wait(local);
+            }, &outer);
+    }
+    jobs.wait(outer);
+    CHECK(inner.load() == 16 * 64);
+
+    // Threads outside the system go through the injection queue
+    std::atomic<int> injected{ 0 };
+    JobCounter external;
+    std::thread thread([&]()
+        {
+            for (int i = 0; i < 500; ++i)
+                jobs.run([&injected]() { injected.fetch_add(1, std::memory_order_relaxed); }, &external);
+            jobs.wait(external);
+        });
+    thread.join();
+    CHECK(injected.load() == 500);
+    CHECK(external.isDone());
+}
+
+TEST_CASE("jobs pushed after the workers fell asleep still run")
+{
+    JobSystem jobs(4);
+
+    // The workers go idle between rounds; every push has to wake one of them
+    for (int round = 0; round < 200; ++round)
+    {
+        if (round % 20 == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+        std::atomic<bool> ran{ false };
+        std::thread::id runner;
+        JobCounter counter;
+
+        std::thread outside([&]()
+            {
+                jobs.run([&]()
+                    {
+                        runner = std::this_thread::get_id();
+                        ran.store(true, std::memory_order_release);
+                    }, &counter);
+            });
+        outside.join();
+
+        // Not wait(): the main thread would run the job itself
+        const auto start = std::chrono::steady_clock::now();
+        while (!counter.isDone() && std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+            std::this_thread::yield();
+
+        REQUIRE(ran.load(std::memory_order_acquire));
+        CHECK(runner != std::this_thread::get_id());
+    }
+}
+
+// ----------------------------------------------------------------------------
+// runChild
+// ----------------------------------------------------------------------------
+
+TEST_CASE("runChild: the parent counter covers children and grandchildren")
+{
+    JobSystem jobs(4);
+
+    for (int round = 0; round < 20; ++round)
+    {
+        std::atomic<int> children{ 0 };
+        std::atomic<int> grandchildren{ 0 };
+        JobCounter counter;
+
+        for (int p = 0; p < 8; ++p)
+        {
+            jobs.run([&]()
+                {
+                    for (int c = 0; c < 8; ++c)
+                    {
+                        jobs.runChild([&]()
+                            {
+                                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                                children.fetch_add(1, std::memory_order_relaxed);
+                                jobs.runChild([&]() { grandchildren.fetch_add(1, std::memory_order_relaxed); });
+                            });
+                    }
+                }, &counter);
+        }
+
+        jobs.wait(counter);
+        CHECK(children.load() == 64);
+        CHECK(grandchildren.load() == 64);
+    }
+}
+
+TEST_CASE("runChild outside a job has no counter")
+{
+    JobSystem jobs(2);
+
+    std::atomic<int> ran{ 0 };
+    jobs.runChild([&ran]() { ran.fetch_add(1); });
+
+    JobCounter fence;
+    jobs.run([]() {}, &fence);
+    jobs.wait(fence);
+
+    while (ran.load() == 0)
+        std::this_thread::yield();
+    CHECK(ran.load() == 1);
+}
+
+// ----------------------------------------------------------------------------
+// Main-thread queue
+// ----------------------------------------------------------------------------
+
+TEST_CASE("main-thread jobs run on the main thread")
+{
+    JobSystem jobs(4);
+    const std::thread::id mainThread = std::this_thread::get_id();
+    CHECK(jobs.isMainThread());
+
+    // Queued from workers, run while the main thread waits
+    std::atomic<int> onMain{ 0 }, elsewhere{ 0 };
+    JobCounter counter;
+    for (int i = 0; i < 64; ++i)
+    {
+        jobs.run([&]()
+            {
+                jobs.runOnMainThread([&]()
+                    {
+                        (std::this_thread::get_id() == mainThread ? onMain : elsewhere).fetch_add(1);
+                    }, &counter);
+            }, &counter);
+    }
+    jobs.wait(counter);
+    CHECK(onMain.load() == 64);
+    CHECK(elsewhere.load() == 0);
+
+    // Without a wait they run in processMainThreadJobs(), in order
+    std::vector<int> order;
+    for (int i = 0; i < 4; ++i)
+        jobs.runOnMainThread([&order, i]() { order.push_back(i); });
+    CHECK(order.empty());
+
+    jobs.processMainThreadJobs();
+    CHECK((order == std::vector<int>{ 0, 1, 2, 3 }));
+}
+
+TEST_CASE("a worker waiting on a main-thread job does not run it")
+{
+    JobSystem jobs(2);
+    const std::thread::id mainThread = std::this_thread::get_id();
+
+    std::atomic<bool> onMain{ false };
+    JobCounter outer;
+    jobs.run([&]()
+        {
+            JobCounter inner;
+            jobs.runOnMainThread([&]() { onMain = std::this_thread::get_id() == mainThread; }, &inner);
+            jobs.wait(inner);
+        }, &outer);
+
+    jobs.wait(outer);
+    CHECK(onMain.load());
+}
+
+// ----------------------------------------------------------------------------
+// parallelFor
+// ----------------------------------------------------------------------------
+
+TEST_CASE("parallelFor covers the range once, in chunks of at most the grain")
+{
+    JobSystem jobs(4);
+
+    struct Case { size_t begin, end, grain; };
+    const Case cases[] = { { 0, 100000, 64 }, { 17, 10017, 1 }, { 5, 1000, 999 }, { 0, 65536, 0 }, { 3, 4, 16 } };
+
+    for (const Case& c : cases)
+    {
+        std::vector<std::atomic<uint8_t>> hits(c.end);
+        std::atomic<size_t> chunks{ 0 };
+        std::atomic<size_t> largest{ 0 };
+
+        jobs.parallelFor(c.begin, c.end, c.grain, [&](size_t b, size_t e)
+            {
+                chunks.fetch_add(1, std::memory_order_relaxed);
+                size_t size = e - b, seen = largest.load();
+                while (size > seen && !largest.compare_exchange_weak(seen, size)) {}
+
+                for (size_t i = b; i < e; ++i)
+                    hits[i].fetch_add(1, std::memory_order_relaxed);
+            });
+
+        size_t wrong = 0;
+        for (size_t i = 0; i < c.end; ++i)
+            wrong += hits[i].load() == (i >= c.begin ? 1 : 0) ? 0 : 1;
+        CHECK(wrong == 0);
+
+        // Halving stops at the grain: chunks are more than half of it
+        const size_t grain = c.grain ? c.grain : std::max<size_t>(1, (c.end - c.begin) / (size_t(jobs.getThreadCount()) * 8));
+        CHECK(largest.load() <= std::max(grain, size_t(1)));
+        if (c.end - c.begin > grain)
+        {
+            CHECK(chunks.load() >= (c.end - c.begin) / grain);
+            CHECK(chunks.load() <= 2 * (c.end - c.begin) / grain + 1);
+        }
+        else
+        {
+            CHECK(chunks.load() == 1);
+        }
+    }
+}
+
+TEST_CASE("parallelFor: small and empty ranges run on the caller")
+{
+    JobSystem jobs(2);
+    const std::thread::id caller = std::this_thread::get_id();
+
+    int calls = 0;
+    jobs.parallelFor(10, 10, 1, [&](size_t, size_t) { ++calls; });
+    jobs.parallelFor(10, 5, 1, [&](size_t, size_t) { ++calls; });
+    CHECK(calls == 0);
+
+    bool onCaller = false;
+    jobs.parallelFor(0, 8, 8, [&](size_t b, size_t e) { onCaller = std::this_thread::get_id() == caller && b == 0 && e == 8; });
+    CHECK(onCaller);
+}
+
+TEST_CASE("parallelFor spreads over the workers and nests")
+{
+    JobSystem jobs(4);
+
+    std::mutex mutex;
+    std::vector<std::thread::id> threads;
+    std::atomic<size_t> sum{ 0 };
+
+    jobs.parallelFor(0, 64, 1, [&](size_t b, size_t e)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (std::find(threads.begin(), threads.end(), std::this_thread::get_id()) == threads.end())
+                    threads.push_back(std::this_thread::get_id());
+            }
+
+            // Nested loops wait inside a job
+            for (size_t i = b; i < e; ++i)
+            {
+                jobs.parallelFor(0, 256, 16, [&](size_t ib, size_t ie) { sum.fetch_add(ie - ib, std::memory_order_relaxed); });
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        });
+
+    CHECK(sum.load() == 64 * 256);
+    CHECK(threads.size() > 1);
+    CHECK(jobs.getStats().stolen > 0);
+}
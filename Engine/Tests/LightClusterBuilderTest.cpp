@@ -0,0 +1,281 @@
+#include "Test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "JobSystem.h"
+#include "LightClusterBuilder.h"
+#include "LightManager.h"
+
+using namespace DirectX;
+
+namespace
+{
+    using Settings = LightClusterBuilder::Settings;
+
+    // Right handed view matrix (XMMatrixLookToRH), looking along yaw / pitch from 'eye'
+    XMFLOAT4X4 lookTo(const XMFLOAT3& eye, float yaw, float pitch)
+    {
+        const XMFLOAT3 forward(sinf(yaw) * cosf(pitch), sinf(pitch), -cosf(yaw) * cosf(pitch));
+        const XMFLOAT3 back(-forward.x, -forward.y, -forward.z);
+
+        // right = normalize(cross(up, back)), up' = cross(back, right)
+        XMFLOAT3 right(back.z, 0.0f, -back.x);
+        const float length = sqrtf(right.x * right.x + right.z * right.z);
+        right = XMFLOAT3(right.x / length, 0.0f, right.z / length);
+        const XMFLOAT3 up(back.y * right.z - back.z * right.y, back.z * right.x - back.x * right.z, back.x * right.y - back.y * right.x);
+
+        auto dot = [&eye](const XMFLOAT3& v) { return v.x * eye.x + v.y * eye.y + v.z * eye.z; };
+
+        return XMFLOAT4X4(
+            right.x, up.x, back.x, 0.0f,
+            right.y, up.y, back.y, 0.0f,
+            right.z, up.z, back.z, 0.0f,
+            -dot(right), -dot(up), -dot(back), 1.0f);
+    }
+
+    LightClusterBuilder::View makeView(const XMFLOAT3& eye, float yaw, float pitch, float aspect, float nearZ, float farZ)
+    {
+        LightClusterBuilder::View view;
+        view.view = lookTo(eye, yaw, pitch);
+        view.fovY = XM_PIDIV4;
+        view.aspect = aspect;
+        view.nearZ = nearZ;
+        view.farZ = farZ;
+        return view;
+    }
+
+    // Lights all around the origin: in front, behind, across the near plane,
+    // outside the frustum, tiny and huge, narrow and wide cones
+    void addRandomLights(LightManager& lights, std::mt19937& random, uint32_t pointCount, uint32_t spotCount, float extent)
+    {
+        std::uniform_real_distribution<float> position(-extent, extent);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> radius(0.05f, 0.25f * extent);
+        std::uniform_real_distribution<float> inner(0.05f, 0.6f);
+        std::uniform_real_distribution<float> extra(0.0f, 0.9f);
+
+        for (uint32_t i = 0; i < pointCount; ++i)
+        {
+            LightManager::PointLight light;
+            light.position = XMFLOAT3(position(random), position(random), position(random));
+            light.radius = radius(random);
+            lights.addPoint(light);
+        }
+
+        for (uint32_t i = 0; i < spotCount; ++i)
+        {
+            XMFLOAT3 direction(unit(random), unit(random), unit(random));
+            if (direction.x == 0.0f && direction.y == 0.0f && direction.z == 0.0f)
+                direction.y = -1.0f;
+
+            LightManager::SpotLight light;
+            light.position = XMFLOAT3(position(random), position(random), position(random));
+            light.direction = direction;
+            light.radius = radius(random);
+            light.innerAngle = inner(random);
+            light.outerAngle = light.innerAngle + extra(random);       // up to ~85 degrees: both bounding spheres
+            lights.addSpot(light);
+        }
+    }
+
+    uint32_t clusterCount(const LightClusterBuilder::ClusterRange& range)
+    {
+        return (range.counts & 0xFFFF) + (range.counts >> 16);
+    }
+
+    // Light slots of one cluster: points, then spots
+    std::vector<uint32_t> clusterLights(const LightClusterBuilder& builder, uint32_t x, uint32_t y, uint32_t z)
+    {
+        const LightClusterBuilder::ClusterRange& range = builder.getClusters()[builder.getClusterIndex(x, y, z)];
+        const std::vector<uint32_t>& indices = builder.getIndices();
+        return std::vector<uint32_t>(indices.begin() + range.offset, indices.begin() + range.offset + clusterCount(range));
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Fast path vs reference
+// ----------------------------------------------------------------------------
+
+TEST_CASE("build matches buildReference over random lights and grids")
+{
+    const Settings grids[] =
+    {
+        { 16, 9, 24 },          // default
+        { 1, 1, 1 },
+        { 7, 5, 3 },
+        { 3, 13, 64 },
+        { 32, 18, 48 },
+    };
+
+    // Counts that leave 0..3 padding lanes
+    const uint32_t counts[][2] = { { 0, 0 }, { 1, 0 }, { 0, 3 }, { 37, 22 }, { 400, 150 } };
+
+    std::mt19937 random(20240611);
+    std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+    std::uniform_real_distribution<float> tilt(-1.2f, 1.2f);
+
+    uint32_t checked = 0;
+    uint64_t totalIndices = 0;
+
+    for (const auto& count : counts)
+    {
+        LightManager lights;
+        addRandomLights(lights, random, count[0], count[1], 40.0f);
+
+        for (const Settings& grid : grids)
+        {
+            for (int v = 0; v < 3; ++v)
+            {
+                const float nearZ = v == 0 ? 0.1f : (v == 1 ? 0.5f : 2.0f);
+                const float farZ = v == 2 ? 60.0f : 200.0f;
+                const LightClusterBuilder::View view = makeView(XMFLOAT3(0.0f, 1.0f, 5.0f), angle(random), tilt(random),
+                    v == 1 ? 1.0f : 16.0f / 9.0f, nearZ, farZ);
+
+                LightClusterBuilder fast, reference;
+                fast.settings = grid;
+                reference.settings = grid;
+
+                fast.build(view, lights, nullptr);
+                reference.buildReference(view, lights);
+
+                CHECK(fast.getClusters().size() == size_t(grid.dimX) * grid.dimY * grid.dimZ);
+                CHECK(fast.compare(reference) == 0);
+                CHECK(reference.compare(fast) == 0);
+                CHECK(fast.getStats().indices == reference.getStats().indices);
+
+                totalIndices += reference.getStats().indices;
+                ++checked;
+            }
+        }
+    }
+
+    CHECK(checked == 5 * 5 * 3);
+    CHECK(totalIndices > 10000);        // the lights did land in clusters
+}
+
+TEST_CASE("build on the job system matches buildReference")
+{
+    JobSystem jobs(4);
+
+    std::mt19937 random(7);
+    LightManager lights;
+    addRandomLights(lights, random, 1000, 300, 60.0f);
+
+    // Removal swaps the last light into the hole: the slots must still line up
+    for (uint32_t id = 0; id < 1000; id += 7)
+        lights.remove(LightManager::POINT, id);
+    for (uint32_t id = 0; id < 300; id += 5)
+        lights.remove(LightManager::SPOT, id);
+
+    const LightClusterBuilder::View view = makeView(XMFLOAT3(3.0f, 2.0f, -4.0f), 0.7f, -0.2f, 16.0f / 9.0f, 0.1f, 150.0f);
+
+    LightClusterBuilder fast, reference;
+    reference.buildReference(view, lights);
+
+    // Twice: the per-slice scratch is reused across frames
+    for (int frame = 0; frame < 2; ++frame)
+    {
+        fast.build(view, lights, &jobs);
+        CHECK(fast.compare(reference) == 0);
+    }
+
+    CHECK(reference.getStats().nonEmptyClusters > 0);
+    CHECK(reference.getStats().maxLightsPerCluster > 1);
+}
+
+TEST_CASE("compare reports differing clusters")
+{
+    std::mt19937 random(3);
+    LightManager lights;
+    addRandomLights(lights, random, 200, 50, 30.0f);
+
+    const LightClusterBuilder::View view = makeView(XMFLOAT3(0.0f, 0.0f, 0.0f), 0.0f, 0.0f, 1.5f, 0.1f, 100.0f);
+
+    LightClusterBuilder a, b;
+    a.build(view, lights, nullptr);
+    b.buildReference(view, lights);
+    REQUIRE(a.compare(b) == 0);
+
+    // One light moved: a light list changes somewhere
+    const uint32_t id = 0;
+    LightManager::PointLight moved;
+    moved.position = XMFLOAT3(0.0f, 0.0f, -10.0f);
+    moved.radius = 1.0f;
+    lights.setPoint(id, moved);
+    b.buildReference(view, lights);
+    CHECK(a.compare(b) > 0);
+
+    // Different grids never compare equal
+    b.settings = { 8, 8, 8 };
+    b.buildReference(view, lights);
+    CHECK(a.compare(b) != 0);
+}
+
+// ----------------------------------------------------------------------------
+// Known placement
+// ----------------------------------------------------------------------------
+
+TEST_CASE("a light straight ahead lands in the centre clusters of its depth")
+{
+    LightManager lights;
+
+    LightManager::PointLight ahead;
+    ahead.position = XMFLOAT3(0.0f, 0.0f, -10.0f);      // identity view: looking down -z
+    ahead.radius = 0.25f;
+    const uint32_t aheadId = lights.addPoint(ahead);
+
+    LightManager::PointLight behind;
+    behind.position = XMFLOAT3(0.0f, 0.0f, 10.0f);
+    behind.radius = 2.0f;
+    lights.addPoint(behind);
+
+    LightManager::SpotLight spot;
+    spot.position = XMFLOAT3(0.0f, 0.0f, -5.0f);
+    spot.direction = XMFLOAT3(0.0f, 0.0f, -1.0f);
+    spot.radius = 10.0f;
+    spot.innerAngle = 0.05f;
+    spot.outerAngle = 0.1f;
+    lights.addSpot(spot);
+
+    const LightClusterBuilder::View view = makeView(XMFLOAT3(0.0f, 0.0f, 0.0f), 0.0f, 0.0f, 1.0f, 0.1f, 100.0f);
+
+    LightClusterBuilder builder;
+    builder.settings = { 15, 9, 24 };
+    builder.build(view, lights, nullptr);
+
+    const uint32_t slice = uint32_t(floorf(logf(10.0f) * builder.getDepthScale() + builder.getDepthBias()));
+    REQUIRE(slice < 24);
+
+    const uint32_t slot = lights.getSlot(LightManager::POINT, aheadId);
+    const std::vector<uint32_t> centre = clusterLights(builder, 7, 4, slice);
+    CHECK(std::find(centre.begin(), centre.end(), slot) != centre.end());
+
+    // Nowhere near the corners, and the light behind the camera is nowhere
+    CHECK(clusterLights(builder, 0, 0, slice).empty());
+    CHECK(clusterLights(builder, 14, 8, 0).empty());
+
+    uint32_t pointHits = 0;
+    for (const LightClusterBuilder::ClusterRange& range : builder.getClusters())
+        pointHits += range.counts & 0xFFFF;
+    CHECK(pointHits > 0 && pointHits < 10);
+
+    // The spot lights the centre from depth 5 to 15: after the point lights in the list
+    const std::vector<uint32_t> spotCentre = clusterLights(builder, 7, 4, slice);
+    const LightClusterBuilder::ClusterRange& range = builder.getClusters()[builder.getClusterIndex(7, 4, slice)];
+    CHECK((range.counts >> 16) == 1);
+    CHECK(spotCentre.back() == lights.getSlot(LightManager::SPOT, 0));
+}
+
+TEST_CASE("no lights: every cluster is empty")
+{
+    LightManager lights;
+    LightClusterBuilder builder;
+    builder.build(makeView(XMFLOAT3(0.0f, 0.0f, 0.0f), 0.0f, 0.0f, 1.0f, 0.1f, 100.0f), lights, nullptr);
+
+    CHECK(builder.getClusters().size() == 16 * 9 * 24);
+    CHECK(builder.getIndices().empty());
+    CHECK(builder.getStats().nonEmptyClusters == 0);
+}
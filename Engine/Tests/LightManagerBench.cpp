@@ -0,0 +1,144 @@
+// LightManager benchmark: dirty-slot uploads vs re-uploading every light
+// (setFullUpload), per frame, for fixed light counts and the share of lights
+// that move every frame. 'moved' lights are either the first ones (one run,
+// what Exercise8's orbiting lights do) or scattered at random (one copy each,
+// the worst case). Time is set*() + upload() on the CPU: packing into the
+// staging memory and finding the copy runs (the fake PersistentGpuBuffer
+// stands in for the ring buffer). '--quick' runs a short pass (ctest smoke
+// run).
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "LightManager.h"
+
+using namespace DirectX;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Result
+    {
+        double bytes = 0.0;     // per frame
+        double copies = 0.0;
+        double us = 0.0;
+    };
+
+    enum class Pattern { First, Scattered };
+
+    Result run(uint32_t pointCount, uint32_t spotCount, double changeRate, Pattern pattern, bool full, uint32_t frames)
+    {
+        LightManager lights;
+        lights.setFullUpload(full);
+
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+        std::vector<uint32_t> pointIds, spotIds;
+        std::vector<XMFLOAT3> centers;
+        for (uint32_t i = 0; i < pointCount; ++i)
+        {
+            LightManager::PointLight light;
+            light.position = XMFLOAT3(unit(random) * 50.0f, 1.0f, unit(random) * 50.0f);
+            light.radius = 2.0f;
+            centers.push_back(light.position);
+            pointIds.push_back(lights.addPoint(light));
+        }
+
+        for (uint32_t i = 0; i < spotCount; ++i)
+        {
+            LightManager::SpotLight light;
+            light.position = XMFLOAT3(unit(random) * 50.0f, 4.0f, unit(random) * 50.0f);
+            spotIds.push_back(lights.addSpot(light));
+        }
+
+        // First frame uploads everything in both modes
+        lights.upload(nullptr, nullptr);
+
+        const uint32_t moving = uint32_t(std::lround(double(pointCount) * changeRate));
+        std::vector<uint32_t> order(pointCount);
+        for (uint32_t i = 0; i < pointCount; ++i)
+            order[i] = i;
+
+        Result result;
+        double seconds = 0.0;
+
+        for (uint32_t frame = 1; frame <= frames; ++frame)
+        {
+            // Pick the lights outside the timed part
+            if (pattern == Pattern::Scattered)
+                std::shuffle(order.begin(), order.end(), random);
+
+            const Clock::time_point start = Clock::now();
+
+            const float phase = float(frame) * 0.1f;
+            for (uint32_t i = 0; i < moving; ++i)
+            {
+                const uint32_t light = order[i];
+                const XMFLOAT3& c = centers[light];
+                lights.setPointPosition(pointIds[light], XMFLOAT3(c.x + cosf(phase + float(light)), c.y, c.z + sinf(phase + float(light))));
+            }
+
+            lights.upload(nullptr, nullptr);
+
+            seconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+            const LightManager::Stats& stats = lights.getStats();
+            result.bytes += double(stats.uploadedBytes);
+            result.copies += double(stats.copies);
+        }
+
+        result.bytes /= frames;
+        result.copies /= frames;
+        result.us = seconds * 1e6 / frames;
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool quick = false;
+    for (int i = 1; i < argc; ++i)
+        quick |= std::strcmp(argv[i], "--quick") == 0;
+
+    const uint32_t frames = quick ? 20 : 500;
+    const uint32_t pointCounts[] = { 256, 1024, 4096, 16384 };
+    const double changeRates[] = { 0.0, 0.01, 0.1, 0.5, 1.0 };
+
+    std::printf("LightManager upload, %u frames per row, spots = points / 4 (never move)%s\n", frames, quick ? " (quick)" : "");
+    std::printf("%6s %6s %7s %10s | %12s %8s %9s | %12s %8s %9s | %7s\n", "points", "spots", "moved", "pattern",
+        "dirty B/fr", "copies", "us/fr", "full B/fr", "copies", "us/fr", "bytes");
+
+    for (uint32_t points : pointCounts)
+    {
+        if (quick && points > 1024)
+            break;
+
+        const uint32_t spots = points / 4;
+
+        for (double rate : changeRates)
+        {
+            for (Pattern pattern : { Pattern::First, Pattern::Scattered })
+            {
+                if (pattern == Pattern::Scattered && (rate == 0.0 || rate == 1.0))
+                    continue;
+
+                // Same lights, same changes: only the upload mode differs
+                const Result dirty = run(points, spots, rate, pattern, false, frames);
+                const Result full = run(points, spots, rate, pattern, true, frames);
+
+                std::printf("%6u %6u %6.0f%% %10s | %12.0f %8.1f %9.2f | %12.0f %8.1f %9.2f | %6.1f%%\n",
+                    points, spots, rate * 100.0, pattern == Pattern::First ? "first" : "scattered",
+                    dirty.bytes, dirty.copies, dirty.us, full.bytes, full.copies, full.us,
+                    full.bytes > 0.0 ? 100.0 * dirty.bytes / full.bytes : 0.0);
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,382 @@
+#include "Test.h"
+
+#include <d3d12.h>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+#include "PipelineHash.h"
+
+namespace
+{
+    // ------------------------------------------------------------------------
+    // Plain structs: the same state in two layouts
+    // ------------------------------------------------------------------------
+    struct RasterA
+    {
+        uint8_t  enable;        // 3 bytes of padding follow
+        uint32_t mask;
+        float    bias;
+        uint16_t slot;          // 2 bytes of tail padding
+    };
+
+    struct RasterB
+    {
+        float    bias;
+        uint16_t slot;
+        uint8_t  enable;        // 1 byte of padding
+        uint32_t mask;
+    };
+
+    // Canonical order, whatever the layout
+    template<typename T>
+    PipelineKey rasterKey(const T& state)
+    {
+        PipelineKeyWriter w;
+        w.write(state.enable);
+        w.write(state.mask);
+        w.writeFloat(state.bias);
+        w.write(state.slot);
+        return w.finish();
+    }
+
+    // ------------------------------------------------------------------------
+    // Graphics descriptions
+    // ------------------------------------------------------------------------
+    const uint8_t VS_CODE[] = { 0x44, 0x58, 0x42, 0x43, 1, 2, 3, 4, 5, 6, 7, 8 };
+    const uint8_t PS_CODE[] = { 0x44, 0x58, 0x42, 0x43, 8, 7, 6, 5, 4, 3, 2, 1, 0 };
+
+    struct Storage
+    {
+        std::vector<uint8_t> vs, ps;
+        std::string position, normal, streamName;
+        D3D12_INPUT_ELEMENT_DESC elements[2];
+        D3D12_SO_DECLARATION_ENTRY entries[1];
+        UINT strides[1];
+    };
+
+    // Writes every field of 'desc' (never reads it): whatever the memory held
+    // before, padding included, is left as it was
+    void fill(D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, Storage& s)
+    {
+        // Own copies: the key must not depend on where the data lives
+        s.vs.assign(VS_CODE, VS_CODE + sizeof(VS_CODE));
+        s.ps.assign(PS_CODE, PS_CODE + sizeof(PS_CODE));
+        s.position = "POSITION";
+        s.normal = "NORMAL";
+        s.streamName = "SV_Position";
+
+        s.elements[0] = { s.position.c_str(), 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+        s.elements[1] = { s.normal.c_str(), 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+        s.entries[0] = { 0, s.streamName.c_str(), 0, 0, 4, 0 };
+        s.strides[0] = 16;
+
+        desc.pRootSignature = nullptr;
+        desc.VS = { s.vs.data(), s.vs.size() };
+        desc.PS = { s.ps.data(), s.ps.size() };
+        desc.DS = { nullptr, 0 };
+        desc.HS = { nullptr, 0 };
+        desc.GS = { nullptr, 0 };
+
+        desc.StreamOutput.pSODeclaration = s.entries;
+        desc.StreamOutput.NumEntries = 1;
+        desc.StreamOutput.pBufferStrides = s.strides;
+        desc.StreamOutput.NumStrides = 1;
+        desc.StreamOutput.RasterizedStream = 0;
+
+        desc.BlendState.AlphaToCoverageEnable = FALSE;
+        desc.BlendState.IndependentBlendEnable = FALSE;
+        for (D3D12_RENDER_TARGET_BLEND_DESC& rt : desc.BlendState.RenderTarget)
+        {
+            rt.BlendEnable = FALSE;
+            rt.LogicOpEnable = FALSE;
+            rt.SrcBlend = D3D12_BLEND_ONE;
+            rt.DestBlend = D3D12_BLEND_ZERO;
+            rt.BlendOp = D3D12_BLEND_OP_ADD;
+            rt.SrcBlendAlpha = D3D12_BLEND_ONE;
+            rt.DestBlendAlpha = D3D12_BLEND_ZERO;
+            rt.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+            rt.LogicOp = D3D12_LOGIC_OP_NOOP;
+            rt.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+        }
+        desc.SampleMask = D3D12_DEFAULT_SAMPLE_MASK;
+
+        D3D12_RASTERIZER_DESC& raster = desc.RasterizerState;
+        raster.FillMode = D3D12_FILL_MODE_SOLID;
+        raster.CullMode = D3D12_CULL_MODE_BACK;
+        raster.FrontCounterClockwise = FALSE;
+        raster.DepthBias = 0;
+        raster.DepthBiasClamp = 0.0f;
+        raster.SlopeScaledDepthBias = 0.0f;
+        raster.DepthClipEnable = TRUE;
+        raster.MultisampleEnable = FALSE;
+        raster.AntialiasedLineEnable = FALSE;
+        raster.ForcedSampleCount = 0;
+        raster.ConservativeRaster = D3D12_CONSERVATIVE_RASTERIZATION_MODE_OFF;
+
+        D3D12_DEPTH_STENCIL_DESC& depth = desc.DepthStencilState;
+        depth.DepthEnable = TRUE;
+        depth.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ALL;
+        depth.DepthFunc = D3D12_COMPARISON_FUNC_LESS;
+        depth.StencilEnable = FALSE;
+        depth.StencilReadMask = 0xFF;
+        depth.StencilWriteMask = 0xFF;
+        depth.FrontFace = { D3D12_STENCIL_OP_KEEP, D3D12_STENCIL_OP_KEEP, D3D12_STENCIL_OP_KEEP, D3D12_COMPARISON_FUNC_ALWAYS };
+        depth.BackFace = depth.FrontFace;
+
+        desc.InputLayout = { s.elements, 2 };
+        desc.IBStripCutValue = D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_DISABLED;
+        desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+        desc.NumRenderTargets = 1;
+        for (DXGI_FORMAT& format : desc.RTVFormats)
+            format = DXGI_FORMAT_UNKNOWN;
+        desc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
+        desc.SampleDesc = { 1, 0 };
+        desc.NodeMask = 0;
+        desc.CachedPSO = { nullptr, 0 };
+        desc.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
+    }
+
+    // A description in memory pre-filled with 'pattern'
+    struct Desc
+    {
+        alignas(D3D12_GRAPHICS_PIPELINE_STATE_DESC) uint8_t memory[sizeof(D3D12_GRAPHICS_PIPELINE_STATE_DESC)];
+        Storage storage;
+
+        explicit Desc(uint8_t pattern = 0)
+        {
+            std::memset(memory, pattern, sizeof(memory));
+            fill(get(), storage);
+        }
+
+        Desc(const Desc&) = delete;
+        Desc& operator=(const Desc&) = delete;
+
+        D3D12_GRAPHICS_PIPELINE_STATE_DESC& get() { return *reinterpret_cast<D3D12_GRAPHICS_PIPELINE_STATE_DESC*>(memory); }
+        PipelineKey key(uint64_t rootSignatureHash = 0x1234) { return makeGraphicsPipelineKey(get(), rootSignatureHash); }
+    };
+
+    using Mutation = std::function<void(D3D12_GRAPHICS_PIPELINE_STATE_DESC&, Storage&)>;
+
+    struct NamedMutation
+    {
+        const char* name;
+        Mutation    apply;
+    };
+}
+
+// ----------------------------------------------------------------------------
+// PipelineKeyWriter
+// ----------------------------------------------------------------------------
+
+TEST_CASE("writer: layout and padding never reach the key")
+{
+    RasterA a;
+    RasterB b;
+    std::memset(&a, 0xAA, sizeof(a));
+    std::memset(&b, 0x55, sizeof(b));
+
+    a.enable = b.enable = 1;
+    a.mask = b.mask = 0xF0F0u;
+    a.bias = b.bias = 0.5f;
+    a.slot = b.slot = 3;
+
+    CHECK(std::memcmp(&a, &b, sizeof(a)) != 0);
+    CHECK(rasterKey(a) == rasterKey(b));
+    CHECK(rasterKey(a).hash == hashBytes(rasterKey(a).bytes.data(), rasterKey(a).bytes.size()));
+
+    b.slot = 4;
+    CHECK(rasterKey(a) != rasterKey(b));
+}
+
+TEST_CASE("writer: canonical values")
+{
+    auto floatKey = [](float value) { PipelineKeyWriter w; w.writeFloat(value); return w.finish(); };
+    CHECK(floatKey(0.0f) == floatKey(-0.0f));
+    CHECK(floatKey(1.0f) != floatKey(-1.0f));
+
+    auto stringKey = [](const char* text) { PipelineKeyWriter w; w.writeString(text); w.write(uint32_t(7)); return w.finish(); };
+    const std::string copy = "TEXCOORD";
+    CHECK(stringKey("TEXCOORD") == stringKey(copy.c_str()));
+    CHECK(stringKey(nullptr) != stringKey(""));
+    CHECK(stringKey("TEX") != stringKey("TEXCOORD"));
+
+    // Blobs by size + contents, not by address
+    const std::vector<uint8_t> blob(VS_CODE, VS_CODE + sizeof(VS_CODE));
+    auto hashedKey = [](const void* data, size_t size) { PipelineKeyWriter w; w.writeHashed(data, size); return w.finish(); };
+    CHECK(hashedKey(VS_CODE, sizeof(VS_CODE)) == hashedKey(blob.data(), blob.size()));
+    CHECK(hashedKey(VS_CODE, sizeof(VS_CODE) - 1) != hashedKey(blob.data(), blob.size()));
+    CHECK(hashedKey(nullptr, 16) == hashedKey(VS_CODE, 0));
+
+    // finish() leaves the writer empty
+    PipelineKeyWriter w;
+    w.write(uint32_t(1));
+    PipelineKey first = w.finish();
+    PipelineKey second = w.finish();
+    CHECK(first.bytes.size() == 4);
+    CHECK(second.bytes.empty());
+}
+
+// ----------------------------------------------------------------------------
+// Graphics pipeline keys
+// ----------------------------------------------------------------------------
+
+TEST_CASE("graphics: padding and data addresses never reach the key")
+{
+    Desc zeroed(0x00), garbage(0xCD);
+
+    CHECK(std::memcmp(zeroed.memory, garbage.memory, sizeof(zeroed.memory)) != 0);
+    CHECK(zeroed.get().VS.pShaderBytecode != garbage.get().VS.pShaderBytecode);
+    CHECK(zeroed.get().InputLayout.pInputElementDescs[0].SemanticName != garbage.get().InputLayout.pInputElementDescs[0].SemanticName);
+
+    CHECK(zeroed.key() == garbage.key());
+}
+
+TEST_CASE("graphics: state the pipeline ignores is left out")
+{
+    const PipelineKey base = Desc().key();
+
+    const NamedMutation ignored[] =
+    {
+        { "RenderTarget[3] without independent blend", [](auto& d, auto&) { d.BlendState.RenderTarget[3].BlendEnable = TRUE; } },
+        { "stencil ops without StencilEnable", [](auto& d, auto&) { d.DepthStencilState.FrontFace.StencilPassOp = D3D12_STENCIL_OP_REPLACE; } },
+        { "stencil masks without StencilEnable", [](auto& d, auto&) { d.DepthStencilState.StencilWriteMask = 0x0F; } },
+        { "RTVFormats past NumRenderTargets", [](auto& d, auto&) { d.RTVFormats[5] = DXGI_FORMAT_R16G16B16A16_FLOAT; } },
+        { "-0.0f", [](auto& d, auto&) { d.RasterizerState.DepthBiasClamp = -0.0f; } },
+        { "pRootSignature", [](auto& d, auto&) { d.pRootSignature = reinterpret_cast<ID3D12RootSignature*>(uintptr_t(0x1000)); } },
+        { "CachedPSO", [](auto& d, auto&) { d.CachedPSO = { VS_CODE, sizeof(VS_CODE) }; } },
+    };
+
+    for (const NamedMutation& m : ignored)
+    {
+        Desc desc;
+        m.apply(desc.get(), desc.storage);
+        const bool same = desc.key() == base;
+        CHECK(same);
+        if (!same)
+            std::printf("  changed by: %s\n", m.name);
+    }
+}
+
+TEST_CASE("graphics: equal descriptions share one key")
+{
+    std::unordered_map<PipelineKey, int, PipelineKeyHash> cache;
+
+    // Ten requests of the same state from different memory: one entry
+    for (int i = 0; i < 10; ++i)
+    {
+        Desc desc(uint8_t(i * 25));
+        cache.emplace(desc.key(), i);
+    }
+    CHECK(cache.size() == 1);
+    CHECK(cache.begin()->second == 0);
+
+    // Another root signature is another pipeline
+    Desc other;
+    cache.emplace(other.key(0x5678), 10);
+    CHECK(cache.size() == 2);
+}
+
+TEST_CASE("graphics: any differing field gives a different key")
+{
+    const NamedMutation mutations[] =
+    {
+        { "root signature", [](auto&, auto&) {} },       // applied through the hash below
+        { "VS contents", [](auto&, auto& s) { s.vs[6] ^= 1; } },
+        { "VS size", [](auto& d, auto&) { d.VS.BytecodeLength -= 1; } },
+        { "PS", [](auto& d, auto&) { d.PS = d.VS; } },
+        { "DS", [](auto& d, auto&) { d.DS = { VS_CODE, sizeof(VS_CODE) }; } },
+        { "HS", [](auto& d, auto&) { d.HS = { VS_CODE, sizeof(VS_CODE) }; } },
+        { "GS", [](auto& d, auto&) { d.GS = { VS_CODE, sizeof(VS_CODE) }; } },
+
+        { "SO stream", [](auto&, auto& s) { s.entries[0].Stream = 1; } },
+        { "SO semantic", [](auto&, auto& s) { s.streamName = "TEXCOORD"; s.entries[0].SemanticName = s.streamName.c_str(); } },
+        { "SO semantic index", [](auto&, auto& s) { s.entries[0].SemanticIndex = 1; } },
+        { "SO start component", [](auto&, auto& s) { s.entries[0].StartComponent = 1; } },
+        { "SO component count", [](auto&, auto& s) { s.entries[0].ComponentCount = 3; } },
+        { "SO output slot", [](auto&, auto& s) { s.entries[0].OutputSlot = 1; } },
+        { "SO entries", [](auto& d, auto&) { d.StreamOutput.NumEntries = 0; } },
+        { "SO stride", [](auto&, auto& s) { s.strides[0] = 32; } },
+        { "SO strides", [](auto& d, auto&) { d.StreamOutput.NumStrides = 0; } },
+        { "SO rasterized stream", [](auto& d, auto&) { d.StreamOutput.RasterizedStream = 1; } },
+
+        { "AlphaToCoverageEnable", [](auto& d, auto&) { d.BlendState.AlphaToCoverageEnable = TRUE; } },
+        { "IndependentBlendEnable", [](auto& d, auto&) { d.BlendState.IndependentBlendEnable = TRUE; } },
+        { "RT3 with independent blend", [](auto& d, auto&) { d.BlendState.IndependentBlendEnable = TRUE; d.BlendState.RenderTarget[3].BlendEnable = TRUE; } },
+        { "BlendEnable", [](auto& d, auto&) { d.BlendState.RenderTarget[0].BlendEnable = TRUE; } },
+        { "LogicOpEnable", [](auto& d, auto&) { d.BlendState.RenderTarget[0].LogicOpEnable = TRUE; } },
+        { "SrcBlend", [](auto& d, auto&) { d.BlendState.RenderTarget[0].SrcBlend = D3D12_BLEND_SRC_ALPHA; } },
+        { "DestBlend", [](auto& d, auto&) { d.BlendState.RenderTarget[0].DestBlend = D3D12_BLEND_INV_SRC_ALPHA; } },
+        { "BlendOp", [](auto& d, auto&) { d.BlendState.RenderTarget[0].BlendOp = D3D12_BLEND_OP_MAX; } },
+        { "SrcBlendAlpha", [](auto& d, auto&) { d.BlendState.RenderTarget[0].SrcBlendAlpha = D3D12_BLEND_ZERO; } },
+        { "DestBlendAlpha", [](auto& d, auto&) { d.BlendState.RenderTarget[0].DestBlendAlpha = D3D12_BLEND_ONE; } },
+        { "BlendOpAlpha", [](auto& d, auto&) { d.BlendState.RenderTarget[0].BlendOpAlpha = D3D12_BLEND_OP_MIN; } },
+        { "LogicOp", [](auto& d, auto&) { d.BlendState.RenderTarget[0].LogicOp = D3D12_LOGIC_OP_COPY; } },
+        { "RenderTargetWriteMask", [](auto& d, auto&) { d.BlendState.RenderTarget[0].RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_RED; } },
+        { "SampleMask", [](auto& d, auto&) { d.SampleMask = 1; } },
+
+        { "FillMode", [](auto& d, auto&) { d.RasterizerState.FillMode = D3D12_FILL_MODE_WIREFRAME; } },
+        { "CullMode", [](auto& d, auto&) { d.RasterizerState.CullMode = D3D12_CULL_MODE_NONE; } },
+        { "FrontCounterClockwise", [](auto& d, auto&) { d.RasterizerState.FrontCounterClockwise = TRUE; } },
+        { "DepthBias", [](auto& d, auto&) { d.RasterizerState.DepthBias = 1; } },
+        { "DepthBiasClamp", [](auto& d, auto&) { d.RasterizerState.DepthBiasClamp = 0.5f; } },
+        { "SlopeScaledDepthBias", [](auto& d, auto&) { d.RasterizerState.SlopeScaledDepthBias = 1.0f; } },
+        { "DepthClipEnable", [](auto& d, auto&) { d.RasterizerState.DepthClipEnable = FALSE; } },
+        { "MultisampleEnable", [](auto& d, auto&) { d.RasterizerState.MultisampleEnable = TRUE; } },
+        { "AntialiasedLineEnable", [](auto& d, auto&) { d.RasterizerState.AntialiasedLineEnable = TRUE; } },
+        { "ForcedSampleCount", [](auto& d, auto&) { d.RasterizerState.ForcedSampleCount = 4; } },
+        { "ConservativeRaster", [](auto& d, auto&) { d.RasterizerState.ConservativeRaster = D3D12_CONSERVATIVE_RASTERIZATION_MODE_ON; } },
+
+        { "DepthEnable", [](auto& d, auto&) { d.DepthStencilState.DepthEnable = FALSE; } },
+        { "DepthWriteMask", [](auto& d, auto&) { d.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO; } },
+        { "DepthFunc", [](auto& d, auto&) { d.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_GREATER; } },
+        { "StencilEnable", [](auto& d, auto&) { d.DepthStencilState.StencilEnable = TRUE; } },
+        { "StencilReadMask", [](auto& d, auto&) { d.DepthStencilState.StencilEnable = TRUE; d.DepthStencilState.StencilReadMask = 0x0F; } },
+        { "StencilWriteMask", [](auto& d, auto&) { d.DepthStencilState.StencilEnable = TRUE; d.DepthStencilState.StencilWriteMask = 0x0F; } },
+        { "FrontFace.StencilFailOp", [](auto& d, auto&) { d.DepthStencilState.StencilEnable = TRUE; d.DepthStencilState.FrontFace.StencilFailOp = D3D12_STENCIL_OP_ZERO; } },
+        { "FrontFace.StencilDepthFailOp", [](auto& d, auto&) { d.DepthStencilState.StencilEnable = TRUE; d.DepthStencilState.FrontFace.StencilDepthFailOp = D3D12_STENCIL_OP_ZERO; } },
+        { "FrontFace.StencilPassOp", [](auto& d, auto&) { d.DepthStencilState.StencilEnable = TRUE; d.DepthStencilState.FrontFace.StencilPassOp = D3D12_STENCIL_OP_REPLACE; } },
+        { "FrontFace.StencilFunc", [](auto& d, auto&) { d.DepthStencilState.StencilEnable = TRUE; d.DepthStencilState.FrontFace.StencilFunc = D3D12_COMPARISON_FUNC_EQUAL; } },
+        { "BackFace.StencilPassOp", [](auto& d, auto&) { d.DepthStencilState.StencilEnable = TRUE; d.DepthStencilState.BackFace.StencilPassOp = D3D12_STENCIL_OP_INCR_SAT; } },
+
+        { "input semantic", [](auto&, auto& s) { s.normal = "TEXCOORD"; s.elements[1].SemanticName = s.normal.c_str(); } },
+        { "input semantic index", [](auto&, auto& s) { s.elements[1].SemanticIndex = 1; } },
+        { "input format", [](auto&, auto& s) { s.elements[1].Format = DXGI_FORMAT_R32G32_FLOAT; } },
+        { "input slot", [](auto&, auto& s) { s.elements[1].InputSlot = 1; } },
+        { "input offset", [](auto&, auto& s) { s.elements[1].AlignedByteOffset = 16; } },
+        { "input classification", [](auto&, auto& s) { s.elements[1].InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA; } },
+        { "input step rate", [](auto&, auto& s) { s.elements[1].InstanceDataStepRate = 1; } },
+        { "input element count", [](auto& d, auto&) { d.InputLayout.NumElements = 1; } },
+        { "input element order", [](auto&, auto& s) { std::swap(s.elements[0], s.elements[1]); } },
+
+        { "IBStripCutValue", [](auto& d, auto&) { d.IBStripCutValue = D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_0xFFFF; } },
+        { "PrimitiveTopologyType", [](auto& d, auto&) { d.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_LINE; } },
+        { "NumRenderTargets", [](auto& d, auto&) { d.NumRenderTargets = 2; } },
+        { "RTVFormats[0]", [](auto& d, auto&) { d.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB; } },
+        { "DSVFormat", [](auto& d, auto&) { d.DSVFormat = DXGI_FORMAT_D24_UNORM_S8_UINT; } },
+        { "SampleDesc.Count", [](auto& d, auto&) { d.SampleDesc.Count = 4; } },
+        { "SampleDesc.Quality", [](auto& d, auto&) { d.SampleDesc.Quality = 1; } },
+        { "NodeMask", [](auto& d, auto&) { d.NodeMask = 1; } },
+        { "Flags", [](auto& d, auto&) { d.Flags = D3D12_PIPELINE_STATE_FLAG_TOOL_DEBUG; } },
+    };
+
+    std::unordered_map<PipelineKey, const char*, PipelineKeyHash> keys;
+    keys.emplace(Desc().key(), "base");
+
+    for (const NamedMutation& m : mutations)
+    {
+        Desc desc;
+        m.apply(desc.get(), desc.storage);
+        PipelineKey key = std::strcmp(m.name, "root signature") == 0 ? desc.key(0x9999) : desc.key();
+
+        // Different from the base and from every other single change
+        auto inserted = keys.emplace(std::move(key), m.name);
+        CHECK(inserted.second);
+        if (!inserted.second)
+            std::printf("  '%s' gives the same key as '%s'\n", m.name, inserted.first->second);
+    }
+
+    CHECK(keys.size() == sizeof(mutations) / sizeof(mutations[0]) + 1);
+}
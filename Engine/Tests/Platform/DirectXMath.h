@@ -0,0 +1,226 @@
+#pragma once
+
+// ============================================================================
+// DirectXMath.h (headless subset)
+// ----------------------------------------------------------------------------
+// Only on the include path of the headless tests outside Windows. Scalar
+// implementations (the _XM_NO_INTRINSICS_ path: one float per lane, masks
+// are 0xFFFFFFFF / 0) of the DirectXMath types and functions the tested
+// sources use, with the SDK's names, layouts and conventions (row vectors,
+// v * M). Add functions here as tested code needs them.
+// ============================================================================
+
+#include <cmath>
+#include <cstdint>
+
+namespace DirectX
+{
+    constexpr float XM_PI = 3.141592654f;
+    constexpr float XM_2PI = 6.283185307f;
+    constexpr float XM_PIDIV2 = 1.570796327f;
+    constexpr float XM_PIDIV4 = 0.785398163f;
+
+    struct alignas(16) XMVECTOR
+    {
+        union
+        {
+            float    f[4];
+            uint32_t u[4];
+        };
+    };
+
+    typedef const XMVECTOR FXMVECTOR;
+    typedef const XMVECTOR GXMVECTOR;
+    typedef const XMVECTOR HXMVECTOR;
+    typedef const XMVECTOR& CXMVECTOR;
+
+    struct alignas(16) XMMATRIX
+    {
+        XMVECTOR r[4];
+    };
+
+    typedef const XMMATRIX FXMMATRIX;
+    typedef const XMMATRIX& CXMMATRIX;
+
+    struct XMFLOAT3
+    {
+        float x, y, z;
+
+        XMFLOAT3() = default;
+        constexpr XMFLOAT3(float x, float y, float z) : x(x), y(y), z(z) {}
+    };
+
+    struct XMFLOAT4
+    {
+        float x, y, z, w;
+
+        XMFLOAT4() = default;
+        constexpr XMFLOAT4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+    };
+
+    struct XMUINT4
+    {
+        uint32_t x, y, z, w;
+    };
+
+    struct XMFLOAT4X4
+    {
+        union
+        {
+            struct
+            {
+                float _11, _12, _13, _14;
+                float _21, _22, _23, _24;
+                float _31, _32, _33, _34;
+                float _41, _42, _43, _44;
+            };
+            float m[4][4];
+        };
+
+        XMFLOAT4X4() = default;
+        constexpr XMFLOAT4X4(float m00, float m01, float m02, float m03,
+                             float m10, float m11, float m12, float m13,
+                             float m20, float m21, float m22, float m23,
+                             float m30, float m31, float m32, float m33)
+            : _11(m00), _12(m01), _13(m02), _14(m03),
+              _21(m10), _22(m11), _23(m12), _24(m13),
+              _31(m20), _32(m21), _33(m22), _34(m23),
+              _41(m30), _42(m31), _43(m32), _44(m33) {}
+    };
+
+    // ------------------------------------------------------------------------
+    // Load / store / set
+    // ------------------------------------------------------------------------
+
+    inline XMVECTOR XMVectorSet(float x, float y, float z, float w)
+    {
+        XMVECTOR v;
+        v.f[0] = x; v.f[1] = y; v.f[2] = z; v.f[3] = w;
+        return v;
+    }
+
+    inline XMVECTOR XMVectorReplicate(float value) { return XMVectorSet(value, value, value, value); }
+    inline XMVECTOR XMVectorZero() { return XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f); }
+
+    inline XMVECTOR XMLoadFloat3(const XMFLOAT3* src) { return XMVectorSet(src->x, src->y, src->z, 0.0f); }
+    inline XMVECTOR XMLoadFloat4(const XMFLOAT4* src) { return XMVectorSet(src->x, src->y, src->z, src->w); }
+
+    inline void XMStoreFloat3(XMFLOAT3* dst, FXMVECTOR v)
+    {
+        dst->x = v.f[0]; dst->y = v.f[1]; dst->z = v.f[2];
+    }
+
+    inline void XMStoreFloat4(XMFLOAT4* dst, FXMVECTOR v)
+    {
+        dst->x = v.f[0]; dst->y = v.f[1]; dst->z = v.f[2]; dst->w = v.f[3];
+    }
+
+    inline void XMStoreUInt4(XMUINT4* dst, FXMVECTOR v)
+    {
+        dst->x = v.u[0]; dst->y = v.u[1]; dst->z = v.u[2]; dst->w = v.u[3];
+    }
+
+    inline XMMATRIX XMLoadFloat4x4(const XMFLOAT4X4* src)
+    {
+        XMMATRIX m;
+        for (int r = 0; r < 4; ++r)
+            m.r[r] = XMVectorSet(src->m[r][0], src->m[r][1], src->m[r][2], src->m[r][3]);
+        return m;
+    }
+
+    // ------------------------------------------------------------------------
+    // Per lane arithmetic and comparisons
+    // ------------------------------------------------------------------------
+
+    namespace Internal
+    {
+        template<typename Op>
+        inline XMVECTOR perLane(FXMVECTOR a, FXMVECTOR b, Op op)
+        {
+            XMVECTOR v;
+            for (int i = 0; i < 4; ++i)
+                v.f[i] = op(a.f[i], b.f[i]);
+            return v;
+        }
+
+        template<typename Op>
+        inline XMVECTOR perLaneMask(FXMVECTOR a, FXMVECTOR b, Op op)
+        {
+            XMVECTOR v;
+            for (int i = 0; i < 4; ++i)
+                v.u[i] = op(a.f[i], b.f[i]) ? 0xFFFFFFFFu : 0u;
+            return v;
+        }
+    }
+
+    inline XMVECTOR XMVectorAdd(FXMVECTOR a, FXMVECTOR b) { return Internal::perLane(a, b, [](float x, float y) { return x + y; }); }
+    inline XMVECTOR XMVectorSubtract(FXMVECTOR a, FXMVECTOR b) { return Internal::perLane(a, b, [](float x, float y) { return x - y; }); }
+    inline XMVECTOR XMVectorMultiply(FXMVECTOR a, FXMVECTOR b) { return Internal::perLane(a, b, [](float x, float y) { return x * y; }); }
+    inline XMVECTOR XMVectorMax(FXMVECTOR a, FXMVECTOR b) { return Internal::perLane(a, b, [](float x, float y) { return x > y ? x : y; }); }
+    inline XMVECTOR XMVectorMin(FXMVECTOR a, FXMVECTOR b) { return Internal::perLane(a, b, [](float x, float y) { return x < y ? x : y; }); }
+
+    inline XMVECTOR XMVectorScale(FXMVECTOR v, float s) { return XMVectorMultiply(v, XMVectorReplicate(s)); }
+    inline XMVECTOR XMVectorNegate(FXMVECTOR v) { return XMVectorSubtract(XMVectorZero(), v); }
+
+    inline XMVECTOR XMVectorSqrt(FXMVECTOR v)
+    {
+        return XMVectorSet(std::sqrt(v.f[0]), std::sqrt(v.f[1]), std::sqrt(v.f[2]), std::sqrt(v.f[3]));
+    }
+
+    inline XMVECTOR XMVectorLess(FXMVECTOR a, FXMVECTOR b) { return Internal::perLaneMask(a, b, [](float x, float y) { return x < y; }); }
+    inline XMVECTOR XMVectorLessOrEqual(FXMVECTOR a, FXMVECTOR b) { return Internal::perLaneMask(a, b, [](float x, float y) { return x <= y; }); }
+    inline XMVECTOR XMVectorGreater(FXMVECTOR a, FXMVECTOR b) { return Internal::perLaneMask(a, b, [](float x, float y) { return x > y; }); }
+    inline XMVECTOR XMVectorGreaterOrEqual(FXMVECTOR a, FXMVECTOR b) { return Internal::perLaneMask(a, b, [](float x, float y) { return x >= y; }); }
+
+    inline XMVECTOR XMVectorAndInt(FXMVECTOR a, FXMVECTOR b)
+    {
+        XMVECTOR v;
+        for (int i = 0; i < 4; ++i)
+            v.u[i] = a.u[i] & b.u[i];
+        return v;
+    }
+
+    inline XMVECTOR XMVectorOrInt(FXMVECTOR a, FXMVECTOR b)
+    {
+        XMVECTOR v;
+        for (int i = 0; i < 4; ++i)
+            v.u[i] = a.u[i] | b.u[i];
+        return v;
+    }
+
+    // ------------------------------------------------------------------------
+    // 3D vectors
+    // ------------------------------------------------------------------------
+
+    inline XMVECTOR XMVector3Dot(FXMVECTOR a, FXMVECTOR b)
+    {
+        return XMVectorReplicate(a.f[0] * b.f[0] + a.f[1] * b.f[1] + a.f[2] * b.f[2]);
+    }
+
+    inline XMVECTOR XMVector3Normalize(FXMVECTOR v)
+    {
+        float length = std::sqrt(XMVector3Dot(v, v).f[0]);
+        if (length > 0.0f)
+            length = 1.0f / length;
+        return XMVectorSet(v.f[0] * length, v.f[1] * length, v.f[2] * length, v.f[3] * length);
+    }
+
+    // v.xyz as a point (w = 1)
+    inline XMVECTOR XMVector3Transform(FXMVECTOR v, FXMMATRIX m)
+    {
+        XMVECTOR result = XMVectorMultiply(XMVectorReplicate(v.f[2]), m.r[2]);
+        result = XMVectorAdd(result, m.r[3]);
+        result = XMVectorAdd(XMVectorMultiply(XMVectorReplicate(v.f[1]), m.r[1]), result);
+        return XMVectorAdd(XMVectorMultiply(XMVectorReplicate(v.f[0]), m.r[0]), result);
+    }
+
+    // v.xyz as a direction (w = 0)
+    inline XMVECTOR XMVector3TransformNormal(FXMVECTOR v, FXMMATRIX m)
+    {
+        XMVECTOR result = XMVectorMultiply(XMVectorReplicate(v.f[2]), m.r[2]);
+        result = XMVectorAdd(XMVectorMultiply(XMVectorReplicate(v.f[1]), m.r[1]), result);
+        return XMVectorAdd(XMVectorMultiply(XMVectorReplicate(v.f[0]), m.r[0]), result);
+    }
+
+    inline float XMConvertToRadians(float degrees) { return degrees * (XM_PI / 180.0f); }
+}
@@ -0,0 +1,420 @@
+#pragma once
+
+// ============================================================================
+// d3d12.h (headless subset)
+// ----------------------------------------------------------------------------
+// Only on the include path of the headless tests outside Windows. Declares
+// the D3D12 structs and enums the tested headers read, with the SDK's names,
+// members and values. Interfaces are opaque (the tests pass mocks or fake
+// pointers) except for the few methods a tested header calls inline, which
+// are declared pure virtual. Add declarations here as tested code needs
+// them, never engine logic.
+// ============================================================================
+
+#include <cstddef>
+#include <cstdint>
+
+typedef int32_t  INT;
+typedef uint32_t UINT;
+typedef int      BOOL;
+typedef float    FLOAT;
+typedef uint8_t  UINT8;
+typedef uint16_t UINT16;
+typedef uint64_t UINT64;
+typedef size_t   SIZE_T;
+typedef const char* LPCSTR;
+
+#ifndef TRUE
+#define TRUE 1
+#define FALSE 0
+#endif
+
+typedef uint64_t D3D12_GPU_VIRTUAL_ADDRESS;
+typedef unsigned long ULONG;
+
+// ComPtr (wrl/client.h) needs the reference counting
+struct IUnknown
+{
+    virtual ULONG AddRef() = 0;
+    virtual ULONG Release() = 0;
+};
+
+struct ID3D12Resource : IUnknown
+{
+    virtual D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress() = 0;
+};
+
+struct ID3D12PipelineState;
+struct ID3D12RootSignature;
+struct ID3D12DescriptorHeap;
+struct ID3D12GraphicsCommandList;
+
+struct D3D12_GPU_DESCRIPTOR_HANDLE
+{
+    UINT64 ptr;
+};
+
+enum DXGI_FORMAT
+{
+    DXGI_FORMAT_UNKNOWN = 0,
+    DXGI_FORMAT_R32G32B32A32_FLOAT = 2,
+    DXGI_FORMAT_R32G32B32_FLOAT = 6,
+    DXGI_FORMAT_R16G16B16A16_FLOAT = 10,
+    DXGI_FORMAT_R32G32_FLOAT = 16,
+    DXGI_FORMAT_R8G8B8A8_UNORM = 28,
+    DXGI_FORMAT_R8G8B8A8_UNORM_SRGB = 29,
+    DXGI_FORMAT_D32_FLOAT = 40,
+    DXGI_FORMAT_R32_UINT = 42,
+    DXGI_FORMAT_D24_UNORM_S8_UINT = 45,
+    DXGI_FORMAT_R16_UINT = 57,
+};
+
+// ----------------------------------------------------------------------------
+// Input assembler
+// ----------------------------------------------------------------------------
+
+enum D3D_PRIMITIVE_TOPOLOGY
+{
+    D3D_PRIMITIVE_TOPOLOGY_UNDEFINED = 0,
+    D3D_PRIMITIVE_TOPOLOGY_POINTLIST = 1,
+    D3D_PRIMITIVE_TOPOLOGY_LINELIST = 2,
+    D3D_PRIMITIVE_TOPOLOGY_LINESTRIP = 3,
+    D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST = 4,
+    D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP = 5,
+};
+
+typedef D3D_PRIMITIVE_TOPOLOGY D3D12_PRIMITIVE_TOPOLOGY;
+
+struct D3D12_VERTEX_BUFFER_VIEW
+{
+    D3D12_GPU_VIRTUAL_ADDRESS BufferLocation;
+    UINT SizeInBytes;
+    UINT StrideInBytes;
+};
+
+struct D3D12_INDEX_BUFFER_VIEW
+{
+    D3D12_GPU_VIRTUAL_ADDRESS BufferLocation;
+    UINT SizeInBytes;
+    DXGI_FORMAT Format;
+};
+
+// ----------------------------------------------------------------------------
+// Barriers
+// ----------------------------------------------------------------------------
+
+enum D3D12_RESOURCE_STATES
+{
+    D3D12_RESOURCE_STATE_COMMON = 0,
+    D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER = 0x1,
+    D3D12_RESOURCE_STATE_INDEX_BUFFER = 0x2,
+    D3D12_RESOURCE_STATE_RENDER_TARGET = 0x4,
+    D3D12_RESOURCE_STATE_UNORDERED_ACCESS = 0x8,
+    D3D12_RESOURCE_STATE_DEPTH_WRITE = 0x10,
+    D3D12_RESOURCE_STATE_DEPTH_READ = 0x20,
+    D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE = 0x40,
+    D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE = 0x80,
+    D3D12_RESOURCE_STATE_COPY_DEST = 0x400,
+    D3D12_RESOURCE_STATE_COPY_SOURCE = 0x800,
+    D3D12_RESOURCE_STATE_PRESENT = 0,
+};
+
+enum D3D12_RESOURCE_BARRIER_TYPE
+{
+    D3D12_RESOURCE_BARRIER_TYPE_TRANSITION = 0,
+    D3D12_RESOURCE_BARRIER_TYPE_ALIASING = 1,
+    D3D12_RESOURCE_BARRIER_TYPE_UAV = 2,
+};
+
+enum D3D12_RESOURCE_BARRIER_FLAGS
+{
+    D3D12_RESOURCE_BARRIER_FLAG_NONE = 0,
+    D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY = 0x1,
+    D3D12_RESOURCE_BARRIER_FLAG_END_ONLY = 0x2,
+};
+
+#define D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES 0xffffffff
+
+struct D3D12_RESOURCE_TRANSITION_BARRIER
+{
+    ID3D12Resource* pResource;
+    UINT Subresource;
+    D3D12_RESOURCE_STATES StateBefore;
+    D3D12_RESOURCE_STATES StateAfter;
+};
+
+struct D3D12_RESOURCE_ALIASING_BARRIER
+{
+    ID3D12Resource* pResourceBefore;
+    ID3D12Resource* pResourceAfter;
+};
+
+struct D3D12_RESOURCE_UAV_BARRIER
+{
+    ID3D12Resource* pResource;
+};
+
+struct D3D12_RESOURCE_BARRIER
+{
+    D3D12_RESOURCE_BARRIER_TYPE Type;
+    D3D12_RESOURCE_BARRIER_FLAGS Flags;
+    union
+    {
+        D3D12_RESOURCE_TRANSITION_BARRIER Transition;
+        D3D12_RESOURCE_ALIASING_BARRIER Aliasing;
+        D3D12_RESOURCE_UAV_BARRIER UAV;
+    };
+};
+
+// ----------------------------------------------------------------------------
+// Graphics pipeline description
+// ----------------------------------------------------------------------------
+
+#define D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT 8
+#define D3D12_DEFAULT_SAMPLE_MASK 0xffffffff
+
+struct D3D12_SHADER_BYTECODE
+{
+    const void* pShaderBytecode;
+    SIZE_T BytecodeLength;
+};
+
+struct D3D12_SO_DECLARATION_ENTRY
+{
+    UINT Stream;
+    LPCSTR SemanticName;
+    UINT SemanticIndex;
+    UINT8 StartComponent;
+    UINT8 ComponentCount;
+    UINT8 OutputSlot;
+};
+
+struct D3D12_STREAM_OUTPUT_DESC
+{
+    const D3D12_SO_DECLARATION_ENTRY* pSODeclaration;
+    UINT NumEntries;
+    const UINT* pBufferStrides;
+    UINT NumStrides;
+    UINT RasterizedStream;
+};
+
+enum D3D12_BLEND
+{
+    D3D12_BLEND_ZERO = 1,
+    D3D12_BLEND_ONE = 2,
+    D3D12_BLEND_SRC_COLOR = 3,
+    D3D12_BLEND_INV_SRC_COLOR = 4,
+    D3D12_BLEND_SRC_ALPHA = 5,
+    D3D12_BLEND_INV_SRC_ALPHA = 6,
+};
+
+enum D3D12_BLEND_OP
+{
+    D3D12_BLEND_OP_ADD = 1,
+    D3D12_BLEND_OP_SUBTRACT = 2,
+    D3D12_BLEND_OP_REV_SUBTRACT = 3,
+    D3D12_BLEND_OP_MIN = 4,
+    D3D12_BLEND_OP_MAX = 5,
+};
+
+enum D3D12_LOGIC_OP
+{
+    D3D12_LOGIC_OP_CLEAR = 0,
+    D3D12_LOGIC_OP_SET = 1,
+    D3D12_LOGIC_OP_COPY = 2,
+    D3D12_LOGIC_OP_NOOP = 4,
+};
+
+enum D3D12_COLOR_WRITE_ENABLE
+{
+    D3D12_COLOR_WRITE_ENABLE_RED = 1,
+    D3D12_COLOR_WRITE_ENABLE_GREEN = 2,
+    D3D12_COLOR_WRITE_ENABLE_BLUE = 4,
+    D3D12_COLOR_WRITE_ENABLE_ALPHA = 8,
+    D3D12_COLOR_WRITE_ENABLE_ALL = 15,
+};
+
+struct D3D12_RENDER_TARGET_BLEND_DESC
+{
+    BOOL BlendEnable;
+    BOOL LogicOpEnable;
+    D3D12_BLEND SrcBlend;
+    D3D12_BLEND DestBlend;
+    D3D12_BLEND_OP BlendOp;
+    D3D12_BLEND SrcBlendAlpha;
+    D3D12_BLEND DestBlendAlpha;
+    D3D12_BLEND_OP BlendOpAlpha;
+    D3D12_LOGIC_OP LogicOp;
+    UINT8 RenderTargetWriteMask;
+};
+
+struct D3D12_BLEND_DESC
+{
+    BOOL AlphaToCoverageEnable;
+    BOOL IndependentBlendEnable;
+    D3D12_RENDER_TARGET_BLEND_DESC RenderTarget[D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT];
+};
+
+enum D3D12_FILL_MODE
+{
+    D3D12_FILL_MODE_WIREFRAME = 2,
+    D3D12_FILL_MODE_SOLID = 3,
+};
+
+enum D3D12_CULL_MODE
+{
+    D3D12_CULL_MODE_NONE = 1,
+    D3D12_CULL_MODE_FRONT = 2,
+    D3D12_CULL_MODE_BACK = 3,
+};
+
+enum D3D12_CONSERVATIVE_RASTERIZATION_MODE
+{
+    D3D12_CONSERVATIVE_RASTERIZATION_MODE_OFF = 0,
+    D3D12_CONSERVATIVE_RASTERIZATION_MODE_ON = 1,
+};
+
+struct D3D12_RASTERIZER_DESC
+{
+    D3D12_FILL_MODE FillMode;
+    D3D12_CULL_MODE CullMode;
+    BOOL FrontCounterClockwise;
+    INT DepthBias;
+    FLOAT DepthBiasClamp;
+    FLOAT SlopeScaledDepthBias;
+    BOOL DepthClipEnable;
+    BOOL MultisampleEnable;
+    BOOL AntialiasedLineEnable;
+    UINT ForcedSampleCount;
+    D3D12_CONSERVATIVE_RASTERIZATION_MODE ConservativeRaster;
+};
+
+enum D3D12_DEPTH_WRITE_MASK
+{
+    D3D12_DEPTH_WRITE_MASK_ZERO = 0,
+    D3D12_DEPTH_WRITE_MASK_ALL = 1,
+};
+
+enum D3D12_COMPARISON_FUNC
+{
+    D3D12_COMPARISON_FUNC_NEVER = 1,
+    D3D12_COMPARISON_FUNC_LESS = 2,
+    D3D12_COMPARISON_FUNC_EQUAL = 3,
+    D3D12_COMPARISON_FUNC_LESS_EQUAL = 4,
+    D3D12_COMPARISON_FUNC_GREATER = 5,
+    D3D12_COMPARISON_FUNC_NOT_EQUAL = 6,
+    D3D12_COMPARISON_FUNC_GREATER_EQUAL = 7,
+    D3D12_COMPARISON_FUNC_ALWAYS = 8,
+};
+
+enum D3D12_STENCIL_OP
+{
+    D3D12_STENCIL_OP_KEEP = 1,
+    D3D12_STENCIL_OP_ZERO = 2,
+    D3D12_STENCIL_OP_REPLACE = 3,
+    D3D12_STENCIL_OP_INCR_SAT = 4,
+};
+
+struct D3D12_DEPTH_STENCILOP_DESC
+{
+    D3D12_STENCIL_OP StencilFailOp;
+    D3D12_STENCIL_OP StencilDepthFailOp;
+    D3D12_STENCIL_OP StencilPassOp;
+    D3D12_COMPARISON_FUNC StencilFunc;
+};
+
+struct D3D12_DEPTH_STENCIL_DESC
+{
+    BOOL DepthEnable;
+    D3D12_DEPTH_WRITE_MASK DepthWriteMask;
+    D3D12_COMPARISON_FUNC DepthFunc;
+    BOOL StencilEnable;
+    UINT8 StencilReadMask;
+    UINT8 StencilWriteMask;
+    D3D12_DEPTH_STENCILOP_DESC FrontFace;
+    D3D12_DEPTH_STENCILOP_DESC BackFace;
+};
+
+enum D3D12_INPUT_CLASSIFICATION
+{
+    D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA = 0,
+    D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA = 1,
+};
+
+#define D3D12_APPEND_ALIGNED_ELEMENT 0xffffffff
+
+struct D3D12_INPUT_ELEMENT_DESC
+{
+    LPCSTR SemanticName;
+    UINT SemanticIndex;
+    DXGI_FORMAT Format;
+    UINT InputSlot;
+    UINT AlignedByteOffset;
+    D3D12_INPUT_CLASSIFICATION InputSlotClass;
+    UINT InstanceDataStepRate;
+};
+
+struct D3D12_INPUT_LAYOUT_DESC
+{
+    const D3D12_INPUT_ELEMENT_DESC* pInputElementDescs;
+    UINT NumElements;
+};
+
+enum D3D12_INDEX_BUFFER_STRIP_CUT_VALUE
+{
+    D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_DISABLED = 0,
+    D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_0xFFFF = 1,
+    D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_0xFFFFFFFF = 2,
+};
+
+enum D3D12_PRIMITIVE_TOPOLOGY_TYPE
+{
+    D3D12_PRIMITIVE_TOPOLOGY_TYPE_UNDEFINED = 0,
+    D3D12_PRIMITIVE_TOPOLOGY_TYPE_POINT = 1,
+    D3D12_PRIMITIVE_TOPOLOGY_TYPE_LINE = 2,
+    D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE = 3,
+    D3D12_PRIMITIVE_TOPOLOGY_TYPE_PATCH = 4,
+};
+
+struct DXGI_SAMPLE_DESC
+{
+    UINT Count;
+    UINT Quality;
+};
+
+struct D3D12_CACHED_PIPELINE_STATE
+{
+    const void* pCachedBlob;
+    SIZE_T CachedBlobSizeInBytes;
+};
+
+enum D3D12_PIPELINE_STATE_FLAGS
+{
+    D3D12_PIPELINE_STATE_FLAG_NONE = 0,
+    D3D12_PIPELINE_STATE_FLAG_TOOL_DEBUG = 0x1,
+};
+
+struct D3D12_GRAPHICS_PIPELINE_STATE_DESC
+{
+    ID3D12RootSignature* pRootSignature;
+    D3D12_SHADER_BYTECODE VS;
+    D3D12_SHADER_BYTECODE PS;
+    D3D12_SHADER_BYTECODE DS;
+    D3D12_SHADER_BYTECODE HS;
+    D3D12_SHADER_BYTECODE GS;
+    D3D12_STREAM_OUTPUT_DESC StreamOutput;
+    D3D12_BLEND_DESC BlendState;
+    UINT SampleMask;
+    D3D12_RASTERIZER_DESC RasterizerState;
+    D3D12_DEPTH_STENCIL_DESC DepthStencilState;
+    D3D12_INPUT_LAYOUT_DESC InputLayout;
+    D3D12_INDEX_BUFFER_STRIP_CUT_VALUE IBStripCutValue;
+    D3D12_PRIMITIVE_TOPOLOGY_TYPE PrimitiveTopologyType;
+    UINT NumRenderTargets;
+    DXGI_FORMAT RTVFormats[8];
+    DXGI_FORMAT DSVFormat;
+    DXGI_SAMPLE_DESC SampleDesc;
+    UINT NodeMask;
+    D3D12_CACHED_PIPELINE_STATE CachedPSO;
+    D3D12_PIPELINE_STATE_FLAGS Flags;
+};
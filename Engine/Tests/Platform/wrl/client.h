@@ -0,0 +1,78 @@
+#pragma once
+
+// ============================================================================
+// wrl/client.h (headless subset)
+// ----------------------------------------------------------------------------
+// Only on the include path of the headless tests outside Windows: the part
+// of Microsoft::WRL::ComPtr the tested headers use, with the same
+// reference counting (AddRef on copy, Release on reset / destruction).
+// ============================================================================
+
+#include <utility>
+
+namespace Microsoft
+{
+    namespace WRL
+    {
+        template<typename T>
+        class ComPtr
+        {
+        public:
+            ComPtr() = default;
+            ComPtr(std::nullptr_t) {}
+            ComPtr(T* other) : ptr(other) { addRef(); }
+            ComPtr(const ComPtr& other) : ptr(other.ptr) { addRef(); }
+            ComPtr(ComPtr&& other) noexcept : ptr(other.ptr) { other.ptr = nullptr; }
+            ~ComPtr() { release(); }
+
+            ComPtr& operator=(const ComPtr& other)
+            {
+                ComPtr(other).Swap(*this);
+                return *this;
+            }
+
+            ComPtr& operator=(ComPtr&& other) noexcept
+            {
+                ComPtr(std::move(other)).Swap(*this);
+                return *this;
+            }
+
+            ComPtr& operator=(std::nullptr_t)
+            {
+                release();
+                return *this;
+            }
+
+            T* Get() const { return ptr; }
+            T* operator->() const { return ptr; }
+            explicit operator bool() const { return ptr != nullptr; }
+
+            T** GetAddressOf() { return &ptr; }
+            T** ReleaseAndGetAddressOf()
+            {
+                release();
+                return &ptr;
+            }
+
+            void Reset() { release(); }
+            void Swap(ComPtr& other) { std::swap(ptr, other.ptr); }
+
+        private:
+            T* ptr = nullptr;
+
+            void addRef()
+            {
+                if (ptr)
+                    ptr->AddRef();
+            }
+
+            void release()
+            {
+                T* old = ptr;
+                ptr = nullptr;
+                if (old)
+                    old->Release();
+            }
+        };
+    }
+}
@@ -0,0 +1,493 @@
+#include "Test.h"
+
+#include <string>
+
+#include "RenderGraphCompiler.h"
+
+namespace
+{
+    using namespace RenderGraphState;
+    using Barrier = RenderGraphBarrier;
+
+    constexpr uint64_t KB = 1024;
+    constexpr uint64_t MB = 1024 * KB;
+
+    RenderGraphResourceDesc imported(const char* name, uint32_t initialState, uint32_t finalState)
+    {
+        RenderGraphResourceDesc desc;
+        desc.name = name;
+        desc.imported = true;
+        desc.initialState = initialState;
+        desc.finalState = finalState;
+        return desc;
+    }
+
+    RenderGraphResourceDesc transient(const char* name, uint64_t size, uint64_t alignment = 64 * KB, uint32_t initialState = Common)
+    {
+        RenderGraphResourceDesc desc;
+        desc.name = name;
+        desc.size = size;
+        desc.alignment = alignment;
+        desc.initialState = initialState;
+        return desc;
+    }
+
+    RenderGraphPassDesc pass(const char* name, std::vector<RenderGraphPassDesc::Access> accesses, bool sideEffects = false, bool changesCommandList = false)
+    {
+        RenderGraphPassDesc desc;
+        desc.name = name;
+        desc.accesses = std::move(accesses);
+        desc.sideEffects = sideEffects;
+        desc.changesCommandList = changesCommandList;
+        return desc;
+    }
+
+    std::vector<std::string> executedNames(const CompiledRenderGraph& graph, const std::vector<RenderGraphPassDesc>& passes)
+    {
+        std::vector<std::string> names;
+        for (const CompiledRenderGraph::PassBarriers& p : graph.passes)
+            names.push_back(passes[p.pass].name);
+        return names;
+    }
+
+    std::vector<Barrier> ofResource(const std::vector<Barrier>& batch, uint32_t resource, Barrier::Type type = Barrier::Type::Transition)
+    {
+        std::vector<Barrier> found;
+        for (const Barrier& b : batch)
+        {
+            if (b.resource == resource && b.type == type)
+                found.push_back(b);
+        }
+        return found;
+    }
+
+    bool isTransition(const Barrier& b, uint32_t before, uint32_t after, Barrier::Split split)
+    {
+        return b.type == Barrier::Type::Transition && b.before == before && b.after == after && b.split == split;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Culling
+// ----------------------------------------------------------------------------
+
+TEST_CASE("culling keeps what reaches an import or a side effect")
+{
+    enum { BackBuffer, GBuffer, Unused, Chain0, Chain1, Debug };
+    const std::vector<RenderGraphResourceDesc> resources =
+    {
+        imported("BackBuffer", Present, Present),
+        transient("GBuffer", 8 * MB),
+        transient("Unused", 8 * MB),
+        transient("Chain0", 1 * MB),
+        transient("Chain1", 1 * MB),
+        transient("Debug", 1 * MB),
+    };
+
+    const std::vector<RenderGraphPassDesc> passes =
+    {
+        pass("GBuffer", { { GBuffer, RenderTarget } }),
+        pass("Nobody reads", { { Unused, RenderTarget } }),
+        pass("Chain A", { { Chain0, UnorderedAccess } }),
+        pass("Chain B", { { Chain0, NonPixelShaderResource }, { Chain1, UnorderedAccess } }),
+        pass("Lighting", { { GBuffer, PixelShaderResource }, { BackBuffer, RenderTarget } }),
+        pass("Readback", { { Debug, CopyDest } }, true),
+    };
+
+    CompiledRenderGraph graph = RenderGraphCompiler::compile(resources, passes);
+
+    // The chain is dead as a whole: B's output is never read, so A's isn't either
+    CHECK((executedNames(graph, passes) == std::vector<std::string>{ "GBuffer", "Lighting", "Readback" }));
+    CHECK(graph.stats.passes == 3);
+    CHECK(graph.stats.culledPasses == 3);
+
+    // Culled passes leave no trace
+    CHECK(graph.placements[Unused].offset == CompiledRenderGraph::Placement::NONE);
+    CHECK(graph.placements[Chain0].offset == CompiledRenderGraph::Placement::NONE);
+}
+
+TEST_CASE("culling: unordered access reads what it writes")
+{
+    enum { Target, Buffer };
+    const std::vector<RenderGraphResourceDesc> resources = { imported("Target", Common, Common), transient("Buffer", 1 * MB) };
+
+    const std::vector<RenderGraphPassDesc> passes =
+    {
+        pass("Clear", { { Buffer, CopyDest } }),
+        pass("Accumulate", { { Buffer, UnorderedAccess } }),
+        pass("Resolve", { { Buffer, PixelShaderResource }, { Target, RenderTarget } }),
+    };
+
+    // Resolve needs Accumulate, which reads the cleared buffer
+    CompiledRenderGraph graph = RenderGraphCompiler::compile(resources, passes);
+    CHECK(graph.stats.culledPasses == 0);
+
+    // Once Resolve stops reading it, the whole chain is dead
+    std::vector<RenderGraphPassDesc> unread = passes;
+    unread[2].accesses.erase(unread[2].accesses.begin());
+    graph = RenderGraphCompiler::compile(resources, unread);
+    CHECK((executedNames(graph, unread) == std::vector<std::string>{ "Resolve" }));
+    CHECK(graph.stats.culledPasses == 2);
+}
+
+// ----------------------------------------------------------------------------
+// Transitions
+// ----------------------------------------------------------------------------
+
+TEST_CASE("consecutive reads merge into one transition")
+{
+    enum { BackBuffer, Color };
+    const std::vector<RenderGraphResourceDesc> resources = { imported("BackBuffer", Present, Present), transient("Color", 4 * MB) };
+
+    const std::vector<RenderGraphPassDesc> passes =
+    {
+        pass("Draw", { { Color, RenderTarget } }),
+        pass("Blur", { { Color, PixelShaderResource }, { BackBuffer, RenderTarget } }),
+        pass("Copy", { { Color, CopySource }, { BackBuffer, CopyDest } }),
+        pass("Sample", { { Color, NonPixelShaderResource }, { BackBuffer, RenderTarget } }),
+    };
+
+    CompiledRenderGraph graph = RenderGraphCompiler::compile(resources, passes);
+    REQUIRE(graph.passes.size() == 4);
+
+    const uint32_t reads = PixelShaderResource | CopySource | NonPixelShaderResource;
+
+    std::vector<Barrier> first = ofResource(graph.passes[1].before, Color);
+    REQUIRE(first.size() == 1);
+    CHECK(isTransition(first[0], RenderTarget, reads, Barrier::Split::None));
+    CHECK(ofResource(graph.passes[2].before, Color).empty());
+    CHECK(ofResource(graph.passes[3].before, Color).empty());
+    CHECK(graph.endStates[Color] == reads);
+
+    // The back buffer goes back to Present in the final batch
+    std::vector<Barrier> final = ofResource(graph.finalBarriers, BackBuffer);
+    REQUIRE(final.size() == 1);
+    CHECK(isTransition(final[0], RenderTarget, Present, Barrier::Split::None));
+    CHECK(graph.endStates[BackBuffer] == Present);
+}
+
+TEST_CASE("one pass using a resource twice gets one combined state")
+{
+    enum { Target, Depth };
+    const std::vector<RenderGraphResourceDesc> resources = { imported("Target", Common, Common), imported("Depth", DepthWrite, DepthWrite) };
+
+    const std::vector<RenderGraphPassDesc> passes =
+    {
+        pass("Decals", { { Depth, DepthRead }, { Depth, PixelShaderResource }, { Target, RenderTarget } }),
+    };
+
+    CompiledRenderGraph graph = RenderGraphCompiler::compile(resources, passes);
+    std::vector<Barrier> depth = ofResource(graph.passes[0].before, Depth);
+    REQUIRE(depth.size() == 1);
+    CHECK(isTransition(depth[0], DepthWrite, DepthRead | PixelShaderResource, Barrier::Split::None));
+
+    // Every barrier of a pass in one batch
+    CHECK(graph.passes[0].before.size() == 2);
+    CHECK(graph.stats.batches == 2);        // the pass and the final batch
+}
+
+TEST_CASE("UAV to UAV gets a UAV barrier")
+{
+    enum { Target, Buffer };
+    const std::vector<RenderGraphResourceDesc> resources = { imported("Target", Common, Common), transient("Buffer", 1 * MB) };
+
+    const std::vector<RenderGraphPassDesc> passes =
+    {
+        pass("Pass 1", { { Buffer, UnorderedAccess } }),
+        pass("Pass 2", { { Buffer, UnorderedAccess } }),
+        pass("Resolve", { { Buffer, PixelShaderResource }, { Target, RenderTarget } }),
+    };
+
+    CompiledRenderGraph graph = RenderGraphCompiler::compile(resources, passes);
+    REQUIRE(graph.passes.size() == 3);
+    CHECK(ofResource(graph.passes[0].before, Buffer, Barrier::Type::UAV).empty());
+    CHECK(ofResource(graph.passes[1].before, Buffer, Barrier::Type::UAV).size() == 1);
+    CHECK(ofResource(graph.passes[1].before, Buffer).empty());
+}
+
+TEST_CASE("transient state carries over between frames")
+{
+    enum { Target, Shadow };
+    const std::vector<RenderGraphPassDesc> passes =
+    {
+        pass("Shadow", { { Shadow, DepthWrite } }),
+        pass("Light", { { Shadow, PixelShaderResource }, { Target, RenderTarget } }),
+    };
+
+    std::vector<RenderGraphResourceDesc> resources = { imported("Target", RenderTarget, RenderTarget), transient("Shadow", 4 * MB) };
+
+    CompiledRenderGraph frame0 = RenderGraphCompiler::compile(resources, passes);
+    REQUIRE(ofResource(frame0.passes[0].before, Shadow).size() == 1);
+    CHECK(isTransition(ofResource(frame0.passes[0].before, Shadow)[0], Common, DepthWrite, Barrier::Split::None));
+    CHECK(frame0.finalBarriers.empty());
+
+    // Next frame starts where this one ended
+    resources[Shadow].initialState = frame0.endStates[Shadow];
+    CompiledRenderGraph frame1 = RenderGraphCompiler::compile(resources, passes);
+    REQUIRE(ofResource(frame1.passes[0].before, Shadow).size() == 1);
+    CHECK(isTransition(ofResource(frame1.passes[0].before, Shadow)[0], PixelShaderResource, DepthWrite, Barrier::Split::None));
+}
+
+// ----------------------------------------------------------------------------
+// Split barriers
+// ----------------------------------------------------------------------------
+
+TEST_CASE("split barriers span the idle passes")
+{
+    enum { Target, Shadow, Other };
+    const std::vector<RenderGraphResourceDesc> resources =
+    {
+        imported("Target", Common, Common),
+        transient("Shadow", 4 * MB),
+        transient("Other", 4 * MB),
+    };
+
+    const std::vector<RenderGraphPassDesc> passes =
+    {
+        pass("Shadow", { { Shadow, DepthWrite } }),
+        pass("Other 1", { { Other, RenderTarget } }),
+        pass("Other 2", { { Other, PixelShaderResource }, { Target, RenderTarget } }),
+        pass("Light", { { Shadow, PixelShaderResource }, { Target, RenderTarget } }),
+    };
+
+    CompiledRenderGraph graph = RenderGraphCompiler::compile(resources, passes);
+    REQUIRE(graph.passes.size() == 4);
+
+    // Begins right after its last use, ends right before the next
+    std::vector<Barrier> begin = ofResource(graph.passes[0].after, Shadow);
+    std::vector<Barrier> end = ofResource(graph.passes[3].before, Shadow);
+    REQUIRE(begin.size() == 1);
+    REQUIRE(end.size() == 1);
+    CHECK(isTransition(begin[0], DepthWrite, PixelShaderResource, Barrier::Split::Begin));
+    CHECK(isTransition(end[0], DepthWrite, PixelShaderResource, Barrier::Split::End));
+
+    // Adjacent uses never split
+    std::vector<Barrier> other = ofResource(graph.passes[2].before, Other);
+    REQUIRE(other.size() == 1);
+    CHECK(other[0].split == Barrier::Split::None);
+    CHECK(ofResource(graph.passes[1].after, Other).empty());
+
+    CHECK(graph.stats.splitBarriers == 1);
+}
+
+TEST_CASE("split barriers never cross a command list change")
+{
+    enum { Target, Shadow, Other };
+    const std::vector<RenderGraphResourceDesc> resources =
+    {
+        imported("Target", Common, Common),
+        transient("Shadow", 4 * MB),
+        transient("Other", 4 * MB),
+    };
+
+    std::vector<RenderGraphPassDesc> passes =
+    {
+        pass("Shadow", { { Shadow, DepthWrite } }),
+        pass("Parallel", { { Other, RenderTarget } }, false, true),
+        pass("Light", { { Shadow, PixelShaderResource }, { Other, PixelShaderResource }, { Target, RenderTarget } }),
+    };
+
+    CompiledRenderGraph graph = RenderGraphCompiler::compile(resources, passes);
+    CHECK(ofResource(graph.passes[0].after, Shadow).empty());
+    std::vector<Barrier> whole = ofResource(graph.passes[2].before, Shadow);
+    REQUIRE(whole.size() == 1);
+    CHECK(whole[0].split == Barrier::Split::None);
+    CHECK(graph.stats.splitBarriers == 0);
+
+    // The same graph without the flag splits
+    passes[1].changesCommandList = false;
+    graph = RenderGraphCompiler::compile(resources, passes);
+    CHECK(graph.stats.splitBarriers == 1);
+}
+
+TEST_CASE("the final batch splits like one more pass")
+{
+    enum { BackBuffer, Target };
+    const std::vector<RenderGraphResourceDesc> resources =
+    {
+        imported("BackBuffer", Present, Present),
+        imported("Target", Common, Common),
+    };
+
+    const std::vector<RenderGraphPassDesc> passes =
+    {
+        pass("Present", { { BackBuffer, RenderTarget } }),
+        pass("Tools", { { Target, RenderTarget } }),
+    };
+
+    CompiledRenderGraph graph = RenderGraphCompiler::compile(resources, passes);
+    REQUIRE(ofResource(graph.passes[0].after, BackBuffer).size() == 1);
+    std::vector<Barrier> end = ofResource(graph.finalBarriers, BackBuffer);
+    REQUIRE(end.size() == 1);
+    CHECK(isTransition(end[0], RenderTarget, Present, Barrier::Split::End));
+
+    // Used by the last pass: nothing to overlap with
+    std::vector<Barrier> target = ofResource(graph.finalBarriers, Target);
+    REQUIRE(target.size() == 1);
+    CHECK(target[0].split == Barrier::Split::None);
+}
+
+// ----------------------------------------------------------------------------
+// Aliasing
+// ----------------------------------------------------------------------------
+
+TEST_CASE("first-fit aliasing packs disjoint lifetimes")
+{
+    enum { Target, A, B, C };
+    const std::vector<RenderGraphResourceDesc> resources =
+    {
+        imported("Target", Common, Common),
+        transient("A", 4 * MB),             // passes 0..1
+        transient("B", 4 * MB),             // passes 2..3
+        transient("C", 2 * MB),             // passes 1..2: overlaps both
+    };
+
+    const std::vector<RenderGraphPassDesc> passes =
+    {
+        pass("0", { { A, RenderTarget } }),
+        pass("1", { { A, PixelShaderResource }, { C, RenderTarget } }),
+        pass("2", { { C, PixelShaderResource }, { B, RenderTarget } }),
+        pass("3", { { B, PixelShaderResource }, { Target, RenderTarget } }),
+    };
+
+    CompiledRenderGraph graph = RenderGraphCompiler::compile(resources, passes);
+
+    CHECK(graph.placements[A].offset == 0);
+    CHECK(graph.placements[B].offset == 0);
+    CHECK(graph.placements[C].offset == 4 * MB);
+    CHECK(graph.placements[A].firstPass == 0 && graph.placements[A].lastPass == 1);
+    CHECK(graph.placements[B].firstPass == 2 && graph.placements[B].lastPass == 3);
+    CHECK(graph.placements[Target].offset == CompiledRenderGraph::Placement::NONE);
+
+    CHECK(graph.stats.heapSize == 6 * MB);
+    CHECK(graph.stats.unaliasedSize == 10 * MB);
+}
+
+TEST_CASE("first-fit takes the lowest aligned hole")
+{
+    enum { Target, Big, Left, Right, Small, Tiny };
+    const std::vector<RenderGraphResourceDesc> resources =
+    {
+        imported("Target", Common, Common),
+        transient("Big", 8 * MB),                   // passes 0..1, placed first
+        transient("Left", 3 * MB),                  // passes 2..3
+        transient("Right", 3 * MB + 100),           // passes 2..3, odd size
+        transient("Small", 1 * MB, 4 * MB),         // passes 3..4, needs 4 MB alignment
+        transient("Tiny", 64 * KB),                 // passes 3..4
+    };
+
+    const std::vector<RenderGraphPassDesc> passes =
+    {
+        pass("0", { { Big, RenderTarget } }),
+        pass("1", { { Big, PixelShaderResource }, { Target, RenderTarget } }),
+        pass("2", { { Left, RenderTarget }, { Right, RenderTarget } }),
+        pass("3", { { Left, PixelShaderResource }, { Right, PixelShaderResource }, { Small, RenderTarget }, { Tiny, RenderTarget } }),
+        pass("4", { { Small, PixelShaderResource }, { Tiny, PixelShaderResource }, { Target, RenderTarget } }),
+    };
+
+    CompiledRenderGraph graph = RenderGraphCompiler::compile(resources, passes);
+
+    // Largest first: Big at 0, Right and Left reuse its memory once it is dead
+    CHECK(graph.placements[Big].offset == 0);
+    CHECK(graph.placements[Right].offset == 0);
+    CHECK(graph.placements[Left].offset == 3 * MB + 64 * KB);        // after Right, 64 KB aligned
+
+    // Small overlaps Left and Right in time: first 4 MB boundary past both
+    CHECK(graph.placements[Small].offset == 8 * MB);
+    CHECK(graph.placements[Small].offset % (4 * MB) == 0);
+
+    // Tiny fits in the hole Small's alignment left behind Left
+    CHECK(graph.placements[Tiny].offset == 6 * MB + 64 * KB);
+    CHECK(graph.stats.heapSize == 9 * MB);
+
+    // Every pair alive at the same time is disjoint in memory
+    for (uint32_t a = 1; a < resources.size(); ++a)
+    {
+        for (uint32_t b = a + 1; b < resources.size(); ++b)
+        {
+            const CompiledRenderGraph::Placement& pa = graph.placements[a];
+            const CompiledRenderGraph::Placement& pb = graph.placements[b];
+            const bool together = pa.firstPass <= pb.lastPass && pb.firstPass <= pa.lastPass;
+            const bool sharing = pa.offset < pb.offset + resources[b].size && pb.offset < pa.offset + resources[a].size;
+            CHECK(!(together && sharing));
+        }
+    }
+}
+
+TEST_CASE("aliasing barriers activate shared memory")
+{
+    enum { Target, A, B, C };
+    const std::vector<RenderGraphResourceDesc> resources =
+    {
+        imported("Target", Common, Common),
+        transient("A", 4 * MB),
+        transient("B", 4 * MB),
+        transient("C", 2 * MB),
+    };
+
+    const std::vector<RenderGraphPassDesc> passes =
+    {
+        pass("0", { { A, RenderTarget } }),
+        pass("1", { { A, PixelShaderResource }, { C, RenderTarget } }),
+        pass("2", { { C, PixelShaderResource }, { B, RenderTarget } }),
+        pass("3", { { B, PixelShaderResource }, { Target, RenderTarget } }),
+    };
+
+    CompiledRenderGraph graph = RenderGraphCompiler::compile(resources, passes);
+
+    // B takes over A's memory before pass 2
+    std::vector<Barrier> toB = ofResource(graph.passes[2].before, B, Barrier::Type::Aliasing);
+    REQUIRE(toB.size() == 1);
+    CHECK(toB[0].before == A);
+    CHECK(graph.placements[B].aliased);
+
+    // A shares with B too: last frame's B was there, no occupant this frame
+    std::vector<Barrier> toA = ofResource(graph.passes[0].before, A, Barrier::Type::Aliasing);
+    REQUIRE(toA.size() == 1);
+    CHECK(toA[0].before == Barrier::NONE);
+    CHECK(graph.placements[A].aliased);
+
+    // C has memory of its own
+    CHECK(!graph.placements[C].aliased);
+    CHECK(ofResource(graph.passes[1].before, C, Barrier::Type::Aliasing).empty());
+
+    CHECK(graph.stats.aliasingBarriers == 2);
+
+    // The aliasing barrier goes in the same batch as the transition
+    CHECK(ofResource(graph.passes[2].before, B).size() == 1);
+}
+
+TEST_CASE("aliasing barrier names the latest previous occupant")
+{
+    enum { Target, A, B, C };
+    const std::vector<RenderGraphResourceDesc> resources =
+    {
+        imported("Target", Common, Common),
+        transient("A", 4 * MB),
+        transient("B", 4 * MB),
+        transient("C", 4 * MB),
+    };
+
+    // Three disjoint lifetimes in a row, all at offset 0
+    const std::vector<RenderGraphPassDesc> passes =
+    {
+        pass("0", { { A, UnorderedAccess } }, true),
+        pass("1", { { A, PixelShaderResource } }, true),
+        pass("2", { { B, UnorderedAccess } }, true),
+        pass("3", { { B, PixelShaderResource } }, true),
+        pass("4", { { C, UnorderedAccess } }, true),
+        pass("5", { { C, PixelShaderResource }, { Target, RenderTarget } }),
+    };
+
+    CompiledRenderGraph graph = RenderGraphCompiler::compile(resources, passes);
+    CHECK(graph.placements[A].offset == 0 && graph.placements[B].offset == 0 && graph.placements[C].offset == 0);
+    CHECK(graph.stats.heapSize == 4 * MB);
+
+    std::vector<Barrier> toC = ofResource(graph.passes[4].before, C, Barrier::Type::Aliasing);
+    REQUIRE(toC.size() == 1);
+    CHECK(toC[0].before == B);
+
+    std::vector<Barrier> toB = ofResource(graph.passes[2].before, B, Barrier::Type::Aliasing);
+    REQUIRE(toB.size() == 1);
+    CHECK(toB[0].before == A);
+}
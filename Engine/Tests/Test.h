@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+// ============================================================================
+// Test
+// ----------------------------------------------------------------------------
+// Minimal test registry for the headless tests: TEST_CASE(name) registers a
+// function, CHECK() records a failure and keeps going, REQUIRE() stops the
+// case. Every executable links TestMain.cpp, which runs all the cases of
+// the file (or the ones named on the command line) and returns non-zero
+// when any check failed.
+// ============================================================================
+
+namespace test
+{
+    struct Case
+    {
+        const char*           name;
+        std::function<void()> run;
+    };
+
+    std::vector<Case>& registry();
+    void fail(const char* file, int line, const char* expression);
+
+    struct Registrar
+    {
+        Registrar(const char* name, std::function<void()> run) { registry().push_back({ name, std::move(run) }); }
+    };
+
+    // Thrown by REQUIRE(), caught by the runner
+    struct Abort {};
+}
+
+#define TEST_CONCAT_(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT_(a, b)
+
+#define TEST_CASE(name)                                                                          \
+    static void TEST_CONCAT(testCase_, __LINE__)();                                              \
+    static test::Registrar TEST_CONCAT(testRegistrar_, __LINE__)(name, TEST_CONCAT(testCase_, __LINE__)); \
+    static void TEST_CONCAT(testCase_, __LINE__)()
+
+#define CHECK(expression) \
+    do { if (!(expression)) test::fail(__FILE__, __LINE__, #expression); } while (false)
+
+#define REQUIRE(expression) \
+    do { if (!(expression)) { test::fail(__FILE__, __LINE__, #expression); throw test::Abort(); } } while (false)
@@ -0,0 +1,65 @@
+#include "Test.h"
+
+#include <cstring>
+#include <exception>
+
+namespace
+{
+    int failures = 0;
+}
+
+std::vector<test::Case>& test::registry()
+{
+    static std::vector<Case> cases;
+    return cases;
+}
+
+void test::fail(const char* file, int line, const char* expression)
+{
+    ++failures;
+    std::printf("  %s(%d): CHECK failed: %s\n", file, line, expression);
+}
+
+// Runs every case, or the ones whose name contains an argument
+int main(int argc, char** argv)
+{
+    int run = 0, failed = 0;
+
+    for (const test::Case& testCase : test::registry())
+    {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc && !selected; ++i)
+            selected = std::strstr(testCase.name, argv[i]) != nullptr;
+        if (!selected)
+            continue;
+
+        const int before = failures;
+        std::printf("[ RUN  ] %s\n", testCase.name);
+
+        try
+        {
+            testCase.run();
+        }
+        catch (const test::Abort&)
+        {
+        }
+        catch (const std::exception& e)
+        {
+            test::fail(__FILE__, __LINE__, e.what());
+        }
+
+        ++run;
+        if (failures != before)
+        {
+            ++failed;
+            std::printf("[ FAIL ] %s\n", testCase.name);
+        }
+        else
+        {
+            std::printf("[  OK  ] %s\n", testCase.name);
+        }
+    }
+
+    std::printf("%d case(s), %d failed\n", run, failed);
+    return failed ? 1 : 0;
+}